@@ -18,8 +18,11 @@
 #include "../../Source/Core/Audio/BuiltIn/MetronomeSynth.cpp"
 #include "../../Source/Core/Audio/BuiltIn/SoundFontSynthAudioPlugin.cpp"
 #include "../../Source/Core/Audio/Instruments/Instrument.cpp"
+#include "../../Source/Core/Audio/Instruments/ParameterAutomation.cpp"
+#include "../../Source/Core/Audio/Instruments/NotePreviewScheduler.cpp"
 #include "../../Source/Core/Audio/Instruments/OrchestraPit.cpp"
 #include "../../Source/Core/Audio/Instruments/PluginScanner.cpp"
+#include "../../Source/Core/Audio/Instruments/PluginScanCache.cpp"
 #include "../../Source/Core/Audio/Instruments/SerializablePluginDescription.cpp"
 #include "../../Source/Core/Audio/Transport/MidiRecorder.cpp"
 #include "../../Source/Core/Audio/Transport/PlayerThread.cpp"
@@ -55,6 +58,8 @@
 #include "../../Source/Core/CommandPalette/CommandPaletteProjectsList.cpp"
 #include "../../Source/Core/CommandPalette/CommandPaletteTimelineEvents.cpp"
 #include "../../Source/Core/Midi/Patterns/Modifiers/GeneratedSequenceBuilder.cpp"
+#include "../../Source/Core/Midi/Patterns/Modifiers/ParametricSequenceModifier.cpp"
+#include "../../Source/Core/Midi/Patterns/Modifiers/ParametricExpression.cpp"
 #include "../../Source/Core/Midi/Patterns/Clip.cpp"
 #include "../../Source/Core/Midi/Patterns/Pattern.cpp"
 #include "../../Source/Core/Midi/Sequences/Events/AnnotationEvent.cpp"
@@ -67,6 +72,8 @@
 #include "../../Source/Core/Midi/Sequences/AutomationSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/KeySignaturesSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/MidiSequence.cpp"
+#include "../../Source/Core/Midi/Sequences/MidiFileWriter.cpp"
+#include "../../Source/Core/Midi/Sequences/MidiTrackDemultiplexer.cpp"
 #include "../../Source/Core/Midi/Sequences/PianoSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesAggregator.cpp"
@@ -97,6 +104,7 @@
 #include "../../Source/Core/Tree/ProjectMetadata.cpp"
 #include "../../Source/Core/Tree/ProjectTimeline.cpp"
 #include "../../Source/Core/Tree/ProjectNode.cpp"
+#include "../../Source/Core/Tree/ProjectLoader.cpp"
 #include "../../Source/Core/Tree/RootNode.cpp"
 #include "../../Source/Core/Tree/SettingsNode.cpp"
 #include "../../Source/Core/Tree/TrackGroupNode.cpp"
@@ -137,6 +145,7 @@
 #include "../../Source/Core/Workspace/Workspace.cpp"
 #include "../../Source/Core/App.cpp"
 #include "../../Source/UI/Common/ColourButton.cpp"
+#include "../../Source/UI/Common/FrameClock.cpp"
 #include "../../Source/UI/Common/ColourSwatches.cpp"
 #include "../../Source/UI/Common/CommandIDs.cpp"
 #include "../../Source/UI/Common/ColourIDs.cpp"
@@ -241,6 +250,7 @@
 #include "../../Source/UI/Sequencer/Helpers/TimelineWarningMarker.cpp"
 #include "../../Source/UI/Sequencer/Helpers/PatternOperations.cpp"
 #include "../../Source/UI/Sequencer/Helpers/SequencerOperations.cpp"
+#include "../../Source/UI/Sequencer/Helpers/NoteBatchTransform.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/AutomationCurveClipComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/AutomationStepsClipComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/PianoClipComponent.cpp"
@@ -263,6 +273,7 @@
 #include "../../Source/UI/Sequencer/MiniMaps/KeySignaturesMap/KeySignatureSmallComponent.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/KeySignaturesMap/KeySignaturesProjectMap.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/PianoMap/PianoProjectMap.cpp"
+#include "../../Source/UI/Sequencer/MiniMaps/PianoMap/PianoSequenceRaster.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/TimeSignaturesMap/TimeSignatureLargeComponent.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/TimeSignaturesMap/TimeSignatureSmallComponent.cpp"
 #include "../../Source/UI/Sequencer/MiniMaps/TimeSignaturesMap/TimeSignaturesProjectMap.cpp"
@@ -21,11 +21,13 @@
 #include "HelioTheme.h"
 #include "Config.h"
 #include "Icons.h"
+#include "FrameClock.h"
 
 #include "DocumentHelpers.h"
 #include "XmlSerializer.h"
 #include "SerializationKeys.h"
 #include "SerializablePluginDescription.h"
+#include "PluginScanner.h"
 
 #include "MainLayout.h"
 #include "ScaledComponentProxy.h"
@@ -204,6 +206,21 @@ private:
 };
 
 
+//===----------------------------------------------------------------------===//
+// StartupPhase
+//===----------------------------------------------------------------------===//
+
+StartupPhase::StartupPhase(const char *name) noexcept :
+    name(name),
+    startTimeMs(Time::getMillisecondCounterHiRes()) {}
+
+StartupPhase::~StartupPhase()
+{
+    // logged in release builds as well, to compare the startup times on users' machines
+    Logger::writeToLog("Startup: " + String(this->name) + " took " +
+        String(Time::getMillisecondCounterHiRes() - this->startTimeMs, 2) + " ms");
+}
+
 //===----------------------------------------------------------------------===//
 // Clipboard
 //===----------------------------------------------------------------------===//
@@ -266,6 +283,11 @@ class Clipboard &App::Clipboard() noexcept
     return static_cast<App *>(getInstance())->clipboard;
 }
 
+class FrameClock &App::FrameClock() noexcept
+{
+    return *static_cast<App *>(getInstance())->frameClock;
+}
+
 static Point<double> getScreenInCm()
 {
     const auto *mainDisplay = Desktop::getInstance().getDisplays().getPrimaryDisplay();
@@ -513,15 +535,31 @@ void App::initialise(const String &commandLine)
         const auto album = Desktop::rotatedClockwise + Desktop::rotatedAntiClockwise;
         Desktop::getInstance().setOrientationsEnabled(album);
         
-        this->config = make<class Config>();
-        this->config->initResources();
+        StartupPhase startup("initialise");
+
+        // the startup steps depend on each other in this order:
+        // config -> theme (needs colour schemes) -> workspace (needs config,
+        // and loads the audio devices and projects) -> window -> network (needs workspace);
+        // the only independent step is parsing the resources which are not
+        // needed for the first screen, so the config does that in the background
+
+        {
+            StartupPhase phase("config");
+            this->config = make<class Config>();
+            this->config->initResources();
+        }
+
+        {
+            StartupPhase phase("theme");
+            auto helioTheme = make<HelioTheme>();
+            helioTheme->initResources();
+            helioTheme->initColours(this->config->getColourSchemes()->getCurrent());
 
-        auto helioTheme = make<HelioTheme>();
-        helioTheme->initResources();
-        helioTheme->initColours(this->config->getColourSchemes()->getCurrent());
+            this->theme = move(helioTheme);
+            LookAndFeel::setDefaultLookAndFeel(this->theme.get());
+        }
 
-        this->theme = move(helioTheme);
-        LookAndFeel::setDefaultLookAndFeel(this->theme.get());
+        this->frameClock = make<class FrameClock>();
 
 #if JUCE_UNIT_TESTS
 
@@ -563,10 +601,16 @@ void App::initialise(const String &commandLine)
         const auto shouldEnableOpenGL = this->config->getUiFlags()->isOpenGlRendererEnabled();
         const auto shouldUseNativeTitleBar = this->config->getUiFlags()->isNativeTitleBarEnabled();
 
-        this->window = make<MainWindow>();
-        this->window->init(shouldEnableOpenGL, shouldUseNativeTitleBar);
+        {
+            StartupPhase phase("main window");
+            this->window = make<MainWindow>();
+            this->window->init(shouldEnableOpenGL, shouldUseNativeTitleBar);
+        }
 
-        this->network = make<class Network>(*this->workspace.get());
+        {
+            StartupPhase phase("network");
+            this->network = make<class Network>(*this->workspace.get());
+        }
 
         this->config->getUiFlags()->addListener(this);
         
@@ -604,6 +648,7 @@ void App::shutdown()
             this->workspace = nullptr;
         }
 
+        this->frameClock = nullptr;
         this->theme = nullptr;
         this->config = nullptr;
 
@@ -657,6 +702,11 @@ void App::systemRequestedQuit()
 
 void App::suspended()
 {
+    if (this->frameClock != nullptr)
+    {
+        this->frameClock->setSuspended(true);
+    }
+
 #if !JUCE_IOS
     // on iOS we have the background audio capability
     if (this->workspace != nullptr)
@@ -673,6 +723,11 @@ void App::suspended()
 
 void App::resumed()
 {
+    if (this->frameClock != nullptr)
+    {
+        this->frameClock->setSuspended(false);
+    }
+
 #if JUCE_ANDROID
     this->window->attachOpenGLContext();
 #endif
@@ -699,26 +754,19 @@ void App::checkPlugin(const String &markerFile)
             // delete the file immediately so that host will know if we crashed
             tempFile.deleteFile();
 
-            KnownPluginList pluginList;
-            OwnedArray<PluginDescription> typesFound;
-
             AudioPluginFormatManager formatManager;
             AudioCore::initAudioFormats(formatManager);
 
-            for (int i = 0; i < formatManager.getNumFormats(); ++i)
-            {
-                const auto format = formatManager.getFormat(i);
-                pluginList.scanAndAddFile(pluginPath, false, typesFound, *format);
-            }
+            const auto typesFound = PluginScanner::scanFile(formatManager, pluginPath);
 
             // let host know if we haven't crashed at the moment
-            if (typesFound.size() != 0)
+            if (!typesFound.isEmpty())
             {
                 SerializedData typesNode(Serialization::Core::instrumentsList);
 
-                for (const auto *description : typesFound)
+                for (const auto &description : typesFound)
                 {
-                    const SerializablePluginDescription sd(*description);
+                    const SerializablePluginDescription sd(description);
                     typesNode.appendChild(sd.serialize());
                 }
 
@@ -22,6 +22,7 @@ class Network;
 class Workspace;
 class MainWindow;
 class MainLayout;
+class FrameClock;
 
 #include "Serializable.h"
 #include "UserInterfaceFlags.h"
@@ -44,6 +45,24 @@ private:
     JUCE_PREVENT_HEAP_ALLOCATION
 };
 
+// logs how long each of the startup steps takes,
+// so that we could keep an eye on the cold start time
+class StartupPhase final
+{
+public:
+
+    explicit StartupPhase(const char *name) noexcept;
+    ~StartupPhase();
+
+private:
+
+    const char *name;
+    const double startTimeMs;
+
+    JUCE_DECLARE_NON_COPYABLE(StartupPhase)
+    JUCE_PREVENT_HEAP_ALLOCATION
+};
+
 class App final : public JUCEApplication,
                   private UserInterfaceFlags::Listener,
                   private AsyncUpdater
@@ -59,6 +78,7 @@ public:
     static class MainLayout &Layout() noexcept;
     static class Workspace &Workspace() noexcept;
     static class Clipboard &Clipboard() noexcept;
+    static class FrameClock &FrameClock() noexcept;
 
     static bool isRunningOnPhone();
     static bool isRunningOnTablet();
@@ -105,6 +125,7 @@ private:
     class Clipboard clipboard;
 
     UniquePointer<class LookAndFeel> theme;
+    UniquePointer<class FrameClock> frameClock;
     UniquePointer<class Config> config;
     UniquePointer<class Workspace> workspace;
     UniquePointer<class MainWindow> window;
@@ -68,7 +68,7 @@ AudioMonitor *AudioCore::getMonitor() const noexcept
 void AudioCore::addInstrument(const PluginDescription &pluginDescription,
     const String &name, Instrument::InitializationCallback callback)
 {
-    auto *instrument = this->instruments.add(new Instrument(this->formatManager, name));
+    auto *instrument = this->instruments.add(new Instrument(this->formatManager, this->instrumentsLoadingPool, name));
     this->addInstrumentToAudioDevice(instrument);
     instrument->initializeFrom(pluginDescription,
         [this, callback](Instrument *instrument)
@@ -85,7 +85,7 @@ void AudioCore::addInstrument(const PluginDescription &pluginDescription,
 
 Instrument *AudioCore::addBuiltInInstrument(const PluginDescription &pluginDescription, const String &name)
 {
-    auto *instrument = this->instruments.add(new Instrument(this->formatManager, name));
+    auto *instrument = this->instruments.add(new Instrument(this->formatManager, this->instrumentsLoadingPool, name));
     this->addInstrumentToAudioDevice(instrument);
     instrument->initializeBuiltInInstrument(pluginDescription);
     this->broadcastAddInstrument(instrument);
@@ -94,7 +94,7 @@ Instrument *AudioCore::addBuiltInInstrument(const PluginDescription &pluginDescr
 
 Instrument *AudioCore::addMidiOutputInstrument(const String &name)
 {
-    auto *instrument = this->instruments.add(new Instrument(this->formatManager, name));
+    auto *instrument = this->instruments.add(new Instrument(this->formatManager, this->instrumentsLoadingPool, name));
     this->addInstrumentToAudioDevice(instrument);
     instrument->initializeMidiOutputInstrument();
     this->broadcastAddInstrument(instrument);
@@ -693,7 +693,7 @@ void AudioCore::deserialize(const SerializedData &data)
     {
         for (const auto &instrumentNode : orchestra)
         {
-            auto instrument = make<Instrument>(this->formatManager, "");
+            auto instrument = make<Instrument>(this->formatManager, this->instrumentsLoadingPool, "");
 
             // it's important to add audio processor to device
             // before actually creating nodes and connections:
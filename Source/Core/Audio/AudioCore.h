@@ -157,6 +157,10 @@ private:
     AudioPluginFormatManager formatManager;
     AudioDeviceManager deviceManager;
 
+    // creates and restores the heavy instruments' nodes on project loading,
+    // must be destroyed before the format manager it uses:
+    ThreadPool instrumentsLoadingPool;
+
     Atomic<bool> isMuted = false;
 
 private:
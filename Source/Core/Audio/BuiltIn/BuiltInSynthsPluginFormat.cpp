@@ -60,7 +60,10 @@ void BuiltInSynthsPluginFormat::findAllTypesForFile(OwnedArray<PluginDescription
 bool BuiltInSynthsPluginFormat::fileMightContainThisPluginType(const String &fileOrIdentifier)
 {
     return fileOrIdentifier.isEmpty() ||
-        fileOrIdentifier == BuiltInSynthsPluginFormat::formatIdentifier;
+        fileOrIdentifier == BuiltInSynthsPluginFormat::formatIdentifier ||
+        fileOrIdentifier == DefaultSynthAudioPlugin::instrumentId ||
+        fileOrIdentifier == MetronomeSynthAudioPlugin::instrumentId ||
+        fileOrIdentifier == SoundFontSynthAudioPlugin::instrumentId;
 }
 
 void BuiltInSynthsPluginFormat::createPluginInstance(const PluginDescription &desc,
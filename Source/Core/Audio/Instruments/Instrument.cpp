@@ -23,13 +23,16 @@
 #include "SerializationKeys.h"
 #include "DefaultSynthAudioPlugin.h"
 #include "MetronomeSynthAudioPlugin.h"
+#include "SoundFontSynthAudioPlugin.h"
 #include "BuiltInSynthsPluginFormat.h"
 #include "KeyboardMapping.h"
 #include "Workspace.h"
 #include "AudioCore.h"
 
-Instrument::Instrument(AudioPluginFormatManager &formatManager, const String &name) :
+Instrument::Instrument(AudioPluginFormatManager &formatManager,
+    ThreadPool &loadingPool, const String &name) :
     formatManager(formatManager),
+    loadingPool(loadingPool),
     instrumentName(name),
     instrumentId()
 {
@@ -583,6 +586,11 @@ void Instrument::removeConnection(AudioProcessorGraph::Connection connection)
 
 void Instrument::reset()
 {
+    // the nodes still being loaded will be discarded
+    this->nodesLoadingVersion++;
+    this->numNodesGroupsLoading = 0;
+    this->onAllNodesDeserialized = nullptr;
+
     PluginWindow::closeAllCurrentlyOpenWindows();
     this->processorGraph->clear();
     this->instrumentName.clear();
@@ -700,10 +708,12 @@ void Instrument::deserialize(const SerializedData &data)
         });
     }
 
-    // we'll try to load simple plugins as early as possible, i.e. synchronously;
-    // these are standard i/o nodes and built-in plugins for now, but maybe we'll
-    // add more conditions later, e.g. will only load AUv3 plugins asynchronously?
+    // we'll try to load simple plugins as early as possible, i.e. synchronously,
+    // the heavy built-in ones will be loaded in the worker threads in parallel,
+    // and all the others will be created on the message thread one by one
     Array<SerializedData> nodesToDeserializeAsync;
+    Array<SerializedData> nodesToDeserializeInWorkerThreads;
+    Array<SerializablePluginDescription> workerThreadsNodesDescriptions;
     int numNodesInDescription = 0;
     forEachChildWithType(root, nodeState, Serialization::Audio::node)
     {
@@ -712,8 +722,8 @@ void Instrument::deserialize(const SerializedData &data)
 
         numNodesInDescription++;
 
-        if (desc.pluginFormatName == BuiltInSynthsPluginFormat::formatName ||
-            desc.pluginFormatName == InternalIODevicesPluginFormat::formatName)
+        const auto loadingMode = this->getLoadingModeFor(desc);
+        if (loadingMode == NodeLoadingMode::Synchronous)
         {
             String error;
 
@@ -726,7 +736,7 @@ void Instrument::deserialize(const SerializedData &data)
             AudioProcessorGraph::Node::Ptr node = nullptr;
             if (error.isEmpty())
             {
-                node = this->addNode(move(instance), nodeState);
+                node = this->addNode(move(instance), nodeState, true);
             }
 
             if (node == nullptr)
@@ -735,14 +745,20 @@ void Instrument::deserialize(const SerializedData &data)
                 nodesToDeserializeAsync.add(nodeState);
             }
         }
+        else if (loadingMode == NodeLoadingMode::WorkerThread)
+        {
+            nodesToDeserializeInWorkerThreads.add(nodeState);
+            workerThreadsNodesDescriptions.add(desc);
+        }
         else
         {
             nodesToDeserializeAsync.add(nodeState);
         }
     }
 
-    this->deserializeNodesAsync(nodesToDeserializeAsync,
-        [this, numNodesInDescription, connectionDescriptions]()
+    const auto loadingVersion = this->nodesLoadingVersion;
+
+    this->onAllNodesDeserialized = [this, numNodesInDescription, connectionDescriptions]()
     {
         for (const auto &connectionInfo : connectionDescriptions)
         {
@@ -766,6 +782,21 @@ void Instrument::deserialize(const SerializedData &data)
         }
 
         this->sendChangeMessage();
+    };
+
+    // each worker thread node is a group of its own, plus
+    // one group for all nodes created on the message thread:
+    this->numNodesGroupsLoading = nodesToDeserializeInWorkerThreads.size() + 1;
+
+    for (int i = 0; i < nodesToDeserializeInWorkerThreads.size(); ++i)
+    {
+        this->deserializeNodeInWorkerThread(workerThreadsNodesDescriptions.getReference(i),
+            nodesToDeserializeInWorkerThreads.getReference(i), loadingVersion);
+    }
+
+    this->deserializeNodesAsync(nodesToDeserializeAsync, [this, loadingVersion]()
+    {
+        this->onNodesGroupDeserialized(loadingVersion);
     });
 }
 
@@ -790,7 +821,7 @@ void Instrument::deserializeNodesAsync(Array<SerializedData> nodesToDeserialize,
     const auto callback = [this, dpiDisabler, nodesToDeserialize, tree, allDoneCallback]
     (UniquePointer<AudioPluginInstance> instance, const String &error)
     {
-        this->addNode(move(instance), tree);
+        this->addNode(move(instance), tree, true);
         this->deserializeNodesAsync(nodesToDeserialize, allDoneCallback);
     };
 
@@ -800,6 +831,108 @@ void Instrument::deserializeNodesAsync(Array<SerializedData> nodesToDeserialize,
         callback);
 }
 
+Instrument::NodeLoadingMode Instrument::getLoadingModeFor(const PluginDescription &desc) const
+{
+    if (desc.pluginFormatName == InternalIODevicesPluginFormat::formatName)
+    {
+        return NodeLoadingMode::Synchronous;
+    }
+
+    if (desc.pluginFormatName == BuiltInSynthsPluginFormat::formatName)
+    {
+        // built-in synths don't need the message thread to be created and restored,
+        // but only the sound font player is heavy enough to be worth it; the default
+        // and metronome synths are created synchronously, because AudioCore needs
+        // them right after deserialization to detect the built-in instruments
+        return desc.name == SoundFontSynthAudioPlugin::instrumentName ?
+            NodeLoadingMode::WorkerThread : NodeLoadingMode::Synchronous;
+    }
+
+    // all other formats' plugins are only allowed
+    // to be created on the message thread
+    return NodeLoadingMode::MessageThread;
+}
+
+void Instrument::deserializeNodeInWorkerThread(const PluginDescription &description,
+    const SerializedData &nodeState, uint32 loadingVersion)
+{
+    BuiltInSynthsPluginFormat *builtInFormat = nullptr;
+    for (int i = 0; i < this->formatManager.getNumFormats(); ++i)
+    {
+        if (auto *format = dynamic_cast<BuiltInSynthsPluginFormat *>(this->formatManager.getFormat(i)))
+        {
+            builtInFormat = format;
+            break;
+        }
+    }
+
+    if (builtInFormat == nullptr)
+    {
+        jassertfalse;
+        this->deserializeNodesAsync({ nodeState }, [this, loadingVersion]()
+        {
+            this->onNodesGroupDeserialized(loadingVersion);
+        });
+        return;
+    }
+
+    const auto sampleRate = this->processorGraph->getSampleRate();
+    const auto blockSize = this->processorGraph->getBlockSize();
+    const WeakReference<Instrument> weakThis(this);
+
+    // the format instance is owned by the format manager,
+    // which outlives the pool; the instrument might not,
+    // so the results are passed back via a weak reference
+    this->loadingPool.addJob([weakThis, builtInFormat, description,
+        nodeState, sampleRate, blockSize, loadingVersion]()
+    {
+        auto instance = std::make_shared<UniquePointer<AudioPluginInstance>>();
+
+        // the built-in format calls back synchronously
+        builtInFormat->createPluginInstance(description, sampleRate, blockSize,
+            [&instance](UniquePointer<AudioPluginInstance> newInstance, const String &)
+            {
+                *instance = move(newInstance);
+            });
+
+        if (*instance != nullptr)
+        {
+            // not in the graph yet, so nothing else can touch it
+            Instrument::restoreNodeState(**instance, nodeState);
+        }
+
+        MessageManager::callAsync([weakThis, instance, nodeState, loadingVersion]()
+        {
+            if (weakThis == nullptr ||
+                weakThis->nodesLoadingVersion != loadingVersion)
+            {
+                return;
+            }
+
+            weakThis->addNode(move(*instance), nodeState, false);
+            weakThis->onNodesGroupDeserialized(loadingVersion);
+        });
+    });
+}
+
+void Instrument::onNodesGroupDeserialized(uint32 loadingVersion)
+{
+    if (this->nodesLoadingVersion != loadingVersion)
+    {
+        return; // reset or deserialized again meanwhile
+    }
+
+    jassert(this->numNodesGroupsLoading > 0);
+    this->numNodesGroupsLoading--;
+
+    if (this->numNodesGroupsLoading == 0 && this->onAllNodesDeserialized != nullptr)
+    {
+        const auto callback = move(this->onAllNodesDeserialized);
+        this->onAllNodesDeserialized = nullptr;
+        callback();
+    }
+}
+
 AudioProcessorGraph::Node::Ptr Instrument::addNode(const PluginDescription &desc, double x, double y)
 {
     String errorMessage;
@@ -828,7 +961,7 @@ AudioProcessorGraph::Node::Ptr Instrument::addNode(const PluginDescription &desc
 }
 
 AudioProcessorGraph::Node::Ptr Instrument::addNode(UniquePointer<AudioPluginInstance> instance,
-    const SerializedData &data)
+    const SerializedData &data, bool shouldRestoreState)
 {
     if (instance == nullptr)
     {
@@ -837,13 +970,6 @@ AudioProcessorGraph::Node::Ptr Instrument::addNode(UniquePointer<AudioPluginInst
 
     using namespace Serialization;
 
-    MemoryBlock nodeStateBlock;
-    const String state = data.getProperty(Audio::pluginState);
-    if (state.isNotEmpty())
-    {
-        nodeStateBlock.fromBase64Encoding(state);
-    }
-
     const uint32 nodeUid = int(data.getProperty(Audio::nodeId));
     const String nodeHash = data.getProperty(Audio::nodeHash);
     const double nodeX = data.getProperty(UI::positionX);
@@ -862,11 +988,10 @@ AudioProcessorGraph::Node::Ptr Instrument::addNode(UniquePointer<AudioPluginInst
         return nullptr;
     }
 
-    if (nodeStateBlock.getSize() > 0)
+    if (shouldRestoreState)
     {
         node->getProcessor()->suspendProcessing(true);
-        node->getProcessor()->
-            setStateInformation(nodeStateBlock.getData(), int(nodeStateBlock.getSize()));
+        Instrument::restoreNodeState(*node->getProcessor(), data);
         node->getProcessor()->suspendProcessing(false);
     }
 
@@ -879,6 +1004,23 @@ AudioProcessorGraph::Node::Ptr Instrument::addNode(UniquePointer<AudioPluginInst
     return node;
 }
 
+void Instrument::restoreNodeState(AudioProcessor &processor, const SerializedData &data)
+{
+    const String state = data.getProperty(Serialization::Audio::pluginState);
+    if (state.isEmpty())
+    {
+        return;
+    }
+
+    MemoryBlock nodeStateBlock;
+    nodeStateBlock.fromBase64Encoding(state);
+
+    if (nodeStateBlock.getSize() > 0)
+    {
+        processor.setStateInformation(nodeStateBlock.getData(), int(nodeStateBlock.getSize()));
+    }
+}
+
 void Instrument::configureNode(AudioProcessorGraph::Node::Ptr node,
     const PluginDescription &desc, double x, double y)
 {
@@ -915,6 +1057,7 @@ void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
             const ScopedLock sl(this->lock);
             oldOne = this->isPrepared ? this->processor : nullptr;
             this->processor = newOne;
+            this->processorGraph = dynamic_cast<AudioProcessorGraph *>(newOne);
             this->isPrepared = true;
         }
 
@@ -933,6 +1076,8 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
 
     this->incomingMidi.clear();
     this->messageCollector.removeNextBlockOfMessages(this->incomingMidi, numSamples);
+    this->notePreviewScheduler.renderNextBlock(this->incomingMidi,
+        numSamples, Time::getMillisecondCounterHiRes());
     int totalNumChans = 0;
 
     if (numInputChannels > numOutputChannels)
@@ -981,7 +1126,16 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
 
             if (!this->processor->isSuspended())
             {
-                this->processor->processBlock(buffer, this->incomingMidi);
+                if (this->processorGraph != nullptr)
+                {
+                    // the automated plugin parameters are applied sample-accurately:
+                    this->parameterAutomation.processBlock(*this->processorGraph,
+                        buffer, this->incomingMidi);
+                }
+                else
+                {
+                    this->processor->processBlock(buffer, this->incomingMidi);
+                }
 
                 // if the MIDI message buffer is not empty here,
                 // the processor wants to send events to MIDI output:
@@ -1023,6 +1177,7 @@ void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const dev
     this->numOutputChans = numChansOut;
 
     this->messageCollector.reset(sampleRate);
+    this->notePreviewScheduler.prepareToPlay(sampleRate, Time::getMillisecondCounterHiRes());
     this->channels.calloc(jmax(numChansIn, numChansOut) + 2);
 
     if (this->processor != nullptr)
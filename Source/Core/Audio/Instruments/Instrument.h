@@ -19,13 +19,17 @@
 
 class KeyboardMapping;
 
+#include "ParameterAutomation.h"
+#include "NotePreviewScheduler.h"
+
 class Instrument final :
     public Serializable,
     public ChangeBroadcaster // notifies InstrumentEditor
 {
 public:
 
-    Instrument(AudioPluginFormatManager &formatManager, const String &name);
+    Instrument(AudioPluginFormatManager &formatManager,
+        ThreadPool &loadingPool, const String &name);
     ~Instrument() override;
 
     String getName() const noexcept;
@@ -59,6 +63,7 @@ public:
 
         void setProcessor(AudioProcessor *processor);
         MidiMessageCollector &getMidiMessageCollector() noexcept { return messageCollector; }
+        NotePreviewScheduler &getNotePreviewScheduler() noexcept { return notePreviewScheduler; }
 
         void audioDeviceIOCallback(const float **, int, float **, int, int) override;
         void audioDeviceAboutToStart(AudioIODevice *) override;
@@ -68,6 +73,7 @@ public:
     private:
 
         AudioProcessor *processor = nullptr;
+        AudioProcessorGraph *processorGraph = nullptr;
         CriticalSection lock;
         double sampleRate = 0;
         int blockSize = 0;
@@ -80,6 +86,9 @@ public:
 
         MidiBuffer incomingMidi;
         MidiMessageCollector messageCollector;
+        NotePreviewScheduler notePreviewScheduler;
+
+        ParameterAutomation parameterAutomation;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallback)
     };
@@ -170,7 +179,9 @@ private:
     String getInstrumentHash() const; // should be the same on all platforms
     
     AudioProcessorGraph::Node::Ptr addNode(const PluginDescription &, double x, double y);
-    AudioProcessorGraph::Node::Ptr addNode(UniquePointer<AudioPluginInstance> instance, const SerializedData &data);
+    AudioProcessorGraph::Node::Ptr addNode(UniquePointer<AudioPluginInstance> instance,
+        const SerializedData &data, bool shouldRestoreState);
+    static void restoreNodeState(AudioProcessor &processor, const SerializedData &data);
     void configureNode(AudioProcessorGraph::Node::Ptr, const PluginDescription &, double x, double y);
 
     friend class Transport;
@@ -179,6 +190,7 @@ private:
 private:
 
     AudioPluginFormatManager &formatManager;
+    ThreadPool &loadingPool;
     Instrument::AudioCallback audioCallback;
     UniquePointer<AudioProcessorGraph> processorGraph;
 
@@ -187,6 +199,25 @@ private:
     using DeserializeNodesCallback = Function<void()>;
     void deserializeNodesAsync(Array<SerializedData> nodesToDeserialize, DeserializeNodesCallback f);
 
+    // some nodes can be created and restored in the worker threads,
+    // so that the heavy instruments of a project are loaded in parallel;
+    // the graph connections are only restored when all nodes are ready
+    enum class NodeLoadingMode : int8
+    {
+        Synchronous,
+        WorkerThread,
+        MessageThread
+    };
+
+    NodeLoadingMode getLoadingModeFor(const PluginDescription &description) const;
+    void deserializeNodeInWorkerThread(const PluginDescription &description,
+        const SerializedData &nodeState, uint32 loadingVersion);
+    void onNodesGroupDeserialized(uint32 loadingVersion);
+
+    int numNodesGroupsLoading = 0;
+    uint32 nodesLoadingVersion = 0;
+    DeserializeNodesCallback onAllNodesDeserialized;
+
     SerializedData lastValidStateFallback;
 
 private:
@@ -0,0 +1,344 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "NotePreviewScheduler.h"
+
+NotePreviewScheduler::NotePreviewScheduler()
+{
+    this->commands.allocate(NotePreviewScheduler::commandsFifoSize, true);
+}
+
+void NotePreviewScheduler::previewNote(int channel, int key,
+    float velocity, double lengthMs, double timeMs)
+{
+    jassert(key >= 0 && key < 128);
+    jassert(channel > 0 && channel <= Globals::numChannels);
+
+    this->postCommand({ Command::Type::NoteOn,
+        uint8(channel), uint8(key), velocity, timeMs, lengthMs });
+}
+
+void NotePreviewScheduler::cancelAllPreviews(double timeMs)
+{
+    this->postCommand({ Command::Type::CancelAll, 0, 0, 0.f, timeMs, 0.0 });
+}
+
+void NotePreviewScheduler::postCommand(const Command &command)
+{
+    const SpinLock::ScopedLockType lock(this->writersLock);
+
+    const auto scope = this->commandsFifo.write(1);
+    if (scope.blockSize1 > 0)
+    {
+        this->commands[scope.startIndex1] = command;
+    }
+
+    // otherwise the audio device is not running, and the queue is full
+    // of the previews which are too old to be played anyway
+}
+
+//===----------------------------------------------------------------------===//
+// Audio thread
+//===----------------------------------------------------------------------===//
+
+void NotePreviewScheduler::prepareToPlay(double newSampleRate, double timeMs)
+{
+    this->sampleRate = newSampleRate;
+    this->lastBlockTimeMs = timeMs;
+    this->blockStartSample = 0;
+    this->numVoices = 0;
+}
+
+void NotePreviewScheduler::renderNextBlock(MidiBuffer &midiMessages,
+    int numSamples, double blockTimeMs)
+{
+    if (this->sampleRate <= 0.0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    {
+        const auto scope = this->commandsFifo.read(this->commandsFifo.getNumReady());
+        scope.forEach([&](int index)
+        {
+            const auto &command = this->commands[index];
+            const bool isTooLate = command.type == Command::Type::NoteOn &&
+                blockTimeMs - command.timeMs > NotePreviewScheduler::maxCommandLatencyMs;
+
+            if (!isTooLate)
+            {
+                this->handleCommand(command, midiMessages, numSamples);
+            }
+        });
+    }
+
+    const auto blockEndSample = this->blockStartSample + numSamples;
+
+    // iterating backwards, because stopVoice moves the last voice in place
+    for (int i = this->numVoices; --i >= 0;)
+    {
+        auto &voice = this->voices[i];
+
+        if (!voice.isSounding && voice.noteOnSample < blockEndSample)
+        {
+            midiMessages.addEvent(MidiMessage::noteOn(voice.channel, voice.key, voice.velocity),
+                int(voice.noteOnSample - this->blockStartSample));
+
+            voice.isSounding = true;
+        }
+
+        if (voice.isSounding && voice.noteOffSample < blockEndSample)
+        {
+            this->stopVoice(i, midiMessages, voice.noteOffSample);
+        }
+    }
+
+    this->blockStartSample = blockEndSample;
+    this->lastBlockTimeMs = blockTimeMs;
+}
+
+// the commands posted since the previous block are spread over the current one
+// the same way as they were spread in time, like MidiMessageCollector does it
+void NotePreviewScheduler::handleCommand(const Command &command,
+    MidiBuffer &midiMessages, int numSamples)
+{
+    const auto offset = jlimit(0, numSamples - 1,
+        roundToInt((command.timeMs - this->lastBlockTimeMs) * this->sampleRate * 0.001));
+
+    const auto sample = this->blockStartSample + offset;
+
+    if (command.type == Command::Type::CancelAll)
+    {
+        for (int i = this->numVoices; --i >= 0;)
+        {
+            this->stopVoice(i, midiMessages, sample);
+        }
+
+        return;
+    }
+
+    // the repeated preview of the same key restarts it
+    for (int i = 0; i < this->numVoices; ++i)
+    {
+        if (this->voices[i].channel == command.channel &&
+            this->voices[i].key == command.key)
+        {
+            this->stopVoice(i, midiMessages, sample);
+            break;
+        }
+    }
+
+    if (this->numVoices == NotePreviewScheduler::maxNumVoices)
+    {
+        int oldestVoiceIndex = 0;
+        for (int i = 1; i < this->numVoices; ++i)
+        {
+            if (this->voices[i].noteOnSample < this->voices[oldestVoiceIndex].noteOnSample)
+            {
+                oldestVoiceIndex = i;
+            }
+        }
+
+        this->stopVoice(oldestVoiceIndex, midiMessages, sample);
+    }
+
+    const auto lengthInSamples = int64(roundToInt(command.lengthMs * this->sampleRate * 0.001));
+
+    auto &voice = this->voices[this->numVoices++];
+    voice.channel = command.channel;
+    voice.key = command.key;
+    voice.velocity = command.velocity;
+    voice.noteOnSample = sample;
+    voice.noteOffSample = sample + jmax(int64(1), lengthInSamples);
+    voice.isSounding = false;
+}
+
+void NotePreviewScheduler::stopVoice(int index,
+    MidiBuffer &midiMessages, int64 noteOffSample)
+{
+    jassert(index >= 0 && index < this->numVoices);
+
+    const auto &voice = this->voices[index];
+    if (voice.isSounding)
+    {
+        midiMessages.addEvent(MidiMessage::noteOff(voice.channel, voice.key),
+            jmax(0, int(noteOffSample - this->blockStartSample)));
+    }
+
+    this->voices[index] = this->voices[--this->numVoices];
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class NotePreviewSchedulerTests final : public UnitTest
+{
+public:
+    NotePreviewSchedulerTests() : UnitTest("Note preview scheduler tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Note-on and note-off are sample-accurate");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+            scheduler.previewNote(1, 60, 0.5f, 100.0, 0.0);
+
+            const auto events = render(scheduler, 20);
+            expectEquals(events.size(), 2);
+            expect(events[0].message.isNoteOn());
+            expectEquals(events[0].sample, int64(0));
+            expect(events[1].message.isNoteOff());
+            expectEquals(events[1].sample, int64(4410));
+        }
+
+        beginTest("Previews are positioned within a block by their timestamps");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+            scheduler.previewNote(1, 60, 0.5f, 10.0, 4.0);
+            scheduler.previewNote(1, 64, 0.5f, 10.0, 10.0);
+
+            const auto events = render(scheduler, 20);
+            expectEquals(events.size(), 4);
+            expectEquals(events[0].sample, int64(176));
+            expectEquals(events[1].sample, int64(441));
+            expectEquals(events[2].sample, int64(176 + 441));
+            expectEquals(events[3].sample, int64(441 + 441));
+        }
+
+        beginTest("Repeated previews of the same key restart it");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+            scheduler.previewNote(1, 60, 0.5f, 1000.0, 0.0);
+            auto events = render(scheduler, 4);
+            expectEquals(events.size(), 1);
+
+            scheduler.previewNote(1, 60, 0.5f, 100.0, blockMs * 4.0);
+            events = render(scheduler, 20, 4);
+            expectEquals(events.size(), 3);
+            expect(events[0].message.isNoteOff());
+            expect(events[1].message.isNoteOn());
+            expect(events[2].message.isNoteOff());
+            expect(events[0].sample <= events[1].sample);
+        }
+
+        beginTest("The voice budget never leaves stuck notes");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+
+            Random random(42);
+            for (int i = 0; i < 1000; ++i)
+            {
+                scheduler.previewNote(1 + random.nextInt(16), random.nextInt(128),
+                    0.5f, double(random.nextInt(1000)), blockMs * random.nextDouble());
+            }
+
+            const auto events = render(scheduler, 200);
+            expectStuckNotes(events, 0);
+
+            int maxNumSounding = 0;
+            int numSounding = 0;
+            for (const auto &event : events)
+            {
+                numSounding += event.message.isNoteOn() ? 1 : -1;
+                maxNumSounding = jmax(maxNumSounding, numSounding);
+            }
+
+            expect(maxNumSounding <= NotePreviewScheduler::maxNumVoices);
+        }
+
+        beginTest("Cancelling stops all sounding previews");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+            scheduler.previewNote(1, 60, 0.5f, 1000.0, 0.0);
+            scheduler.previewNote(1, 64, 0.5f, 1000.0, 0.0);
+            scheduler.previewNote(2, 67, 0.5f, 1000.0, 0.0);
+            auto events = render(scheduler, 2);
+            expectStuckNotes(events, 3);
+
+            scheduler.cancelAllPreviews(blockMs * 2.0);
+            events.addArray(render(scheduler, 2, 2));
+            expectStuckNotes(events, 0);
+            expectEquals(events.size(), 6);
+        }
+
+        beginTest("Outdated previews are dropped");
+        {
+            NotePreviewScheduler scheduler;
+            scheduler.prepareToPlay(sampleRate, 0.0);
+            scheduler.previewNote(1, 60, 0.5f, 100.0, 0.0);
+
+            const auto events = render(scheduler, 20, 100);
+            expect(events.isEmpty());
+        }
+    }
+
+private:
+
+    static constexpr auto sampleRate = 44100.0;
+    static constexpr auto blockSize = 512;
+    static constexpr auto blockMs = blockSize * 1000.0 / sampleRate;
+
+    struct RenderedEvent final
+    {
+        MidiMessage message;
+        int64 sample;
+    };
+
+    static Array<RenderedEvent> render(NotePreviewScheduler &scheduler,
+        int numBlocks, int firstBlock = 0)
+    {
+        Array<RenderedEvent> result;
+        MidiBuffer buffer;
+
+        for (int i = firstBlock; i < firstBlock + numBlocks; ++i)
+        {
+            buffer.clear();
+            scheduler.renderNextBlock(buffer, blockSize, blockMs * double(i + 1));
+
+            for (const auto metadata : buffer)
+            {
+                result.add({ metadata.getMessage(), int64(i) * blockSize + metadata.samplePosition });
+            }
+        }
+
+        return result;
+    }
+
+    void expectStuckNotes(const Array<RenderedEvent> &events, int expectedNumStuckNotes)
+    {
+        int numSounding = 0;
+        for (const auto &event : events)
+        {
+            numSounding += event.message.isNoteOn() ? 1 : -1;
+        }
+
+        expectEquals(numSounding, expectedNumStuckNotes);
+    }
+};
+
+static NotePreviewSchedulerTests notePreviewSchedulerTests;
+
+#endif
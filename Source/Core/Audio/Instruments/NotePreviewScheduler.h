@@ -0,0 +1,103 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Interactive note previews, e.g. when dragging notes or auditioning chords,
+// are posted here as timestamped commands, and the instrument's audio callback
+// turns them into note-on/note-off pairs right in its midi buffer, so that
+// their durations are sample-accurate, and they never arrive out of order.
+
+// The commands queue is a single-consumer ring buffer: the audio thread
+// reads it without locking, while the writers (the message thread, and
+// the scale or metronome preview threads) only serialize among themselves.
+
+class NotePreviewScheduler final
+{
+public:
+
+    NotePreviewScheduler();
+
+    // called from any thread except the audio thread,
+    // the key and the channel are expected to be already mapped,
+    // and the time is in Time::getMillisecondCounterHiRes() units
+    void previewNote(int channel, int key, float velocity,
+        double lengthMs, double timeMs);
+
+    // sends note-offs for all sounding previews and drops the pending ones
+    void cancelAllPreviews(double timeMs);
+
+    // called from the audio thread
+    void prepareToPlay(double sampleRate, double timeMs);
+    void renderNextBlock(MidiBuffer &midiMessages, int numSamples, double blockTimeMs);
+
+    // when the previews come faster than they end,
+    // the oldest ones are stopped to make room for the new ones
+    static constexpr auto maxNumVoices = 64;
+
+private:
+
+    struct Command final
+    {
+        enum class Type : uint8
+        {
+            NoteOn,
+            CancelAll
+        };
+
+        Type type;
+        uint8 channel;
+        uint8 key;
+        float velocity;
+        double timeMs;
+        double lengthMs;
+    };
+
+    struct Voice final
+    {
+        uint8 channel;
+        uint8 key;
+        float velocity;
+        int64 noteOnSample;
+        int64 noteOffSample;
+        bool isSounding;
+    };
+
+    void postCommand(const Command &command);
+    void handleCommand(const Command &command,
+        MidiBuffer &midiMessages, int numSamples);
+    void stopVoice(int index, MidiBuffer &midiMessages, int64 noteOffSample);
+
+    // the commands older than that are dropped instead of being played
+    // all at once, e.g. when the audio device was not running for a while
+    static constexpr auto maxCommandLatencyMs = 500.0;
+
+    static constexpr auto commandsFifoSize = 1024;
+    AbstractFifo commandsFifo { commandsFifoSize };
+    HeapBlock<Command> commands;
+    SpinLock writersLock;
+
+    // only accessed from the audio thread:
+    Voice voices[maxNumVoices];
+    int numVoices = 0;
+
+    double sampleRate = 0.0;
+    double lastBlockTimeMs = 0.0;
+    int64 blockStartSample = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NotePreviewScheduler)
+};
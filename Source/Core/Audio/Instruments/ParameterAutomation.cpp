@@ -0,0 +1,210 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "ParameterAutomation.h"
+
+// the non-commercial sysex id, plus a couple of bytes for the signature
+static constexpr uint8 parameterChangeHeader[] = { 0x7d, 0x48, 0x50 };
+static constexpr int parameterChangeHeaderSize = 3;
+static constexpr int parameterChangeDataSize = parameterChangeHeaderSize + 3 + 3 + 5;
+static constexpr int parameterChangeMessageSize = parameterChangeDataSize + 2; // + F0 and F7
+
+static inline void writeSevenBitChunks(uint8 *dest, uint32 value, int numChunks) noexcept
+{
+    for (int i = 0; i < numChunks; ++i)
+    {
+        dest[i] = uint8((value >> (i * 7)) & 0x7f);
+    }
+}
+
+static inline uint32 readSevenBitChunks(const uint8 *source, int numChunks) noexcept
+{
+    uint32 value = 0;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        value |= uint32(source[i] & 0x7f) << (i * 7);
+    }
+
+    return value;
+}
+
+ParameterAutomation::ParameterAutomation()
+{
+    // try to avoid allocations on the audio thread
+    this->chunkMidi.ensureSize(2048);
+    this->outputMidi.ensureSize(2048);
+}
+
+//===----------------------------------------------------------------------===//
+// Controller numbers
+//===----------------------------------------------------------------------===//
+
+bool ParameterAutomation::canAutomate(AudioProcessorGraph::NodeID nodeId, int parameterIndex) noexcept
+{
+    return nodeId.uid <= ParameterAutomation::maxNodeId &&
+        parameterIndex >= 0 && parameterIndex <= ParameterAutomation::maxParameterIndex;
+}
+
+int ParameterAutomation::makeControllerNumber(AudioProcessorGraph::NodeID nodeId, int parameterIndex) noexcept
+{
+    jassert(ParameterAutomation::canAutomate(nodeId, parameterIndex));
+    return ParameterAutomation::controllerFlag |
+        int((nodeId.uid & ParameterAutomation::maxNodeId) << 16) |
+        (parameterIndex & ParameterAutomation::maxParameterIndex);
+}
+
+bool ParameterAutomation::isParameterController(int controllerNumber) noexcept
+{
+    return (controllerNumber & ParameterAutomation::controllerFlag) != 0;
+}
+
+AudioProcessorGraph::NodeID ParameterAutomation::getNodeId(int controllerNumber) noexcept
+{
+    return AudioProcessorGraph::NodeID((uint32(controllerNumber) >> 16) & ParameterAutomation::maxNodeId);
+}
+
+int ParameterAutomation::getParameterIndex(int controllerNumber) noexcept
+{
+    return controllerNumber & ParameterAutomation::maxParameterIndex;
+}
+
+//===----------------------------------------------------------------------===//
+// Parameter change messages
+//===----------------------------------------------------------------------===//
+
+MidiMessage ParameterAutomation::makeParameterChange(int controllerNumber, float value)
+{
+    jassert(ParameterAutomation::isParameterController(controllerNumber));
+
+    uint8 data[parameterChangeDataSize];
+    memcpy(data, parameterChangeHeader, parameterChangeHeaderSize);
+
+    uint32 valueBits = 0;
+    const auto clampedValue = jlimit(0.f, 1.f, value);
+    memcpy(&valueBits, &clampedValue, sizeof(float));
+
+    auto *payload = data + parameterChangeHeaderSize;
+    writeSevenBitChunks(payload, ParameterAutomation::getNodeId(controllerNumber).uid, 3);
+    writeSevenBitChunks(payload + 3, uint32(ParameterAutomation::getParameterIndex(controllerNumber)), 3);
+    writeSevenBitChunks(payload + 6, valueBits, 5);
+
+    return MidiMessage::createSysExMessage(data, parameterChangeDataSize);
+}
+
+bool ParameterAutomation::isParameterChange(const uint8 *data, int numBytes) noexcept
+{
+    return numBytes == parameterChangeMessageSize && data[0] == 0xf0 &&
+        memcmp(data + 1, parameterChangeHeader, parameterChangeHeaderSize) == 0;
+}
+
+void ParameterAutomation::applyParameterChange(AudioProcessorGraph &graph,
+    const uint8 *data, int numBytes)
+{
+    jassert(ParameterAutomation::isParameterChange(data, numBytes));
+
+    const auto *payload = data + 1 + parameterChangeHeaderSize;
+    const AudioProcessorGraph::NodeID nodeId(readSevenBitChunks(payload, 3));
+    const auto parameterIndex = int(readSevenBitChunks(payload + 3, 3));
+    const auto valueBits = readSevenBitChunks(payload + 6, 5);
+
+    float value = 0.f;
+    memcpy(&value, &valueBits, sizeof(float));
+
+    if (auto *node = graph.getNodeForId(nodeId))
+    {
+        const auto &parameters = node->getProcessor()->getParameters();
+        if (auto *parameter = parameters[parameterIndex])
+        {
+            parameter->setValue(value);
+        }
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Processing
+//===----------------------------------------------------------------------===//
+
+void ParameterAutomation::processBlock(AudioProcessorGraph &graph,
+    AudioBuffer<float> &buffer, MidiBuffer &midiMessages)
+{
+    bool hasParameterChanges = false;
+    for (const auto metadata : midiMessages)
+    {
+        if (ParameterAutomation::isParameterChange(metadata.data, metadata.numBytes))
+        {
+            hasParameterChanges = true;
+            break;
+        }
+    }
+
+    // most of the blocks have nothing to split
+    if (!hasParameterChanges)
+    {
+        graph.processBlock(buffer, midiMessages);
+        return;
+    }
+
+    const auto numSamples = buffer.getNumSamples();
+    this->outputMidi.clear();
+
+    int chunkStart = 0;
+    auto it = midiMessages.cbegin();
+    while (chunkStart < numSamples)
+    {
+        // apply all parameter changes at the chunk start, and collect
+        // the other events up to the next parameter change position
+        int chunkEnd = numSamples;
+        this->chunkMidi.clear();
+
+        for (; it != midiMessages.cend(); ++it)
+        {
+            const auto metadata = *it;
+            const auto position = jlimit(0, numSamples - 1, metadata.samplePosition);
+            if (ParameterAutomation::isParameterChange(metadata.data, metadata.numBytes))
+            {
+                if (position > chunkStart)
+                {
+                    chunkEnd = position;
+                    break;
+                }
+
+                ParameterAutomation::applyParameterChange(graph, metadata.data, metadata.numBytes);
+            }
+            else
+            {
+                this->chunkMidi.addEvent(metadata.data, metadata.numBytes, position - chunkStart);
+            }
+        }
+
+        AudioBuffer<float> chunk(buffer.getArrayOfWritePointers(),
+            buffer.getNumChannels(), chunkStart, chunkEnd - chunkStart);
+
+        graph.processBlock(chunk, this->chunkMidi);
+
+        for (const auto metadata : this->chunkMidi)
+        {
+            this->outputMidi.addEvent(metadata.data, metadata.numBytes,
+                metadata.samplePosition + chunkStart);
+        }
+
+        chunkStart = chunkEnd;
+    }
+
+    midiMessages.swapWith(this->outputMidi);
+}
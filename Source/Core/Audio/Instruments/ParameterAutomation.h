@@ -0,0 +1,61 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Automation tracks can target any parameter of any node in their instrument's
+// graph; such tracks' events are sent to the instrument along with all other
+// midi events, encoded as private sysex messages, so that they are timed exactly
+// the same way as notes, both in the live playback and when rendering.
+
+class ParameterAutomation final
+{
+public:
+
+    ParameterAutomation();
+
+    // track controller numbers with this flag set target the plugin parameters,
+    // the rest of the bits contain the node id and the parameter index
+    static constexpr int controllerFlag = 0x40000000;
+    static constexpr uint32 maxNodeId = 0x3fff;
+    static constexpr int maxParameterIndex = 0xffff;
+
+    static bool canAutomate(AudioProcessorGraph::NodeID nodeId, int parameterIndex) noexcept;
+    static int makeControllerNumber(AudioProcessorGraph::NodeID nodeId, int parameterIndex) noexcept;
+    static bool isParameterController(int controllerNumber) noexcept;
+    static AudioProcessorGraph::NodeID getNodeId(int controllerNumber) noexcept;
+    static int getParameterIndex(int controllerNumber) noexcept;
+
+    static MidiMessage makeParameterChange(int controllerNumber, float value);
+    static bool isParameterChange(const uint8 *data, int numBytes) noexcept;
+
+    // processes the block in chunks split at the parameter changes,
+    // applying each change right at its sample position; the parameter
+    // changes are consumed, and the graph's midi output is left in the buffer
+    void processBlock(AudioProcessorGraph &graph,
+        AudioBuffer<float> &buffer, MidiBuffer &midiMessages);
+
+private:
+
+    static void applyParameterChange(AudioProcessorGraph &graph,
+        const uint8 *data, int numBytes);
+
+    MidiBuffer chunkMidi;
+    MidiBuffer outputMidi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterAutomation)
+};
@@ -0,0 +1,203 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "PluginScanCache.h"
+#include "SerializablePluginDescription.h"
+#include "SerializationKeys.h"
+
+bool PluginScanCache::FileStamp::read(const String &fileOrIdentifier, FileStamp &outStamp)
+{
+    if (!File::isAbsolutePath(fileOrIdentifier))
+    {
+        return false;
+    }
+
+    const File file(fileOrIdentifier);
+    if (!file.exists())
+    {
+        return false;
+    }
+
+    outStamp.size = file.getSize();
+    outStamp.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    // the bundles are directories, which modification time
+    // doesn't change when the binaries inside are updated,
+    // so the stamp is made of all the files they contain
+    if (file.isDirectory())
+    {
+        for (const auto &entry : RangedDirectoryIterator(file, true, "*", File::findFiles))
+        {
+            outStamp.size += entry.getFileSize();
+            outStamp.modificationTime = jmax(outStamp.modificationTime,
+                entry.getModificationTime().toMilliseconds());
+        }
+    }
+
+    return true;
+}
+
+bool PluginScanCache::findUpToDate(const String &fileOrIdentifier,
+    Array<PluginDescription> &outDescriptions) const
+{
+    FileStamp stamp;
+    if (!FileStamp::read(fileOrIdentifier, stamp))
+    {
+        return false;
+    }
+
+    const ScopedLock lock(this->entriesLock);
+
+    const auto found = this->entries.find(fileOrIdentifier);
+    if (found == this->entries.end() || !(found->second.stamp == stamp))
+    {
+        return false;
+    }
+
+    outDescriptions = found->second.descriptions;
+    return true;
+}
+
+void PluginScanCache::update(const String &fileOrIdentifier,
+    const Array<PluginDescription> &descriptions)
+{
+    Entry entry;
+    if (!FileStamp::read(fileOrIdentifier, entry.stamp))
+    {
+        return;
+    }
+
+    entry.descriptions = descriptions;
+
+    const ScopedLock lock(this->entriesLock);
+    this->entries[fileOrIdentifier] = move(entry);
+}
+
+void PluginScanCache::updateFailed(const String &fileOrIdentifier)
+{
+    Entry entry;
+    if (!FileStamp::read(fileOrIdentifier, entry.stamp))
+    {
+        return;
+    }
+
+    entry.hasFailed = true;
+
+    const ScopedLock lock(this->entriesLock);
+    this->entries[fileOrIdentifier] = move(entry);
+}
+
+int PluginScanCache::size() const noexcept
+{
+    const ScopedLock lock(this->entriesLock);
+    return int(this->entries.size());
+}
+
+int PluginScanCache::getNumFailed() const noexcept
+{
+    const ScopedLock lock(this->entriesLock);
+
+    int numFailed = 0;
+    for (const auto &it : this->entries)
+    {
+        numFailed += it.second.hasFailed ? 1 : 0;
+    }
+
+    return numFailed;
+}
+
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+SerializedData PluginScanCache::serialize() const
+{
+    using namespace Serialization;
+    SerializedData tree(Audio::pluginScanCache);
+
+    const ScopedLock lock(this->entriesLock);
+
+    for (const auto &it : this->entries)
+    {
+        SerializedData entryNode(Audio::pluginScanCacheEntry);
+        entryNode.setProperty(Audio::pluginFile, it.first);
+        entryNode.setProperty(Audio::pluginFileSize, String::toHexString(it.second.stamp.size));
+        entryNode.setProperty(Audio::pluginFileModTime, String::toHexString(it.second.stamp.modificationTime));
+
+        if (it.second.hasFailed)
+        {
+            entryNode.setProperty(Audio::pluginScanFailed, true);
+        }
+
+        for (const auto &description : it.second.descriptions)
+        {
+            const SerializablePluginDescription sd(description);
+            entryNode.appendChild(sd.serialize());
+        }
+
+        tree.appendChild(entryNode);
+    }
+
+    return tree;
+}
+
+void PluginScanCache::deserialize(const SerializedData &data)
+{
+    using namespace Serialization;
+
+    this->reset();
+
+    const auto root = data.hasType(Audio::pluginScanCache) ?
+        data : data.getChildWithName(Audio::pluginScanCache);
+
+    if (!root.isValid()) { return; }
+
+    const ScopedLock lock(this->entriesLock);
+
+    forEachChildWithType(root, entryNode, Audio::pluginScanCacheEntry)
+    {
+        const String fileOrIdentifier = entryNode.getProperty(Audio::pluginFile);
+        if (fileOrIdentifier.isEmpty())
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.stamp.size = entryNode.getProperty(Audio::pluginFileSize).toString().getHexValue64();
+        entry.stamp.modificationTime = entryNode.getProperty(Audio::pluginFileModTime).toString().getHexValue64();
+        entry.hasFailed = entryNode.getProperty(Audio::pluginScanFailed, false);
+
+        forEachChildWithType(entryNode, e, Audio::plugin)
+        {
+            SerializablePluginDescription description;
+            description.deserialize(e);
+            if (description.isValid())
+            {
+                entry.descriptions.add(description);
+            }
+        }
+
+        this->entries[fileOrIdentifier] = move(entry);
+    }
+}
+
+void PluginScanCache::reset()
+{
+    const ScopedLock lock(this->entriesLock);
+    this->entries.clear();
+}
@@ -0,0 +1,84 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Remembers the scan results for each scanned plugin file, including
+// the files which turned out to contain no plugins or crashed the scanner,
+// keyed by the file path, size and modification time,
+// so that the plugins which haven't changed are never rescanned;
+// the crashed files are only skipped until they change, e.g. get updated.
+// The identifiers which are not files, like the built-in instruments,
+// are not cached, since there's nothing to check them against.
+
+class PluginScanCache final : public Serializable
+{
+public:
+
+    PluginScanCache() = default;
+
+    // returns false, if the file is not cached, or has changed since
+    bool findUpToDate(const String &fileOrIdentifier,
+        Array<PluginDescription> &outDescriptions) const;
+
+    void update(const String &fileOrIdentifier,
+        const Array<PluginDescription> &descriptions);
+
+    // remembers that the file has crashed the scanner,
+    // along with its stamp at the moment of the crash
+    void updateFailed(const String &fileOrIdentifier);
+
+    int size() const noexcept;
+    int getNumFailed() const noexcept;
+
+    //===------------------------------------------------------------------===//
+    // Serializable
+    //===------------------------------------------------------------------===//
+
+    SerializedData serialize() const override;
+    void deserialize(const SerializedData &data) override;
+    void reset() override;
+
+private:
+
+    struct FileStamp final
+    {
+        int64 size = 0;
+        int64 modificationTime = 0;
+
+        static bool read(const String &fileOrIdentifier, FileStamp &outStamp);
+
+        bool operator== (const FileStamp &other) const noexcept
+        {
+            return this->size == other.size &&
+                this->modificationTime == other.modificationTime;
+        }
+    };
+
+    struct Entry final
+    {
+        FileStamp stamp;
+        Array<PluginDescription> descriptions;
+        bool hasFailed = false;
+    };
+
+    // updated concurrently by the scanning workers
+    mutable CriticalSection entriesLock;
+    FlatHashMap<String, Entry, StringHash> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScanCache)
+};
@@ -20,9 +20,11 @@
 #include "AudioCore.h"
 #include "DocumentHelpers.h"
 #include "XmlSerializer.h"
+#include "BinarySerializer.h"
 #include "Config.h"
 #include "MainLayout.h"
 #include "SerializationKeys.h"
+#include "BuiltInSynthsPluginFormat.h"
 #include "DefaultSynthAudioPlugin.h"
 #include "MetronomeSynthAudioPlugin.h"
 #include "SoundFontSynthAudioPlugin.h"
@@ -179,6 +181,181 @@ void PluginScanner::scanFolderAndAddResults(const File &dir)
     this->signal();
 }
 
+//===----------------------------------------------------------------------===//
+// Scanning
+//===----------------------------------------------------------------------===//
+
+Array<PluginDescription> PluginScanner::scanFile(AudioPluginFormatManager &formatManager,
+    const String &fileOrIdentifier)
+{
+    Array<PluginDescription> result;
+
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+    {
+        auto *format = formatManager.getFormat(i);
+
+        try
+        {
+            if (format->fileMightContainThisPluginType(fileOrIdentifier))
+            {
+                OwnedArray<PluginDescription> typesFound;
+                format->findAllTypesForFile(typesFound, fileOrIdentifier);
+
+                for (const auto *type : typesFound)
+                {
+                    result.add(*type);
+                }
+            }
+        }
+        catch (...) {}
+    }
+
+    return result;
+}
+
+void PluginScanner::scanFiles(const StringArray &files, PluginScanCache &cache,
+    int numWorkers, const ScanFunction &scanFunction,
+    const ResultsCallback &resultsCallback, const Function<bool()> &shouldStop)
+{
+    StringArray filesToScan;
+
+    for (const auto &file : files)
+    {
+        Array<PluginDescription> cachedDescriptions;
+        if (!cache.findUpToDate(file, cachedDescriptions))
+        {
+            filesToScan.add(file);
+        }
+        else if (!cachedDescriptions.isEmpty())
+        {
+            resultsCallback(cachedDescriptions);
+        }
+    }
+
+    DBG("Plugin files up to date: " + String(files.size() - filesToScan.size()) +
+        ", plugin files to scan: " + String(filesToScan.size()));
+
+    if (filesToScan.isEmpty())
+    {
+        return;
+    }
+
+    ThreadPool workers(jlimit(1, filesToScan.size(), numWorkers));
+
+    for (const auto &file : filesToScan)
+    {
+        workers.addJob([file, &cache, &scanFunction, &resultsCallback, &shouldStop]()
+        {
+            if (shouldStop())
+            {
+                return;
+            }
+
+            DBG("Scanning: " + file);
+
+            Array<PluginDescription> descriptions;
+            switch (scanFunction(file, descriptions))
+            {
+            case ScanResult::Scanned:
+                cache.update(file, descriptions);
+                break;
+            case ScanResult::Crashed:
+                DBG("Plugin scan crashed: " + file);
+                cache.updateFailed(file);
+                break;
+            case ScanResult::Inconclusive:
+                break;
+            }
+
+            if (!descriptions.isEmpty())
+            {
+                resultsCallback(descriptions);
+            }
+        });
+    }
+
+    while (workers.getNumJobs() > 0)
+    {
+        if (shouldStop())
+        {
+            // drop the pending jobs, the running ones will stop shortly
+            workers.removeAllJobs(false, 5000);
+            break;
+        }
+
+        Thread::sleep(50);
+    }
+}
+
+bool PluginScanner::shouldStopScanning() const
+{
+    return this->cancelled.get() || this->threadShouldExit();
+}
+
+PluginScanner::ScanResult PluginScanner::scanFileInCheckerProcess(const String &fileOrIdentifier,
+    Array<PluginDescription> &outDescriptions) const
+{
+    const Uuid tempFileName;
+    const File tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()));
+    tempFile.replaceWithText(fileOrIdentifier, false, false);
+
+    ChildProcess checkerProcess;
+    const auto myPath = File::getSpecialLocation(File::currentExecutableFile).getFullPathName();
+    const String commandLine(myPath + " " + tempFileName.toString());
+    if (!checkerProcess.start(commandLine))
+    {
+        tempFile.deleteFile();
+        return ScanResult::Inconclusive;
+    }
+
+    constexpr uint32 timeoutMs = 60000;
+    const auto startTimeMs = Time::getMillisecondCounter();
+
+    while (checkerProcess.isRunning())
+    {
+        if (this->shouldStopScanning() ||
+            Time::getMillisecondCounter() - startTimeMs > timeoutMs)
+        {
+            // the result is not conclusive, so it won't be cached
+            checkerProcess.kill();
+            tempFile.deleteFile();
+            return ScanResult::Inconclusive;
+        }
+
+        Thread::sleep(20);
+    }
+
+    // the checker deletes the temp file before loading the plugin
+    // and writes the descriptions back only if it hasn't crashed
+    if (!tempFile.existsAsFile())
+    {
+        return ScanResult::Crashed;
+    }
+
+    try
+    {
+        const auto tree(DocumentHelpers::load<XmlSerializer>(tempFile));
+        forEachChildWithType(tree, e, Serialization::Audio::plugin)
+        {
+            SerializablePluginDescription pluginDescription;
+            pluginDescription.deserialize(e);
+            if (pluginDescription.isValid())
+            {
+                outDescriptions.add(pluginDescription);
+            }
+        }
+    }
+    catch (...) {}
+
+    tempFile.deleteFile();
+    return ScanResult::Scanned;
+}
+
+File PluginScanner::getScanCacheFile()
+{
+    return DocumentHelpers::getConfigSlot("plugins.cache");
+}
+
 //===----------------------------------------------------------------------===//
 // Thread
 //===----------------------------------------------------------------------===//
@@ -202,6 +379,12 @@ void PluginScanner::run()
         // plugins list might have changed while waiting:
         this->sendChangeMessage();
 
+        if (!this->isScanCacheLoaded)
+        {
+            this->scanCache.deserialize(DocumentHelpers::load<BinarySerializer>(getScanCacheFile()));
+            this->isScanCacheLoaded = true;
+        }
+
         for (int i = 0; i < formatManager.getNumFormats(); ++i)
         {
             auto *format = formatManager.getFormat(i);
@@ -210,105 +393,59 @@ void PluginScanner::run()
 
             if (this->cancelled.get())
             {
-                DBG("Plugin scanning canceled");
                 break;
             }
         }
 
-        const auto pluginSorting = App::Config().getUiFlags()->getPluginSorting();
-        const auto pluginSortingForwards = App::Config().getUiFlags()->isPluginSortingForwards();
-
-        try
-        {
-            for (const auto &pluginPath : this->filesToScan)
-            {
-                if (this->cancelled.get())
-                {
-                    DBG("Plugin scanning canceled");
-                    break;
-                }
-
-                DBG("Found: " + pluginPath);
+        this->filesToScan.removeDuplicates(false);
 
 #if SAFE_SCAN
-                const Uuid tempFileName;
-                const File tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()));
-                tempFile.appendText(pluginPath, false, false);
-
-                Thread::sleep(50);
-
-                ChildProcess checkerProcess;
-                const auto myPath = File::getSpecialLocation(File::currentExecutableFile).getFullPathName();
-                const String commandLine(myPath + " " + tempFileName.toString());
-                checkerProcess.start(commandLine);
-
-                if (!checkerProcess.waitForProcessToFinish(60000))
-                {
-                    checkerProcess.kill();
-                }
-                else
-                {
-                    if (this->cancelled.get())
-                    {
-                        DBG("Plugin scanning canceled");
-                        tempFile.deleteFile();
-                        break;
-                    }
-
-                    Thread::sleep(50);
-
-                    if (tempFile.existsAsFile())
-                    {
-                        try
-                        {
-                            const auto tree(DocumentHelpers::load<XmlSerializer>(tempFile));
-                            if (tree.isValid())
-                            {
-                                forEachChildWithType(tree, e, Serialization::Audio::plugin)
-                                {
-                                    SerializablePluginDescription pluginDescription;
-                                    pluginDescription.deserialize(e);
-                                    this->pluginsList.addType(pluginDescription);
-                                }
-
-                                this->sortList(pluginSorting, pluginSortingForwards); // will also sendChangeMessage();
-                            }
-                        }
-                        catch (...) {}
-                    }
-                }
-
-                tempFile.deleteFile();
+        // each worker waits for its own checker process,
+        // so this is the number of the processes running at once
+        const auto numWorkers = jlimit(1, 8, SystemStats::getNumCpus());
+        const ScanFunction scanFunction = [this](const String &fileOrIdentifier,
+            Array<PluginDescription> &outDescriptions)
+        {
+            return this->scanFileInCheckerProcess(fileOrIdentifier, outDescriptions);
+        };
 #else
-                KnownPluginList knownPluginList;
-                OwnedArray<PluginDescription> typesFound;
+        // plugins are loaded right in this process,
+        // and they are not supposed to be loaded concurrently
+        const auto numWorkers = 1;
+        const ScanFunction scanFunction = [&formatManager](const String &fileOrIdentifier,
+            Array<PluginDescription> &outDescriptions)
+        {
+            outDescriptions = PluginScanner::scanFile(formatManager, fileOrIdentifier);
+            return ScanResult::Scanned;
+        };
+#endif
 
-                try
+        PluginScanner::scanFiles(this->filesToScan, this->scanCache, numWorkers, scanFunction,
+            [this](const Array<PluginDescription> &descriptions)
+            {
+                for (const auto &description : descriptions)
                 {
-                    for (int j = 0; j < formatManager.getNumFormats(); ++j)
-                    {
-                        auto *format = formatManager.getFormat(j);
-                        knownPluginList.scanAndAddFile(pluginPath, false, typesFound, *format);
-                    }
+                    this->pluginsList.addType(description);
                 }
-                catch (...) {}
 
-                // at this point we are still alive and the plugin hasn't crashed the app
-                if (typesFound.size() != 0)
-                {
-                    for (auto *type : typesFound)
-                    {
-                        this->pluginsList.addType(*type);
-                    }
+                // the list is only sorted once, when done
+                this->sendChangeMessage();
+            },
+            [this]()
+            {
+                return this->shouldStopScanning();
+            });
 
-                    this->sortList(pluginSorting, pluginSortingForwards); // will also sendChangeMessage();
-                }
-                
-                Thread::sleep(150);
-#endif
-            }
+        DocumentHelpers::save<BinarySerializer>(getScanCacheFile(), this->scanCache);
+
+        if (this->cancelled.get())
+        {
+            DBG("Plugin scanning canceled");
         }
-        catch (...) {}
+
+        const auto pluginSorting = App::Config().getUiFlags()->getPluginSorting();
+        const auto pluginSortingForwards = App::Config().getUiFlags()->isPluginSortingForwards();
+        this->sortList(pluginSorting, pluginSortingForwards); // will also sendChangeMessage();
 
         {
             this->cancelled = false;
@@ -438,3 +575,292 @@ void PluginScanner::reset()
     this->pluginsList.clear();
     this->sendChangeMessage();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+// a fake plugin format: each *.stub file contains the name of a single plugin,
+// and scanning it takes a while, so that the concurrent scans could overlap
+class StubPluginFormat final : public AudioPluginFormat
+{
+public:
+
+    int getNumScans() const
+    {
+        const SpinLock::ScopedLockType lock(this->statsLock);
+        return this->numScans;
+    }
+
+    int getMaxRunningScans() const
+    {
+        const SpinLock::ScopedLockType lock(this->statsLock);
+        return this->maxRunningScans;
+    }
+
+    String getName() const override { return "Stub"; }
+
+    void findAllTypesForFile(OwnedArray<PluginDescription> &results,
+        const String &fileOrIdentifier) override
+    {
+        {
+            const SpinLock::ScopedLockType lock(this->statsLock);
+            this->numScans++;
+            this->numRunningScans++;
+            this->maxRunningScans = jmax(this->maxRunningScans, this->numRunningScans);
+        }
+
+        Thread::sleep(50);
+
+        auto *description = new PluginDescription();
+        description->name = File(fileOrIdentifier).loadFileAsString().trim();
+        description->pluginFormatName = this->getName();
+        description->fileOrIdentifier = fileOrIdentifier;
+        description->isInstrument = true;
+        results.add(description);
+
+        {
+            const SpinLock::ScopedLockType lock(this->statsLock);
+            this->numRunningScans--;
+        }
+    }
+
+    bool fileMightContainThisPluginType(const String &fileOrIdentifier) override
+    {
+        return fileOrIdentifier.endsWithIgnoreCase(".stub");
+    }
+
+    String getNameOfPluginFromIdentifier(const String &fileOrIdentifier) override
+    {
+        return File(fileOrIdentifier).getFileNameWithoutExtension();
+    }
+
+    bool pluginNeedsRescanning(const PluginDescription &) override { return false; }
+
+    bool doesPluginStillExist(const PluginDescription &description) override
+    {
+        return File(description.fileOrIdentifier).existsAsFile();
+    }
+
+    bool canScanForPlugins() const override { return true; }
+    bool isTrivialToScan() const override { return true; }
+
+    StringArray searchPathsForPlugins(const FileSearchPath &directoriesToSearch, bool recursive, bool) override
+    {
+        StringArray results;
+        for (int i = 0; i < directoriesToSearch.getNumPaths(); ++i)
+        {
+            for (const auto &file : directoriesToSearch[i].findChildFiles(File::findFiles, recursive, "*.stub"))
+            {
+                results.add(file.getFullPathName());
+            }
+        }
+
+        return results;
+    }
+
+    FileSearchPath getDefaultLocationsToSearch() override { return {}; }
+
+private:
+
+    void createPluginInstance(const PluginDescription &, double, int, PluginCreationCallback callback) override
+    {
+        callback(nullptr, "Stub plugins cannot be instantiated");
+    }
+
+    bool requiresUnblockedMessageThreadDuringCreation(const PluginDescription &) const override
+    {
+        return false;
+    }
+
+    SpinLock statsLock;
+    int numScans = 0;
+    int numRunningScans = 0;
+    int maxRunningScans = 0;
+
+};
+
+class PluginScannerTests final : public UnitTest
+{
+public:
+    PluginScannerTests() : UnitTest("Plugin scanner tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        const auto tempDir = File::getSpecialLocation(File::tempDirectory)
+            .getChildFile("HelioPluginScannerTests").getNonexistentSibling();
+
+        tempDir.createDirectory();
+
+        StringArray files;
+        for (int i = 0; i < 8; ++i)
+        {
+            const auto file = tempDir.getChildFile("Plugin" + String(i) + ".stub");
+            file.replaceWithText("Stub " + String(i));
+            files.add(file.getFullPathName());
+        }
+
+        const auto notAPlugin = tempDir.getChildFile("Readme.txt");
+        notAPlugin.replaceWithText("Not a plugin");
+        files.add(notAPlugin.getFullPathName());
+
+        AudioPluginFormatManager formatManager;
+        auto *stubFormat = new StubPluginFormat();
+        formatManager.addFormat(stubFormat);
+
+        const auto scanInProcess = [&formatManager](const String &fileOrIdentifier,
+            Array<PluginDescription> &outDescriptions)
+        {
+            outDescriptions = PluginScanner::scanFile(formatManager, fileOrIdentifier);
+            return PluginScanner::ScanResult::Scanned;
+        };
+
+        const auto neverStop = []() { return false; };
+
+        PluginScanCache cache;
+
+        beginTest("Parallel scanning");
+        {
+            KnownPluginList list;
+            PluginScanner::scanFiles(files, cache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 8);
+            expectEquals(stubFormat->getNumScans(), 8);
+            expect(stubFormat->getMaxRunningScans() > 1);
+            // the file without plugins is cached as well:
+            expectEquals(cache.size(), 9);
+        }
+
+        beginTest("Unchanged files are not rescanned");
+        {
+            KnownPluginList list;
+            PluginScanner::scanFiles(files, cache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 8);
+            expectEquals(stubFormat->getNumScans(), 8);
+        }
+
+        beginTest("Changed files are rescanned");
+        {
+            File(files[3]).appendText(" updated");
+
+            KnownPluginList list;
+            PluginScanner::scanFiles(files, cache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 8);
+            expectEquals(stubFormat->getNumScans(), 9);
+
+            bool hasUpdatedPlugin = false;
+            for (const auto &description : list.getTypes())
+            {
+                hasUpdatedPlugin = hasUpdatedPlugin || description.name == "Stub 3 updated";
+            }
+
+            expect(hasUpdatedPlugin);
+        }
+
+        beginTest("Scan cache serialization");
+        {
+            PluginScanCache restoredCache;
+            restoredCache.deserialize(cache.serialize());
+            expectEquals(restoredCache.size(), cache.size());
+
+            KnownPluginList list;
+            PluginScanner::scanFiles(files, restoredCache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 8);
+            expectEquals(stubFormat->getNumScans(), 9);
+        }
+
+        beginTest("Inconclusive and cancelled scans are not cached");
+        {
+            PluginScanCache emptyCache;
+            PluginScanner::scanFiles(files, emptyCache, 4,
+                [](const String &, Array<PluginDescription> &) { return PluginScanner::ScanResult::Inconclusive; },
+                [](const Array<PluginDescription> &) {}, neverStop);
+
+            expectEquals(emptyCache.size(), 0);
+
+            PluginScanner::scanFiles(files, emptyCache, 4, scanInProcess,
+                [](const Array<PluginDescription> &) {}, []() { return true; });
+
+            expectEquals(emptyCache.size(), 0);
+            expectEquals(stubFormat->getNumScans(), 9);
+        }
+
+        beginTest("Crashed scans are skipped until the file changes");
+        {
+            PluginScanCache crashCache;
+            PluginScanner::scanFiles(files, crashCache, 4,
+                [](const String &, Array<PluginDescription> &) { return PluginScanner::ScanResult::Crashed; },
+                [](const Array<PluginDescription> &) {}, neverStop);
+
+            expectEquals(crashCache.size(), 9);
+            expectEquals(crashCache.getNumFailed(), 9);
+
+            PluginScanCache restoredCrashCache;
+            restoredCrashCache.deserialize(crashCache.serialize());
+            expectEquals(restoredCrashCache.getNumFailed(), 9);
+
+            KnownPluginList list;
+            PluginScanner::scanFiles(files, restoredCrashCache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 0);
+            expectEquals(stubFormat->getNumScans(), 9);
+
+            File(files[5]).appendText(" fixed");
+
+            PluginScanner::scanFiles(files, restoredCrashCache, 4, scanInProcess,
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 1);
+            expectEquals(stubFormat->getNumScans(), 10);
+            expectEquals(restoredCrashCache.getNumFailed(), 8);
+        }
+
+        beginTest("Built-in instruments scanning");
+        {
+            AudioPluginFormatManager builtInFormatManager;
+            AudioCore::initAudioFormats(builtInFormatManager);
+
+            const StringArray builtInIds(DefaultSynthAudioPlugin::instrumentId,
+                MetronomeSynthAudioPlugin::instrumentId, SoundFontSynthAudioPlugin::instrumentId);
+
+            KnownPluginList list;
+            PluginScanner::scanFiles(builtInIds, cache, 4,
+                [&builtInFormatManager](const String &fileOrIdentifier, Array<PluginDescription> &outDescriptions)
+                {
+                    outDescriptions = PluginScanner::scanFile(builtInFormatManager, fileOrIdentifier);
+                    return PluginScanner::ScanResult::Scanned;
+                },
+                [&list](const Array<PluginDescription> &found) { for (const auto &d : found) { list.addType(d); } },
+                neverStop);
+
+            expectEquals(list.getNumTypes(), 3);
+
+            for (const auto &description : list.getTypes())
+            {
+                expectEquals(description.pluginFormatName, BuiltInSynthsPluginFormat::formatName);
+            }
+        }
+
+        tempDir.deleteRecursively();
+    }
+};
+
+static PluginScannerTests pluginScannerTests;
+
+#endif
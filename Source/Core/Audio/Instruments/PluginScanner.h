@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "PluginScanCache.h"
+
 class PluginScanner final :
     public Serializable,
     private Thread,
@@ -45,6 +47,33 @@ public:
     void scanFolderAndAddResults(const File &dir);
     void cancelRunningScan();
 
+    // scans the file in this process with all given formats,
+    // (used by the checker process, or directly, when safe scan is disabled)
+    static Array<PluginDescription> scanFile(AudioPluginFormatManager &formatManager,
+        const String &fileOrIdentifier);
+
+    enum class ScanResult
+    {
+        Scanned,
+        // the plugin has crashed the checker process,
+        // so it won't be rescanned until the file changes:
+        Crashed,
+        // e.g. timed out or cancelled, so it won't be cached:
+        Inconclusive
+    };
+
+    using ScanFunction = Function<ScanResult(const String &fileOrIdentifier,
+        Array<PluginDescription> &outDescriptions)>;
+
+    using ResultsCallback = Function<void(const Array<PluginDescription> &descriptions)>;
+
+    // runs up to numWorkers scan functions concurrently, skipping the files which
+    // haven't changed since they were cached; the callback is called for both
+    // the cached and the newly found results, possibly from the worker threads
+    static void scanFiles(const StringArray &files, PluginScanCache &cache,
+        int numWorkers, const ScanFunction &scanFunction,
+        const ResultsCallback &resultsCallback, const Function<bool()> &shouldStop);
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -70,6 +99,15 @@ private:
     FileSearchPath searchPath;
     StringArray filesToScan;
 
+    // loaded lazily by the search thread, saved after each scan:
+    PluginScanCache scanCache;
+    bool isScanCacheLoaded = false;
+    static File getScanCacheFile();
+
+    bool shouldStopScanning() const;
+    ScanResult scanFileInCheckerProcess(const String &fileOrIdentifier,
+        Array<PluginDescription> &outDescriptions) const;
+
     FileSearchPath getCommonFolders();
     void scanPossibleSubfolders(const StringArray &possibleSubfolders,
         const File &currentSystemFolder, FileSearchPath &foldersOut);
@@ -38,8 +38,10 @@
 MidiRecorder::MidiRecorder(ProjectNode &project) :
     project(project)
 {
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
+    this->receivedMessagesBuffer.allocate(MidiRecorder::receivedMessagesFifoSize, true);
+
     this->lastCorrectPosition = this->getTransport().getSeekBeat();
+    this->resetTempoMap(this->lastCorrectPosition.get());
 
     this->getTransport().addTransportListener(this);
 }
@@ -83,17 +85,23 @@ void MidiRecorder::onSeek(float beatPosition)
         MessageManagerLock mml(Thread::getCurrentThread());
         jassert(mml.lockWasGained());
 
+        // the notes received before the rewind go first,
+        // while the tempo map still doesn't know about it:
+        this->cancelPendingUpdate();
+        this->handleAsyncUpdate();
+
         this->finaliseAllHoldingNotes();
     }
 
     this->lastCorrectPosition = beatPosition;
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
+    this->addTempoAnchor(beatPosition);
 }
 
 void MidiRecorder::onCurrentTempoChanged(double msPerQuarter) noexcept
 {
+    const auto currentBeat = this->getBeatAt(Time::getMillisecondCounterHiRes());
     this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
-    this->lastUpdateTime = Time::getMillisecondCounterHiRes();
+    this->addTempoAnchor(currentBeat);
 }
 
 void MidiRecorder::onRecord()
@@ -117,7 +125,7 @@ void MidiRecorder::onPlay() noexcept
     if (!this->isPlaying.get())
     {
         this->isPlaying = true;
-        this->lastUpdateTime = Time::getMillisecondCounterHiRes();
+        this->addTempoAnchor(this->lastCorrectPosition.get());
 
         if (this->isRecording.get())
         {
@@ -136,16 +144,17 @@ void MidiRecorder::onStop()
 
         this->isRecording = false;
 
-        // fixme handle buffers?
-        jassert(this->noteOnsBuffer.isEmpty());
-        jassert(this->noteOffsBuffer.isEmpty());
-
-        this->holdingNotes.clear();
+        // the input callback is removed, so nothing is written into the fifo
+        // any more; the notes received so far are still a part of this take,
+        // and the notes still holding end where the playback has stopped:
+        this->cancelPendingUpdate();
+        this->handleAsyncUpdate();
+        this->finaliseAllHoldingNotes();
     }
 
     this->isPlaying = false;
-    this->lastUpdateTime = 0.0;
     this->msPerQuarterNote = Globals::Defaults::msPerBeat;
+    this->resetTempoMap(this->lastCorrectPosition.get());
 }
 
 static SerializedData createPianoTrackTemplate(const String &name,
@@ -172,8 +181,17 @@ static SerializedData createPianoTrackTemplate(const String &name,
 // the main recording logic goes here:
 void MidiRecorder::handleAsyncUpdate()
 {
-    if (this->noteOnsBuffer.isEmpty() &&
-        this->noteOffsBuffer.isEmpty())
+    this->receivedMessages.clearQuick();
+
+    {
+        const auto scope = this->receivedMessagesFifo.read(this->receivedMessagesFifo.getNumReady());
+        scope.forEach([this](int index)
+        {
+            this->receivedMessages.add(this->receivedMessagesBuffer[index]);
+        });
+    }
+
+    if (this->receivedMessages.isEmpty())
     {
         // nothing to do
         return;
@@ -183,7 +201,8 @@ void MidiRecorder::handleAsyncUpdate()
     // yet have received some midi events;
     // we do it before inserting any events,
     // so that the first note doesn't sound twice
-    if (!this->isPlaying.get())
+    // (unless the recording has just been stopped)
+    if (!this->isPlaying.get() && this->isRecording.get())
     {
         this->getTransport().startPlayback();
     }
@@ -196,7 +215,7 @@ void MidiRecorder::handleAsyncUpdate()
     // we'll checkpoint every time the active track changes:
     if (this->shouldCheckpoint.get())
     {
-        jassert(this->holdingNotes.empty());
+        jassert(!this->recordedNotes.hasHoldingNotes());
         this->project.checkpoint();
         this->shouldCheckpoint = false;
     }
@@ -232,76 +251,146 @@ void MidiRecorder::handleAsyncUpdate()
         this->activeClip = this->activeTrack->getPattern()->getUnchecked(0);
         this->shouldCheckpoint = false;
     }
-    
-    // handle note offs and fill unhandledNoteOffs
-    while (!this->noteOffsBuffer.isEmpty())
+
+    // the messages of several devices are interleaved in the fifo,
+    // so it is not strictly ordered by the device timestamps:
+    std::stable_sort(this->receivedMessages.begin(), this->receivedMessages.end(),
+        [](const ReceivedMessage &a, const ReceivedMessage &b)
+        {
+            return a.timeMs < b.timeMs;
+        });
+
+    for (const auto &received : this->receivedMessages)
     {
-        const auto last = this->noteOffsBuffer.size() - 1;
-        const auto i = this->noteOffsBuffer.removeAndReturn(last);
-        const bool wasHandled = this->finaliseHoldingNote(i);
-        if (!wasHandled)
+        const MidiMessage message(received.data[0], received.data[1], received.data[2]);
+        const auto beat = this->getBeatAt(received.timeMs);
+
+        if (message.isNoteOn())
+        {
+            this->startHoldingNote(message.getNoteNumber(), message.getFloatVelocity(), beat);
+        }
+        else if (message.isNoteOff())
         {
-            this->unhandledNoteOffs.add(i);
+            this->finaliseHoldingNote(message.getNoteNumber(), beat);
         }
     }
 
-    // handle note ons
-    while (!this->noteOnsBuffer.isEmpty())
+    this->applyRecordedNotes();
+}
+
+// called from the high-priority system thread:
+void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
+{
+    // the dense controller streams are skipped right away
+    // without waking up the message thread at all
+    if (!message.isNoteOnOrOff())
     {
-        const auto last = this->noteOnsBuffer.size() - 1;
-        const auto i = this->noteOnsBuffer.removeAndReturn(last);
-        this->startHoldingNote(i);
+        return;
     }
 
-    // handle unhandledNoteOffs and clean
-    for (const auto &i : this->unhandledNoteOffs)
+    // JUCE timestamps the incoming messages in seconds, on the same clock
+    // as Time::getMillisecondCounterHiRes(), but some drivers leave it empty:
+    const auto now = Time::getMillisecondCounterHiRes();
+    const auto deviceTimeMs = message.getTimeStamp() * 1000.0;
+    const auto timeMs = (deviceTimeMs > 0.0 && deviceTimeMs <= now) ? deviceTimeMs : now;
+
     {
-        this->finaliseHoldingNote(i);
+        const auto scope = this->receivedMessagesFifo.write(1);
+        if (scope.blockSize1 == 0)
+        {
+            jassertfalse; // the message thread is not keeping up
+            return;
+        }
+
+        auto &received = this->receivedMessagesBuffer[scope.startIndex1];
+        const auto *data = message.getRawData();
+        received.timeMs = timeMs;
+        received.data[0] = data[0];
+        received.data[1] = data[1];
+        received.data[2] = message.getRawDataSize() > 2 ? data[2] : uint8(0);
     }
 
-    this->unhandledNoteOffs.clearQuick();
+    this->triggerAsyncUpdate();
 }
 
-struct SortMidiMessagesByTimestamp final
+//===----------------------------------------------------------------------===//
+// Tempo map
+//===----------------------------------------------------------------------===//
+
+void MidiRecorder::resetTempoMap(double beat)
 {
-    static int compareElements(const MidiMessage &first, const MidiMessage &second)
-    {
-        return int(first.getTimeStamp() - second.getTimeStamp());
-    }
-};
+    const SpinLock::ScopedLockType lock(this->tempoMapLock);
+    this->tempoMap.reset(Time::getMillisecondCounterHiRes(),
+        beat, this->msPerQuarterNote.get());
+}
 
-static SortMidiMessagesByTimestamp tsSort;
+// called when the player reports the position or the tempo,
+// which may happen both on the player thread and the message thread
+void MidiRecorder::addTempoAnchor(double beat)
+{
+    const SpinLock::ScopedLockType lock(this->tempoMapLock);
+    // the time is taken under the lock, so that the anchors are sorted
+    this->tempoMap.addAnchor(Time::getMillisecondCounterHiRes(),
+        beat, this->msPerQuarterNote.get(), this->isPlaying.get());
+}
 
-// called from the high-priority system thread:
-void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
+double MidiRecorder::getBeatAt(double timeMs) const
+{
+    const SpinLock::ScopedLockType lock(this->tempoMapLock);
+    return this->tempoMap.getBeatAt(timeMs, this->lastCorrectPosition.get());
+}
+
+MidiRecorder::TempoMap::TempoMap()
+{
+    this->anchors.ensureStorageAllocated(TempoMap::maxNumAnchors);
+}
+
+void MidiRecorder::TempoMap::reset(double timeMs, double beat, double msPerQuarterNote)
 {
-    if (message.isNoteOn())
+    this->anchors.clearQuick();
+    this->anchors.add({ timeMs, beat, msPerQuarterNote, false });
+}
+
+bool MidiRecorder::TempoMap::addAnchor(double timeMs, double beat,
+    double msPerQuarterNote, bool isPlaying)
+{
+    const Anchor anchor{ timeMs, beat, msPerQuarterNote, isPlaying };
+
+    if (!this->anchors.isEmpty())
     {
-        this->noteOnsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        // the player reports its position at every event it sends out,
+        // but most of the time the previous anchor predicts it just fine
+        const auto &lastAnchor = this->anchors.getReference(this->anchors.size() - 1);
+        const auto driftMs = std::abs(lastAnchor.getBeatAt(anchor.timeMs) - beat) * anchor.msPerQuarterNote;
+        if (lastAnchor.isPlaying == anchor.isPlaying &&
+            lastAnchor.msPerQuarterNote == anchor.msPerQuarterNote &&
+            driftMs < TempoMap::maxAnchorDriftMs)
+        {
+            return false;
+        }
     }
-    else if (message.isNoteOff())
+
+    if (this->anchors.size() >= TempoMap::maxNumAnchors)
     {
-        this->noteOffsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        this->anchors.remove(0);
     }
 
-    this->triggerAsyncUpdate();
+    this->anchors.add(anchor);
+    return true;
 }
 
-// current beat, estimated since the last known
-// midi event, including the tempo change events:
-double MidiRecorder::getEstimatedPosition() const
+double MidiRecorder::TempoMap::getBeatAt(double timeMs, double fallbackBeat) const
 {
-    if (!this->isPlaying.get())
+    if (this->anchors.isEmpty())
     {
-        return this->lastCorrectPosition.get();
+        return fallbackBeat;
     }
 
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->lastUpdateTime.get();
-    const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
-    const double estimatedPosition = this->lastCorrectPosition.get() + positionOffset;
-    return estimatedPosition;
+    const auto found = std::upper_bound(this->anchors.begin(), this->anchors.end(), timeMs,
+        [](double time, const Anchor &anchor) { return time < anchor.timeMs; });
+
+    const auto index = jmax(0, int(found - this->anchors.begin()) - 1);
+    return this->anchors.getReference(index).getBeatAt(timeMs);
 }
 
 void MidiRecorder::timerCallback()
@@ -334,90 +423,143 @@ int MidiRecorder::getMappedKey(int key) const noexcept
         temperament->getPeriodSize() * periodNumber, false);
 }
 
-void MidiRecorder::startHoldingNote(const MidiMessage &message)
+void MidiRecorder::startHoldingNote(int key, float velocity, double beat)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto key = this->getMappedKey(message.getNoteNumber());
-    
-    if (this->holdingNotes.contains(key))
+    this->recordedNotes.startHoldingNote(this->activeTrack->getSequence(),
+        this->getMappedKey(key) - this->activeClip->getKey(), velocity,
+        float(beat) - this->activeClip->getBeat());
+}
+
+void MidiRecorder::updateLengthsOfHoldingNotes()
+{
+    jassert(this->activeClip != nullptr);
+    jassert(this->activeTrack != nullptr);
+
+    if (!this->recordedNotes.hasHoldingNotes())
     {
-        DBG("Found weird note-on/note-off order");
-        this->finaliseHoldingNote(message);
+        return;
     }
 
-    const Note noteParams(this->activeTrack->getSequence(),
-        key - this->activeClip->getKey(),
-        roundBeat(float(message.getTimeStamp()) - this->activeClip->getBeat()),
-        Globals::minNoteLength,
-        float(message.getVelocity()) / 127.f);
+    const auto currentBeat =
+        float(this->getBeatAt(Time::getMillisecondCounterHiRes()) - this->activeClip->getBeat());
 
-    this->getPianoSequence()->insert(noteParams, true);
-    this->holdingNotes[key] = noteParams;
+    this->recordedNotes.updateLengthsOfHoldingNotes(currentBeat);
+    this->applyRecordedNotes();
+}
+
+void MidiRecorder::finaliseAllHoldingNotes()
+{
+    if (this->activeTrack != nullptr) // the user cleared the selection before hitting stop
+    {
+        this->updateLengthsOfHoldingNotes();
+    }
+
+    this->recordedNotes.clearHoldingNotes();
 }
 
-void MidiRecorder::updateLengthsOfHoldingNotes() const
+void MidiRecorder::finaliseHoldingNote(int key, double beat)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    if (this->holdingNotes.empty())
+    this->recordedNotes.finaliseHoldingNote(
+        this->getMappedKey(key) - this->activeClip->getKey(),
+        float(beat) - this->activeClip->getBeat());
+}
+
+void MidiRecorder::applyRecordedNotes()
+{
+    auto *sequence = this->getPianoSequence();
+    auto &notes = this->recordedNotes;
+
+    if (!notes.notesToInsert.isEmpty())
     {
-        return;
+        sequence->insertGroup(notes.notesToInsert, true);
+        notes.notesToInsert.clearQuick();
     }
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+    if (!notes.notesToChangeBefore.isEmpty())
+    {
+        sequence->changeGroup(notes.notesToChangeBefore, notes.notesToChangeAfter, true);
+        notes.notesToChangeBefore.clearQuick();
+        notes.notesToChangeAfter.clearQuick();
+    }
+}
 
-    Array<Note> groupBefore;
-    Array<Note> groupAfter;
+//===----------------------------------------------------------------------===//
+// Recorded notes
+//===----------------------------------------------------------------------===//
 
-    for (const auto &i : this->holdingNotes)
+void MidiRecorder::RecordedNotes::startHoldingNote(WeakReference<MidiSequence> sequence,
+    int key, float velocity, float beat)
+{
+    if (this->holdingNotes.contains(key))
     {
-        const auto newLength = roundBeat(currentBeat - i.second.getBeat());
-        if (i.second.getLength() == newLength)
-        {
-            return;
-        }
-
-        groupBefore.add(i.second);
-        groupAfter.add(i.second.withLength(newLength));
+        DBG("Found weird note-on/note-off order");
+        this->finaliseHoldingNote(key, beat);
     }
 
-    this->getPianoSequence()->changeGroup(groupBefore, groupAfter, true);
+    const Note noteParams(sequence, key, roundBeat(beat), Globals::minNoteLength, velocity);
+
+    this->notesToInsert.add(noteParams);
+    this->holdingNotes[key] = noteParams;
 }
 
-void MidiRecorder::finaliseAllHoldingNotes()
+void MidiRecorder::RecordedNotes::updateLengthsOfHoldingNotes(float beat)
 {
-    if (this->activeTrack != nullptr) // the user cleared the selection before hitting stop
+    for (auto &i : this->holdingNotes)
     {
-        this->updateLengthsOfHoldingNotes();
+        const auto newLength = jmax(Globals::minNoteLength, roundBeat(beat - i.second.getBeat()));
+        if (i.second.getLength() == newLength)
+        {
+            continue;
+        }
+
+        this->notesToChangeBefore.add(i.second);
+        i.second = i.second.withLength(newLength);
+        this->notesToChangeAfter.add(i.second);
     }
+}
 
+void MidiRecorder::RecordedNotes::clearHoldingNotes()
+{
     this->holdingNotes.clear();
 }
 
-bool MidiRecorder::finaliseHoldingNote(const MidiMessage &message)
+bool MidiRecorder::RecordedNotes::finaliseHoldingNote(int key, float beat)
 {
-    jassert(this->activeClip != nullptr);
-    jassert(this->activeTrack != nullptr);
+    const auto found = this->holdingNotes.find(key);
+    if (found == this->holdingNotes.end())
+    {
+        return false;
+    }
 
-    const auto key = this->getMappedKey(message.getNoteNumber());
+    const auto &note = found->second;
+    const auto newLength = jmax(Globals::minNoteLength, roundBeat(beat - note.getBeat()));
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+    // the note might have been started within the same batch:
+    bool isInsertionPending = false;
+    for (auto &pendingNote : this->notesToInsert)
+    {
+        if (pendingNote.getId() == note.getId())
+        {
+            pendingNote = pendingNote.withLength(newLength);
+            isInsertionPending = true;
+            break;
+        }
+    }
 
-    if (this->holdingNotes.contains(key))
+    if (!isInsertionPending)
     {
-        const auto &note = this->holdingNotes[key];
-        const auto newLength = roundBeat(currentBeat - note.getBeat());
-        this->getPianoSequence()->change(note, note.withLength(newLength), true);
-        this->holdingNotes.erase(key);
-        return true;
+        this->notesToChangeBefore.add(note);
+        this->notesToChangeAfter.add(note.withLength(newLength));
     }
 
-    return false;
+    this->holdingNotes.erase(found);
+    return true;
 }
 
 PianoSequence *MidiRecorder::getPianoSequence() const
@@ -429,3 +571,171 @@ Transport &MidiRecorder::getTransport() const noexcept
 {
     return this->project.getTransport();
 }
+
+#if JUCE_UNIT_TESTS
+
+class MidiRecorderTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    MidiRecorderTestTrack() :
+        sequence(make<PianoSequence>(*this, *this)) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<PianoSequence> sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiRecorderTestTrack)
+};
+
+class MidiRecorderTests final : public UnitTest
+{
+public:
+    MidiRecorderTests() : UnitTest("Midi recorder tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Tempo map converts the timestamps across tempo changes");
+        {
+            MidiRecorder::TempoMap map;
+            map.reset(0.0, 0.0, 500.0);
+
+            // stopped, the position doesn't move
+            expectEquals(map.getBeatAt(500.0, -1.0), 0.0);
+
+            expect(map.addAnchor(1000.0, 0.0, 500.0, true));
+            expectEquals(map.getBeatAt(2000.0, -1.0), 2.0);
+
+            // twice as fast since the 4th beat
+            expect(map.addAnchor(3000.0, 4.0, 250.0, true));
+            expectEquals(map.getBeatAt(3500.0, -1.0), 6.0);
+
+            // the messages received before the tempo change,
+            // but drained after it, still use the old tempo
+            expectEquals(map.getBeatAt(2500.0, -1.0), 3.0);
+            expectEquals(map.getBeatAt(500.0, -1.0), 0.0);
+        }
+
+        beginTest("Tempo map skips the anchors it already predicts");
+        {
+            MidiRecorder::TempoMap map;
+            map.reset(0.0, 0.0, 500.0);
+            expect(map.addAnchor(0.0, 0.0, 500.0, true));
+
+            // 0.5 ms off the estimate
+            expect(!map.addAnchor(1000.0, 2.001, 500.0, true));
+            // 10 ms off the estimate
+            expect(map.addAnchor(2000.0, 4.02, 500.0, true));
+            expectWithinAbsoluteError(map.getBeatAt(2500.0, -1.0), 5.02, 0.0001);
+
+            // the empty map uses the fallback
+            MidiRecorder::TempoMap emptyMap;
+            expectEquals(emptyMap.getBeatAt(100.0, 42.0), 42.0);
+        }
+
+        beginTest("Tempo map handles the loop rewinds");
+        {
+            MidiRecorder::TempoMap map;
+            map.reset(0.0, 0.0, 500.0);
+            expect(map.addAnchor(0.0, 0.0, 500.0, true));
+
+            // the loop ends at the 8th beat and starts over
+            expect(map.addAnchor(4000.0, 0.0, 500.0, true));
+
+            // a batch with the messages from both sides of the rewind
+            expectEquals(map.getBeatAt(3900.0, -1.0), 7.8);
+            expectEquals(map.getBeatAt(4100.0, -1.0), 0.2);
+
+            // many rewinds later, the oldest anchors are dropped
+            for (int i = 2; i < 100; ++i)
+            {
+                expect(map.addAnchor(i * 4000.0, 0.0, 500.0, true));
+            }
+
+            expectEquals(map.getBeatAt(99 * 4000.0 + 1000.0, -1.0), 2.0);
+            expectEquals(map.getBeatAt(99 * 4000.0 - 1000.0, -1.0), 6.0);
+        }
+
+        MidiRecorderTestTrack track;
+        auto *sequence = track.getSequence();
+
+        beginTest("Recorded notes pair the note-offs within the same batch");
+        {
+            MidiRecorder::RecordedNotes notes;
+            notes.startHoldingNote(sequence, 60, 0.5f, 1.f);
+            notes.startHoldingNote(sequence, 64, 0.5f, 1.5f);
+            expect(notes.hasHoldingNotes());
+
+            expect(notes.finaliseHoldingNote(60, 2.f));
+            expect(notes.finaliseHoldingNote(64, 4.f));
+            expect(!notes.finaliseHoldingNote(67, 4.f));
+            expect(!notes.hasHoldingNotes());
+
+            // both notes are inserted with their final lengths
+            expectEquals(notes.notesToInsert.size(), 2);
+            expectEquals(notes.notesToInsert[0].getLength(), 1.f);
+            expectEquals(notes.notesToInsert[1].getLength(), 2.5f);
+            expect(notes.notesToChangeBefore.isEmpty());
+            expect(notes.notesToChangeAfter.isEmpty());
+        }
+
+        beginTest("Recorded notes change the notes inserted in earlier batches");
+        {
+            MidiRecorder::RecordedNotes notes;
+            notes.startHoldingNote(sequence, 60, 0.5f, 1.f);
+            const auto inserted = notes.notesToInsert.getFirst();
+            notes.notesToInsert.clearQuick(); // applied
+
+            notes.updateLengthsOfHoldingNotes(1.5f);
+            expectEquals(notes.notesToChangeBefore.size(), 1);
+            expectEquals(notes.notesToChangeAfter[0].getLength(), 0.5f);
+
+            // no changes are made while the length stays the same
+            notes.updateLengthsOfHoldingNotes(1.5f);
+            expectEquals(notes.notesToChangeBefore.size(), 1);
+            notes.notesToChangeBefore.clearQuick(); // applied
+            notes.notesToChangeAfter.clearQuick();
+
+            expect(notes.finaliseHoldingNote(60, 3.f));
+            expect(notes.notesToInsert.isEmpty());
+            expectEquals(notes.notesToChangeBefore.size(), 1);
+            expect(notes.notesToChangeBefore[0].getId() == inserted.getId());
+            expectEquals(notes.notesToChangeBefore[0].getLength(), 0.5f);
+            expectEquals(notes.notesToChangeAfter[0].getLength(), 2.f);
+        }
+
+        beginTest("Recorded notes finalise the retriggered keys first");
+        {
+            MidiRecorder::RecordedNotes notes;
+            notes.startHoldingNote(sequence, 60, 0.5f, 1.f);
+            notes.startHoldingNote(sequence, 60, 0.5f, 2.f);
+            expect(notes.finaliseHoldingNote(60, 2.5f));
+            expect(!notes.hasHoldingNotes());
+
+            expectEquals(notes.notesToInsert.size(), 2);
+            expectEquals(notes.notesToInsert[0].getLength(), 1.f);
+            expectEquals(notes.notesToInsert[1].getBeat(), 2.f);
+            expectEquals(notes.notesToInsert[1].getLength(), 0.5f);
+        }
+    }
+};
+
+static MidiRecorderTests midiRecorderTests;
+
+#endif
@@ -84,30 +84,142 @@ private:
 
     PianoSequence *getPianoSequence() const;
 
-    Array<MidiMessage, CriticalSection> noteOnsBuffer;
-    Array<MidiMessage, CriticalSection> noteOffsBuffer;
-    Array<MidiMessage> unhandledNoteOffs;
+    //===------------------------------------------------------------------===//
+    // Incoming messages
+    //===------------------------------------------------------------------===//
+
+    // the raw note messages as they come from the midi input thread,
+    // along with the device timestamps, converted into beats later
+    struct ReceivedMessage final
+    {
+        double timeMs;
+        uint8 data[3];
+    };
+
+    // the single-producer, single-consumer ring buffer, where the message thread
+    // is the only reader; there may be several input devices, but AudioDeviceManager
+    // calls all input callbacks under its midiCallbackLock, one at a time, so there
+    // is still one writer at any moment, and the input threads never allocate here
+    static constexpr auto receivedMessagesFifoSize = 4096;
+    AbstractFifo receivedMessagesFifo { receivedMessagesFifoSize };
+    HeapBlock<ReceivedMessage> receivedMessagesBuffer;
+
+    // the message thread drains the whole fifo at once into this batch
+    Array<ReceivedMessage> receivedMessages;
+
+    //===------------------------------------------------------------------===//
+    // Tempo map
+    //===------------------------------------------------------------------===//
+
+    // the positions and tempos reported by the player since the last stop,
+    // used to convert the timestamps into beats; the messages are drained
+    // a bit later than they are received, and a loop rewind or a tempo change
+    // may happen in between, so only the latest anchor would not be enough
+    class TempoMap final
+    {
+    public:
+
+        TempoMap();
+
+        void reset(double timeMs, double beat, double msPerQuarterNote);
+
+        // returns false, if the new anchor was skipped,
+        // because the previous one predicts it well enough
+        bool addAnchor(double timeMs, double beat,
+            double msPerQuarterNote, bool isPlaying);
+
+        // the beat at the given time, estimated from the last anchor before that time,
+        // including the loop rewinds and the tempo change events:
+        double getBeatAt(double timeMs, double fallbackBeat) const;
+
+    private:
+
+        struct Anchor final
+        {
+            double timeMs;
+            double beat;
+            double msPerQuarterNote;
+            bool isPlaying;
+
+            double getBeatAt(double time) const noexcept
+            {
+                return this->isPlaying ?
+                    this->beat + (time - this->timeMs) / this->msPerQuarterNote :
+                    this->beat;
+            }
+        };
+
+        Array<Anchor> anchors;
+
+        // a new anchor is only added when the reported position deviates
+        // from the previous anchor's estimate more than this:
+        static constexpr auto maxAnchorDriftMs = 2.0;
+        static constexpr auto maxNumAnchors = 64;
+    };
+
+    // warning: spinlock is not reentrant, use carefully;
+    // it synchronizes the transport callbacks, which may come
+    // from the player thread, with the message thread reading them
+    SpinLock tempoMapLock;
+    TempoMap tempoMap;
+
+    void resetTempoMap(double beat);
+    void addTempoAnchor(double beat);
+    double getBeatAt(double timeMs) const;
+
+    //===------------------------------------------------------------------===//
+    // Recording
+    //===------------------------------------------------------------------===//
 
-    FlatHashMap<int, Note> holdingNotes;
-    void startHoldingNote(const MidiMessage &message);
-    void updateLengthsOfHoldingNotes() const;
+    // pairs the note-ons and note-offs of a take into the note insertions
+    // and changes; the keys are already mapped, and the beats are clip-relative;
+    // each batch of received messages is applied as one group insertion
+    // and one group change, all within the same undo transaction of a take
+    class RecordedNotes final
+    {
+    public:
+
+        void startHoldingNote(WeakReference<MidiSequence> sequence,
+            int key, float velocity, float beat);
+        bool finaliseHoldingNote(int key, float beat);
+        void updateLengthsOfHoldingNotes(float beat);
+        void clearHoldingNotes();
+
+        bool hasHoldingNotes() const noexcept
+        {
+            return !this->holdingNotes.empty();
+        }
+
+        Array<Note> notesToInsert;
+        Array<Note> notesToChangeBefore;
+        Array<Note> notesToChangeAfter;
+
+    private:
+
+        FlatHashMap<int, Note> holdingNotes;
+    };
+
+    RecordedNotes recordedNotes;
+
+    void startHoldingNote(int key, float velocity, double beat);
+    void updateLengthsOfHoldingNotes();
     void finaliseAllHoldingNotes();
-    bool finaliseHoldingNote(const MidiMessage &message);
+    void finaliseHoldingNote(int key, double beat);
+    void applyRecordedNotes();
 
     int getMappedKey(int key) const noexcept;
 
-    double getEstimatedPosition() const;
-
     // no need for updating too often, I guess:
     static constexpr auto updateTimeHz = 15;
 
     Atomic<float> lastCorrectPosition = 0.f;
-    Atomic<double> lastUpdateTime = 0.0;
     Atomic<double> msPerQuarterNote = Globals::Defaults::msPerBeat;
 
     Atomic<bool> isPlaying = false;
     Atomic<bool> isRecording = false;
     Atomic<bool> shouldCheckpoint = false;
 
+    friend class MidiRecorderTests;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiRecorder)
 };
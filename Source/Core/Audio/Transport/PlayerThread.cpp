@@ -73,6 +73,11 @@ void PlayerThread::run()
 
     this->sequences.seekToTime(this->context->startBeat);
 
+    if (isLooped)
+    {
+        this->sequences.setLoopStart(this->context->rewindBeat);
+    }
+
     Atomic<float> previousEventBeat = this->context->startBeat;
     broadcastSeekAndTempo(previousEventBeat.get());
 
@@ -201,7 +206,7 @@ void PlayerThread::run()
 
             if (isLooped)
             {
-                this->sequences.seekToTime(this->context->rewindBeat);
+                this->sequences.seekToLoopStart();
                 previousEventBeat = this->context->rewindBeat;
                 broadcastSeekAndTempo(previousEventBeat.get());
                 continue;
@@ -283,7 +288,7 @@ void PlayerThread::run()
         
         if (shouldRewind)
         {
-            this->sequences.seekToTime(this->context->rewindBeat);
+            this->sequences.seekToLoopStart();
             previousEventBeat = this->context->rewindBeat;
             broadcastSeekAndTempo(previousEventBeat.get());
         }
@@ -306,11 +311,10 @@ void PlayerThread::run()
             }
             else
             {
+                // plugin parameter changes go to the instrument's queue as well,
+                // they are applied in its audio callback, see ParameterAutomation
                 wrapper.listener->addMessageToQueue(wrapper.message);
             }
-            
-            // todo automating individual plugin node parameters
-            //wrapper.instrument->getNodeForId(node id)->getProcessor()->getParameters()[param index]->setValue()
 
             if (wrapper.message.isNoteOn())
             {
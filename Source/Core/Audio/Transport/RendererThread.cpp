@@ -137,6 +137,7 @@ struct RenderBuffer final
     Instrument *instrument;
     AudioBuffer<float> sampleBuffer;
     MidiBuffer midiBuffer;
+    ParameterAutomation parameterAutomation;
 };
 
 void RendererThread::run()
@@ -284,7 +285,8 @@ void RendererThread::run()
             auto *graph = subBuffer->instrument->getProcessorGraph();
             {
                 const ScopedLock lock(graph->getCallbackLock());
-                graph->processBlock(subBuffer->sampleBuffer, subBuffer->midiBuffer);
+                subBuffer->parameterAutomation.processBlock(*graph,
+                    subBuffer->sampleBuffer, subBuffer->midiBuffer);
             }
 
             subBuffer->midiBuffer.clear();
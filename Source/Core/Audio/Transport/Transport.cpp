@@ -147,21 +147,18 @@ void Transport::probeSoundAtBeat(float targetBeat, const MidiSequence *limitToSe
     
     for (const auto &seq : sequencesToProbe)
     {
-        for (int j = 0; j < seq->midiMessages.getNumEvents(); ++j)
+        for (int j = 0; j < seq->getNumEvents(); ++j)
         {
-            auto *noteOnHolder = seq->midiMessages.getEventPointer(j);
-            
-            if (auto *noteOffHolder = noteOnHolder->noteOffObject)
+            const auto noteOnBeat = seq->getTimestamp(j);
+            if (noteOnBeat > targetBeat)
+            {
+                break; // the events are sorted
+            }
+
+            const auto noteOffIndex = seq->getNoteOffIndex(j);
+            if (noteOffIndex >= 0 && seq->getTimestamp(noteOffIndex) > targetBeat)
             {
-                const auto noteOnBeat = noteOnHolder->message.getTimeStamp();
-                const auto noteOffBeat = noteOffHolder->message.getTimeStamp();
-                
-                if (noteOnBeat <= targetBeat && noteOffBeat > targetBeat)
-                {
-                    MidiMessage messageTimestampedAsNow(noteOnHolder->message);
-                    messageTimestampedAsNow.setTimeStamp(TIME_NOW);
-                    seq->listener->addMessageToQueue(messageTimestampedAsNow);
-                }
+                seq->listener->addMessageToQueue(seq->getMessage(j).withTimeStamp(TIME_NOW));
             }
         }
     }
@@ -397,153 +394,6 @@ const Array<float, CriticalSection> &Transport::getRenderingWaveformThumbnail()
 // Sending messages at real-time
 //===----------------------------------------------------------------------===//
 
-/*
-    The purpose of this class is to help previewing messages interactively in the sequencer.
-    It will send note-on events after a delay and keep track of note-off events which need
-    to be sent later. All those previews will be cancelled by transport on stopSound.
-    The delay before the note-on event is needed because some plugins (e.g. Kontakt in my case)
-    are sometimes processing play/stop messages out of order for whatever reason, which is weird -
-    note the word `queue` in the addMessageToQueue() method name - but it still happens
-    in some scenarios, such as when the user drags some notes around quickly.
-*/
-
-Transport::NotePreviewTimer::~NotePreviewTimer()
-{
-    this->cancelAllPendingPreviews(false);
-}
-
-void Transport::NotePreviewTimer::cancelAllPendingPreviews(bool sendRemainingNoteOffs)
-{
-    if (this->isTimerRunning())
-    {
-        this->stopTimer();
-
-        // can be accessed from a separate thread, like scale/metronome preview threads:
-        const CriticalSection::ScopedLockType lock(this->previews.getLock());
-
-        for (const auto &preview : this->previews)
-        {
-            if (sendRemainingNoteOffs &&
-                preview.noteOnTimeoutMs <= 0 && // has sent the note-on message
-                preview.noteOffTimeoutMs > 0 && // but hasn't sent the note-off message yet
-                preview.instrument != nullptr)
-            {
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(preview.key, preview.channel);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(TIME_NOW);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-        }
-
-        this->previews.clearQuick();
-    }
-}
-
-void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrument,
-    int channel, int key, float volume, int16 noteOffTimeoutMs)
-{
-    jassert(key >= 0 && key < Globals::maxKeyboardSize);
-    jassert(channel > 0 && channel <= Globals::numChannels);
-
-    const CriticalSection::ScopedLockType lock(this->previews.getLock());
-
-    for (auto &preview : this->previews)
-    {
-        if (preview.key == key && preview.channel == channel)
-        {
-            jassert(preview.instrument == instrument);
-
-            if (preview.noteOnTimeoutMs <= 0 && 
-                preview.noteOffTimeoutMs > 0 &&
-                preview.instrument != nullptr)
-            {
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(key, channel);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(TIME_NOW);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-
-            preview.volume = volume;
-            preview.noteOnTimeoutMs = NotePreviewTimer::timerTickMs;
-            preview.noteOffTimeoutMs = noteOffTimeoutMs;
-            preview.instrument = instrument;
-
-            if (!this->isTimerRunning())
-            {
-                this->startTimer(NotePreviewTimer::timerTickMs);
-            }
-
-            return;
-        }
-    }
-
-    Transport::NotePreviewTimer::KeyPreviewState preview;
-    preview.key = key;
-    preview.channel = channel;
-    preview.volume = volume;
-    preview.noteOnTimeoutMs = NotePreviewTimer::timerTickMs;
-    preview.noteOffTimeoutMs = noteOffTimeoutMs;
-    preview.instrument = instrument;
-    this->previews.add(move(preview));
-
-    if (!this->isTimerRunning())
-    {
-        this->startTimer(NotePreviewTimer::timerTickMs);
-    }
-}
-
-void Transport::NotePreviewTimer::timerCallback()
-{
-#if PLATFORM_MOBILE
-    // iSEM tends to hang >_< if too many messages are send simultaniously
-    const auto time = TIME_NOW + float(rand() % 50) * 0.01;
-#elif PLATFORM_DESKTOP
-    const auto time = TIME_NOW;
-#endif
-
-    const CriticalSection::ScopedLockType lock(this->previews.getLock());
-
-    bool canStop = true;
-    for (auto &preview : this->previews)
-    {
-        if (preview.noteOnTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOnTimeoutMs -= NotePreviewTimer::timerTickMs;
-
-            if (preview.noteOnTimeoutMs <= 0 && preview.instrument != nullptr)
-            {
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(preview.key, preview.channel);
-                auto message = MidiMessage::noteOn(mapped.channel, mapped.key, preview.volume);
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-        }
-        else if (preview.noteOffTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOffTimeoutMs -= NotePreviewTimer::timerTickMs;
-
-            if (preview.noteOffTimeoutMs <= 0 && preview.instrument != nullptr)
-            {
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(preview.key, preview.channel);
-                auto message = MidiMessage::noteOff(mapped.channel, mapped.key);
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
-        }
-    }
-
-    if (canStop)
-    {
-        this->stopTimer();
-    }
-}
-
 void Transport::previewKey(const String &trackId, int channel,
     int key, float volume, float lengthInBeats) const
 {
@@ -568,11 +418,31 @@ void Transport::previewKey(WeakReference<Instrument> instrument,
 {
     jassert(instrument != nullptr);
 
-    // to calculate the note-off timeout interval, let's just use
-    // the default 120 BPM for simplicity - instead of finding the tempo
+    jassert(key >= 0 && key < Globals::maxKeyboardSize);
+    jassert(channel > 0 && channel <= Globals::numChannels);
+
+    // to calculate the note length, let's just use the default
+    // 120 BPM for simplicity - instead of finding the tempo
     // at the note position, which I think is a bit of an overkill:
-    const auto noteOffTimeoutMs = int16(Globals::Defaults::msPerBeat * lengthInBeats);
-    this->notePreviewTimer.previewNote(instrument, channel, key, volume, noteOffTimeoutMs);
+    const auto lengthMs = Globals::Defaults::msPerBeat * lengthInBeats;
+
+    // the note-on and the note-off are rendered by the instrument's audio
+    // callback, sample-accurately and always in order, which matters,
+    // because some plugins (e.g. Kontakt in my case) are sometimes processing
+    // quickly repeated play/stop messages out of order otherwise, such as
+    // when the user drags some notes around quickly
+    const auto mapped = instrument->getKeyboardMapping()->map(key, channel);
+    instrument->getProcessorPlayer().getNotePreviewScheduler()
+        .previewNote(mapped.channel, mapped.key, volume, lengthMs, Time::getMillisecondCounterHiRes());
+}
+
+void Transport::cancelAllNotePreviews() const
+{
+    const auto timeMs = Time::getMillisecondCounterHiRes();
+    for (auto *instrument : this->orchestra.getInstruments())
+    {
+        instrument->getProcessorPlayer().getNotePreviewScheduler().cancelAllPreviews(timeMs);
+    }
 }
 
 static void stopSoundForInstrument(Instrument *instrument)
@@ -589,7 +459,7 @@ static void stopSoundForInstrument(Instrument *instrument)
 
 void Transport::stopSound(const String &trackId) const
 {
-    this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->cancelAllNotePreviews();
 
     if (Instrument *instrument = this->instrumentLinks[trackId])
     {
@@ -603,7 +473,7 @@ void Transport::stopSound(const String &trackId) const
 
 void Transport::allNotesControllersAndSoundOff() const
 {
-    this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->cancelAllNotePreviews();
 
     for (int i = 1; i <= Globals::numChannels; ++i)
     {
@@ -646,7 +516,7 @@ void Transport::onMetronomeFlagChanged(bool enabled)
 // TimeSignaturesAggregator::Listener
 //===----------------------------------------------------------------------===//
 
-void Transport::onTimeSignaturesUpdated()
+void Transport::onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat)
 {
     // almost same logic as in onMetronomeFlagChanged:
     if (this->isMetronomeEnabled)
@@ -772,6 +642,15 @@ void Transport::onPostRemoveClip(Pattern *const pattern)
     this->hasSoloClipsCache = this->findSoloClipFlagIfAny();
 }
 
+void Transport::onReloadGeneratedSequence(const Clip &clip,
+    MidiSequence *const generatedSequence)
+{
+    // generated sequences are swapped in when the background jobs are done,
+    // and the changes that caused re-generation have already stopped
+    // the playback, so just make sure the next playback picks them up:
+    this->playbackCacheIsOutdated = true;
+}
+
 void Transport::onChangeTrackProperties(MidiTrack *const track)
 {
     // Stop playback only when instrument changes:
@@ -1048,6 +927,9 @@ TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
     this->hasSoloClipsCache = this->findSoloClipFlagIfAny();
     auto &generatedSequences = *this->project.getGeneratedSequences();
 
+    // the messages are exported here first, and then flattened
+    MidiMessageSequence exportedMessages;
+
     for (const auto *track : this->tracksCache)
     {
         const auto instrument = this->instrumentLinks[track->getTrackId()];
@@ -1055,12 +937,13 @@ TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
         const auto &keyMapping = *instrument->getKeyboardMapping();
 
         auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+        exportedMessages.clear();
 
         if (track->getPattern() != nullptr)
         {
             for (const auto *clip : track->getPattern()->getClips())
             {
-                cached->sequence->exportMidi(cached->midiMessages, *clip,
+                cached->sequence->exportMidi(exportedMessages, *clip,
                     keyMapping, generatedSequences,
                     this->hasSoloClipsCache, withMetronome,
                     this->projectFirstBeat.get(), this->projectLastBeat.get());
@@ -1069,12 +952,13 @@ TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
         else
         {
             static Clip noTransform;
-            cached->sequence->exportMidi(cached->midiMessages, noTransform,
+            cached->sequence->exportMidi(exportedMessages, noTransform,
                 keyMapping, generatedSequences,
                 this->hasSoloClipsCache, withMetronome,
                 this->projectFirstBeat.get(), this->projectLastBeat.get());
         }
 
+        cached->setMessages(exportedMessages);
         result.addWrapper(cached);
     }
 
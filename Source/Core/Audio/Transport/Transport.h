@@ -168,7 +168,7 @@ public:
     // TimeSignaturesAggregator::Listener
     //===------------------------------------------------------------------===//
 
-    void onTimeSignaturesUpdated() override;
+    void onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat) override;
 
     //===------------------------------------------------------------------===//
     // OrchestraListener
@@ -192,6 +192,8 @@ public:
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
     void onRemoveClip(const Clip &clip) override;
     void onPostRemoveClip(Pattern *const pattern) override;
+    void onReloadGeneratedSequence(const Clip &clip,
+        MidiSequence *const generatedSequence) override;
 
     void onAddTrack(MidiTrack *const track) override;
     void onRemoveTrack(MidiTrack *const track) override;
@@ -271,39 +273,9 @@ private:
 
 private:
 
-    class NotePreviewTimer final : private Timer
-    {
-    public:
-
-        NotePreviewTimer() = default;
-        ~NotePreviewTimer();
-
-        void cancelAllPendingPreviews(bool sendRemainingNoteOffs);
-        void previewNote(WeakReference<Instrument> instrument,
-            int channel, int key, float volume, int16 noteOffTimeoutMs);
-
-    private:
-
-        void timerCallback() override;
-
-        struct KeyPreviewState final
-        {
-            int key = 0;
-            int channel = 0;
-            float volume = 0.f;
-            int noteOnTimeoutMs = 0;
-            int noteOffTimeoutMs = 0;
-            WeakReference<Instrument> instrument;
-        };
-
-        static constexpr auto timerTickMs = 50;
-
-        Array<KeyPreviewState, CriticalSection> previews;
-
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NotePreviewTimer)
-    };
-
-    mutable NotePreviewTimer notePreviewTimer;
+    // the previews are scheduled by the instruments' audio callbacks,
+    // see NotePreviewScheduler; this just posts the cancel commands:
+    void cancelAllNotePreviews() const;
 
 private:
 
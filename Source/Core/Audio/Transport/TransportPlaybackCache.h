@@ -23,8 +23,22 @@ class MidiSequence;
 
 struct CachedMidiSequence final : public ReferenceCountedObject
 {
-    MidiMessageSequence midiMessages;
-    int currentIndex;
+    // the exported events stored flat, sorted by their timestamps in beats,
+    // with the raw bytes of all messages packed into a single block;
+    // once built, this data is shared by all copies of the playback cache,
+    // and it is never modified, since each copy has its own cursors
+    struct Event final
+    {
+        double timestamp;
+        int dataOffset;
+        int dataSize;
+        // the matching note-off for note-ons, if any, otherwise -1
+        int noteOffIndex;
+    };
+
+    Array<Event> events;
+    Array<uint8> data;
+
     MidiMessageCollector *listener;
     Instrument *instrument;
     const MidiSequence *sequence;
@@ -36,11 +50,82 @@ struct CachedMidiSequence final : public ReferenceCountedObject
         jassert(instrument != nullptr);
         CachedMidiSequence::Ptr wrapper(new CachedMidiSequence());
         wrapper->sequence = sequence;
-        wrapper->currentIndex = 0;
         wrapper->instrument = instrument;
         wrapper->listener = &instrument->getProcessorPlayer().getMidiMessageCollector();
         return wrapper;
     }
+
+    // expects the sorted exported messages, which are matched in pairs here,
+    // because sound probing needs the note-offs, and then flattened
+    void setMessages(MidiMessageSequence &exportedMessages)
+    {
+        exportedMessages.updateMatchedPairs();
+
+        const auto numEvents = exportedMessages.getNumEvents();
+
+        FlatHashMap<const MidiMessageSequence::MidiEventHolder *, int> eventIndices;
+        eventIndices.reserve(size_t(numEvents));
+        for (int i = 0; i < numEvents; ++i)
+        {
+            eventIndices[exportedMessages.getEventPointer(i)] = i;
+        }
+
+        this->events.clearQuick();
+        this->events.ensureStorageAllocated(numEvents);
+        this->data.clearQuick();
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            const auto *holder = exportedMessages.getEventPointer(i);
+            const auto &message = holder->message;
+
+            int noteOffIndex = -1;
+            if (holder->noteOffObject != nullptr)
+            {
+                const auto found = eventIndices.find(holder->noteOffObject);
+                jassert(found != eventIndices.end());
+                noteOffIndex = found->second;
+            }
+
+            this->events.add({ message.getTimeStamp(),
+                this->data.size(), message.getRawDataSize(), noteOffIndex });
+
+            this->data.addArray(message.getRawData(), message.getRawDataSize());
+        }
+    }
+
+    inline int getNumEvents() const noexcept
+    {
+        return this->events.size();
+    }
+
+    inline double getTimestamp(int index) const noexcept
+    {
+        return this->events.getReference(index).timestamp;
+    }
+
+    inline int getNoteOffIndex(int index) const noexcept
+    {
+        return this->events.getReference(index).noteOffIndex;
+    }
+
+    // short messages, i.e. notes, controllers and tempo events,
+    // fit in MidiMessage's preallocated data, so this doesn't allocate
+    inline MidiMessage getMessage(int index) const
+    {
+        const auto &event = this->events.getReference(index);
+        return MidiMessage(this->data.begin() + event.dataOffset,
+            event.dataSize, event.timestamp);
+    }
+
+    // the index of the first event at or after the given timestamp
+    int findIndexAtTime(double timestamp) const noexcept
+    {
+        const auto found = std::lower_bound(this->events.begin(), this->events.end(), timestamp,
+            [](const Event &event, double value) { return event.timestamp < value; });
+
+        return int(found - this->events.begin());
+    }
 };
 
 struct CachedMidiMessage final : public ReferenceCountedObject
@@ -58,6 +143,18 @@ private:
     Array<Instrument *, CriticalSection> uniqueInstruments;
     ReferenceCountedArray<CachedMidiSequence, CriticalSection> sequences;
 
+    // the playback positions, one per sequence, are not shared between
+    // the copies of the cache, so that the player threads never interfere;
+    // the loop start indices are found once before the playback starts,
+    // so that every loop rewind is just resetting the indices
+    struct Cursor final
+    {
+        int currentIndex = 0;
+        int loopStartIndex = 0;
+    };
+
+    Array<Cursor> cursors;
+
 public:
     
     TransportPlaybackCache() = default;
@@ -66,18 +163,21 @@ public:
     {
         this->sequences.addArray(other.sequences);
         this->uniqueInstruments.addArray(other.uniqueInstruments);
+        this->cursors.addArray(other.cursors);
     }
 
     TransportPlaybackCache(TransportPlaybackCache &&other) noexcept
     {
         this->sequences.swapWith(other.sequences);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        this->cursors.swapWith(other.cursors);
     }
 
     TransportPlaybackCache &operator= (TransportPlaybackCache &&other) noexcept
     {
         this->sequences.swapWith(other.sequences);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        this->cursors.swapWith(other.cursors);
         return *this;
     }
 
@@ -88,10 +188,11 @@ public:
     
     void addWrapper(CachedMidiSequence::Ptr newWrapper) noexcept
     {
-        if (newWrapper->midiMessages.getNumEvents() > 0)
+        if (newWrapper->getNumEvents() > 0)
         {
             this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
             this->sequences.add(newWrapper);
+            this->cursors.add(Cursor());
         }
     }
     
@@ -99,6 +200,7 @@ public:
     {
         this->uniqueInstruments.clearQuick();
         this->sequences.clearQuick();
+        this->cursors.clearQuick();
     }
     
     inline bool isEmpty() const
@@ -156,17 +258,35 @@ public:
 
     void seekToTime(double position)
     {
-        for (auto *wrapper : this->sequences)
+        for (int i = 0; i < this->sequences.size(); ++i)
         {
-            wrapper->currentIndex = this->getNextIndexAtTime(wrapper->midiMessages, (position - DBL_MIN));
+            this->cursors.getReference(i).currentIndex =
+                this->sequences.getObjectPointerUnchecked(i)->findIndexAtTime(position);
         }
     }
     
     void seekToStart()
     {
-        for (auto *wrapper : this->sequences)
+        for (auto &cursor : this->cursors)
+        {
+            cursor.currentIndex = 0;
+        }
+    }
+
+    void setLoopStart(double position)
+    {
+        for (int i = 0; i < this->sequences.size(); ++i)
+        {
+            this->cursors.getReference(i).loopStartIndex =
+                this->sequences.getObjectPointerUnchecked(i)->findIndexAtTime(position);
+        }
+    }
+
+    void seekToLoopStart()
+    {
+        for (auto &cursor : this->cursors)
         {
-            wrapper->currentIndex = 0;
+            cursor.currentIndex = cursor.loopStartIndex;
         }
     }
     
@@ -181,14 +301,14 @@ public:
 
         for (int i = 0; i < this->sequences.size(); ++i)
         {
-            const auto *wrapper = this->sequences.getObjectPointer(i);
-            if (wrapper->currentIndex < wrapper->midiMessages.getNumEvents())
+            const auto *wrapper = this->sequences.getObjectPointerUnchecked(i);
+            const auto currentIndex = this->cursors.getReference(i).currentIndex;
+            if (currentIndex < wrapper->getNumEvents())
             {
-                const auto &message = wrapper->midiMessages.getEventPointer(wrapper->currentIndex)->message;
-
-                if (message.getTimeStamp() < minTimeStamp)
+                const auto timestamp = wrapper->getTimestamp(currentIndex);
+                if (timestamp < minTimeStamp)
                 {
-                    minTimeStamp = message.getTimeStamp();
+                    minTimeStamp = timestamp;
                     targetSequenceIndex = i;
                 }
             }
@@ -199,35 +319,20 @@ public:
             return false;
         }
 
-        auto *foundWrapper = this->sequences.getObjectPointer(targetSequenceIndex);
-        jassert(foundWrapper->currentIndex < foundWrapper->midiMessages.getNumEvents());
-
-        auto &foundMessage = foundWrapper->midiMessages.getEventPointer(foundWrapper->currentIndex)->message;
-        foundWrapper->currentIndex++;
+        const auto *foundWrapper = this->sequences.getObjectPointerUnchecked(targetSequenceIndex);
+        auto &foundCursor = this->cursors.getReference(targetSequenceIndex);
+        jassert(foundCursor.currentIndex < foundWrapper->getNumEvents());
 
-        target.message = foundMessage;
+        target.message = foundWrapper->getMessage(foundCursor.currentIndex);
         target.listener = foundWrapper->listener;
         target.instrument = foundWrapper->instrument;
 
+        foundCursor.currentIndex++;
+
         return true;
     }
     
 private:
     
-    int getNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) const
-    {
-        int i = 0;
-        for (; i < sequence.getNumEvents(); ++i)
-        {
-            const double eventTs = sequence.getEventPointer(i)->message.getTimeStamp();
-            if (eventTs >= timeStamp)
-            {
-                break;
-            }
-        }
-        
-        return i;
-    }
-
     JUCE_LEAK_DETECTOR(TransportPlaybackCache)
 };
@@ -67,6 +67,28 @@ CommandPaletteAction::CommandPaletteAction(String text, String hint, float order
 void CommandPaletteAction::setMatch(int score, const uint8 *matches)
 {
     this->matchScore = score;
+    this->hasMatchedGlyphs = matches != nullptr;
+    if (matches != nullptr)
+    {
+        memcpy(this->matchedGlyphs, matches, CommandPaletteAction::maxMatches);
+    }
+
+    this->highlightedMatchOutdated = true;
+}
+
+int CommandPaletteAction::getMatchScore() const noexcept
+{
+    return this->matchScore;
+}
+
+const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const noexcept
+{
+    if (!this->highlightedMatchOutdated)
+    {
+        return this->highlightedMatch;
+    }
+
+    this->highlightedMatchOutdated = false;
     this->highlightedMatch.clear();
 
     const Font fontNormal(Globals::UI::Fonts::L, Font::plain);
@@ -83,6 +105,7 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
     const float xOffset = 0.f;
     const float yOffset = 0.f;
     auto t = this->name.getCharPointer();
+    const auto *matches = this->hasMatchedGlyphs ? this->matchedGlyphs : nullptr;
 
     for (int i = 0, nextMatch = 0; i < newGlyphs.size(); ++i)
     {
@@ -90,11 +113,11 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
         const auto thisX = xOffsets.getUnchecked(i);
 
         bool isMatchGlyph = false;
-        if (matches != nullptr && matches[nextMatch] == i)
+        if (matches != nullptr && nextMatch < CommandPaletteAction::maxMatches &&
+            matches[nextMatch] == i)
         {
             isMatchGlyph = true;
             nextMatch++;
-            jassert(nextMatch < 32);
         }
 
         const bool isWhitespace = t.isWhitespace();
@@ -104,16 +127,65 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
             xOffset + thisX, yOffset, nextX - thisX,
             isWhitespace));
     }
-}
 
-int CommandPaletteAction::getMatchScore() const noexcept
-{
-    return this->matchScore;
+    return this->highlightedMatch;
 }
 
-const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const noexcept
+const CommandPaletteAction::SearchIndex &CommandPaletteAction::getSearchIndex() const noexcept
 {
-    return this->highlightedMatch;
+    if (this->hasSearchIndex)
+    {
+        return this->searchIndex;
+    }
+
+    // see the scoring rules in fuzzyMatch below
+    static constexpr int separatorBonus = 30;     // bonus if match occurs after a separator
+    static constexpr int camelBonus = 25;         // bonus if match is uppercase and prev is lower
+    static constexpr int firstLetterBonus = 15;   // bonus if the first letter is matched
+
+    // match positions are stored as uint8, so the very long names are only searchable partially
+    static constexpr int maxSearchableLength = 255;
+
+    this->hasSearchIndex = true;
+    auto &index = this->searchIndex;
+    index.length = this->name.length();
+
+    const auto numChars = jmin(index.length, maxSearchableLength);
+    index.chars.ensureStorageAllocated(numChars);
+    index.bonuses.ensureStorageAllocated(numChars);
+
+    juce_wchar previous = 0;
+    auto t = this->name.getCharPointer();
+    for (int i = 0; i < numChars; ++i)
+    {
+        const auto current = t.getAndAdvance();
+        const auto folded = CharacterFunctions::toLowerCase(current);
+
+        int bonus = 0;
+        if (i == 0)
+        {
+            bonus += firstLetterBonus;
+        }
+        else
+        {
+            if (CharacterFunctions::isLowerCase(previous) && CharacterFunctions::isUpperCase(current))
+            {
+                bonus += camelBonus;
+            }
+
+            if (CharacterFunctions::isWhitespace(previous) || previous == '_')
+            {
+                bonus += separatorBonus;
+            }
+        }
+
+        index.chars.add(folded);
+        index.bonuses.add(bonus);
+        index.mask |= uint64(1) << (uint32(folded) & 63);
+        previous = current;
+    }
+
+    return index;
 }
 
 const String &CommandPaletteAction::getName() const noexcept
@@ -146,25 +218,20 @@ bool CommandPaletteAction::isUnfiltered() const noexcept
     return this->required;
 }
 
-// Actions filtering makes use of Sublime-like fuzzy matcher,
-// taken from this public domain library by Forrest Smith,
-// adapted for JUCE String class for the sake of Unicode support:
+// Actions filtering makes use of Sublime-like fuzzy matcher scoring rules,
+// taken from this public domain library by Forrest Smith:
 // https://github.com/forrestthewoods/lib_fts/blob/master/code/fts_fuzzy_match.h
 // https://www.forrestthewoods.com/blog/reverse_engineering_sublime_texts_fuzzy_match
 
-// Original code had a limit of 256, but I really expect it to be way lower:
-#define FUZZY_MAX_MATCHES (32)
-#define FUZZY_MAX_RECURSION (8)
-
-static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str,
-    int &outScore, String::CharPointerType strBegin, uint8 const *srcMatches, uint8 *newMatches,
-    int nextMatch, int &recursionCount);
+// Instead of the recursive search for the best match with a recursion limit,
+// it uses dynamic programming: the score is a sum of the per-character bonuses
+// (precomputed in the action's search index) and the sequential match bonuses,
+// so the best score for each (pattern character, name character) pair depends
+// only on the best scores of the previous pattern character; this always finds
+// the best match in O(pattern length * name length) without any recursion.
 
-static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str, int &outScore, uint8 *matches)
-{
-    int recursionCount = 0;
-    return fuzzyMatch(pattern, str, outScore, str, nullptr, matches, 0, recursionCount);
-}
+static bool fuzzyMatch(const Array<juce_wchar> &pattern, uint64 patternMask,
+    const CommandPaletteAction::SearchIndex &index, int &outScore, uint8 *matches);
 
 void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool skipPrefix)
 {
@@ -176,7 +243,18 @@ void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool ski
         patternPtr.getAndAdvance();
     }
 
-    const auto updateFilteredListWith = [this, patternPtr](const Actions &actions)
+    // fold the pattern once, not for each action:
+    static Array<juce_wchar> foldedPattern;
+    foldedPattern.clearQuick();
+    uint64 patternMask = 0;
+    while (!patternPtr.isEmpty())
+    {
+        const auto c = CharacterFunctions::toLowerCase(patternPtr.getAndAdvance());
+        patternMask |= uint64(1) << (uint32(c) & 63);
+        foldedPattern.add(c);
+    }
+
+    const auto updateFilteredListWith = [this, patternMask](const Actions &actions)
     {
         for (const auto &action : actions)
         {
@@ -187,8 +265,10 @@ void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool ski
             else
             {
                 int outScore = 0;
-                uint8 matches[FUZZY_MAX_MATCHES] = {};
-                const auto match = fuzzyMatch(patternPtr, action->getName().getCharPointer(), outScore, matches);
+                uint8 matches[CommandPaletteAction::maxMatches] = {};
+                const auto match = fuzzyMatch(foldedPattern, patternMask,
+                    action->getSearchIndex(), outScore, matches);
+
                 if (match)
                 {
                     action->setMatch(outScore, matches);
@@ -219,158 +299,121 @@ void CommandPaletteActionsProvider::clearFilter()
     this->filteredActions.sort(comparator);
 }
 
-static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str, int &outScore,
-    String::CharPointerType strBegin, uint8 const *srcMatches, uint8 *matches, int nextMatch, int &recursionCount)
+static bool fuzzyMatch(const Array<juce_wchar> &pattern, uint64 patternMask,
+    const CommandPaletteAction::SearchIndex &index, int &outScore, uint8 *matches)
 {
-    ++recursionCount;
-    if (recursionCount >= FUZZY_MAX_RECURSION)
+    constexpr int sequentialBonus = 15;             // bonus for adjacent matches
+    constexpr int leadingLetterPenalty = -5;        // penalty applied for every letter in str before the first match
+    constexpr int maxLeadingLetterPenalty = -15;    // maximum penalty for leading letters
+    constexpr int unmatchedLetterPenalty = -1;      // penalty for every letter that doesn't matter
+    constexpr int noMatch = std::numeric_limits<int>::min() / 2;
+
+    const auto patternLength = pattern.size();
+    const auto numChars = index.chars.size();
+
+    if (patternLength == 0 ||
+        patternLength > numChars ||
+        patternLength > CommandPaletteAction::maxMatches ||
+        (patternMask & ~index.mask) != 0)
     {
         return false;
     }
 
-    if (*pattern == 0 || *str == 0)
+    // scores[i * numChars + j] is the best score of matching
+    // the first i + 1 pattern characters, with the i-th one matched at j:
+    static Array<int> scores;
+    scores.clearQuick();
+    scores.insertMultiple(0, noMatch, patternLength * numChars);
+
+    const auto *chars = index.chars.getRawDataPointer();
+    const auto *bonuses = index.bonuses.getRawDataPointer();
+    auto *table = scores.getRawDataPointer();
+
+    for (int j = 0; j <= numChars - patternLength; ++j)
     {
-        return false;
+        if (chars[j] == pattern.getUnchecked(0))
+        {
+            table[j] = jmax(maxLeadingLetterPenalty, leadingLetterPenalty * j) + bonuses[j];
+        }
     }
 
-    bool recursiveMatch = false;
-    uint8 bestRecursiveMatches[FUZZY_MAX_MATCHES] = {};
-    int bestRecursiveScore = 0;
-
-    // Loop through pattern and str looking for a match
-    bool firstMatch = true;
-    while (*pattern != 0 && *str != 0)
+    for (int i = 1; i < patternLength; ++i)
     {
-        // Found match
-        if (CharacterFunctions::toLowerCase(*pattern) == CharacterFunctions::toLowerCase(*str))
+        const auto *previousRow = table + (i - 1) * numChars;
+        auto *row = table + i * numChars;
+        const auto patternChar = pattern.getUnchecked(i);
+
+        // the best score of the previous pattern character
+        // matched anywhere before j - 1, i.e. not adjacent:
+        int bestNonAdjacent = noMatch;
+
+        for (int j = i; j <= numChars - patternLength + i; ++j)
         {
-            // Supplied matches buffer was too short
-            if (nextMatch >= FUZZY_MAX_MATCHES)
+            if (j >= 2)
             {
-                return false;
+                bestNonAdjacent = jmax(bestNonAdjacent, previousRow[j - 2]);
             }
 
-            // "Copy-on-Write" srcMatches into matches
-            if (firstMatch && srcMatches)
+            if (chars[j] != patternChar)
             {
-                memcpy(matches, srcMatches, nextMatch);
-                firstMatch = false;
+                continue;
             }
 
-            // Recursive call that "skips" this match
-            uint8 recursiveMatches[FUZZY_MAX_MATCHES] = {};
-            int recursiveScore;
-            if (fuzzyMatch(pattern, str + 1, recursiveScore, strBegin, matches, recursiveMatches, nextMatch, recursionCount))
-            {
-                // Pick best recursive score
-                if (!recursiveMatch || recursiveScore > bestRecursiveScore)
-                {
-                    memcpy(bestRecursiveMatches, recursiveMatches, FUZZY_MAX_MATCHES);
-                    bestRecursiveScore = recursiveScore;
-                }
+            const auto adjacent = previousRow[j - 1] == noMatch ?
+                noMatch : previousRow[j - 1] + sequentialBonus;
 
-                recursiveMatch = true;
+            const auto best = jmax(adjacent, bestNonAdjacent);
+            if (best != noMatch)
+            {
+                row[j] = best + bonuses[j];
             }
-
-            // Advance
-            matches[nextMatch++] = (uint8)(str - strBegin);
-            ++pattern;
         }
-        ++str;
     }
 
-    // Determine if full pattern was matched
-    const bool matched = (*pattern == 0);
-
-    // Calculate score
-    if (matched)
+    const auto *lastRow = table + (patternLength - 1) * numChars;
+    int lastMatch = -1;
+    for (int j = patternLength - 1; j < numChars; ++j)
     {
-        constexpr int sequentialBonus = 15;             // bonus for adjacent matches
-        constexpr int separatorBonus = 30;              // bonus if match occurs after a separator
-        constexpr int camelBonus = 25;                  // bonus if match is uppercase and prev is lower
-        constexpr int firstLetterBonus = 15;            // bonus if the first letter is matched
-        constexpr int leadingLetterPenalty = -5;        // penalty applied for every letter in str before the first match
-        constexpr int maxLeadingLetterPenalty = -15;    // maximum penalty for leading letters
-        constexpr int unmatchedLetterPenalty = -1;      // penalty for every letter that doesn't matter
-
-        // Iterate str to end
-        while (*str != 0)
+        if (lastRow[j] != noMatch && (lastMatch < 0 || lastRow[j] > lastRow[lastMatch]))
         {
-            ++str;
+            lastMatch = j;
         }
+    }
 
-        // Initialize score
-        outScore = 100;
+    if (lastMatch < 0)
+    {
+        return false;
+    }
 
-        // Apply leading letter penalty
-        auto penalty = leadingLetterPenalty * matches[0];
-        if (penalty < maxLeadingLetterPenalty)
+    outScore = 100 + lastRow[lastMatch] +
+        unmatchedLetterPenalty * (index.length - patternLength);
+
+    // walk back to restore the matched positions
+    for (int i = patternLength - 1, j = lastMatch; i >= 0; --i)
+    {
+        matches[i] = uint8(j);
+        if (i == 0)
         {
-            penalty = maxLeadingLetterPenalty;
+            break;
         }
 
-        outScore += penalty;
-
-        // Apply unmatched penalty
-        const auto unmatched = (int)(str - strBegin) - nextMatch;
-        outScore += unmatchedLetterPenalty * unmatched;
-
-        // Apply ordering bonuses
-        for (int i = 0; i < nextMatch; ++i)
+        const auto *previousRow = table + (i - 1) * numChars;
+        const auto expected = table[i * numChars + j] - bonuses[j];
+        if (previousRow[j - 1] != noMatch && previousRow[j - 1] + sequentialBonus == expected)
         {
-            const auto currIdx = matches[i];
-
-            if (i > 0)
-            {
-                const auto prevIdx = matches[i - 1];
-                if (currIdx == (prevIdx + 1))
-                {
-                    outScore += sequentialBonus;
-                }
-            }
-
-            // Check for bonuses based on neighbor character value
-            if (currIdx > 0)
-            {
-                // Camel case
-                const auto neighbor = strBegin[currIdx - 1];
-                const auto curr = strBegin[currIdx];
-                if (CharacterFunctions::isLowerCase(neighbor) && CharacterFunctions::isUpperCase(curr))
-                {
-                    outScore += camelBonus;
-                }
+            j = j - 1;
+            continue;
+        }
 
-                // Separator
-                const bool neighborSeparator = CharacterFunctions::isWhitespace(neighbor) || neighbor == '_';
-                if (neighborSeparator)
-                {
-                    outScore += separatorBonus;
-                }
-            }
-            else
+        for (int k = j - 2; k >= 0; --k)
+        {
+            if (previousRow[k] == expected)
             {
-                // First letter
-                outScore += firstLetterBonus;
+                j = k;
+                break;
             }
         }
     }
 
-    // Return best result
-    if (recursiveMatch && (!matched || bestRecursiveScore > outScore))
-    {
-        // Recursive score is better than "this"
-        memcpy(matches, bestRecursiveMatches, FUZZY_MAX_MATCHES);
-        outScore = bestRecursiveScore;
-        return true;
-    }
-    else if (matched)
-    {
-        // "this" score is better than recursive
-        return true;
-    }
-    else
-    {
-        // no match
-        return false;
-    }
+    return true;
 }
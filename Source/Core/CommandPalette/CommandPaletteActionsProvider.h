@@ -35,11 +35,29 @@ public:
     Callback getCallback() const noexcept;
     bool isUnfiltered() const noexcept;
 
+    // the glyphs are only laid out when requested,
+    // i.e. only for the rows which are actually displayed
+    static constexpr auto maxMatches = 32;
     void setMatch(int score, const uint8 *matches);
     int getMatchScore() const noexcept;
     float getOrder() const noexcept;
     const GlyphArrangement &getGlyphArrangement() const noexcept;
 
+    // the name folded to lowercase, with the score bonuses for each character
+    // and a bit mask of all characters, which allows to reject most actions
+    // without even trying to match them; built once per action's lifetime,
+    // and since providers re-create the actions when refreshing their lists,
+    // this effectively makes it a search index per provider refresh
+    struct SearchIndex final
+    {
+        Array<juce_wchar> chars;
+        Array<int> bonuses;
+        int length = 0; // in characters, including the non-searchable tail
+        uint64 mask = 0;
+    };
+
+    const SearchIndex &getSearchIndex() const noexcept;
+
 private:
 
     CommandPaletteAction() = delete;
@@ -54,9 +72,15 @@ private:
     bool shouldClosePalette = true;
     bool required = false;
 
-    GlyphArrangement highlightedMatch;
+    mutable GlyphArrangement highlightedMatch;
+    mutable bool highlightedMatchOutdated = true;
+    uint8 matchedGlyphs[maxMatches] = {};
+    bool hasMatchedGlyphs = false;
     int matchScore = 0;
 
+    mutable SearchIndex searchIndex;
+    mutable bool hasSearchIndex = false;
+
     // actions will be sorted by match, as user is entering the search text,
     // but we may also need ordering for the full list or items with the same match;
     // the context for this variable should be defined by action provider,
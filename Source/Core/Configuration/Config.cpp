@@ -23,7 +23,8 @@
 
 Config::Config() :
     fileLock("Config file lock"),
-    propertiesFile(DocumentHelpers::getConfigSlot("settings.helio"))
+    propertiesFile(DocumentHelpers::getConfigSlot("settings.helio")),
+    resourcesPreloadingPool(jlimit(1, 4, SystemStats::getNumCpus()))
 {
     this->translationsCollection = make<TranslationsCollection>();
     this->arpeggiatorsCollection = make<ArpeggiatorsCollection>();
@@ -84,9 +85,23 @@ void Config::initResources()
         }
     }
 
-    for (auto &manager : this->resources)
+    // the collections needed to show the first screen are loaded right away,
+    // the others are parsed by the worker threads in the meanwhile,
+    // and only deserialized on the message thread when first accessed;
+    // the meters are also loaded right away, since the time signatures
+    // of the older projects look them up while the project loader thread
+    // deserializes the tracks, so they must not be lazily loaded there:
+    this->translationsCollection->reloadResources();
+    this->colourSchemesCollection->reloadResources();
+    this->hotkeySchemesCollection->reloadResources();
+    this->metersCollection->reloadResources();
+
+    for (auto *collection : this->getLazyLoadedResources())
     {
-        manager.second->reloadResources();
+        this->resourcesPreloadingPool.addJob([collection]()
+        {
+            collection->preloadResources();
+        });
     }
 
     this->load(this->uiFlags.get(), Serialization::Config::activeUiFlags);
@@ -231,16 +246,36 @@ int Config::getMaxSavedUndoActions() const noexcept
 
 ResourceCollectionsLookup &Config::getAllResources() noexcept
 {
+    // whoever needs all resources at once (i.e. the sync service),
+    // will most likely iterate all of them, so load them all here:
+    for (auto *collection : this->getLazyLoadedResources())
+    {
+        collection->loadResourcesIfNeeded();
+    }
+
     return this->resources;
 }
 
+Array<ConfigurationResourceCollection *> Config::getLazyLoadedResources() const
+{
+    return {
+        this->arpeggiatorsCollection.get(),
+        this->temperamentsCollection.get(),
+        this->keyboardMappingsCollection.get(),
+        this->scalesCollection.get(),
+        this->chordsCollection.get()
+    };
+}
+
 ChordsCollection *Config::getChords() const noexcept
 {
+    this->chordsCollection->loadResourcesIfNeeded();
     return this->chordsCollection.get();
 }
 
 ScalesCollection *Config::getScales() const noexcept
 {
+    this->scalesCollection->loadResourcesIfNeeded();
     return this->scalesCollection.get();
 }
 
@@ -256,6 +291,7 @@ TranslationsCollection *Config::getTranslations() const noexcept
 
 ArpeggiatorsCollection *Config::getArpeggiators() const noexcept
 {
+    this->arpeggiatorsCollection->loadResourcesIfNeeded();
     return this->arpeggiatorsCollection.get();
 }
 
@@ -271,11 +307,13 @@ HotkeySchemesCollection *Config::getHotkeySchemes() const noexcept
 
 TemperamentsCollection *Config::getTemperaments() const noexcept
 {
+    this->temperamentsCollection->loadResourcesIfNeeded();
     return this->temperamentsCollection.get();
 }
 
 KeyboardMappingsCollection *Config::getKeyboardMappings() const noexcept
 {
+    this->keyboardMappingsCollection->loadResourcesIfNeeded();
     return this->keyboardMappingsCollection.get();
 }
 
@@ -77,6 +77,9 @@ private:
 
     void timerCallback() override;
 
+    // the collections not needed for the first screen to show up
+    Array<ConfigurationResourceCollection *> getLazyLoadedResources() const;
+
     InterProcessLock fileLock;
     File propertiesFile;
     
@@ -95,6 +98,10 @@ private:
 
     ResourceCollectionsLookup resources;
 
+    // parses the lazy-loaded resources at startup; declared after
+    // the collections, so that it is stopped before they are deleted
+    ThreadPool resourcesPreloadingPool;
+
     UniquePointer<UserInterfaceFlags> uiFlags;
 
     bool needsSaving = false;
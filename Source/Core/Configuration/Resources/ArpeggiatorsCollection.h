@@ -31,7 +31,7 @@ public:
         return { new Arpeggiator() };
     }
 
-    inline Array<Arpeggiator::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Arpeggiator> getAll() const
     {
         return this->getAllResources<Arpeggiator>();
     }
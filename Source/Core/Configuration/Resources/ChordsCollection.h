@@ -31,7 +31,7 @@ public:
         return { new Chord() };
     }
 
-    inline const Array<Chord::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Chord> getAll() const
     {
         return this->getAllResources<Chord>();
     }
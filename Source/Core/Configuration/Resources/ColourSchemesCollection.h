@@ -31,7 +31,7 @@ public:
         return { new ColourScheme() };
     }
 
-    inline const Array<ColourScheme::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<ColourScheme> getAll() const
     {
         return this->getAllResources<ColourScheme>();
     }
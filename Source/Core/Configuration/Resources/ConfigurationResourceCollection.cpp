@@ -50,14 +50,21 @@ void ConfigurationResourceCollection::updateBaseResource(const SerializedData &r
 
 void ConfigurationResourceCollection::updateUserResource(const ConfigurationResource::Ptr resource)
 {
-    this->userResources[resource->getResourceId()] = resource;
+    SerializedData userResourcesTree;
+
+    {
+        const ScopedLock lock(this->resourcesLock);
+        this->userResources[resource->getResourceId()] = resource;
+        this->resetSnapshot();
+        userResourcesTree = this->serializeResources(this->userResources);
+    }
 
     // TODO sync with server?
     DBG("Updating user's resource file for " + this->resourceType.toString());
 
     JsonSerializer serializer(false);
     serializer.setHeaderComments({ "Custom overrides for " + this->resourceType.toString(), "Can be edited manually" });
-    serializer.saveToFile(this->getUsersResourceFile(), this->serializeResources(this->userResources));
+    serializer.saveToFile(this->getUsersResourceFile(), userResourcesTree);
 
     // Should we really send update message here?
     this->sendChangeMessage();
@@ -107,76 +114,138 @@ SerializedData ConfigurationResourceCollection::serializeResources(const Resourc
 
 void ConfigurationResourceCollection::reset()
 {
+    const ScopedLock lock(this->resourcesLock);
     this->baseResources.clear();
     this->userResources.clear();
+    this->resetSnapshot();
+}
+
+void ConfigurationResourceCollection::resetSnapshot() noexcept
+{
+    const ScopedLock lock(this->resourcesLock);
+    this->snapshot = nullptr;
 }
 
 void ConfigurationResourceCollection::reloadResources()
 {
-    bool shouldBroadcastChange = false;
+    const ScopedLock lock(this->preloadLock);
+    this->preloadedResources = nullptr;
+    this->applyResources(this->parseResources());
+}
 
-    // Reset and store an empty tree to append user objects to
-    this->baseResources.clear();
-    this->userResources.clear();
+void ConfigurationResourceCollection::preloadResources()
+{
+    const ScopedLock lock(this->preloadLock);
+    if (this->resourcesLoaded.get() || this->preloadedResources != nullptr)
+    {
+        return;
+    }
+
+    this->preloadedResources = make<ParsedResources>(this->parseResources());
+}
+
+void ConfigurationResourceCollection::loadResourcesIfNeeded()
+{
+    if (this->resourcesLoaded.get())
+    {
+        return;
+    }
+
+    const ScopedLock lock(this->preloadLock);
+    if (this->resourcesLoaded.get())
+    {
+        return;
+    }
 
-    // load both built-in and downloaded resource:
-    // downloaded extends and overrides built-in one,
-    // user's config extends and overrides the previous step
+    if (this->preloadedResources != nullptr)
+    {
+        const auto parsed = move(this->preloadedResources);
+        this->applyResources(*parsed);
+    }
+    else
+    {
+        this->applyResources(this->parseResources());
+    }
+}
+
+// load both built-in and downloaded resource:
+// downloaded extends and overrides built-in one,
+// user's config extends and overrides the previous step;
+// only parses the files, so this is safe to call from any thread
+ConfigurationResourceCollection::ParsedResources ConfigurationResourceCollection::parseResources() const
+{
+    ParsedResources result;
 
 #if DEBUG
-    auto startTime = Time::getMillisecondCounter();
+    const auto startTime = Time::getMillisecondCounter();
 #endif
 
     const String builtInResource(this->getBuiltInResourceString());
     if (builtInResource.isNotEmpty())
     {
-        const auto tree(DocumentHelpers::load(builtInResource));
-        if (tree.isValid())
-        {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
-        }
-
-        DBG("Loaded built-in " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+        result.builtInResources = DocumentHelpers::load(builtInResource);
     }
 
-#if DEBUG
-    startTime = Time::getMillisecondCounter();
-#endif
-
     // Try to extend built-in config with downloaded one
     const File downloadedResource(this->getDownloadedResourceFile());
     if (downloadedResource.existsAsFile())
     {
-        const auto tree(DocumentHelpers::load(downloadedResource));
-        if (tree.isValid())
-        {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
-        }
-
-        DBG("Loaded extended " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+        result.downloadedResources = DocumentHelpers::load(downloadedResource);
     }
 
+    // Try to extend base config with user's settings
+    const File usersResource(this->getUsersResourceFile());
+    if (usersResource.existsAsFile())
+    {
+        result.userResources = DocumentHelpers::load(usersResource);
+    }
+
+    DBG("Parsed " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+
+    return result;
+}
+
+void ConfigurationResourceCollection::applyResources(const ParsedResources &parsed)
+{
+    bool shouldBroadcastChange = false;
+
 #if DEBUG
-    startTime = Time::getMillisecondCounter();
+    const auto startTime = Time::getMillisecondCounter();
 #endif
 
-    // Try to extend base config with user's settings
-    const File usersResource(this->getUsersResourceFile());
+    // the readers on other threads must not see the half-deserialized maps
+    const ScopedLock lock(this->resourcesLock);
 
-    if (usersResource.existsAsFile())
+    // Reset and store an empty tree to append user objects to
+    this->baseResources.clear();
+    this->userResources.clear();
+    this->resetSnapshot();
+
+    if (parsed.builtInResources.isValid())
     {
-        const auto tree(DocumentHelpers::load(usersResource));
-        if (tree.isValid())
-        {
-            this->deserializeResources(tree, this->userResources);
-            shouldBroadcastChange = true;
-        }
-
-        DBG("Loaded user's " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+        this->deserializeResources(parsed.builtInResources, this->baseResources);
+        this->resetSnapshot();
+        shouldBroadcastChange = true;
     }
 
+    if (parsed.downloadedResources.isValid())
+    {
+        this->deserializeResources(parsed.downloadedResources, this->baseResources);
+        this->resetSnapshot();
+        shouldBroadcastChange = true;
+    }
+
+    if (parsed.userResources.isValid())
+    {
+        this->deserializeResources(parsed.userResources, this->userResources);
+        this->resetSnapshot();
+        shouldBroadcastChange = true;
+    }
+
+    this->resourcesLoaded = true;
+
+    DBG("Loaded " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+
     if (shouldBroadcastChange)
     {
         this->sendChangeMessage();
@@ -19,6 +19,45 @@
 
 #include "ConfigurationResource.h"
 
+// a read-only view of all resources of a collection, sorted with its comparator;
+// the sorted list is shared by all views until the resources change,
+// so they are cheap to copy, and each view keeps its list alive
+template<typename T>
+class ConfigurationResourcesSnapshot final
+{
+public:
+
+    using Resources = Array<typename T::Ptr>;
+
+    ConfigurationResourcesSnapshot() : data(new Data()) {}
+
+    inline int size() const noexcept { return this->data->resources.size(); }
+    inline bool isEmpty() const noexcept { return this->data->resources.isEmpty(); }
+
+    inline typename T::Ptr operator[] (int index) const noexcept { return this->data->resources[index]; }
+    inline typename T::Ptr getUnchecked(int index) const noexcept { return this->data->resources.getUnchecked(index); }
+    inline typename T::Ptr getFirst() const noexcept { return this->data->resources.getFirst(); }
+
+    inline const typename T::Ptr *begin() const noexcept { return this->data->resources.begin(); }
+    inline const typename T::Ptr *end() const noexcept { return this->data->resources.end(); }
+
+    // valid for as long as this view exists
+    inline const Resources &getResources() const noexcept { return this->data->resources; }
+
+private:
+
+    friend class ConfigurationResourceCollection;
+
+    struct Data final : public ReferenceCountedObject
+    {
+        Resources resources;
+    };
+
+    explicit ConfigurationResourcesSnapshot(Data *data) : data(data) {}
+
+    ReferenceCountedObjectPtr<Data> data;
+};
+
 class ConfigurationResourceCollection : public ChangeBroadcaster
 {
 public:
@@ -28,37 +67,32 @@ public:
 
     void reloadResources();
 
+    // parses the resource files without deserializing them,
+    // so that it can be done by a worker thread at startup
+    void preloadResources();
+
+    // deserializes the preloaded resources on the first access,
+    // or waits for the worker, if it is still parsing them
+    void loadResourcesIfNeeded();
+
     inline bool isEmpty() const noexcept
     {
+        const ScopedLock lock(this->resourcesLock);
         return this->baseResources.size() == 0 && this->userResources.size() == 0;
     }
 
+    // returns the shared snapshot of the sorted resources,
+    // which is only rebuilt after the resources have changed
     template<typename T = ConfigurationResource>
-    const Array<typename T::Ptr> getAllResources() const
+    ConfigurationResourcesSnapshot<T> getAllResources() const
     {
-        Array<typename T::Ptr> result;
-
-        for (const auto &baseConfig : this->baseResources)
-        {
-            if (!this->userResources.contains(baseConfig.first))
-            {
-                result.addSorted(this->getResourceComparator(),
-                    typename T::Ptr(static_cast<T *>(baseConfig.second.get())));
-            }
-        }
-
-        for (const auto &userConfig : this->userResources)
-        {
-            result.addSorted(this->getResourceComparator(),
-                typename T::Ptr(static_cast<T *>(userConfig.second.get())));
-        }
-
-        return result;
+        return this->getSnapshot<T>();
     }
 
     template<typename T = ConfigurationResource>
     const Array<typename T::Ptr> getUserResources() const
     {
+        const ScopedLock lock(this->resourcesLock);
         Array<typename T::Ptr> result;
 
         for (const auto &userConfig : this->userResources)
@@ -70,9 +104,12 @@ public:
         return result;
     }
 
+    // not using the snapshot here, since the collections also use this
+    // while deserializing, i.e. when the snapshot would be outdated:
     template<typename T = ConfigurationResource>
     const typename T::Ptr getResourceById(const String &resourceId) const
     {
+        const ScopedLock lock(this->resourcesLock);
         const auto foundUserResource = this->userResources.find(resourceId);
         if (foundUserResource != this->userResources.end())
         {
@@ -91,6 +128,7 @@ public:
     template<typename T = ConfigurationResource>
     const typename T::Ptr getUserResourceById(const String &resourceId) const
     {
+        const ScopedLock lock(this->resourcesLock);
         const auto foundUserResource = this->userResources.find(resourceId);
         if (foundUserResource != this->userResources.end())
         {
@@ -103,6 +141,7 @@ public:
     template<typename T = ConfigurationResource>
     const bool containsUserResourceWithId(const String &resourceId) const
     {
+        const ScopedLock lock(this->resourcesLock);
         const auto foundUserResource = this->userResources.find(resourceId);
         return foundUserResource != this->userResources.end();
     }
@@ -127,11 +166,76 @@ protected:
     virtual void deserializeResources(const SerializedData &tree, Resources &outResources) = 0;
     virtual void reset();
 
+    // should be called whenever base or user resources are changed
+    void resetSnapshot() noexcept;
+
 private: 
 
     const Identifier resourceType;
     const DummyConfigurationResource comparator;
 
+    struct ParsedResources final
+    {
+        SerializedData builtInResources;
+        SerializedData downloadedResources;
+        SerializedData userResources;
+    };
+
+    ParsedResources parseResources() const;
+    void applyResources(const ParsedResources &parsed);
+
+    CriticalSection preloadLock;
+    UniquePointer<ParsedResources> preloadedResources;
+    Atomic<bool> resourcesLoaded = false;
+
+    // the base and user resources are modified by whoever (re)loads them,
+    // and the snapshot might be requested by the preloading workers
+    // and the message thread at the same time, so both are guarded by this
+    mutable CriticalSection resourcesLock;
+
+    // all resources, the user's ones overriding the base ones,
+    // sorted with the collection's comparator; built lazily on the first
+    // request, and then shared by all readers as is until the next change
+    mutable ReferenceCountedObjectPtr<ReferenceCountedObject> snapshot;
+
+    template<typename T>
+    ConfigurationResourcesSnapshot<T> getSnapshot() const
+    {
+        using SnapshotData = typename ConfigurationResourcesSnapshot<T>::Data;
+
+        const ScopedLock lock(this->resourcesLock);
+
+        // the collections always request the same resource type,
+        // so there will be no more than one rebuild after each change
+        if (auto *existing = dynamic_cast<SnapshotData *>(this->snapshot.get()))
+        {
+            return ConfigurationResourcesSnapshot<T>(existing);
+        }
+
+        auto *newSnapshot = new SnapshotData();
+        this->snapshot = newSnapshot;
+
+        auto &sortedResources = newSnapshot->resources;
+        sortedResources.ensureStorageAllocated(int(this->baseResources.size() + this->userResources.size()));
+        for (const auto &baseConfig : this->baseResources)
+        {
+            if (!this->userResources.contains(baseConfig.first))
+            {
+                sortedResources.add(typename T::Ptr(static_cast<T *>(baseConfig.second.get())));
+            }
+        }
+
+        for (const auto &userConfig : this->userResources)
+        {
+            sortedResources.add(typename T::Ptr(static_cast<T *>(userConfig.second.get())));
+        }
+
+        const auto &comparator = this->getResourceComparator();
+        sortedResources.sort(comparator, true);
+
+        return ConfigurationResourcesSnapshot<T>(newSnapshot);
+    }
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(ConfigurationResourceCollection)
 };
 
@@ -31,7 +31,7 @@ public:
         return { new HotkeyScheme() };
     }
 
-    inline const Array<HotkeyScheme::Ptr> getAll() const noexcept
+    inline ConfigurationResourcesSnapshot<HotkeyScheme> getAll() const noexcept
     {
         return this->getAllResources<HotkeyScheme>();
     }
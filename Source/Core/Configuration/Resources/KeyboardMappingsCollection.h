@@ -31,7 +31,7 @@ public:
         return { new KeyboardMapping() };
     }
 
-    inline const Array<KeyboardMapping::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<KeyboardMapping> getAll() const
     {
         return this->getAllResources<KeyboardMapping>();
     }
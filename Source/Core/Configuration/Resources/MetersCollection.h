@@ -31,7 +31,7 @@ public:
         return { new Meter() };
     }
 
-    inline const Array<Meter::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Meter> getAll() const
     {
         return this->getAllResources<Meter>();
     }
@@ -223,8 +223,9 @@ Note Arpeggiator::mapArpKeyIntoChordSpace(const Temperament::Ptr temperament,
     const auto arpKey = this->keys.getUnchecked(safeKeyIndex);
     const auto arpKeyOrReversed = this->keys.getUnchecked(safeKeyIndexOrReversed);
     
-    // randomly add -1/0/1 scale offset with a random chance:
-    static Random rng;
+    // randomly add -1/0/1 scale offset with a random chance
+    // (arps are also applied by clip modifiers in background threads):
+    thread_local Random rng;
     const auto randomScaleOffset =
         (!arpKey.isBarStart && rng.nextFloat() < randomness) ?
         roundToIntAccurate((rng.nextFloat() * 2.f) - 1.f) : 0;
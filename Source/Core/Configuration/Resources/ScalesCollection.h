@@ -31,7 +31,7 @@ public:
         return { new Scale() };
     }
 
-    inline const Array<Scale::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Scale> getAll() const
     {
         return this->getAllResources<Scale>();
     }
@@ -32,7 +32,7 @@ public:
         return { new Temperament() };
     }
 
-    inline const Array<Temperament::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Temperament> getAll() const
     {
         return this->getAllResources<Temperament>();
     }
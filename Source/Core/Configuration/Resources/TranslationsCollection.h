@@ -32,7 +32,7 @@ public:
         return { new Translation() };
     }
 
-    inline const Array<Translation::Ptr> getAll() const
+    inline ConfigurationResourcesSnapshot<Translation> getAll() const
     {
         return this->getAllResources<Translation>();
     }
@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "MidiTrack.h"
 #include "SerializationKeys.h"
+#include "ParameterAutomation.h"
 
 int MidiTrack::compareElements(const MidiTrack &first, const MidiTrack &second)
 {
@@ -74,3 +75,8 @@ bool MidiTrack::isOnOffAutomationTrack() const noexcept
     return this->getTrackControllerNumber() >= 64 &&
         this->getTrackControllerNumber() <= 69;
 }
+
+bool MidiTrack::isPluginParameterAutomationTrack() const noexcept
+{
+    return ParameterAutomation::isParameterController(this->getTrackControllerNumber());
+}
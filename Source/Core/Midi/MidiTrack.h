@@ -128,6 +128,7 @@ public:
 
     bool isTempoTrack() const noexcept;
     bool isOnOffAutomationTrack() const noexcept;
+    bool isPluginParameterAutomationTrack() const noexcept;
 
 protected:
 
@@ -24,6 +24,7 @@
 #include "RefactoringSequenceModifier.h"
 #include "TuningSequenceModifier.h"
 #include "ArpeggiationSequenceModifier.h"
+#include "ParametricSequenceModifier.h"
 
 Clip::Clip() : pattern(nullptr) {}
 
@@ -351,6 +352,7 @@ SequenceModifier::Ptr Clip::makeSequenceModifierByTag(const Identifier &tagName)
     if (tagName == Modifiers::refactoringModifier) { return new RefactoringSequenceModifier(); }
     else if (tagName == Modifiers::arpeggiationModifier) { return new ArpeggiationSequenceModifier(); }
     else if (tagName == Modifiers::tuningModifier) { return new TuningSequenceModifier(); }
+    else if (tagName == Modifiers::parametricModifier) { return new ParametricSequenceModifier(); }
 
     jassertfalse;
     return nullptr;
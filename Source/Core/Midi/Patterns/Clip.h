@@ -24,7 +24,7 @@ class Pattern;
 // Clip is an instance of a sequence on a certain position.
 // Optionally, with key delta, velocity multiplier, muted or soloed.
 // Optionally, has a stack of parametric modifiers like arps and refactorings.
-// (todo in future: a scripting language for parametric modifiers)
+// (including user-defined ones, see ParametricSequenceModifier)
 
 class Clip final : public Serializable
 {
@@ -35,7 +35,7 @@ public:
     explicit ArpeggiationSequenceModifier(const Arpeggiator::Ptr arpeggiator, float speed = 1.f) :
         arpeggiator(arpeggiator), speedMultiplier(speed) {}
 
-    void processSequence(const ProjectNode &project,
+    void processSequence(const Context &context,
         const Clip &clip, const PianoSequence &sequence) override
     {
         if (!this->isEnabled())
@@ -47,9 +47,9 @@ public:
         if (this->arpeggiator != nullptr)
         {
             SequencerOperations::arpeggiate(sequence, clip, this->arpeggiator,
-                project.getProjectInfo()->getTemperament(),
-                project.getTimeline()->getKeySignaturesSequence(),
-                project.getTimeline()->getTimeSignaturesAggregator(),
+                context.temperament,
+                context.keySignatures,
+                context.timeSignatures,
                 this->speedMultiplier,
                 0.f, false, false, false, false);
         }
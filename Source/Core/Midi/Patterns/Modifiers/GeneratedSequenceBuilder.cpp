@@ -17,13 +17,21 @@
 
 #include "Common.h"
 #include "GeneratedSequenceBuilder.h"
+#include "ParametricSequenceModifier.h"
 #include "PianoSequence.h"
+#include "KeySignaturesSequence.h"
+#include "KeySignatureEvent.h"
+#include "TimeSignaturesAggregator.h"
+#include "TimeSignatureEvent.h"
 #include "ProjectNode.h"
+#include "ProjectMetadata.h"
+#include "ProjectTimeline.h"
 #include "MidiEvent.h"
 #include "Pattern.h"
 
 GeneratedSequenceBuilder::GeneratedSequenceBuilder(ProjectNode &project) :
-    project(project)
+    project(project),
+    generationPool(jlimit(1, 4, SystemStats::getNumCpus() - 1))
 {
     this->project.addListener(this);
 }
@@ -41,35 +49,42 @@ MidiSequence *GeneratedSequenceBuilder::getSequenceFor(const Clip &clip)
         return nullptr;
     }
 
+    // the results of the jobs that are done, but not yet applied, might be just in time
+    this->applyFinishedGenerations();
+
     const auto foundSequence = this->generatedSequences.find(clip);
-    if (foundSequence == this->generatedSequences.end() || // not generated yet
-        this->clipsToUpdate.contains(clip)) // or the cached sequence is stale
+    if (foundSequence != this->generatedSequences.end() &&
+        !this->clipsToUpdate.contains(clip) &&
+        !this->pendingGenerations.contains(clip))
     {
-        // this method was probably called before the update for this clip
-        // was triggered, let's update it synchronously
-        // (warning: some duplicate code here)
-
-        auto *originalTrack = clip.getPattern()->getTrack();
-        jassert(dynamic_cast<PianoSequence *>(originalTrack->getSequence()));
-        auto sequence = make<PianoSequence>(*originalTrack, *this,
-            static_cast<const PianoSequence &>(*originalTrack->getSequence()));
+        return foundSequence->second.sequence.get();
+    }
 
-        for (const auto &modifier : clip.getModifiers())
-        {
-            modifier->processSequence(this->project, clip, *sequence);
-        }
+    // this method was probably called before the update for this clip
+    // was finished, e.g. by the transport or the exporter, which need the
+    // up-to-date sequence right now, so let's update it synchronously,
+    // and discard the result of the background job, when it arrives
+    this->clipsToUpdate.erase(clip);
+    this->pendingGenerations.erase(clip);
 
-        this->project.broadcastReloadGeneratedSequence(clip, sequence.get());
-        // todo test if beat range updates are needed:
-        //this->project.broadcastChangeTrackBeatRange();
+    const auto context = this->getLiveContext();
+    const auto inputsHash = hashInputs(hashNotes(*clip.getPattern()->getTrack()->getSequence()),
+        clip, hashContext(context));
 
-        this->generatedSequences[clip] = move(sequence);
-        this->clipsToUpdate.erase(clip);
+    if (foundSequence != this->generatedSequences.end() &&
+        foundSequence->second.inputsHash == inputsHash)
+    {
+        return foundSequence->second.sequence.get();
+    }
 
-        return this->generatedSequences[clip].get();
+    GeneratedSequence generated;
+    if (this->prepareGeneration(generated, clip, inputsHash))
+    {
+        generate(generated, clip, context);
     }
 
-    return foundSequence->second.get();
+    this->applyGeneratedSequence(clip, move(generated));
+    return this->generatedSequences[clip].sequence.get();
 }
 
 //===----------------------------------------------------------------------===//
@@ -126,6 +141,9 @@ void GeneratedSequenceBuilder::onRemoveClip(const Clip &clip)
     jassert(!this->clipsToUpdate.contains(clip));
     this->clipsToUpdate.erase(clip); // just in case
 
+    // the result of the pending job, if any, will be discarded
+    this->pendingGenerations.erase(clip);
+
     // clean up immediately to avoid dealing with deleted objects later
     if (this->generatedSequences.contains(clip))
     {
@@ -169,11 +187,15 @@ void GeneratedSequenceBuilder::onRemoveTrack(MidiTrack *const track)
             it++;
         }
     }
+
+    this->forgetTrack(track);
 }
 
 void GeneratedSequenceBuilder::onReloadProjectContent(const Array<MidiTrack *> &tracks, const ProjectMetadata *meta)
 {
     this->generatedSequences.clear();
+    this->pendingGenerations.clear();
+    this->memoizedSequences.clear();
 
     for (auto *track : tracks)
     {
@@ -183,7 +205,8 @@ void GeneratedSequenceBuilder::onReloadProjectContent(const Array<MidiTrack *> &
 
 void GeneratedSequenceBuilder::onChangeProjectInfo(const ProjectMetadata *info)
 {
-    // re-generate all, temperament might have changed:
+    // re-generate all, temperament might have changed
+    // (if it didn't, the inputs hashes will tell that nothing has changed):
     for (auto &it : this->generatedSequences)
     {
         this->triggerAsyncUpdateForClip(it.first);
@@ -222,11 +245,22 @@ void GeneratedSequenceBuilder::triggerAsyncUpdateForClip(const Clip &clip)
 
 void GeneratedSequenceBuilder::handleAsyncUpdate()
 {
+    // this is triggered both by the project changes and by the workers:
+    this->applyFinishedGenerations();
+
     if (this->clipsToUpdate.empty())
     {
         return;
     }
 
+    // all jobs of this batch share the same snapshot of the project's context
+    const auto context = this->makeGenerationContext();
+
+    // the clips of one track share the notes, so they are hashed once
+    FlatHashMap<const MidiTrack *, uint64> notesHashes;
+
+    bool hasAppliedResults = false;
+
     for (const auto &clip : this->clipsToUpdate)
     {
         if (!clip.isValid())
@@ -237,6 +271,8 @@ void GeneratedSequenceBuilder::handleAsyncUpdate()
 
         if (!clip.hasModifiers())
         {
+            this->pendingGenerations.erase(clip);
+
             if (this->generatedSequences.contains(clip))
             {
                 this->project.broadcastReloadGeneratedSequence(clip, nullptr);
@@ -248,8 +284,6 @@ void GeneratedSequenceBuilder::handleAsyncUpdate()
 
         auto *originalTrack = clip.getPattern()->getTrack();
         jassert(dynamic_cast<PianoSequence *>(originalTrack->getSequence()));
-        auto sequence = make<PianoSequence>(*originalTrack, *this,
-            static_cast<const PianoSequence &>(*originalTrack->getSequence()));
 
         // the clip object stored in clipsToUpdate is a copy with all
         // the valid parameters, which we can use for generating a sequence,
@@ -264,18 +298,306 @@ void GeneratedSequenceBuilder::handleAsyncUpdate()
 
         const auto *originalClip = originalTrack->getPattern()->getUnchecked(i);
 
-        for (const auto &modifier : originalClip->getModifiers())
+        const auto foundNotesHash = notesHashes.find(originalTrack);
+        const auto notesHash = (foundNotesHash != notesHashes.end()) ? foundNotesHash->second :
+            (notesHashes[originalTrack] = hashNotes(*originalTrack->getSequence()));
+
+        const auto inputsHash = hashInputs(notesHash, *originalClip, context->hash);
+
+        const auto foundSequence = this->generatedSequences.find(clip);
+        if (foundSequence != this->generatedSequences.end() &&
+            foundSequence->second.inputsHash == inputsHash)
         {
-            modifier->processSequence(this->project, *originalClip, *sequence);
+            // nothing has changed for this clip after all
+            this->pendingGenerations.erase(clip);
+            continue;
+        }
+
+        auto generation = std::make_shared<Generation>();
+        if (!this->prepareGeneration(generation->result, *originalClip, inputsHash))
+        {
+            // memoized: swap it in right away, no need to bother the workers
+            this->pendingGenerations.erase(clip);
+            this->applyGeneratedSequence(*originalClip, move(generation->result));
+            hasAppliedResults = true;
+            continue;
         }
 
-        this->project.broadcastReloadGeneratedSequence(*originalClip, sequence.get());
-        this->generatedSequences[clip] = move(sequence);
+        generation->clip = *originalClip;
+        generation->context = context;
+        generation->version = ++this->lastGenerationVersion;
+        this->pendingGenerations[clip] = generation->version;
+
+        this->generationPool.addJob([this, generation]()
+        {
+            generate(generation->result, generation->clip,
+                generation->context->modifierContext);
+
+            const ScopedLock lock(this->finishedGenerationsLock);
+            this->finishedGenerations.add(generation);
+            this->triggerAsyncUpdate();
+        });
     }
 
-    this->project.broadcastChangeProjectBeatRange();
+    this->clipsToUpdate.clear();
+
+    if (hasAppliedResults)
+    {
+        this->project.broadcastChangeProjectBeatRange();
+    }
+}
+
+//===--------------------------------------------------------------------------===//
+// Generation
+//===--------------------------------------------------------------------------===//
+
+bool GeneratedSequenceBuilder::prepareGeneration(GeneratedSequence &target,
+    const Clip &clip, uint64 inputsHash)
+{
+    auto *originalTrack = clip.getPattern()->getTrack();
+    jassert(dynamic_cast<PianoSequence *>(originalTrack->getSequence()));
+
+    target.inputsHash = inputsHash;
+    target.modifiers = clip.getModifiers();
+
+    const auto memoized = this->memoizedSequences.find(inputsHash);
+    if (memoized != this->memoizedSequences.end())
+    {
+        target.sequence = std::make_shared<PianoSequence>(*originalTrack,
+            *this, *memoized->second.sequence);
+        return false;
+    }
+
+    target.sequence = std::make_shared<PianoSequence>(*originalTrack, *this,
+        static_cast<const PianoSequence &>(*originalTrack->getSequence()));
+    return true;
+}
+
+void GeneratedSequenceBuilder::generate(GeneratedSequence &target,
+    const Clip &clip, const SequenceModifier::Context &context)
+{
+    // the adjacent parametric modifiers are fused into a single pass
+    Array<const ParametricSequenceModifier *> fusedModifiers;
+
+    for (const auto &modifier : target.modifiers)
+    {
+        if (const auto *parametric = dynamic_cast<const ParametricSequenceModifier *>(modifier.get()))
+        {
+            if (parametric->isEnabled())
+            {
+                fusedModifiers.add(parametric);
+            }
+
+            continue;
+        }
+
+        ParametricSequenceModifier::processFused(fusedModifiers, context, clip, *target.sequence);
+        fusedModifiers.clearQuick();
+
+        modifier->processSequence(context, clip, *target.sequence);
+    }
+
+    ParametricSequenceModifier::processFused(fusedModifiers, context, clip, *target.sequence);
+}
+
+void GeneratedSequenceBuilder::applyGeneratedSequence(const Clip &clip, GeneratedSequence &&generated)
+{
+    jassert(generated.sequence != nullptr);
+
+    if (!this->memoizedSequences.contains(generated.inputsHash))
+    {
+        if (this->memoizedSequences.size() >= maxMemoizedSequences)
+        {
+            this->memoizedSequences.clear();
+        }
+
+        this->memoizedSequences[generated.inputsHash] = generated;
+    }
+
+    this->project.broadcastReloadGeneratedSequence(clip, generated.sequence.get());
     // todo test if beat range updates are needed:
     //this->project.broadcastChangeTrackBeatRange();
 
-    this->clipsToUpdate.clear();
+    this->generatedSequences[clip] = move(generated);
+}
+
+void GeneratedSequenceBuilder::applyFinishedGenerations()
+{
+    Array<std::shared_ptr<Generation>> finished;
+
+    {
+        const ScopedLock lock(this->finishedGenerationsLock);
+        finished.swapWith(this->finishedGenerations);
+    }
+
+    bool hasAppliedResults = false;
+
+    for (auto &generation : finished)
+    {
+        // the clip might have been changed again or removed since the job
+        // has started, or its sequence might have been generated synchronously:
+        const auto pending = this->pendingGenerations.find(generation->clip);
+        if (pending == this->pendingGenerations.end() ||
+            pending->second != generation->version)
+        {
+            continue;
+        }
+
+        this->pendingGenerations.erase(pending);
+
+        const auto *pattern = generation->clip.getPattern();
+        const int i = (pattern != nullptr) ? pattern->indexOfSorted(&generation->clip) : -1;
+        if (i < 0)
+        {
+            jassertfalse;
+            continue;
+        }
+
+        this->applyGeneratedSequence(*pattern->getUnchecked(i), move(generation->result));
+        hasAppliedResults = true;
+    }
+
+    if (hasAppliedResults)
+    {
+        this->project.broadcastChangeProjectBeatRange();
+    }
+}
+
+void GeneratedSequenceBuilder::forgetTrack(MidiTrack *const track)
+{
+    for (auto it = this->pendingGenerations.begin(); it != this->pendingGenerations.end() ;)
+    {
+        if (it->first.getPattern() == nullptr ||
+            it->first.getPattern()->getTrack() == track)
+        {
+            it = this->pendingGenerations.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    // the memoized sequences refer to their tracks,
+    // and it's hard to tell which ones are affected:
+    this->memoizedSequences.clear();
+}
+
+//===--------------------------------------------------------------------------===//
+// Context snapshots and hashing
+//===--------------------------------------------------------------------------===//
+
+GeneratedSequenceBuilder::GenerationContext::Ptr GeneratedSequenceBuilder::makeGenerationContext()
+{
+    const auto liveContext = this->getLiveContext();
+
+    GenerationContext::Ptr context(new GenerationContext());
+
+    // not using the builder as a dispatcher here, just to make sure
+    // the copied key signatures never send anything to anybody:
+    auto *timeline = this->project.getTimeline();
+    context->keySignatures = make<KeySignaturesSequence>(*timeline->getKeySignatures(), *this);
+    for (const auto *event : *liveContext.keySignatures.get())
+    {
+        context->keySignatures->insert(static_cast<const KeySignatureEvent &>(*event), false);
+    }
+
+    context->timeSignatures = liveContext.timeSignatures->makeSnapshot();
+
+    context->modifierContext.temperament = liveContext.temperament;
+    context->modifierContext.keySignatures = context->keySignatures.get();
+    context->modifierContext.timeSignatures = context->timeSignatures.get();
+    context->hash = hashContext(context->modifierContext);
+
+    jassert(context->hash == hashContext(liveContext));
+    return context;
+}
+
+SequenceModifier::Context GeneratedSequenceBuilder::getLiveContext() const
+{
+    SequenceModifier::Context context;
+    context.temperament = this->project.getProjectInfo()->getTemperament();
+    context.keySignatures = this->project.getTimeline()->getKeySignaturesSequence();
+    context.timeSignatures = this->project.getTimeline()->getTimeSignaturesAggregator();
+    return context;
+}
+
+// a cheap 64-bit hash combination, only used to tell whether
+// the inputs of some generation are the same as of the previous one
+static inline void combineGeneratedSequenceHash(uint64 &hash, uint64 value) noexcept
+{
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+}
+
+static inline uint64 getFloatBits(float value) noexcept
+{
+    uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return uint64(bits);
+}
+
+uint64 GeneratedSequenceBuilder::hashContext(const SequenceModifier::Context &context)
+{
+    uint64 hash = 0;
+
+    jassert(context.temperament != nullptr);
+    combineGeneratedSequenceHash(hash, uint64(context.temperament->getResourceId().hashCode64()));
+    combineGeneratedSequenceHash(hash, uint64(context.temperament->getPeriodSize()));
+
+    for (const auto *event : *context.keySignatures.get())
+    {
+        const auto &signature = static_cast<const KeySignatureEvent &>(*event);
+        combineGeneratedSequenceHash(hash, getFloatBits(signature.getBeat()));
+        combineGeneratedSequenceHash(hash, uint64(signature.getRootKey()));
+        combineGeneratedSequenceHash(hash, uint64(signature.getScale()->getIntervals().hashCode64()));
+    }
+
+    for (const auto *event : *context.timeSignatures->getSequence())
+    {
+        const auto &signature = static_cast<const TimeSignatureEvent &>(*event);
+        combineGeneratedSequenceHash(hash, getFloatBits(signature.getBeat()));
+        combineGeneratedSequenceHash(hash, uint64(signature.getNumerator()));
+        combineGeneratedSequenceHash(hash, uint64(signature.getDenominator()));
+    }
+
+    combineGeneratedSequenceHash(hash, getFloatBits(context.timeSignatures->getDefaultMeterBarLength()));
+    combineGeneratedSequenceHash(hash, getFloatBits(context.timeSignatures->getDefaultMeterStartBeat()));
+    return hash;
+}
+
+uint64 GeneratedSequenceBuilder::hashNotes(const MidiSequence &sequence)
+{
+    uint64 hash = 0;
+
+    for (const auto *event : sequence)
+    {
+        jassert(dynamic_cast<const Note *>(event) != nullptr);
+        const auto &note = static_cast<const Note &>(*event);
+        combineGeneratedSequenceHash(hash, getFloatBits(note.getBeat()));
+        combineGeneratedSequenceHash(hash, uint64(note.getKey()));
+        combineGeneratedSequenceHash(hash, getFloatBits(note.getLength()));
+        combineGeneratedSequenceHash(hash, getFloatBits(note.getVelocity()));
+        combineGeneratedSequenceHash(hash, uint64(note.getTuplet()));
+    }
+
+    return hash;
+}
+
+uint64 GeneratedSequenceBuilder::hashInputs(uint64 notesHash, const Clip &clip, uint64 contextHash)
+{
+    uint64 hash = notesHash;
+    combineGeneratedSequenceHash(hash, contextHash);
+
+    // the generated sequences refer to their tracks, so they are not shared
+    // between the tracks, even if those have exactly the same notes:
+    combineGeneratedSequenceHash(hash, uint64(pointer_sized_uint(clip.getPattern()->getTrack())));
+    combineGeneratedSequenceHash(hash, getFloatBits(clip.getBeat()));
+    combineGeneratedSequenceHash(hash, uint64(clip.getKey()));
+
+    for (const auto &modifier : clip.getModifiers())
+    {
+        combineGeneratedSequenceHash(hash, uint64(pointer_sized_uint(modifier.get())));
+    }
+
+    return hash;
 }
@@ -19,9 +19,12 @@
 
 class ProjectNode;
 class PianoSequence;
+class KeySignaturesSequence;
+class TimeSignaturesAggregator;
 
 #include "ProjectListener.h"
 #include "ProjectEventDispatcher.h"
+#include "SequenceModifier.h"
 #include "Clip.h"
 
 // the purpose of this class is to listen to project changes and use
@@ -29,6 +32,13 @@ class PianoSequence;
 // (it's convenient to keep the modifiers stack in clips,
 // but it seems too cumbersome to do all this work in the Clip class)
 
+// the sequences are generated by a pool of worker threads, each job working
+// on its own copy of the track's notes and of the project's context it needs;
+// jobs are versioned per clip, so the results of outdated jobs are discarded,
+// and the fresh ones are swapped in on the message thread; all results are
+// also memoized by the hash of their inputs, so that e.g. undoing an edit
+// doesn't have to re-generate all the clips of the edited track
+
 class GeneratedSequenceBuilder final :
     public ProjectEventDispatcher, // swallows events from generated sequences
     public ProjectListener, // listens to changing events to trigger rebuilds
@@ -39,6 +49,8 @@ public:
     explicit GeneratedSequenceBuilder(ProjectNode &project);
     ~GeneratedSequenceBuilder();
 
+    // returns the up-to-date sequence, generating it synchronously,
+    // if it is not generated yet, or if its generation is still pending
     MidiSequence *getSequenceFor(const Clip &clip);
 
     //===------------------------------------------------------------------===//
@@ -66,7 +78,8 @@ public:
     // rebuilding sequences from scratch using the clips' modifier stacks;
     // generated sequences have to be reloaded entirely by the rolls
     // after they are rebuilt on onReloadGeneratedSequence event,
-    // and this class will make sure to dispatch such event when needed
+    // and this class will make sure to dispatch such event when needed;
+    // (note that these are also called from the worker threads)
 
     void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) noexcept override {}
     void dispatchAddEvent(const MidiEvent &event) noexcept override {}
@@ -101,11 +114,85 @@ private:
 
     FlatHashSet<Clip, ClipHash> clipsToUpdate;
 
+private:
+
+    //===----------------------------------------------------------------------===//
+    // Generation
+    //===----------------------------------------------------------------------===//
+
+    struct GeneratedSequence final
+    {
+        std::shared_ptr<PianoSequence> sequence;
+
+        // the hash of the track's notes, the clip's parameters,
+        // the modifiers stack and the context the sequence was built with
+        uint64 inputsHash = 0;
+
+        // modifiers are hashed by pointers, like in onChangeClip,
+        // so they are kept alive while the hash is in use
+        Array<SequenceModifier::Ptr> modifiers;
+    };
+
+    // the immutable copies of the project data the modifiers need,
+    // made on the message thread and shared by the jobs of one batch
+    struct GenerationContext final : public ReferenceCountedObject
+    {
+        using Ptr = ReferenceCountedObjectPtr<GenerationContext>;
+
+        UniquePointer<KeySignaturesSequence> keySignatures;
+        UniquePointer<TimeSignaturesAggregator> timeSignatures;
+
+        // weak references are created on the message thread,
+        // workers only use the copies of them:
+        SequenceModifier::Context modifierContext;
+        uint64 hash = 0;
+    };
+
+    struct Generation final
+    {
+        Clip clip;
+        GenerationContext::Ptr context;
+        GeneratedSequence result;
+        int version = 0;
+    };
+
+    GenerationContext::Ptr makeGenerationContext();
+    SequenceModifier::Context getLiveContext() const;
+
+    static uint64 hashContext(const SequenceModifier::Context &context);
+    static uint64 hashNotes(const MidiSequence &sequence);
+    static uint64 hashInputs(uint64 notesHash, const Clip &clip, uint64 contextHash);
+
+    // copies the track's notes into a new sequence, which the modifiers
+    // will process in place, or takes a copy of the memoized result, if any;
+    // returns false, if the target is memoized and needs no generation
+    bool prepareGeneration(GeneratedSequence &target, const Clip &clip, uint64 inputsHash);
+    static void generate(GeneratedSequence &target,
+        const Clip &clip, const SequenceModifier::Context &context);
+
+    void applyGeneratedSequence(const Clip &clip, GeneratedSequence &&generated);
+    void applyFinishedGenerations();
+    void forgetTrack(MidiTrack *const track);
+
+    FlatHashMap<Clip, GeneratedSequence, ClipHash> generatedSequences;
+
+    // the latest job version for each clip, which is still in progress
+    FlatHashMap<Clip, int, ClipHash> pendingGenerations;
+    int lastGenerationVersion = 0;
+
+    CriticalSection finishedGenerationsLock;
+    Array<std::shared_ptr<Generation>> finishedGenerations;
+
+    // the recent results by their inputs hashes, bounded by size
+    FlatHashMap<uint64, GeneratedSequence> memoizedSequences;
+    static constexpr auto maxMemoizedSequences = 512;
+
 private:
 
     ProjectNode &project;
 
-    FlatHashMap<Clip, UniquePointer<PianoSequence>, ClipHash> generatedSequences;
+    // must be destroyed first, waiting for all running jobs
+    ThreadPool generationPool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GeneratedSequenceBuilder)
 };
@@ -0,0 +1,888 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ParametricExpression.h"
+
+//===----------------------------------------------------------------------===//
+// Compiler
+//===----------------------------------------------------------------------===//
+
+// a recursive descent parser, which emits the bytecode right away:
+//     program := statement { (';' | newline) statement }
+//     statement := variable '=' expression
+//     expression := or [ '?' expression ':' expression ]
+//     or := and { '||' and }
+//     and := comparison { '&&' comparison }
+//     comparison := additive { ('<' | '<=' | '>' | '>=' | '==' | '!=') additive }
+//     additive := multiplicative { ('+' | '-') multiplicative }
+//     multiplicative := unary { ('*' | '/' | '%') unary }
+//     unary := ('-' | '!') unary | primary
+//     primary := number | variable | function '(' [ expression { ',' expression } ] ')' | '(' expression ')'
+
+class ParametricExpressionCompiler final
+{
+public:
+
+    using OpCode = ParametricExpression::OpCode;
+
+    ParametricExpressionCompiler(ParametricExpression &target, const String &source) :
+        target(target),
+        input(source.getCharPointer()) {}
+
+    bool compile(String &outError)
+    {
+        this->readToken();
+
+        while (this->token != Token::End && this->error.isEmpty())
+        {
+            if (this->token == Token::Separator)
+            {
+                this->readToken();
+                continue;
+            }
+
+            this->parseStatement();
+
+            if (this->error.isEmpty() &&
+                this->token != Token::Separator && this->token != Token::End)
+            {
+                this->setError("expected the end of statement");
+            }
+        }
+
+        outError = this->error;
+        return this->error.isEmpty();
+    }
+
+private:
+
+    //===------------------------------------------------------------------===//
+    // Parsing
+    //===------------------------------------------------------------------===//
+
+    void parseStatement()
+    {
+        if (this->token != Token::Identifier)
+        {
+            this->setError("expected a variable to assign");
+            return;
+        }
+
+        const auto variable = findVariable(this->identifier);
+        if (variable < 0)
+        {
+            this->setError("unknown variable '" + this->identifier + "'");
+            return;
+        }
+
+        if (variable > ParametricExpression::keep)
+        {
+            this->setError("variable '" + this->identifier + "' is read-only");
+            return;
+        }
+
+        this->readToken();
+        if (!this->acceptSymbol("="))
+        {
+            this->setError("expected '='");
+            return;
+        }
+
+        this->parseExpression();
+        this->emit(OpCode::Store, variable);
+        jassert(!this->error.isEmpty() || this->stackSize == 0);
+    }
+
+    void parseExpression()
+    {
+        if (++this->nestingLevel > maxNestingLevel)
+        {
+            this->setError("expression is too complex");
+            return;
+        }
+
+        this->parseOr();
+
+        if (this->acceptSymbol("?"))
+        {
+            this->parseExpression();
+
+            if (!this->acceptSymbol(":"))
+            {
+                this->setError("expected ':'");
+                return;
+            }
+
+            this->parseExpression();
+            this->emit(OpCode::Select);
+        }
+
+        this->nestingLevel--;
+    }
+
+    void parseOr()
+    {
+        this->parseAnd();
+        while (this->acceptSymbol("||"))
+        {
+            this->parseAnd();
+            this->emit(OpCode::Or);
+        }
+    }
+
+    void parseAnd()
+    {
+        this->parseComparison();
+        while (this->acceptSymbol("&&"))
+        {
+            this->parseComparison();
+            this->emit(OpCode::And);
+        }
+    }
+
+    void parseComparison()
+    {
+        this->parseAdditive();
+
+        for (;;)
+        {
+            OpCode opCode;
+            if (this->acceptSymbol("<")) { opCode = OpCode::Less; }
+            else if (this->acceptSymbol("<=")) { opCode = OpCode::LessOrEqual; }
+            else if (this->acceptSymbol(">")) { opCode = OpCode::Greater; }
+            else if (this->acceptSymbol(">=")) { opCode = OpCode::GreaterOrEqual; }
+            else if (this->acceptSymbol("==")) { opCode = OpCode::Equal; }
+            else if (this->acceptSymbol("!=")) { opCode = OpCode::NotEqual; }
+            else { return; }
+
+            this->parseAdditive();
+            this->emit(opCode);
+        }
+    }
+
+    void parseAdditive()
+    {
+        this->parseMultiplicative();
+
+        for (;;)
+        {
+            OpCode opCode;
+            if (this->acceptSymbol("+")) { opCode = OpCode::Add; }
+            else if (this->acceptSymbol("-")) { opCode = OpCode::Subtract; }
+            else { return; }
+
+            this->parseMultiplicative();
+            this->emit(opCode);
+        }
+    }
+
+    void parseMultiplicative()
+    {
+        this->parseUnary();
+
+        for (;;)
+        {
+            OpCode opCode;
+            if (this->acceptSymbol("*")) { opCode = OpCode::Multiply; }
+            else if (this->acceptSymbol("/")) { opCode = OpCode::Divide; }
+            else if (this->acceptSymbol("%")) { opCode = OpCode::Modulo; }
+            else { return; }
+
+            this->parseUnary();
+            this->emit(opCode);
+        }
+    }
+
+    void parseUnary()
+    {
+        if (++this->nestingLevel > maxNestingLevel)
+        {
+            this->setError("expression is too complex");
+            return;
+        }
+
+        if (this->acceptSymbol("-"))
+        {
+            this->parseUnary();
+            this->emit(OpCode::Negate);
+        }
+        else if (this->acceptSymbol("!"))
+        {
+            this->parseUnary();
+            this->emit(OpCode::Not);
+        }
+        else
+        {
+            this->parsePrimary();
+        }
+
+        this->nestingLevel--;
+    }
+
+    void parsePrimary()
+    {
+        if (!this->error.isEmpty())
+        {
+            return;
+        }
+
+        if (this->token == Token::Number)
+        {
+            this->emit(OpCode::Push, 0, this->number);
+            this->readToken();
+            return;
+        }
+
+        if (this->acceptSymbol("("))
+        {
+            this->parseExpression();
+            if (!this->acceptSymbol(")"))
+            {
+                this->setError("expected ')'");
+            }
+
+            return;
+        }
+
+        if (this->token != Token::Identifier)
+        {
+            this->setError("expected a value");
+            return;
+        }
+
+        const auto name = this->identifier;
+        this->readToken();
+
+        if (!this->acceptSymbol("("))
+        {
+            const auto variable = findVariable(name);
+            if (variable < 0)
+            {
+                this->setError("unknown variable '" + name + "'");
+                return;
+            }
+
+            this->emit(OpCode::Load, variable);
+            return;
+        }
+
+        const auto *function = findFunction(name);
+        if (function == nullptr)
+        {
+            this->setError("unknown function '" + name + "'");
+            return;
+        }
+
+        int numArguments = 0;
+        if (!this->acceptSymbol(")"))
+        {
+            do
+            {
+                this->parseExpression();
+                numArguments++;
+            } while (this->error.isEmpty() && this->acceptSymbol(","));
+
+            if (!this->acceptSymbol(")"))
+            {
+                this->setError("expected ')'");
+                return;
+            }
+        }
+
+        if (numArguments != function->numArguments)
+        {
+            this->setError("function '" + name + "' expects " +
+                String(function->numArguments) + " argument(s)");
+            return;
+        }
+
+        // random values depend on the call site, so that
+        // several random() calls in one program are not the same
+        const auto isRandom = function->opCode == OpCode::Random ||
+            function->opCode == OpCode::Chance;
+
+        this->emit(function->opCode, isRandom ? this->numRandomCallSites++ : 0);
+    }
+
+    //===------------------------------------------------------------------===//
+    // Emitting
+    //===------------------------------------------------------------------===//
+
+    void emit(OpCode opCode, int argument = 0, float value = 0.f)
+    {
+        if (!this->error.isEmpty())
+        {
+            return;
+        }
+
+        this->target.instructions.add({ opCode, argument, value });
+        if (this->target.instructions.size() > ParametricExpression::maxNumInstructions)
+        {
+            this->setError("program is too long");
+            return;
+        }
+
+        this->stackSize += getStackEffect(opCode);
+        jassert(this->stackSize >= 0);
+
+        if (this->stackSize > ParametricExpression::maxStackSize)
+        {
+            this->setError("expression is too complex");
+        }
+    }
+
+    static int getStackEffect(OpCode opCode) noexcept
+    {
+        switch (opCode)
+        {
+        case OpCode::Push:
+        case OpCode::Load:
+        case OpCode::Random:
+            return 1;
+        case OpCode::Negate:
+        case OpCode::Not:
+        case OpCode::Abs:
+        case OpCode::Floor:
+        case OpCode::Round:
+        case OpCode::Sin:
+        case OpCode::Chance:
+            return 0;
+        case OpCode::Select:
+        case OpCode::Clamp:
+            return -2;
+        default:
+            // the stores and all binary operations
+            return -1;
+        }
+    }
+
+    //===------------------------------------------------------------------===//
+    // Lexing
+    //===------------------------------------------------------------------===//
+
+    enum class Token
+    {
+        End,
+        Separator,
+        Number,
+        Identifier,
+        Symbol
+    };
+
+    void readToken()
+    {
+        // skip whitespaces, except for newlines, and the comments
+        for (;;)
+        {
+            while (!this->input.isEmpty() && *this->input != '\n' &&
+                this->input.isWhitespace())
+            {
+                ++this->input;
+            }
+
+            if (*this->input == '/' && this->input[1] == '/')
+            {
+                while (!this->input.isEmpty() && *this->input != '\n')
+                {
+                    ++this->input;
+                }
+
+                continue;
+            }
+
+            break;
+        }
+
+        this->symbol = {};
+        this->identifier = {};
+
+        if (this->input.isEmpty())
+        {
+            this->token = Token::End;
+            return;
+        }
+
+        const auto c = *this->input;
+
+        if (c == '\n' || c == ';')
+        {
+            this->lineNumber += (c == '\n') ? 1 : 0;
+            this->token = Token::Separator;
+            ++this->input;
+            return;
+        }
+
+        if (CharacterFunctions::isDigit(c) ||
+            (c == '.' && CharacterFunctions::isDigit(this->input[1])))
+        {
+            this->token = Token::Number;
+            this->number = float(CharacterFunctions::readDoubleValue(this->input));
+            return;
+        }
+
+        if (CharacterFunctions::isLetter(c) || c == '_')
+        {
+            this->token = Token::Identifier;
+            const auto start = this->input;
+            while (this->input.isLetterOrDigit() || *this->input == '_')
+            {
+                ++this->input;
+            }
+
+            this->identifier = String(start, this->input);
+            return;
+        }
+
+        static const char *twoCharSymbols[] = { "<=", ">=", "==", "!=", "&&", "||" };
+        for (const auto *s : twoCharSymbols)
+        {
+            if (c == juce_wchar(s[0]) && this->input[1] == juce_wchar(s[1]))
+            {
+                this->token = Token::Symbol;
+                this->symbol = s;
+                this->input += 2;
+                return;
+            }
+        }
+
+        if (String("+-*/%(),?:<>!=").containsChar(c))
+        {
+            this->token = Token::Symbol;
+            this->symbol = String::charToString(c);
+            ++this->input;
+            return;
+        }
+
+        this->setError("unexpected character '" + String::charToString(c) + "'");
+        this->token = Token::End;
+    }
+
+    bool acceptSymbol(const char *expected)
+    {
+        if (this->error.isEmpty() &&
+            this->token == Token::Symbol && this->symbol == expected)
+        {
+            this->readToken();
+            return true;
+        }
+
+        return false;
+    }
+
+    void setError(const String &message)
+    {
+        if (this->error.isEmpty())
+        {
+            this->error = "line " + String(this->lineNumber) + ": " + message;
+        }
+    }
+
+    //===------------------------------------------------------------------===//
+    // Symbols
+    //===------------------------------------------------------------------===//
+
+    static int findVariable(const String &name) noexcept
+    {
+        static const char *names[ParametricExpression::numVariables] =
+        {
+            "beat", "key", "length", "velocity", "keep",
+            "index", "count", "period"
+        };
+
+        for (int i = 0; i < ParametricExpression::numVariables; ++i)
+        {
+            if (name == names[i])
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    struct Function final
+    {
+        const char *name;
+        OpCode opCode;
+        int numArguments;
+    };
+
+    static const Function *findFunction(const String &name) noexcept
+    {
+        static const Function functions[] =
+        {
+            { "min", OpCode::Min, 2 },
+            { "max", OpCode::Max, 2 },
+            { "clamp", OpCode::Clamp, 3 },
+            { "abs", OpCode::Abs, 1 },
+            { "floor", OpCode::Floor, 1 },
+            { "round", OpCode::Round, 1 },
+            { "sin", OpCode::Sin, 1 },
+            { "random", OpCode::Random, 0 }, // uniform in [0, 1)
+            { "chance", OpCode::Chance, 1 } // 1 with the given probability, or 0
+        };
+
+        for (const auto &function : functions)
+        {
+            if (name == function.name)
+            {
+                return &function;
+            }
+        }
+
+        return nullptr;
+    }
+
+    ParametricExpression &target;
+
+    String::CharPointerType input;
+
+    Token token = Token::End;
+    String symbol;
+    String identifier;
+    float number = 0.f;
+
+    String error;
+    int lineNumber = 1;
+
+    int stackSize = 0;
+    int nestingLevel = 0;
+    int numRandomCallSites = 0;
+
+    // protects the parser's own stack from the malicious input
+    static constexpr auto maxNestingLevel = 64;
+
+    JUCE_DECLARE_NON_COPYABLE(ParametricExpressionCompiler)
+};
+
+ParametricExpression::Ptr ParametricExpression::compile(const String &source, String &outError)
+{
+    if (source.length() > maxSourceLength)
+    {
+        outError = "program is too long";
+        return nullptr;
+    }
+
+    Ptr program(new ParametricExpression());
+    program->source = source;
+
+    ParametricExpressionCompiler compiler(*program, source);
+    if (!compiler.compile(outError))
+    {
+        return nullptr;
+    }
+
+    program->instructions.minimiseStorageOverheads();
+    return program;
+}
+
+const String &ParametricExpression::getSource() const noexcept
+{
+    return this->source;
+}
+
+//===----------------------------------------------------------------------===//
+// Interpreter
+//===----------------------------------------------------------------------===//
+
+// splitmix64 finalizer: a cheap and good enough stateless hash,
+// so that random values don't depend on the evaluation order
+static inline float getParametricRandomValue(uint64 seed, int callSite) noexcept
+{
+    auto x = seed + uint64(callSite + 1) * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= (x >> 31);
+    return float(x >> 40) / 16777216.f;
+}
+
+uint64 ParametricExpression::getNoteSeed(uint32 programSeed, int noteIndex) noexcept
+{
+    return (uint64(programSeed) << 32) | uint64(uint32(noteIndex));
+}
+
+void ParametricExpression::execute(Registers &registers, uint64 seed) const noexcept
+{
+    // the compiler makes sure the stack never overflows or underflows
+    float stack[maxStackSize];
+    int top = -1;
+
+    for (const auto &instruction : this->instructions)
+    {
+        switch (instruction.opCode)
+        {
+        case OpCode::Push:
+            stack[++top] = instruction.value;
+            break;
+        case OpCode::Load:
+            stack[++top] = registers[instruction.argument];
+            break;
+        case OpCode::Store:
+            // non-finite results, like sin(1 / 0), are just ignored
+            if (std::isfinite(stack[top]))
+            {
+                registers[instruction.argument] = stack[top];
+            }
+            top--;
+            break;
+        case OpCode::Add:
+            top--;
+            stack[top] = stack[top] + stack[top + 1];
+            break;
+        case OpCode::Subtract:
+            top--;
+            stack[top] = stack[top] - stack[top + 1];
+            break;
+        case OpCode::Multiply:
+            top--;
+            stack[top] = stack[top] * stack[top + 1];
+            break;
+        case OpCode::Divide:
+            top--;
+            stack[top] = (stack[top + 1] == 0.f) ? 0.f : stack[top] / stack[top + 1];
+            break;
+        case OpCode::Modulo:
+            top--;
+            stack[top] = (stack[top + 1] == 0.f) ? 0.f : std::fmod(stack[top], stack[top + 1]);
+            break;
+        case OpCode::Negate:
+            stack[top] = -stack[top];
+            break;
+        case OpCode::Not:
+            stack[top] = (stack[top] == 0.f) ? 1.f : 0.f;
+            break;
+        case OpCode::Less:
+            top--;
+            stack[top] = (stack[top] < stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::LessOrEqual:
+            top--;
+            stack[top] = (stack[top] <= stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::Greater:
+            top--;
+            stack[top] = (stack[top] > stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::GreaterOrEqual:
+            top--;
+            stack[top] = (stack[top] >= stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::Equal:
+            top--;
+            stack[top] = (stack[top] == stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::NotEqual:
+            top--;
+            stack[top] = (stack[top] != stack[top + 1]) ? 1.f : 0.f;
+            break;
+        case OpCode::And:
+            top--;
+            stack[top] = (stack[top] != 0.f && stack[top + 1] != 0.f) ? 1.f : 0.f;
+            break;
+        case OpCode::Or:
+            top--;
+            stack[top] = (stack[top] != 0.f || stack[top + 1] != 0.f) ? 1.f : 0.f;
+            break;
+        case OpCode::Select:
+            top -= 2;
+            stack[top] = (stack[top] != 0.f) ? stack[top + 1] : stack[top + 2];
+            break;
+        case OpCode::Min:
+            top--;
+            stack[top] = jmin(stack[top], stack[top + 1]);
+            break;
+        case OpCode::Max:
+            top--;
+            stack[top] = jmax(stack[top], stack[top + 1]);
+            break;
+        case OpCode::Clamp:
+            top -= 2;
+            stack[top] = jmax(stack[top + 1], jmin(stack[top + 2], stack[top]));
+            break;
+        case OpCode::Abs:
+            stack[top] = std::abs(stack[top]);
+            break;
+        case OpCode::Floor:
+            stack[top] = std::floor(stack[top]);
+            break;
+        case OpCode::Round:
+            stack[top] = std::round(stack[top]);
+            break;
+        case OpCode::Sin:
+            stack[top] = std::sin(stack[top]);
+            break;
+        case OpCode::Random:
+            stack[++top] = getParametricRandomValue(seed, instruction.argument);
+            break;
+        case OpCode::Chance:
+            stack[top] = (getParametricRandomValue(seed, instruction.argument) < stack[top]) ? 1.f : 0.f;
+            break;
+        default:
+            jassertfalse;
+            break;
+        }
+    }
+
+    jassert(top == -1);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class ParametricExpressionTests final : public UnitTest
+{
+public:
+    ParametricExpressionTests() : UnitTest("Parametric modifier expressions tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Evaluating expressions");
+        {
+            auto registers = run("beat = 1 + 2 * 3 - 4 / 2; key = (1 + 2) * 3\n" // 5, 9
+                "length = -2 * -2 % 3; velocity = 10 / 0", 0); // 1, 0
+            expectEquals(registers[ParametricExpression::beat], 5.f);
+            expectEquals(registers[ParametricExpression::key], 9.f);
+            expectEquals(registers[ParametricExpression::length], 1.f);
+            expectEquals(registers[ParametricExpression::velocity], 0.f);
+
+            registers = run("beat = index > 2 && count == 10 ? 1 : 2; // comment\n"
+                "key = clamp(key + 100, 0, 70); length = max(abs(-3), min(1, 2)) + floor(1.5) + round(0.6);"
+                "velocity = !keep || 0; keep = beat <= 1", 3);
+            expectEquals(registers[ParametricExpression::beat], 1.f);
+            expectEquals(registers[ParametricExpression::key], 70.f);
+            expectEquals(registers[ParametricExpression::length], 5.f);
+            expectEquals(registers[ParametricExpression::velocity], 0.f);
+            expectEquals(registers[ParametricExpression::keep], 1.f);
+
+            // the statements see the results of the previous ones:
+            registers = run("beat = 2; beat = beat * beat; length = beat", 0);
+            expectEquals(registers[ParametricExpression::length], 4.f);
+
+            // non-finite values are ignored
+            registers = run("length = 1e30 * 1e30", 0);
+            expectEquals(registers[ParametricExpression::length], 1.f);
+        }
+
+        beginTest("Rejecting invalid programs");
+        {
+            String error;
+            expect(ParametricExpression::compile("beat = tempo", error) == nullptr);
+            expect(error.contains("tempo"));
+            expect(ParametricExpression::compile("index = 1", error) == nullptr);
+            expect(ParametricExpression::compile("beat = 1 +", error) == nullptr);
+            expect(ParametricExpression::compile("beat = min(1)", error) == nullptr);
+            expect(ParametricExpression::compile("beat = (1", error) == nullptr);
+            expect(ParametricExpression::compile("beat = 1 2", error) == nullptr);
+            expect(ParametricExpression::compile("beat = 1 $ 2", error) == nullptr);
+            expect(ParametricExpression::compile("\nbeat 1", error) == nullptr);
+            expect(error.startsWith("line 2"));
+
+            // no stack overflows, neither in the parser, nor in the program
+            expect(ParametricExpression::compile("beat = " +
+                String::repeatedString("(", 10000) + "1" + String::repeatedString(")", 10000), error) == nullptr);
+            expect(ParametricExpression::compile("beat = " +
+                String::repeatedString("1 + (", 40) + "1" + String::repeatedString(")", 40), error) == nullptr);
+            expect(ParametricExpression::compile(String::repeatedString("beat=1;", 520), error) == nullptr);
+
+            expect(ParametricExpression::compile("", error) != nullptr);
+            expect(ParametricExpression::compile("\n; beat = beat;;\n", error) != nullptr);
+        }
+
+        beginTest("Random values are deterministic");
+        {
+            const auto source = "beat = random(); key = random(); length = chance(0.5); velocity = random()";
+            for (int i = 0; i < 100; ++i)
+            {
+                const auto a = run(source, i, 1);
+                const auto b = run(source, i, 1);
+                const auto c = run(source, i, 2);
+
+                expect(a[ParametricExpression::beat] >= 0.f && a[ParametricExpression::beat] < 1.f);
+                expect(a[ParametricExpression::beat] != a[ParametricExpression::key]);
+                expect(a[ParametricExpression::beat] != c[ParametricExpression::beat]);
+
+                for (int v = 0; v < ParametricExpression::numVariables; ++v)
+                {
+                    expectEquals(a[v], b[v]);
+                }
+            }
+        }
+
+        beginTest("Chained programs are the same as a single one");
+        {
+            String error;
+            const auto first = ParametricExpression::compile("beat = beat + index * 0.25; velocity = velocity * 0.5", error);
+            const auto second = ParametricExpression::compile("key = key + (beat > 1 ? 12 : 0); keep = index % 2", error);
+            const auto combined = ParametricExpression::compile(first->getSource() + "\n" + second->getSource(), error);
+            expect(first != nullptr && second != nullptr && combined != nullptr);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                auto chained = makeRegisters(i);
+                first->execute(chained, ParametricExpression::getNoteSeed(0, i));
+                second->execute(chained, ParametricExpression::getNoteSeed(0, i));
+
+                auto single = makeRegisters(i);
+                combined->execute(single, ParametricExpression::getNoteSeed(0, i));
+
+                for (int v = 0; v < ParametricExpression::numVariables; ++v)
+                {
+                    expectEquals(chained[v], single[v]);
+                }
+            }
+        }
+    }
+
+private:
+
+    static ParametricExpression::Registers makeRegisters(int index)
+    {
+        ParametricExpression::Registers registers;
+        registers[ParametricExpression::beat] = float(index) * 0.5f;
+        registers[ParametricExpression::key] = 60.f;
+        registers[ParametricExpression::length] = 1.f;
+        registers[ParametricExpression::velocity] = 0.75f;
+        registers[ParametricExpression::keep] = 1.f;
+        registers[ParametricExpression::index] = float(index);
+        registers[ParametricExpression::count] = 10.f;
+        registers[ParametricExpression::period] = 12.f;
+        return registers;
+    }
+
+    ParametricExpression::Registers run(const String &source, int index, uint32 seed = 0)
+    {
+        String error;
+        const auto program = ParametricExpression::compile(source, error);
+        expect(program != nullptr, error);
+
+        auto registers = makeRegisters(index);
+        if (program != nullptr)
+        {
+            program->execute(registers, ParametricExpression::getNoteSeed(seed, index));
+        }
+
+        return registers;
+    }
+};
+
+static ParametricExpressionTests parametricExpressionTests;
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A tiny language for user-defined parametric modifiers, e.g.:
+//     velocity = velocity * (0.9 + random() * 0.2);
+//     beat = beat + index * 0.05
+// each statement assigns an expression to one of the note's parameters;
+// programs are compiled once into bytecode for a little stack machine,
+// which is sandboxed by design: no loops, no function calls into the app,
+// a fixed-size stack and a limited program size, so that running it
+// always takes bounded time and can't crash; the only random source
+// is a hash of the seed, the note index and the call site,
+// so the same inputs always produce the same outputs.
+
+class ParametricExpression final : public ReferenceCountedObject
+{
+public:
+
+    using Ptr = ReferenceCountedObjectPtr<ParametricExpression>;
+
+    // returns nullptr and the error description, if the source is invalid
+    static Ptr compile(const String &source, String &outError);
+
+    enum Variable : int
+    {
+        // readable and writable:
+        beat,
+        key,
+        length,
+        velocity,
+        keep, // the probability gate: notes with keep <= 0 are removed
+
+        // read-only:
+        index, // the note's index in the source sequence
+        count, // the number of notes in the source sequence
+        period, // the temperament's period size
+
+        numVariables
+    };
+
+    // the flat per-note state the programs work on
+    struct Registers final
+    {
+        float values[numVariables];
+
+        inline float &operator[] (int variable) noexcept { return this->values[variable]; }
+        inline float operator[] (int variable) const noexcept { return this->values[variable]; }
+    };
+
+    // the seed is expected to be unique per note,
+    // see getNoteSeed; the registers are updated in place
+    void execute(Registers &registers, uint64 seed) const noexcept;
+
+    static uint64 getNoteSeed(uint32 programSeed, int noteIndex) noexcept;
+
+    const String &getSource() const noexcept;
+
+    static constexpr auto maxSourceLength = 4096;
+    static constexpr auto maxNumInstructions = 1024;
+    static constexpr auto maxStackSize = 32;
+
+private:
+
+    ParametricExpression() = default;
+    friend class ParametricExpressionCompiler;
+
+    enum class OpCode : uint8
+    {
+        Push,
+        Load,
+        Store,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo,
+        Negate,
+        Not,
+        Less,
+        LessOrEqual,
+        Greater,
+        GreaterOrEqual,
+        Equal,
+        NotEqual,
+        And,
+        Or,
+        Select,
+        Min,
+        Max,
+        Clamp,
+        Abs,
+        Floor,
+        Round,
+        Sin,
+        Random,
+        Chance
+    };
+
+    struct Instruction final
+    {
+        OpCode opCode;
+        // the variable index for Load/Store,
+        // or the call site index for Random/Chance
+        int argument;
+        float value;
+    };
+
+    Array<Instruction> instructions;
+
+    String source;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametricExpression)
+};
@@ -0,0 +1,401 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ParametricSequenceModifier.h"
+#include "PianoSequence.h"
+#include "Clip.h"
+#include "MidiTrack.h"
+
+ParametricSequenceModifier::ParametricSequenceModifier(const String &source, uint32 seed) :
+    seed(seed)
+{
+    this->compile(source);
+}
+
+String ParametricSequenceModifier::getPresetSource(Preset preset)
+{
+    switch (preset)
+    {
+    case Preset::Humanize:
+        return "beat = beat + (random() - 0.5) * 0.04\n"
+            "velocity = velocity * (0.9 + random() * 0.2)";
+    case Preset::Strum:
+        // spreads the notes of a chord from the lowest one within a period
+        return "beat = beat + (key % period) / period * 0.125";
+    case Preset::VelocityCurve:
+        return "velocity = clamp(velocity * velocity * 1.25, 0.05, 1)";
+    case Preset::ProbabilityGate:
+        return "keep = chance(0.75)";
+    default:
+        jassertfalse;
+        return {};
+    }
+}
+
+void ParametricSequenceModifier::processSequence(const Context &context,
+    const Clip &clip, const PianoSequence &sequence)
+{
+    if (!this->isEnabled())
+    {
+        return;
+    }
+
+    processFused({ this }, context, clip, sequence);
+}
+
+void ParametricSequenceModifier::processFused(const Array<const ParametricSequenceModifier *> &modifiers,
+    const Context &context, const Clip &clip, const PianoSequence &sequence)
+{
+    const auto numNotes = sequence.size();
+    if (modifiers.isEmpty() || numNotes == 0)
+    {
+        return;
+    }
+
+    const auto periodSize = float(context.temperament != nullptr ?
+        context.temperament->getPeriodSize() : Globals::twelveTonePeriodSize);
+
+    // the programs may produce any finite values, so the results are limited
+    // to the keyboard range, including the clip's transposition, which the
+    // keyboard mapping expects, and to the beat range where the ticks are
+    // still exactly representable in floats
+    const auto minKey = jmax(0, -clip.getKey());
+    const auto maxKey = jmax(minKey, Globals::maxKeyboardSize - 1 - clip.getKey());
+
+    const auto sanitize = [](float value, float fallback, float min, float max)
+    {
+        return std::isfinite(value) ? jlimit(min, max, value) : fallback;
+    };
+
+    Array<Note> groupBefore, groupAfter, removedNotes;
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        const auto &note = sequence.getNoteUnchecked(i);
+
+        ParametricExpression::Registers registers;
+        registers[ParametricExpression::beat] = note.getBeat();
+        registers[ParametricExpression::key] = float(note.getKey());
+        registers[ParametricExpression::length] = note.getLength();
+        registers[ParametricExpression::velocity] = note.getVelocity();
+        registers[ParametricExpression::keep] = 1.f;
+        registers[ParametricExpression::index] = float(i);
+        registers[ParametricExpression::count] = float(numNotes);
+        registers[ParametricExpression::period] = periodSize;
+
+        for (const auto *modifier : modifiers)
+        {
+            if (modifier->program != nullptr)
+            {
+                // the clip's id makes the same modifier sound
+                // differently in different clips, but still deterministic
+                modifier->program->execute(registers, ParametricExpression::getNoteSeed(
+                    modifier->seed ^ uint32(clip.getId()), i));
+            }
+        }
+
+        if (registers[ParametricExpression::keep] <= 0.f)
+        {
+            removedNotes.add(note);
+            continue;
+        }
+
+        const auto newKey = roundToInt(sanitize(registers[ParametricExpression::key],
+            float(note.getKey()), float(minKey), float(maxKey)));
+        const auto newBeat = sanitize(registers[ParametricExpression::beat],
+            note.getBeat(), -maxBeatMagnitude, maxBeatMagnitude);
+        const auto newLength = sanitize(registers[ParametricExpression::length],
+            note.getLength(), Globals::minNoteLength, maxBeatMagnitude);
+        const auto newVelocity = sanitize(registers[ParametricExpression::velocity],
+            note.getVelocity(), 0.f, 1.f);
+
+        if (newKey != note.getKey() || newBeat != note.getBeat() ||
+            newLength != note.getLength() || newVelocity != note.getVelocity())
+        {
+            groupBefore.add(note);
+            groupAfter.add(note.withKeyBeat(newKey, newBeat)
+                .withLength(newLength).withVelocity(newVelocity));
+        }
+    }
+
+    // generated sequences are always owned by GeneratedSequenceBuilder,
+    // and the modifiers are the only ones who are allowed to change them
+    auto &target = const_cast<PianoSequence &>(sequence);
+
+    if (!removedNotes.isEmpty())
+    {
+        target.removeGroup(removedNotes, false);
+    }
+
+    if (!groupBefore.isEmpty())
+    {
+        target.changeGroup(groupBefore, groupAfter, false);
+    }
+}
+
+bool ParametricSequenceModifier::isValid() const noexcept
+{
+    return this->program != nullptr;
+}
+
+const String &ParametricSequenceModifier::getCompilationError() const noexcept
+{
+    return this->compilationError;
+}
+
+bool ParametricSequenceModifier::hasParameters() const
+{
+    return false;
+}
+
+String ParametricSequenceModifier::getDescription() const
+{
+    static constexpr auto maxDescriptionLength = 32;
+
+    const auto description = this->source.trim()
+        .removeCharacters("\r").replace("\n", "; ");
+
+    return description.length() > maxDescriptionLength ?
+        description.substring(0, maxDescriptionLength - 3) + "..." : description;
+}
+
+Icons::Id ParametricSequenceModifier::getIconId() const
+{
+    return Icons::console;
+}
+
+SequenceModifier::Ptr ParametricSequenceModifier::withEnabledFlag(bool shouldBeEnabled) const
+{
+    auto m = make<ParametricSequenceModifier>(*this);
+    m->enabled = shouldBeEnabled;
+    return SequenceModifier::Ptr(m.release());
+}
+
+bool ParametricSequenceModifier::isEquivalentTo(SequenceModifier::Ptr other) const
+{
+    jassert(other != nullptr);
+    if (other.get() == this) { return true; }
+    if (other->isEnabled() != this->isEnabled()) { return false; }
+
+    if (const auto *casted = dynamic_cast<ParametricSequenceModifier *>(other.get()))
+    {
+        return casted->seed == this->seed && casted->source == this->source;
+    }
+
+    return false;
+}
+
+void ParametricSequenceModifier::compile(const String &newSource)
+{
+    this->source = newSource;
+    this->compilationError = {};
+    // an invalid expression is a normal case, e.g. while the user is typing,
+    // such modifiers keep the error to display, and pass the notes as is
+    this->program = ParametricExpression::compile(newSource, this->compilationError);
+}
+
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+SerializedData ParametricSequenceModifier::serialize() const
+{
+    using namespace Serialization;
+
+    SerializedData tree(Modifiers::parametricModifier);
+
+    if (!this->enabled)
+    {
+        tree.setProperty(Modifiers::isEnabled, false);
+    }
+
+    tree.setProperty(Modifiers::parametricSource, this->source);
+
+    if (this->seed != 0)
+    {
+        tree.setProperty(Modifiers::parametricSeed, int(this->seed));
+    }
+
+    return tree;
+}
+
+void ParametricSequenceModifier::deserialize(const SerializedData &data)
+{
+    using namespace Serialization;
+    jassert(data.hasType(Modifiers::parametricModifier));
+
+    this->enabled = data.getProperty(Modifiers::isEnabled, true);
+    this->seed = uint32(int(data.getProperty(Modifiers::parametricSeed, 0)));
+
+    // the invalid programs are kept as is, and just do nothing
+    this->compile(data.getProperty(Modifiers::parametricSource));
+}
+
+void ParametricSequenceModifier::reset()
+{
+    this->program = nullptr;
+    this->source = {};
+    this->compilationError = {};
+    this->seed = 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class ParametricModifierTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    ParametricModifierTestTrack() :
+        sequence(make<PianoSequence>(*this, *this)) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    PianoSequence &getNotes() const noexcept { return *this->sequence; }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<PianoSequence> sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametricModifierTestTrack)
+};
+
+class ParametricSequenceModifierTests final : public UnitTest
+{
+public:
+    ParametricSequenceModifierTests() : UnitTest("Parametric sequence modifier tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Fused modifiers keep the notes within the keyboard");
+        {
+            const auto maxKey = Globals::maxKeyboardSize - 1;
+
+            auto notes = process({ "key = key * 1000000 * 1000000 * 1000000" }, 12);
+            expectEquals(notes.size(), 4);
+            for (const auto &note : notes)
+            {
+                expectEquals(note.getKey(), maxKey - 12);
+            }
+
+            notes = process({ "key = key - 1000" }, -12);
+            for (const auto &note : notes)
+            {
+                expectEquals(note.getKey(), 12);
+            }
+
+            // each of the modifiers sees the results of the previous ones:
+            notes = process({ "key = key + 10000", "key = key - 20" }, 0);
+            for (const auto &note : notes)
+            {
+                expectEquals(note.getKey(), maxKey - 20);
+            }
+        }
+
+        beginTest("Fused modifiers keep the beats, lengths and velocities finite");
+        {
+            const auto notes = process({ "beat = beat * 1000000 * 1000000 * 1000000 + 1\n"
+                "length = length * 1000000 * 1000000 * 1000000\n"
+                "velocity = velocity - 1000000 * 1000000 * 1000000" }, 0);
+
+            expectEquals(notes.size(), 4);
+            for (const auto &note : notes)
+            {
+                expect(note.getBeat() >= 0.f && note.getBeat() <= float(1 << 20));
+                expect(note.getLength() >= Globals::minNoteLength && note.getLength() <= float(1 << 20));
+                expectEquals(note.getVelocity(), 0.f);
+            }
+        }
+
+        beginTest("Fused modifiers skip the invalid expressions");
+        {
+            ParametricSequenceModifier invalidModifier("beat = 1 +");
+            expect(!invalidModifier.isValid());
+            expect(invalidModifier.getCompilationError().isNotEmpty());
+
+            const auto notes = process({ "beat = 1 +", "key = key + 1" }, 0);
+            expectEquals(notes.size(), 4);
+            for (int i = 0; i < notes.size(); ++i)
+            {
+                expectEquals(notes[i].getKey(), 61 + i);
+                expectEquals(notes[i].getBeat(), float(i));
+            }
+        }
+
+        beginTest("Fused modifiers remove and keep the notes");
+        {
+            const auto notes = process({ "keep = index % 2", "key = key + 1" }, 0);
+            expectEquals(notes.size(), 2);
+            expectEquals(notes[0].getKey(), 62);
+            expectEquals(notes[0].getBeat(), 1.f);
+            expectEquals(notes[1].getKey(), 64);
+            expectEquals(notes[1].getBeat(), 3.f);
+        }
+    }
+
+private:
+
+    static Array<Note> process(const StringArray &sources, int clipKey)
+    {
+        ParametricModifierTestTrack track;
+        auto &sequence = track.getNotes();
+        for (int i = 0; i < 4; ++i)
+        {
+            sequence.insert(Note(&sequence, 60 + i, float(i), 1.f, 0.5f), false);
+        }
+
+        OwnedArray<ParametricSequenceModifier> modifiers;
+        Array<const ParametricSequenceModifier *> fusedModifiers;
+        for (const auto &source : sources)
+        {
+            fusedModifiers.add(modifiers.add(new ParametricSequenceModifier(source)));
+        }
+
+        ParametricSequenceModifier::processFused(fusedModifiers, {},
+            Clip(nullptr, 0.f, clipKey), sequence);
+
+        Array<Note> result;
+        for (int i = 0; i < sequence.size(); ++i)
+        {
+            result.add(sequence.getNoteUnchecked(i));
+        }
+
+        return result;
+    }
+};
+
+static ParametricSequenceModifierTests parametricSequenceModifierTests;
+
+#endif
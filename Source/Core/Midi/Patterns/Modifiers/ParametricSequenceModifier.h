@@ -0,0 +1,89 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "SequenceModifier.h"
+#include "ParametricExpression.h"
+
+// user-defined modifiers, like humanize, strum, velocity curves
+// or probability gates, written as ParametricExpression programs;
+// the adjacent ones in a clip's stack are fused by processFused,
+// so that the whole chain makes just one pass over a flat buffer
+// and only one group change in the generated sequence
+
+class ParametricSequenceModifier final : public SequenceModifier
+{
+public:
+
+    ParametricSequenceModifier() = default;
+    ParametricSequenceModifier(const ParametricSequenceModifier &other) noexcept = default;
+
+    explicit ParametricSequenceModifier(const String &source, uint32 seed = 0);
+
+    enum class Preset
+    {
+        Humanize,
+        Strum,
+        VelocityCurve,
+        ProbabilityGate
+    };
+
+    static String getPresetSource(Preset preset);
+
+    void processSequence(const Context &context,
+        const Clip &clip, const PianoSequence &sequence) override;
+
+    // applies all the given modifiers in a single pass over the notes;
+    // note that the index variable always refers to the source order
+    static void processFused(const Array<const ParametricSequenceModifier *> &modifiers,
+        const Context &context, const Clip &clip, const PianoSequence &sequence);
+
+    bool isValid() const noexcept;
+    const String &getCompilationError() const noexcept;
+
+    bool hasParameters() const override;
+    String getDescription() const override;
+    Icons::Id getIconId() const override;
+
+    SequenceModifier::Ptr withEnabledFlag(bool shouldBeEnabled) const override;
+    bool isEquivalentTo(SequenceModifier::Ptr other) const override;
+
+    //===------------------------------------------------------------------===//
+    // Serializable
+    //===------------------------------------------------------------------===//
+
+    SerializedData serialize() const override;
+    void deserialize(const SerializedData &data) override;
+    void reset() override;
+
+private:
+
+    void compile(const String &source);
+
+    // 2^24 float mantissa / 16 ticks per beat
+    static constexpr auto maxBeatMagnitude = float(1 << 20);
+
+    // programs are immutable, so the copies of a modifier share them
+    ParametricExpression::Ptr program;
+    String source;
+    String compilationError;
+
+    uint32 seed = 0;
+
+    JUCE_LEAK_DETECTOR(ParametricSequenceModifier)
+};
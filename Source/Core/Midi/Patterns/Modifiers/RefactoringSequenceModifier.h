@@ -65,7 +65,7 @@ public:
     explicit RefactoringSequenceModifier(Type type, int parameterValue = 0) :
         type(type), parameterValue(parameterValue) {}
 
-    void processSequence(const ProjectNode &project,
+    void processSequence(const Context &context,
         const Clip &clip, const PianoSequence &sequence) override
     {
         if (!this->isEnabled())
@@ -90,7 +90,7 @@ public:
             for (int i = 0; i < abs(this->parameterValue); ++i)
             {
                 SequencerOperations::invertChord(sequence,
-                    (this->parameterValue > 0 ? 1 : -1) * project.getProjectInfo()->getPeriodSize(),
+                    (this->parameterValue > 0 ? 1 : -1) * context.temperament->getPeriodSize(),
                     false, false);
             }
             break;
@@ -98,8 +98,8 @@ public:
         case Type::InScaleTranspositionDown:
         case Type::SnapToScale:
             SequencerOperations::shiftInScaleKeyRelative(sequence, clip,
-                project.getTimeline()->getKeySignaturesSequence(),
-                project.getProjectInfo()->getTemperament()->getHighlighting(),
+                context.keySignatures,
+                context.temperament->getHighlighting(),
                 this->parameterValue, false, false);
             break;
         case Type::Legato:
@@ -17,12 +17,14 @@
 
 #pragma once
 
-class ProjectNode;
 class PianoSequence;
 class Clip;
+class KeySignaturesSequence;
+class TimeSignaturesAggregator;
 
 #include "Serializable.h"
 #include "Icons.h"
+#include "Temperament.h"
 
 // even though the class is called SequenceModifier,
 // all such modifiers are stacked on clips, not sequences
@@ -37,8 +39,18 @@ public:
     // to be easily and cheaply copied here and there:
     using Ptr = ReferenceCountedObjectPtr<SequenceModifier>;
 
+    // the project data the modifiers may depend on: sequences are
+    // generated in background threads, so this is typically a snapshot
+    // taken by GeneratedSequenceBuilder, not the project's live data
+    struct Context final
+    {
+        Temperament::Ptr temperament;
+        WeakReference<KeySignaturesSequence> keySignatures;
+        WeakReference<TimeSignaturesAggregator> timeSignatures;
+    };
+
     // for now it will only support transforming notes:
-    virtual void processSequence(const ProjectNode &project, 
+    virtual void processSequence(const Context &context,
         const Clip &clip, const PianoSequence &sequence) = 0;
 
     virtual bool hasParameters() const = 0;
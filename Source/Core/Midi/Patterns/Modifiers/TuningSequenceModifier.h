@@ -29,7 +29,7 @@ public:
     TuningSequenceModifier() = default;
     TuningSequenceModifier(const TuningSequenceModifier &other) noexcept = default;
 
-    void processSequence(const ProjectNode &project,
+    void processSequence(const Context &context,
         const Clip &clip, const PianoSequence &sequence) override
     {
         if (!this->isEnabled())
@@ -21,6 +21,7 @@
 #include "SerializationKeys.h"
 #include "ProjectNode.h"
 #include "UndoStack.h"
+#include "MidiTrack.h"
 
 AnnotationsSequence::AnnotationsSequence(MidiTrack &track, 
     ProjectEventDispatcher &dispatcher) noexcept :
@@ -30,8 +31,7 @@ AnnotationsSequence::AnnotationsSequence(MidiTrack &track,
 // Import/export
 //===----------------------------------------------------------------------===//
 
-void AnnotationsSequence::importMidi(const MidiMessageSequence &sequence,
-    short timeFormat, Optional<int> customFilter)
+void AnnotationsSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
     this->clearUndoHistory();
     this->checkpoint();
@@ -132,6 +132,62 @@ bool AnnotationsSequence::change(const AnnotationEvent &oldParams,
     return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Overlap lookup
+//===----------------------------------------------------------------------===//
+
+void AnnotationsSequence::findOverlapping(float startBeat, float endBeat,
+    Array<const AnnotationEvent *> &outResult) const
+{
+    outResult.clearQuick();
+    this->updateOverlapIndexIfNeeded();
+
+    // all candidates start at or before endBeat,
+    const auto found = std::upper_bound(this->midiEvents.begin(), this->midiEvents.end(), endBeat,
+        [](float value, const MidiEvent *event) { return value < event->getBeat(); });
+
+    // and going backwards, none of them can overlap the range any more
+    // as soon as all the preceding annotations end before startBeat
+    for (int i = int(found - this->midiEvents.begin()) - 1;
+        i >= 0 && this->maxEndBeats.getUnchecked(i) >= startBeat; --i)
+    {
+        const auto *annotation = static_cast<const AnnotationEvent *>(this->midiEvents.getUnchecked(i));
+        if (annotation->getBeat() + annotation->getLength() >= startBeat)
+        {
+            outResult.add(annotation);
+        }
+    }
+
+    std::reverse(outResult.begin(), outResult.end());
+}
+
+void AnnotationsSequence::updateBeatRange(bool shouldNotifyIfChanged)
+{
+    this->isOverlapIndexOutdated = true;
+    MidiSequence::updateBeatRange(shouldNotifyIfChanged);
+}
+
+void AnnotationsSequence::updateOverlapIndexIfNeeded() const
+{
+    if (!this->isOverlapIndexOutdated)
+    {
+        return;
+    }
+
+    this->maxEndBeats.clearQuick();
+    this->maxEndBeats.ensureStorageAllocated(this->midiEvents.size());
+
+    float maxEndBeat = -FLT_MAX;
+    for (const auto *event : this->midiEvents)
+    {
+        const auto *annotation = static_cast<const AnnotationEvent *>(event);
+        maxEndBeat = jmax(maxEndBeat, annotation->getBeat() + annotation->getLength());
+        this->maxEndBeats.add(maxEndBeat);
+    }
+
+    this->isOverlapIndexOutdated = false;
+}
+
 //===----------------------------------------------------------------------===//
 // Callbacks
 //===----------------------------------------------------------------------===//
@@ -199,4 +255,124 @@ void AnnotationsSequence::reset()
 {
     this->midiEvents.clear();
     this->usedEventIds.clear();
+    this->isOverlapIndexOutdated = true;
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class AnnotationsTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    AnnotationsTestTrack() :
+        sequence(make<AnnotationsSequence>(*this, *this)) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    AnnotationsSequence &getAnnotations() const noexcept { return *this->sequence; }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<AnnotationsSequence> sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnnotationsTestTrack)
+};
+
+class AnnotationsSequenceTests final : public UnitTest
+{
+public:
+    AnnotationsSequenceTests() : UnitTest("Annotations sequence tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        AnnotationsTestTrack track;
+        auto &sequence = track.getAnnotations();
+
+        Array<const AnnotationEvent *> result;
+
+        beginTest("Overlapping annotations lookup in an empty sequence");
+        {
+            sequence.findOverlapping(-100.f, 100.f, result);
+            expect(result.isEmpty());
+        }
+
+        sequence.insert(AnnotationEvent(&sequence, 0.f, "a").withLength(4.f), false);
+        sequence.insert(AnnotationEvent(&sequence, 2.f, "b").withLength(10.f), false);
+        sequence.insert(AnnotationEvent(&sequence, 20.f, "c").withLength(1.f), false);
+        sequence.insert(AnnotationEvent(&sequence, 30.f, "d"), false);
+
+        beginTest("Overlapping annotations lookup before the first event");
+        {
+            sequence.findOverlapping(-10.f, -1.f, result);
+            expect(result.isEmpty());
+        }
+
+        beginTest("Overlapping annotations lookup exactly on an event");
+        {
+            sequence.findOverlapping(20.f, 20.f, result);
+            expectDescriptions(result, { "c" });
+
+            sequence.findOverlapping(0.f, 0.f, result);
+            expectDescriptions(result, { "a" });
+
+            // the long annotation still overlaps the ones starting later:
+            sequence.findOverlapping(3.f, 5.f, result);
+            expectDescriptions(result, { "a", "b" });
+
+            sequence.findOverlapping(12.f, 30.f, result);
+            expectDescriptions(result, { "b", "c", "d" });
+        }
+
+        beginTest("Overlapping annotations lookup after the last event");
+        {
+            sequence.findOverlapping(40.f, 50.f, result);
+            expect(result.isEmpty());
+        }
+
+        beginTest("Overlapping annotations lookup after a change");
+        {
+            const auto b = static_cast<const AnnotationEvent &>(*sequence.getUnchecked(1));
+            sequence.change(b, b.withLength(30.f), false);
+
+            sequence.findOverlapping(40.f, 50.f, result);
+            expect(result.isEmpty());
+
+            sequence.findOverlapping(25.f, 26.f, result);
+            expectDescriptions(result, { "b" });
+        }
+    }
+
+private:
+
+    void expectDescriptions(const Array<const AnnotationEvent *> &annotations,
+        const StringArray &descriptions)
+    {
+        expectEquals(annotations.size(), descriptions.size());
+        for (int i = 0; i < jmin(annotations.size(), descriptions.size()); ++i)
+        {
+            expectEquals(annotations.getUnchecked(i)->getDescription(), descriptions[i]);
+        }
+    }
+};
+
+static AnnotationsSequenceTests annotationsSequenceTests;
+
+#endif
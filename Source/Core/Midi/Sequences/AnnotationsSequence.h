@@ -31,8 +31,7 @@ public:
     // Import/export
     //===------------------------------------------------------------------===//
 
-    void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> customFilter) override;
+    void importMidi(const MidiMessageSequence &sequence, short timeFormat);
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -43,6 +42,17 @@ public:
     bool change(const AnnotationEvent &annotation,
         const AnnotationEvent &newAnnotation, bool undoable);
 
+    //===------------------------------------------------------------------===//
+    // Overlap lookup
+    //===------------------------------------------------------------------===//
+
+    // collects the annotations overlapping the given range, boundaries
+    // included, in the same order as they appear in the sequence
+    void findOverlapping(float startBeat, float endBeat,
+        Array<const AnnotationEvent *> &outResult) const;
+
+    void updateBeatRange(bool shouldNotifyIfChanged) override;
+
     //===------------------------------------------------------------------===//
     // Callbacks
     //===------------------------------------------------------------------===//
@@ -59,5 +69,13 @@ public:
 
 private:
 
+    // the events are sorted by their start beats, but the annotations
+    // have lengths, so the overlap lookup also needs the running maximum
+    // of their end beats; it is rebuilt lazily after any change, since all
+    // changes (including the checkouts) end up calling updateBeatRange
+    mutable Array<float> maxEndBeats;
+    mutable bool isOverlapIndexOutdated = true;
+    void updateOverlapIndexIfNeeded() const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnnotationsSequence);
 };
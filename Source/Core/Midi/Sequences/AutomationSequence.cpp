@@ -44,37 +44,30 @@ float AutomationSequence::getAverageControllerValue() const
 // Import/export
 //===----------------------------------------------------------------------===//
 
-void AutomationSequence::importMidi(const MidiMessageSequence &sequence,
-    short timeFormat, Optional<int> filterByCV)
+void AutomationSequence::importMidi(const Array<const MidiMessage *> &messages, short timeFormat)
 {
     this->clearUndoHistory();
     this->checkpoint();
-    
-    for (int i = 0; i < sequence.getNumEvents(); ++i)
+
+    this->midiEvents.ensureStorageAllocated(this->midiEvents.size() + messages.size());
+
+    for (const auto *message : messages)
     {
-        const auto &message = sequence.getEventPointer(i)->message;
-        const float startBeat = MidiSequence::midiTicksToBeats(message.getTimeStamp(), timeFormat);
+        const float startBeat = MidiSequence::midiTicksToBeats(message->getTimeStamp(), timeFormat);
 
-        if (message.isController())
+        if (message->isController())
         {
-            if (filterByCV.hasValue() &&
-                message.getControllerNumber() != *filterByCV)
-            {
-                continue;
-            }
-
-            const int controllerValue = message.getControllerValue();
-            const AutomationEvent event(this, startBeat, float(controllerValue) / 127.f);
-            this->importMidiEvent<AutomationEvent>(event);
+            const int controllerValue = message->getControllerValue();
+            this->midiEvents.add(new AutomationEvent(this, startBeat, float(controllerValue) / 127.f));
         }
-        else if (message.isTempoMetaEvent())
+        else if (message->isTempoMetaEvent())
         {
-            const float controllerValue = Transport::getControllerValueByTempo(message.getTempoSecondsPerQuarterNote());
-            const AutomationEvent event(this, startBeat, controllerValue);
-            this->importMidiEvent<AutomationEvent>(event);
+            const float controllerValue = Transport::getControllerValueByTempo(message->getTempoSecondsPerQuarterNote());
+            this->midiEvents.add(new AutomationEvent(this, startBeat, controllerValue));
         }
     }
-    
+
+    this->sort<AutomationEvent>();
     this->updateBeatRange(false);
 }
 
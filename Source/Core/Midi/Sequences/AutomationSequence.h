@@ -56,8 +56,9 @@ public:
     // Import/export
     //===------------------------------------------------------------------===//
 
-    void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> filterByCV) override;
+    // expects the controller events of a single controller
+    // (or the tempo events), as prepared by MidiTrackDemultiplexer
+    void importMidi(const Array<const MidiMessage *> &messages, short timeFormat);
 
     //===------------------------------------------------------------------===//
     // Serializable
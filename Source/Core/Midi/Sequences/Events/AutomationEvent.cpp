@@ -21,6 +21,7 @@
 #include "Transport.h"
 #include "SerializationKeys.h"
 #include "MidiTrack.h"
+#include "ParameterAutomation.h"
 
 AutomationEvent::AutomationEvent() noexcept :
     MidiEvent(nullptr, Type::Auto, 0.f) {}
@@ -60,18 +61,26 @@ float AutomationEvent::interpolateEvents(float cv1, float cv2, float factor, flo
 void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
     const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
 {
-    MidiMessage cc;
-    const bool isTempoTrack = this->getSequence()->getTrack()->isTempoTrack();
+    const auto *track = this->getSequence()->getTrack();
+    const bool isTempoTrack = track->isTempoTrack();
+    const bool isParameterTrack = track->isPluginParameterAutomationTrack();
 
-    if (isTempoTrack)
+    const auto makeMessage = [this, isTempoTrack, isParameterTrack](float value)
     {
-        cc = MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(this->controllerValue));
-    }
-    else
-    {
-        cc = MidiMessage::controllerEvent(this->getTrackChannel(),
-            this->getTrackControllerNumber(), int(this->controllerValue * 127));
-    }
+        if (isTempoTrack)
+        {
+            return MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(value));
+        }
+        else if (isParameterTrack)
+        {
+            return ParameterAutomation::makeParameterChange(this->getTrackControllerNumber(), value);
+        }
+
+        return MidiMessage::controllerEvent(this->getTrackChannel(),
+            this->getTrackControllerNumber(), int(value * 127));
+    };
+
+    auto cc = makeMessage(this->controllerValue);
 
     const double startTime = (this->beat + clip.getBeat()) * timeFactor;
     cc.setTimeStamp(startTime);
@@ -84,7 +93,11 @@ void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
     if (!isPedalOrSwitchEvent && indexOfThis >= 0 && indexOfThis < (this->getSequence()->size() - 1))
     {
         const auto *nextEvent = static_cast<AutomationEvent *>(this->getSequence()->getUnchecked(indexOfThis + 1));
-        float interpolatedBeat = this->beat + AutomationEvent::curveInterpolationStepBeat;
+        const auto interpolationStep = isParameterTrack ?
+            AutomationEvent::parameterCurveInterpolationStepBeat :
+            AutomationEvent::curveInterpolationStepBeat;
+
+        float interpolatedBeat = this->beat + interpolationStep;
         float lastAppliedValue = this->controllerValue;
 
         while (interpolatedBeat < nextEvent->beat)
@@ -99,24 +112,14 @@ void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
             if (controllerDelta > AutomationEvent::curveInterpolationThreshold)
             {
                 const double interpolatedTs = (interpolatedBeat + clip.getBeat()) * timeFactor;
-                if (isTempoTrack)
-                {
-                    MidiMessage ci(MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(interpolatedValue)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
-                else
-                {
-                    MidiMessage ci(MidiMessage::controllerEvent(this->getTrackChannel(),
-                        this->getTrackControllerNumber(), int(interpolatedValue * 127)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
+                auto ci = makeMessage(interpolatedValue);
+                ci.setTimeStamp(interpolatedTs);
+                outSequence.addEvent(ci);
 
                 lastAppliedValue = interpolatedValue;
             }
 
-            interpolatedBeat += AutomationEvent::curveInterpolationStepBeat;
+            interpolatedBeat += interpolationStep;
         }
     }
 }
@@ -44,6 +44,8 @@ public:
     static float interpolateEvents(float cv1, float cv2, float factor, float easing);
 
     static constexpr auto curveInterpolationStepBeat = 0.25f;
+    // plugin parameters are applied sample-accurately, so they deserve smoother curves:
+    static constexpr auto parameterCurveInterpolationStepBeat = 0.0625f;
     static constexpr auto curveInterpolationThreshold = 0.0025f;
 
     AutomationEvent withBeat(float newBeat) const noexcept;
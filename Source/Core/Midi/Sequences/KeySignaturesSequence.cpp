@@ -21,6 +21,7 @@
 #include "SerializationKeys.h"
 #include "ProjectNode.h"
 #include "UndoStack.h"
+#include "MidiTrack.h"
 
 KeySignaturesSequence::KeySignaturesSequence(MidiTrack &track,
     ProjectEventDispatcher &dispatcher) noexcept :
@@ -30,8 +31,7 @@ KeySignaturesSequence::KeySignaturesSequence(MidiTrack &track,
 // Import/export
 //===----------------------------------------------------------------------===//
 
-void KeySignaturesSequence::importMidi(const MidiMessageSequence &sequence,
-    short timeFormat, Optional<int> customFilter)
+void KeySignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
     this->clearUndoHistory();
     this->checkpoint();
@@ -150,6 +150,43 @@ bool KeySignaturesSequence::change(const KeySignatureEvent &oldParams,
     return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Harmonic context lookup
+//===----------------------------------------------------------------------===//
+
+int KeySignaturesSequence::indexOfContextAt(float beat) const noexcept
+{
+    const auto found = std::upper_bound(this->midiEvents.begin(), this->midiEvents.end(), beat,
+        [](float value, const MidiEvent *event) { return value < event->getBeat(); });
+
+    return jmax(0, int(found - this->midiEvents.begin()) - 1);
+}
+
+const KeySignatureEvent *KeySignaturesSequence::findContextAt(float beat) const noexcept
+{
+    if (this->midiEvents.isEmpty())
+    {
+        return nullptr;
+    }
+
+    const auto index = this->indexOfContextAt(beat);
+    return static_cast<const KeySignatureEvent *>(this->midiEvents.getUnchecked(index));
+}
+
+bool KeySignaturesSequence::hasChangesWithin(float startBeat, float endBeat) const noexcept
+{
+    if (this->midiEvents.isEmpty())
+    {
+        return false;
+    }
+
+    // the event right after the context always starts later than startBeat,
+    // so it's the only one to check, since all further events are sorted
+    const auto nextIndex = this->indexOfContextAt(startBeat) + 1;
+    return nextIndex < this->midiEvents.size() &&
+        this->midiEvents.getUnchecked(nextIndex)->getBeat() < endBeat;
+}
+
 //===----------------------------------------------------------------------===//
 // Serializable
 //===----------------------------------------------------------------------===//
@@ -205,3 +242,93 @@ void KeySignaturesSequence::reset()
     this->midiEvents.clear();
     this->usedEventIds.clear();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class KeySignaturesTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    KeySignaturesTestTrack() :
+        sequence(make<KeySignaturesSequence>(*this, *this)) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    KeySignaturesSequence &getKeySignatures() const noexcept { return *this->sequence; }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<KeySignaturesSequence> sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeySignaturesTestTrack)
+};
+
+class KeySignaturesSequenceTests final : public UnitTest
+{
+public:
+    KeySignaturesSequenceTests() : UnitTest("Key signatures sequence tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        KeySignaturesTestTrack track;
+        auto &sequence = track.getKeySignatures();
+
+        beginTest("Harmonic context lookup in an empty sequence");
+        {
+            expect(sequence.findContextAt(0.f) == nullptr);
+            expect(!sequence.hasChangesWithin(-100.f, 100.f));
+        }
+
+        const auto scale = Scale::makeNaturalMajorScale();
+        sequence.insert(KeySignatureEvent(&sequence, scale, 4.f, 0), false);
+        sequence.insert(KeySignatureEvent(&sequence, scale, 8.f, 2), false);
+        sequence.insert(KeySignatureEvent(&sequence, scale, 16.f, 4), false);
+
+        beginTest("Harmonic context lookup before the first event");
+        {
+            // the first key signature applies to everything before it
+            expectEquals(sequence.findContextAt(0.f)->getRootKey(), 0);
+            expect(!sequence.hasChangesWithin(0.f, 5.f));
+            expect(sequence.hasChangesWithin(0.f, 9.f));
+        }
+
+        beginTest("Harmonic context lookup exactly on an event");
+        {
+            expectEquals(sequence.findContextAt(4.f)->getRootKey(), 0);
+            expectEquals(sequence.findContextAt(8.f)->getRootKey(), 2);
+            expectEquals(sequence.findContextAt(16.f)->getRootKey(), 4);
+            expect(!sequence.hasChangesWithin(8.f, 16.f));
+            expect(sequence.hasChangesWithin(8.f, 16.5f));
+            expect(sequence.hasChangesWithin(7.f, 8.5f));
+        }
+
+        beginTest("Harmonic context lookup after the last event");
+        {
+            expectEquals(sequence.findContextAt(100.f)->getRootKey(), 4);
+            expect(!sequence.hasChangesWithin(16.f, 200.f));
+            expect(!sequence.hasChangesWithin(100.f, 200.f));
+        }
+    }
+};
+
+static KeySignaturesSequenceTests keySignaturesSequenceTests;
+
+#endif
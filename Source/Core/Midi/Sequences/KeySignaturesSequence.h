@@ -31,8 +31,7 @@ public:
     // Import/export
     //===------------------------------------------------------------------===//
 
-    void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> customFilter) override;
+    void importMidi(const MidiMessageSequence &sequence, short timeFormat);
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -44,6 +43,22 @@ public:
         const KeySignatureEvent &newSignature,
         bool undoable);
 
+    //===------------------------------------------------------------------===//
+    // Harmonic context lookup
+    //===------------------------------------------------------------------===//
+
+    // the events are always kept sorted by beat, so they serve as their own
+    // interval index, and both lookups are binary searches, not linear scans
+
+    // the key signature in effect at the given beat, i.e. the last one
+    // starting at or before it, or the first one, if all of them start later;
+    // returns nullptr only if the sequence is empty
+    const KeySignatureEvent *findContextAt(float beat) const noexcept;
+
+    // returns true if the context found at startBeat is followed by
+    // another key signature which starts before endBeat
+    bool hasChangesWithin(float startBeat, float endBeat) const noexcept;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -54,6 +69,8 @@ public:
 
 private:
 
+    int indexOfContextAt(float beat) const noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeySignaturesSequence);
     JUCE_DECLARE_WEAK_REFERENCEABLE(KeySignaturesSequence);
 };
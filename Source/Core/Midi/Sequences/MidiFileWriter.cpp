@@ -0,0 +1,327 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "MidiFileWriter.h"
+
+MidiFileWriter::MidiFileWriter(OutputStream &stream,
+    int ticksPerQuarterNote, int midiFileType,
+    bool shouldCloseRetriggeredNotes /*= false*/) noexcept :
+    stream(stream),
+    ticksPerQuarterNote(ticksPerQuarterNote),
+    midiFileType(midiFileType),
+    shouldCloseRetriggeredNotes(shouldCloseRetriggeredNotes)
+{
+    jassert(midiFileType == 0 || midiFileType == 1);
+    jassert(ticksPerQuarterNote > 0 && ticksPerQuarterNote <= 0x7fff);
+}
+
+bool MidiFileWriter::writeHeader(int numTracks)
+{
+    jassert(this->midiFileType != 0 || numTracks == 1);
+
+    return this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MThd"))) &&
+        this->stream.writeIntBigEndian(6) &&
+        this->stream.writeShortBigEndian(short(this->midiFileType)) &&
+        this->stream.writeShortBigEndian(short(numTracks)) &&
+        this->stream.writeShortBigEndian(short(this->ticksPerQuarterNote));
+}
+
+bool MidiFileWriter::writeTrack(const OwnedArray<MidiMessageSequence> &sortedSequences,
+    double ticksOffset /*= 0.0*/)
+{
+    // a k-way merge with a min-heap of cursors, one per sequence,
+    // ordered by timestamp first, and by the sequence index next:
+    static const auto isLater = [](const MergeCursor &a, const MergeCursor &b)
+    {
+        return a.timestamp > b.timestamp ||
+            (a.timestamp == b.timestamp && a.sequenceIndex > b.sequenceIndex);
+    };
+
+    this->trackChunk.reset();
+    this->mergeHeap.clearQuick();
+
+    this->lastTick = 0;
+    this->lastStatusByte = 0;
+    zeromem(this->unmatchedNoteOns, sizeof(this->unmatchedNoteOns));
+
+    for (int i = 0; i < sortedSequences.size(); ++i)
+    {
+        if (sortedSequences.getUnchecked(i)->getNumEvents() > 0)
+        {
+            this->mergeHeap.add({ sortedSequences.getUnchecked(i)->getEventTime(0), i, 0 });
+        }
+    }
+
+    std::make_heap(this->mergeHeap.begin(), this->mergeHeap.end(), isLater);
+
+    while (!this->mergeHeap.isEmpty())
+    {
+        std::pop_heap(this->mergeHeap.begin(), this->mergeHeap.end(), isLater);
+        auto cursor = this->mergeHeap.getLast();
+        this->mergeHeap.removeLast();
+
+        const auto *sequence = sortedSequences.getUnchecked(cursor.sequenceIndex);
+        const auto &message = sequence->getEventPointer(cursor.eventIndex)->message;
+
+        if (++cursor.eventIndex < sequence->getNumEvents())
+        {
+            cursor.timestamp = sequence->getEventTime(cursor.eventIndex);
+            this->mergeHeap.add(cursor);
+            std::push_heap(this->mergeHeap.begin(), this->mergeHeap.end(), isLater);
+        }
+
+        // the end of track is written once, after all merged events
+        if (message.isEndOfTrackMetaEvent())
+        {
+            continue;
+        }
+
+        const auto tick = roundToInt(message.getTimeStamp() + ticksOffset);
+
+        if (this->shouldCloseRetriggeredNotes && (message.isNoteOn() || message.isNoteOff()))
+        {
+            auto &isUnmatched = this->unmatchedNoteOns
+                [message.getChannel() - 1][message.getNoteNumber()];
+
+            if (message.isNoteOn() && isUnmatched)
+            {
+                const auto noteOff = MidiMessage::noteOff(message.getChannel(), message.getNoteNumber());
+                this->writeEvent(noteOff.getRawData(), noteOff.getRawDataSize(), tick);
+            }
+
+            isUnmatched = message.isNoteOn();
+        }
+
+        this->writeEvent(message.getRawData(), message.getRawDataSize(), tick);
+    }
+
+    this->trackChunk.writeByte(0);
+    const auto endOfTrack = MidiMessage::endOfTrack();
+    this->trackChunk.write(endOfTrack.getRawData(), size_t(endOfTrack.getRawDataSize()));
+
+    return this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MTrk"))) &&
+        this->stream.writeIntBigEndian(int(this->trackChunk.getDataSize())) &&
+        this->stream.write(this->trackChunk.getData(), this->trackChunk.getDataSize());
+}
+
+void MidiFileWriter::writeEvent(const uint8 *data, int dataSize, int tick)
+{
+    writeVariableLengthInt(this->trackChunk, uint32(jmax(0, tick - this->lastTick)));
+    this->lastTick = tick;
+
+    const auto statusByte = data[0];
+
+    if (statusByte == this->lastStatusByte && (statusByte & 0xf0) != 0xf0 && dataSize > 1)
+    {
+        // running status
+        ++data;
+        --dataSize;
+    }
+    else if (statusByte == 0xf0)
+    {
+        // sysex has its length written after the status byte
+        this->trackChunk.writeByte(char(statusByte));
+        ++data;
+        --dataSize;
+        writeVariableLengthInt(this->trackChunk, uint32(dataSize));
+    }
+
+    this->trackChunk.write(data, size_t(dataSize));
+    this->lastStatusByte = statusByte;
+}
+
+void MidiFileWriter::writeVariableLengthInt(OutputStream &out, uint32 value)
+{
+    auto buffer = value & 0x7f;
+
+    while ((value >>= 7) != 0)
+    {
+        buffer <<= 8;
+        buffer |= ((value & 0x7f) | 0x80);
+    }
+
+    for (;;)
+    {
+        out.writeByte(char(buffer));
+
+        if ((buffer & 0x80) == 0)
+        {
+            break;
+        }
+
+        buffer >>= 8;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class MidiFileWriterTests final : public UnitTest
+{
+public:
+    MidiFileWriterTests() : UnitTest("Streaming MIDI file writer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        Random random(7);
+
+        OwnedArray<MidiMessageSequence> sequences;
+        for (int i = 0; i < 8; ++i)
+        {
+            auto *sequence = sequences.add(new MidiMessageSequence());
+            for (int j = 0; j < 1000; ++j)
+            {
+                const auto ticks = double(random.nextInt(10000));
+                sequence->addEvent(MidiMessage::noteOn(1 + i, 60 + random.nextInt(12), uint8(100)), ticks);
+                sequence->addEvent(MidiMessage::noteOff(1 + i, 60), ticks + 120.0);
+                sequence->addEvent(MidiMessage::controllerEvent(1 + i, 7, random.nextInt(128)), ticks);
+            }
+        }
+
+        beginTest("Type 1 output matches JUCE's MidiFile");
+        {
+            MidiFile expectedFile;
+            expectedFile.setTicksPerQuarterNote(480);
+
+            for (const auto *sequence : sequences)
+            {
+                MidiMessageSequence track(*sequence);
+                track.addTimeToMessages(-100.0);
+                expectedFile.addTrack(track);
+            }
+
+            MemoryOutputStream expected;
+            expectedFile.writeTo(expected, 1);
+
+            MemoryOutputStream actual;
+            MidiFileWriter writer(actual, 480, 1);
+            expect(writer.writeHeader(sequences.size()));
+            for (auto *sequence : sequences)
+            {
+                OwnedArray<MidiMessageSequence> singleTrack;
+                singleTrack.add(new MidiMessageSequence(*sequence));
+                expect(writer.writeTrack(singleTrack, -100.0));
+            }
+
+            expect(expected.getMemoryBlock() == actual.getMemoryBlock());
+        }
+
+        beginTest("Type 0 output merges all sequences in order");
+        {
+            // adding the sequences one after another keeps the order
+            // of events with equal timestamps the same as in the merge
+            MidiMessageSequence merged;
+            for (const auto *sequence : sequences)
+            {
+                for (const auto *event : *sequence)
+                {
+                    merged.addEvent(event->message);
+                }
+            }
+
+            MidiFile expectedFile;
+            expectedFile.setTicksPerQuarterNote(96);
+            expectedFile.addTrack(merged);
+
+            MemoryOutputStream expected;
+            expectedFile.writeTo(expected, 0);
+
+            MemoryOutputStream actual;
+            MidiFileWriter writer(actual, 96, 0);
+            expect(writer.writeHeader(1));
+            expect(writer.writeTrack(sequences));
+
+            expect(expected.getMemoryBlock() == actual.getMemoryBlock());
+
+            MemoryInputStream in(actual.getData(), actual.getDataSize(), false);
+            MidiFile importedFile;
+            expect(importedFile.readFrom(in, false));
+            expectEquals(importedFile.getNumTracks(), 1);
+            expectEquals(importedFile.getTimeFormat(), short(96));
+            expect(importedFile.getTrack(0)->getNumEvents() >= merged.getNumEvents());
+        }
+
+        beginTest("Retriggered notes are closed like in the matched pairs export");
+        {
+            // overlapping notes of the same key in two clips of the same track:
+            OwnedArray<MidiMessageSequence> clips;
+            auto *clip1 = clips.add(new MidiMessageSequence());
+            clip1->addEvent(MidiMessage::noteOn(1, 60, uint8(100)), 0.0);
+            clip1->addEvent(MidiMessage::noteOff(1, 60), 100.0);
+            clip1->addEvent(MidiMessage::noteOn(1, 60, uint8(90)), 200.0);
+            clip1->addEvent(MidiMessage::noteOn(1, 60, uint8(80)), 250.0);
+            clip1->addEvent(MidiMessage::noteOff(1, 60), 300.0);
+            clip1->addEvent(MidiMessage::noteOff(1, 60), 350.0);
+            auto *clip2 = clips.add(new MidiMessageSequence());
+            clip2->addEvent(MidiMessage::noteOn(1, 60, uint8(70)), 50.0);
+            clip2->addEvent(MidiMessage::noteOn(2, 60, uint8(70)), 60.0);
+            clip2->addEvent(MidiMessage::noteOff(1, 60), 150.0);
+            clip2->addEvent(MidiMessage::noteOff(2, 60), 160.0);
+
+            const auto expectMatchedPairsExport = [this](const OwnedArray<MidiMessageSequence> &tracks)
+            {
+                // this is how the project export worked with MidiFile:
+                MidiMessageSequence merged;
+                for (const auto *track : tracks)
+                {
+                    merged.addSequence(*track, 0.0);
+                    merged.updateMatchedPairs();
+                }
+
+                MidiFile expectedFile;
+                expectedFile.setTicksPerQuarterNote(960);
+                expectedFile.addTrack(merged);
+
+                MemoryOutputStream expected;
+                expectedFile.writeTo(expected, 1);
+
+                MemoryOutputStream actual;
+                MidiFileWriter writer(actual, 960, 1, true);
+                expect(writer.writeHeader(1));
+                expect(writer.writeTrack(tracks));
+
+                expect(expected.getMemoryBlock() == actual.getMemoryBlock());
+            };
+
+            expectMatchedPairsExport(clips);
+
+            // the random sequences have lots of retriggered notes:
+            expectMatchedPairsExport(sequences);
+
+            // and the writer without closing them writes them as they are
+            MemoryOutputStream closed;
+            MidiFileWriter closingWriter(closed, 960, 1, true);
+            closingWriter.writeHeader(1);
+            closingWriter.writeTrack(clips);
+
+            MemoryOutputStream unclosed;
+            MidiFileWriter writer(unclosed, 960, 1);
+            writer.writeHeader(1);
+            writer.writeTrack(clips);
+
+            expect(closed.getDataSize() > unclosed.getDataSize());
+        }
+    }
+};
+
+static MidiFileWriterTests midiFileWriterTests;
+
+#endif
@@ -0,0 +1,79 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A streaming Standard MIDI File writer: unlike JUCE's MidiFile,
+// it doesn't need the whole song in memory; instead, each track chunk
+// is merged right away from several sorted sequences (typically one
+// per exported clip), and encoded straight into the output stream.
+
+class MidiFileWriter final
+{
+public:
+
+    // SMF type 0 contains a single track chunk,
+    // type 1 contains several simultaneous track chunks
+    // when closing retriggered notes, a note-on of a key that is still
+    // sounding in the same channel is preceded by a note-off, just like
+    // MidiMessageSequence::updateMatchedPairs does for the whole track
+    MidiFileWriter(OutputStream &stream,
+        int ticksPerQuarterNote, int midiFileType,
+        bool shouldCloseRetriggeredNotes = false) noexcept;
+
+    bool writeHeader(int numTracks);
+
+    // the sequences are expected to be timestamped in ticks and sorted;
+    // the events with equal timestamps keep the order of the sequences,
+    // as if all sequences were added one after another into a single one
+    bool writeTrack(const OwnedArray<MidiMessageSequence> &sortedSequences,
+        double ticksOffset = 0.0);
+
+private:
+
+    void writeEvent(const uint8 *data, int dataSize, int tick);
+
+    static void writeVariableLengthInt(OutputStream &out, uint32 value);
+
+    OutputStream &stream;
+
+    const int ticksPerQuarterNote;
+    const int midiFileType;
+    const bool shouldCloseRetriggeredNotes;
+
+    int lastTick = 0;
+    uint8 lastStatusByte = 0;
+
+    // the note-ons, which were not yet followed by
+    // a note-on or a note-off of the same key
+    bool unmatchedNoteOns[Globals::numChannels][128];
+
+    // only the current track chunk is kept in memory,
+    // because the chunk header has to contain its size
+    MemoryOutputStream trackChunk;
+
+    struct MergeCursor final
+    {
+        double timestamp;
+        int sequenceIndex;
+        int eventIndex;
+    };
+
+    Array<MergeCursor> mergeHeap;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiFileWriter)
+};
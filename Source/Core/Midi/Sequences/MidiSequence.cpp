@@ -29,7 +29,8 @@ struct EventIdGenerator final
     {
         jassert(length <= 4);
         MidiEvent::Id id = 0;
-        static Random r;
+        // new events are also created by clip modifiers in background threads
+        thread_local Random r;
         r.setSeedRandomly();
         static const char idChars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
         for (int i = 0; i < length; ++i)
@@ -114,8 +115,6 @@ void MidiSequence::exportMidi(MidiMessageSequence &outSequence,
             event->exportMessages(outSequence, clip, keyMap, timeFactor);
         }
     }
-
-    outSequence.updateMatchedPairs();
 }
 
 float MidiSequence::midiTicksToBeats(double ticks, int timeFormat) noexcept
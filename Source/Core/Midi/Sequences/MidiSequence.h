@@ -51,8 +51,10 @@ public:
     //===------------------------------------------------------------------===//
 
     static float midiTicksToBeats(double ticks, int timeFormat) noexcept;
-    virtual void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> customFilter) = 0;
+
+    // appends the clip's events into the sorted sequence; note that it
+    // doesn't update the matched note pairs, since the file export
+    // doesn't need them: call updateMatchedPairs() when done, if needed
     virtual void exportMidi(MidiMessageSequence &outSequence,
         const Clip &clip, const KeyboardMapping &keyMap,
         GeneratedSequenceBuilder &generatedSequences,
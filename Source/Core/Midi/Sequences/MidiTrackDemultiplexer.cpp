@@ -0,0 +1,342 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "MidiTrackDemultiplexer.h"
+#include "MidiTrack.h"
+
+void MidiTrackDemultiplexer::demultiplex(const MidiMessageSequence &track)
+{
+    this->reset();
+
+    for (int i = 0; i < track.getNumEvents(); ++i)
+    {
+        const auto &message = track.getEventPointer(i)->message;
+        const auto channel = jlimit(1, Globals::numChannels, message.getChannel());
+
+        if (message.isNoteOn())
+        {
+            this->startNote(channel, message.getNoteNumber(),
+                message.getTimeStamp(), message.getVelocity());
+        }
+        else if (message.isNoteOff())
+        {
+            this->endNote(channel, message.getNoteNumber(), message.getTimeStamp());
+        }
+        else if (message.isController())
+        {
+            auto &events = this->controllers[message.getControllerNumber()];
+            if (events.messages.isEmpty())
+            {
+                events.channel = channel;
+            }
+
+            events.messages.add(&message);
+        }
+        else if (message.isTempoMetaEvent())
+        {
+            auto &events = this->controllers[MidiTrack::DefaultControllers::tempoController];
+            if (events.messages.isEmpty())
+            {
+                events.channel = channel;
+            }
+
+            events.messages.add(&message);
+        }
+        else if (message.isTrackNameEvent())
+        {
+            this->trackName = message.getTextFromTextMetaEvent();
+        }
+        else if (message.isTextMetaEvent() ||
+            message.isKeySignatureMetaEvent() ||
+            message.isTimeSignatureMetaEvent())
+        {
+            this->timelineEvents.addEvent(message);
+        }
+    }
+}
+
+const String &MidiTrackDemultiplexer::getTrackName() const noexcept
+{
+    return this->trackName;
+}
+
+Array<int> MidiTrackDemultiplexer::getNoteChannels() const
+{
+    Array<int> result;
+
+    for (int i = 0; i < Globals::numChannels; ++i)
+    {
+        if (this->hasNoteEvents[i])
+        {
+            result.add(i + 1);
+        }
+    }
+
+    return result;
+}
+
+const Array<MidiTrackDemultiplexer::ImportedNote> &MidiTrackDemultiplexer::getNotes(int channel) const noexcept
+{
+    jassert(channel >= 1 && channel <= Globals::numChannels);
+    return this->notes[channel - 1];
+}
+
+const MidiTrackDemultiplexer::ImportedControllers &MidiTrackDemultiplexer::getControllers() const noexcept
+{
+    return this->controllers;
+}
+
+const MidiMessageSequence &MidiTrackDemultiplexer::getTimelineEvents() const noexcept
+{
+    return this->timelineEvents;
+}
+
+void MidiTrackDemultiplexer::reset()
+{
+    for (auto &pendingNote : this->pendingNotes)
+    {
+        pendingNote = {};
+    }
+
+    for (int i = 0; i < Globals::numChannels; ++i)
+    {
+        this->notes[i].clearQuick();
+        this->hasNoteEvents[i] = false;
+    }
+
+    this->controllers.clear();
+    this->timelineEvents.clear();
+    this->trackName = {};
+}
+
+void MidiTrackDemultiplexer::startNote(int channel, int key, double ticks, uint8 velocity)
+{
+    this->hasNoteEvents[channel - 1] = true;
+
+    auto &pendingNote = this->pendingNotes[(channel - 1) * numKeys + key];
+    if (pendingNote.isPending)
+    {
+        this->notes[channel - 1].add({ pendingNote.startTicks, ticks, key, pendingNote.velocity });
+    }
+
+    pendingNote.startTicks = ticks;
+    pendingNote.velocity = velocity;
+    pendingNote.isPending = true;
+}
+
+void MidiTrackDemultiplexer::endNote(int channel, int key, double ticks)
+{
+    this->hasNoteEvents[channel - 1] = true;
+
+    auto &pendingNote = this->pendingNotes[(channel - 1) * numKeys + key];
+    if (pendingNote.isPending)
+    {
+        this->notes[channel - 1].add({ pendingNote.startTicks, ticks, key, pendingNote.velocity });
+        pendingNote.isPending = false;
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class MidiTrackDemultiplexerTests final : public UnitTest
+{
+public:
+    MidiTrackDemultiplexerTests() : UnitTest("MIDI track demultiplexer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Demultiplexing channels, controllers and meta events");
+        {
+            MidiMessageSequence track;
+            track.addEvent(MidiMessage::textMetaEvent(3, "Piano"), 0.0);
+            track.addEvent(MidiMessage::timeSignatureMetaEvent(3, 4), 0.0);
+            track.addEvent(MidiMessage::tempoMetaEvent(500000), 0.0);
+            track.addEvent(MidiMessage::noteOn(1, 60, uint8(100)), 0.0);
+            track.addEvent(MidiMessage::noteOn(2, 64, uint8(90)), 10.0);
+            track.addEvent(MidiMessage::controllerEvent(3, 7, 100), 15.0);
+            track.addEvent(MidiMessage::noteOff(1, 60), 20.0);
+            track.addEvent(MidiMessage::textMetaEvent(1, "Chorus"), 25.0);
+            track.addEvent(MidiMessage::noteOn(1, 60, uint8(80)), 30.0);
+            track.addEvent(MidiMessage::controllerEvent(5, 7, 50), 35.0);
+            track.addEvent(MidiMessage::controllerEvent(1, 1, 64), 35.0);
+            // a repeated note-on ends the previous one:
+            track.addEvent(MidiMessage::noteOn(1, 60, uint8(70)), 40.0);
+            // a note-on with zero velocity is a note-off:
+            track.addEvent(MidiMessage::noteOn(2, 64, uint8(0)), 50.0);
+            track.addEvent(MidiMessage::noteOff(1, 60), 60.0);
+            // the orphaned note-off and the note without note-off are skipped:
+            track.addEvent(MidiMessage::noteOff(1, 72), 70.0);
+            track.addEvent(MidiMessage::noteOn(3, 48, uint8(60)), 80.0);
+
+            auto demultiplexer = make<MidiTrackDemultiplexer>();
+            demultiplexer->demultiplex(track);
+
+            expectEquals(demultiplexer->getTrackName(), String("Piano"));
+            expectEquals(demultiplexer->getTimelineEvents().getNumEvents(), 2);
+            expect(demultiplexer->getNoteChannels() == Array<int>(1, 2, 3));
+
+            const auto &channel1 = demultiplexer->getNotes(1);
+            expectEquals(channel1.size(), 3);
+            expectEquals(channel1[0].startTicks, 0.0);
+            expectEquals(channel1[0].endTicks, 20.0);
+            expectEquals(int(channel1[0].velocity), 100);
+            expectEquals(channel1[1].startTicks, 30.0);
+            expectEquals(channel1[1].endTicks, 40.0);
+            expectEquals(channel1[2].startTicks, 40.0);
+            expectEquals(channel1[2].endTicks, 60.0);
+            expectEquals(int(channel1[2].velocity), 70);
+
+            const auto &channel2 = demultiplexer->getNotes(2);
+            expectEquals(channel2.size(), 1);
+            expectEquals(channel2[0].key, 64);
+            expectEquals(channel2[0].endTicks, 50.0);
+
+            expect(demultiplexer->getNotes(3).isEmpty());
+
+            const auto &controllers = demultiplexer->getControllers();
+            expectEquals(int(controllers.size()), 3);
+            expectEquals(controllers.at(7).channel, 3);
+            expectEquals(controllers.at(7).messages.size(), 2);
+            expectEquals(controllers.at(1).messages.size(), 1);
+            expectEquals(controllers.at(MidiTrack::DefaultControllers::tempoController).messages.size(), 1);
+        }
+
+        beginTest("Note pairing matches JUCE's matched pairs");
+        {
+            Random random(42);
+            const auto track = generateTrack(random, 20000, 4, 8, 0);
+
+            auto demultiplexer = make<MidiTrackDemultiplexer>();
+            demultiplexer->demultiplex(track);
+
+            MidiMessageSequence reference(track);
+            reference.updateMatchedPairs();
+
+            for (int channel = 1; channel <= 4; ++channel)
+            {
+                Array<std::pair<double, double>> expectedNotes;
+                for (int i = 0; i < reference.getNumEvents(); ++i)
+                {
+                    const auto &message = reference.getEventPointer(i)->message;
+                    const auto noteOffIndex = reference.getIndexOfMatchingKeyUp(i);
+                    if (message.isNoteOn() && message.getChannel() == channel && noteOffIndex > 0)
+                    {
+                        const auto endTicks = reference.getEventPointer(noteOffIndex)->message.getTimeStamp();
+                        expectedNotes.add({ message.getTimeStamp() * 128 + message.getNoteNumber(), endTicks });
+                    }
+                }
+
+                Array<std::pair<double, double>> actualNotes;
+                for (const auto &note : demultiplexer->getNotes(channel))
+                {
+                    actualNotes.add({ note.startTicks * 128 + note.key, note.endTicks });
+                }
+
+                std::sort(expectedNotes.begin(), expectedNotes.end());
+                std::sort(actualNotes.begin(), actualNotes.end());
+                expect(expectedNotes == actualNotes);
+            }
+        }
+
+        beginTest("Demultiplexing large generated MIDI files");
+        {
+            Random random(1);
+
+            // a dense single-channel piano dump, an orchestral score
+            // with all 16 channels in use, and a controller-heavy track
+            benchmark("piano", generateTrack(random, 250000, 1, 88, 0));
+            benchmark("orchestral", generateTrack(random, 250000, 16, 48, 0));
+            benchmark("controllers", generateTrack(random, 250000, 4, 24, 8));
+        }
+    }
+
+private:
+
+    void benchmark(const String &name, const MidiMessageSequence &track)
+    {
+        MidiFile file;
+        file.setTicksPerQuarterNote(960);
+        file.addTrack(track);
+
+        MemoryOutputStream out;
+        file.writeTo(out);
+
+        const auto startTime = Time::getMillisecondCounterHiRes();
+
+        MemoryInputStream in(out.getData(), out.getDataSize(), false);
+        MidiFile importedFile;
+        expect(importedFile.readFrom(in, false));
+
+        const auto readTime = Time::getMillisecondCounterHiRes();
+
+        auto demultiplexer = make<MidiTrackDemultiplexer>();
+        demultiplexer->demultiplex(*importedFile.getTrack(0));
+
+        const auto endTime = Time::getMillisecondCounterHiRes();
+
+        int numNotes = 0;
+        for (const auto channel : demultiplexer->getNoteChannels())
+        {
+            numNotes += demultiplexer->getNotes(channel).size();
+        }
+
+        expect(numNotes > 0);
+
+        this->logMessage(name + ": " + String(track.getNumEvents()) + " events, " +
+            String(numNotes) + " notes, read in " + String(readTime - startTime, 1) +
+            " ms, demultiplexed in " + String(endTime - readTime, 1) + " ms");
+    }
+
+    // generates the overlapping notes with random lengths, the retriggered
+    // notes, and optionally the controller events, spread over the channels
+    static MidiMessageSequence generateTrack(Random &random,
+        int numEvents, int numChannels, int numKeys, int numControllers)
+    {
+        MidiMessageSequence track;
+        double ticks = 0.0;
+
+        while (track.getNumEvents() < numEvents)
+        {
+            ticks += double(random.nextInt(4) * 60);
+
+            const auto channel = 1 + random.nextInt(numChannels);
+            if (numControllers > 0 && random.nextInt(3) == 0)
+            {
+                track.addEvent(MidiMessage::controllerEvent(channel,
+                    1 + random.nextInt(numControllers), random.nextInt(128)), ticks);
+                continue;
+            }
+
+            const auto key = 21 + random.nextInt(numKeys);
+            const auto length = double(random.nextInt(16) * 60);
+            track.addEvent(MidiMessage::noteOn(channel, key, uint8(1 + random.nextInt(127))), ticks);
+            track.addEvent(MidiMessage::noteOff(channel, key), ticks + length);
+        }
+
+        track.sort();
+        return track;
+    }
+};
+
+static MidiTrackDemultiplexerTests midiTrackDemultiplexerTests;
+
+#endif
@@ -0,0 +1,103 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// The MIDI standard allows to set channels and controller numbers per-message,
+// while in Helio channels and controllers are per-track for simplicity,
+// so the imported tracks are split into several ones: notes are grouped
+// by channel (a different channel often means a different instrument),
+// and automation events are grouped by controller number.
+
+// This class does all that in a single sweep over the imported track,
+// also pairing note-ons with note-offs on the way, so that sequences
+// can bulk-load the results without rescanning the whole track.
+
+class MidiTrackDemultiplexer final
+{
+public:
+
+    MidiTrackDemultiplexer() = default;
+
+    struct ImportedNote final
+    {
+        double startTicks;
+        double endTicks;
+        int key;
+        uint8 velocity;
+    };
+
+    struct ImportedControllerEvents final
+    {
+        // picking the first found channel for each controller,
+        // which is not ideal but should be ok in practice
+        int channel = 1;
+        Array<const MidiMessage *> messages;
+    };
+
+    using ImportedControllers = FlatHashMap<int, ImportedControllerEvents>;
+
+    // the messages are referenced, not copied,
+    // so the track should outlive the demultiplexer's results
+    void demultiplex(const MidiMessageSequence &track);
+
+    const String &getTrackName() const noexcept;
+
+    // channels that have any note events, in ascending order
+    Array<int> getNoteChannels() const;
+    const Array<ImportedNote> &getNotes(int channel) const noexcept;
+
+    // automation events by controller number, where the tempo
+    // events are stored as MidiTrack::DefaultControllers::tempoController
+    const ImportedControllers &getControllers() const noexcept;
+
+    // text, key signature and time signature meta events
+    const MidiMessageSequence &getTimelineEvents() const noexcept;
+
+private:
+
+    void reset();
+
+    void startNote(int channel, int key, double ticks, uint8 velocity);
+    void endNote(int channel, int key, double ticks);
+
+    static constexpr auto numKeys = 128;
+
+    // the note-on that is still waiting for its note-off for each key
+    // in each channel; a repeated note-on of the same key ends the
+    // previous note, the same way JUCE's updateMatchedPairs does it,
+    // so this stack never gets deeper than one note
+    struct PendingNote final
+    {
+        double startTicks = 0.0;
+        uint8 velocity = 0;
+        bool isPending = false;
+    };
+
+    PendingNote pendingNotes[Globals::numChannels * numKeys];
+
+    Array<ImportedNote> notes[Globals::numChannels];
+    bool hasNoteEvents[Globals::numChannels] = {};
+
+    ImportedControllers controllers;
+
+    MidiMessageSequence timelineEvents;
+
+    String trackName;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiTrackDemultiplexer)
+};
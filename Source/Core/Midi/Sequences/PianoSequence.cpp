@@ -22,6 +22,7 @@
 #include "NoteActions.h"
 #include "SerializationKeys.h"
 #include "UndoStack.h"
+#include "MidiTrack.h"
 
 PianoSequence::PianoSequence(MidiTrack &track,
     ProjectEventDispatcher &dispatcher) noexcept :
@@ -35,6 +36,7 @@ PianoSequence::PianoSequence(MidiTrack &track,
     this->sequenceStartBeat = sequenceToCopy.sequenceStartBeat;
     this->sequenceEndBeat = sequenceToCopy.sequenceEndBeat;
     this->usedEventIds = sequenceToCopy.usedEventIds;
+    this->longestNoteLength = sequenceToCopy.longestNoteLength;
 
     for (const auto *event : sequenceToCopy.midiEvents)
     {
@@ -46,42 +48,29 @@ PianoSequence::PianoSequence(MidiTrack &track,
 // Import/export
 //===----------------------------------------------------------------------===//
 
-void PianoSequence::importMidi(const MidiMessageSequence &sequence,
-    short timeFormat, Optional<int> filterByChannel)
+void PianoSequence::importMidi(const Array<MidiTrackDemultiplexer::ImportedNote> &notes, short timeFormat)
 {
     this->clearUndoHistory();
     this->checkpoint();
 
-    for (int i = 0; i < sequence.getNumEvents(); ++i)
-    {
-        const auto &message = sequence.getEventPointer(i)->message;
+    // the notes come already paired and filtered by channel,
+    // so just add them all unsorted, and sort once in the end
+    this->midiEvents.ensureStorageAllocated(this->midiEvents.size() + notes.size());
 
-        if (filterByChannel.hasValue() &&
-            message.getChannel() != *filterByChannel)
+    for (const auto &importedNote : notes)
+    {
+        const float velocity = importedNote.velocity / 128.f;
+        const float startBeat = MidiSequence::midiTicksToBeats(importedNote.startTicks, timeFormat);
+        const float endBeat = MidiSequence::midiTicksToBeats(importedNote.endTicks, timeFormat);
+        if (endBeat > startBeat)
         {
-            continue;
-        }
-
-        if (message.isNoteOn())
-        {
-            const int key = message.getNoteNumber();
-            const float velocity = message.getVelocity() / 128.f;
-            const float startBeat = MidiSequence::midiTicksToBeats(message.getTimeStamp(), timeFormat);
-            const int noteOffIndex = sequence.getIndexOfMatchingKeyUp(i);
-            if (noteOffIndex > 0)
-            {
-                const MidiMessage &messageOff = sequence.getEventPointer(noteOffIndex)->message;
-                const float endBeat = MidiSequence::midiTicksToBeats(messageOff.getTimeStamp(), timeFormat);
-                if (endBeat > startBeat)
-                {
-                    const float length = endBeat - startBeat;
-                    const Note note(this, key, startBeat, length, velocity);
-                    this->importMidiEvent<Note>(note);
-                }
-            }
+            const float length = endBeat - startBeat;
+            this->midiEvents.add(new Note(this, importedNote.key, startBeat, length, velocity));
         }
     }
 
+    this->sort<Note>();
+    this->longestNoteLength = -1.f;
     this->updateBeatRange(false);
 }
 
@@ -101,6 +90,7 @@ MidiEvent *PianoSequence::insert(const Note &eventParams, const bool undoable)
     {
         auto *ownedNote = new Note(this, eventParams);
         this->midiEvents.addSorted(*ownedNote, ownedNote);
+        this->updateLongestNoteLength(*ownedNote);
         this->eventDispatcher.dispatchAddEvent(*ownedNote);
         this->updateBeatRange(true);
         return ownedNote;
@@ -123,9 +113,10 @@ bool PianoSequence::remove(const Note &eventParams, const bool undoable)
         jassert(index >= 0);
         if (index >= 0)
         {
-            auto *removedNote = this->midiEvents.getUnchecked(index);
+            auto *removedNote = static_cast<Note *>(this->midiEvents.getUnchecked(index));
             jassert(removedNote->isValid());
             this->eventDispatcher.dispatchRemoveEvent(*removedNote);
+            this->invalidateLongestNoteLength(*removedNote);
             this->midiEvents.remove(index, true);
             this->updateBeatRange(true);
             this->eventDispatcher.dispatchPostRemoveEvent(this);
@@ -157,6 +148,7 @@ bool PianoSequence::change(const Note &oldParams,
             changedNote->applyChanges(newParams);
             this->midiEvents.remove(index, false);
             this->midiEvents.addSorted(*changedNote, changedNote);
+            this->updateLongestNoteLength(oldParams, *changedNote);
             this->eventDispatcher.dispatchChangeEvent(oldParams, *changedNote);
             this->updateBeatRange(true);
             return true;
@@ -183,6 +175,7 @@ bool PianoSequence::insertGroup(Array<Note> &group, bool undoable)
             const Note &eventParams = group.getUnchecked(i);
             auto *ownedNote = new Note(this, eventParams);
             this->midiEvents.addSorted(*ownedNote, ownedNote);
+            this->updateLongestNoteLength(*ownedNote);
             this->eventDispatcher.dispatchAddEvent(*ownedNote);
         }
 
@@ -213,8 +206,9 @@ bool PianoSequence::removeGroup(Array<Note> &group, bool undoable)
             jassert(index >= 0);
             if (index >= 0)
             {
-                auto *removedNote = this->midiEvents.getUnchecked(index);
+                auto *removedNote = static_cast<Note *>(this->midiEvents.getUnchecked(index));
                 this->eventDispatcher.dispatchRemoveEvent(*removedNote);
+                this->invalidateLongestNoteLength(*removedNote);
                 this->midiEvents.remove(index, true);
             }
         }
@@ -265,6 +259,7 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
                 changedNote->applyChanges(newParams);
                 this->midiEvents.remove(index, false);
                 this->midiEvents.addSorted(*changedNote, changedNote);
+                this->updateLongestNoteLength(oldParams, *changedNote);
                 this->eventDispatcher.dispatchChangeEvent(oldParams, *changedNote);
             }
         }
@@ -303,6 +298,49 @@ float PianoSequence::findLastBeat() const noexcept
     return lastBeat;
 }
 
+float PianoSequence::getLongestNoteLength() const noexcept
+{
+    if (this->longestNoteLength < 0.f)
+    {
+        this->longestNoteLength = 0.f;
+        for (const auto *event : this->midiEvents)
+        {
+            this->longestNoteLength = jmax(this->longestNoteLength,
+                static_cast<const Note *>(event)->getLength());
+        }
+    }
+
+    return this->longestNoteLength;
+}
+
+void PianoSequence::updateLongestNoteLength(const Note &note) noexcept
+{
+    if (this->longestNoteLength >= 0.f)
+    {
+        this->longestNoteLength = jmax(this->longestNoteLength, note.getLength());
+    }
+}
+
+void PianoSequence::updateLongestNoteLength(const Note &oldNote, const Note &newNote) noexcept
+{
+    if (newNote.getLength() < oldNote.getLength())
+    {
+        this->invalidateLongestNoteLength(oldNote);
+    }
+    else
+    {
+        this->updateLongestNoteLength(newNote);
+    }
+}
+
+void PianoSequence::invalidateLongestNoteLength(const Note &removedNote) noexcept
+{
+    if (removedNote.getLength() >= this->longestNoteLength)
+    {
+        this->longestNoteLength = -1.f;
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // NoteListBase
 //===----------------------------------------------------------------------===//
@@ -377,6 +415,7 @@ void PianoSequence::deserialize(const SerializedData &data)
     }
 
     this->sort<Note>();
+    this->longestNoteLength = -1.f;
     this->updateBeatRange(false);
 }
 
@@ -384,4 +423,151 @@ void PianoSequence::reset()
 {
     this->midiEvents.clear();
     this->usedEventIds.clear();
+    // the events checked out after the reset are added bypassing the editing methods
+    this->longestNoteLength = -1.f;
 }
+
+#if JUCE_UNIT_TESTS
+
+class PianoSequenceTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    PianoSequenceTestTrack() :
+        sequence(make<PianoSequence>(*this, *this)) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    PianoSequence &getNotes() const noexcept { return *this->sequence; }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<PianoSequence> sequence;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoSequenceTestTrack)
+};
+
+class PianoSequenceTests final : public UnitTest
+{
+public:
+    PianoSequenceTests() : UnitTest("Piano sequence tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        PianoSequenceTestTrack track;
+        auto &sequence = track.getNotes();
+
+        const auto findLongestNoteLength = [&sequence]()
+        {
+            float result = 0.f;
+            for (int i = 0; i < sequence.size(); ++i)
+            {
+                result = jmax(result, sequence.getNoteUnchecked(i).getLength());
+            }
+            return result;
+        };
+
+        beginTest("Longest note length follows the edits");
+        {
+            expectEquals(sequence.getLongestNoteLength(), 0.f);
+
+            sequence.insert(Note(&sequence, 60, 0.f, 1.f, 0.5f), false);
+            sequence.insert(Note(&sequence, 62, 2.f, 8.f, 0.5f), false);
+            sequence.insert(Note(&sequence, 64, 4.f, 2.f, 0.5f), false);
+            expectEquals(sequence.getLongestNoteLength(), 8.f);
+
+            // shortening the longest note
+            const auto longest = sequence.getNoteUnchecked(1);
+            sequence.change(longest, longest.withLength(0.5f), false);
+            expectEquals(sequence.getLongestNoteLength(), 2.f);
+
+            // lengthening some other note
+            const auto first = sequence.getNoteUnchecked(0);
+            sequence.change(first, first.withLength(4.f), false);
+            expectEquals(sequence.getLongestNoteLength(), 4.f);
+
+            // removing the longest note
+            sequence.remove(sequence.getNoteUnchecked(0), false);
+            expectEquals(sequence.getLongestNoteLength(), 2.f);
+
+            Array<Note> group;
+            group.add(Note(&sequence, 65, 1.f, 16.f, 0.5f));
+            group.add(Note(&sequence, 67, 3.f, 3.f, 0.5f));
+            sequence.insertGroup(group, false);
+            expectEquals(sequence.getLongestNoteLength(), 16.f);
+
+            sequence.removeGroup(group, false);
+            expectEquals(sequence.getLongestNoteLength(), 2.f);
+
+            sequence.reset();
+            expectEquals(sequence.getLongestNoteLength(), 0.f);
+        }
+
+        beginTest("Beat range queries match the brute force search");
+        {
+            Random random(35);
+            for (int i = 0; i < 200; ++i)
+            {
+                sequence.insert(Note(&sequence, random.nextInt(128),
+                    random.nextFloat() * 100.f, 0.25f + random.nextFloat() * 8.f, 0.5f), false);
+            }
+
+            for (int step = 0; step < 100; ++step)
+            {
+                // edit a random note, sometimes making it much longer or shorter
+                const auto note = sequence.getNoteUnchecked(random.nextInt(sequence.size()));
+                if (random.nextBool())
+                {
+                    sequence.change(note, note.withLength(random.nextBool() ?
+                        0.25f : random.nextFloat() * 32.f), false);
+                }
+                else
+                {
+                    sequence.remove(note, false);
+                    sequence.insert(Note(&sequence, random.nextInt(128),
+                        random.nextFloat() * 100.f, 0.25f + random.nextFloat() * 8.f, 0.5f), false);
+                }
+
+                expectEquals(sequence.getLongestNoteLength(), findLongestNoteLength());
+
+                const auto startBeat = random.nextFloat() * 120.f - 10.f;
+                const auto endBeat = startBeat + random.nextFloat() * 10.f;
+
+                FlatHashSet<MidiEvent::Id> found;
+                sequence.forEachNoteInBeatRange(startBeat, endBeat,
+                    [&found](const Note &note) { found.insert(note.getId()); });
+
+                int numExpected = 0;
+                for (int i = 0; i < sequence.size(); ++i)
+                {
+                    const auto &n = sequence.getNoteUnchecked(i);
+                    if (n.getBeat() <= endBeat && n.getBeat() + n.getLength() >= startBeat)
+                    {
+                        expect(found.contains(n.getId()));
+                        numExpected++;
+                    }
+                }
+
+                expectEquals(int(found.size()), numExpected);
+            }
+        }
+    }
+};
+
+static PianoSequenceTests pianoSequenceTests;
+
+#endif
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "MidiSequence.h"
+#include "MidiTrackDemultiplexer.h"
 #include "Note.h"
 
 class PianoRoll;
@@ -54,8 +55,7 @@ public:
     // Import/export
     //===------------------------------------------------------------------===//
 
-    void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> filterByChannel) override;
+    void importMidi(const Array<MidiTrackDemultiplexer::ImportedNote> &notes, short timeFormat);
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -78,6 +78,35 @@ public:
     const Note &getNoteUnchecked(int i) const override;
     UndoActionId generateTransactionId(int actionId) const override;
 
+    //===------------------------------------------------------------------===//
+    // Range queries
+    //===------------------------------------------------------------------===//
+
+    // sequences are sorted by beat, so the notes which may overlap the given range
+    // are found with a binary search, shifted back by the sequence's longest note
+    // to catch the notes which start before the range and still overlap it:
+    template <typename Callback>
+    void forEachNoteInBeatRange(float startBeat, float endBeat, Callback callback) const
+    {
+        const auto searchStartBeat = startBeat - this->getLongestNoteLength();
+        const auto *firstEvent = std::lower_bound(this->begin(), this->end(), searchStartBeat,
+            [](const MidiEvent *event, float beat) { return event->getBeat() < beat; });
+
+        for (auto *it = firstEvent; it != this->end() && (*it)->getBeat() <= endBeat; ++it)
+        {
+            jassert((*it)->isTypeOf(MidiEvent::Type::Note));
+            const auto *note = static_cast<const Note *>(*it);
+            if (note->getBeat() + note->getLength() >= startBeat)
+            {
+                callback(*note);
+            }
+        }
+    }
+
+    // the length of the longest note, kept up to date by the editing methods,
+    // and only recomputed after the longest note is removed or shortened
+    float getLongestNoteLength() const noexcept;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -90,6 +119,13 @@ private:
 
     float findLastBeat() const noexcept override;
 
+    void updateLongestNoteLength(const Note &note) noexcept;
+    void updateLongestNoteLength(const Note &oldNote, const Note &newNote) noexcept;
+    void invalidateLongestNoteLength(const Note &removedNote) noexcept;
+
+    // negative means it needs to be recomputed on the next request
+    mutable float longestNoteLength = -1.f;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoSequence);
     JUCE_DECLARE_WEAK_REFERENCEABLE(PianoSequence);
 };
@@ -76,10 +76,40 @@ TimeSignaturesAggregator::TimeSignaturesAggregator(ProjectNode &parentProject,
     this->project.addListener(this);
 }
 
+TimeSignaturesAggregator::TimeSignaturesAggregator(const TimeSignaturesAggregator &source, Snapshot) :
+    project(source.project),
+    timelineSignatures(source.timelineSignatures),
+    isSnapshot(true)
+{
+    // the snapshot always uses its own copy of the ordered events,
+    // and never reads the timeline's sequence it refers to
+    this->dummyEventDispatcher = make<DummyProjectEventDispatcher>(this->project);
+    this->orderedEvents = make<TimeSignaturesSequence>(*this, *this->dummyEventDispatcher.get());
+
+    for (const auto *event : *source.getSequence())
+    {
+        this->orderedEvents->appendUnsafe(static_cast<const TimeSignatureEvent &>(*event));
+    }
+
+    this->defaultNumeratorOverride = source.defaultNumeratorOverride;
+    this->defaultDenominatorOverride = source.defaultDenominatorOverride;
+    this->gridStartBeatOverride = source.gridStartBeatOverride;
+    this->defaultGridStartBeat = source.defaultGridStartBeat;
+}
+
 TimeSignaturesAggregator::~TimeSignaturesAggregator()
 {
-    this->removeAllListeners();
-    this->project.removeListener(this);
+    if (!this->isSnapshot)
+    {
+        this->removeAllListeners();
+        this->project.removeListener(this);
+    }
+}
+
+UniquePointer<TimeSignaturesAggregator> TimeSignaturesAggregator::makeSnapshot() const
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+    return UniquePointer<TimeSignaturesAggregator>(new TimeSignaturesAggregator(*this, Snapshot()));
 }
 
 static inline bool trackHasTimeSignature(MidiTrack *track) noexcept
@@ -178,13 +208,37 @@ MidiSequence *TimeSignaturesAggregator::getSequence() const noexcept
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
+// in the timeline mode, a time signature affects the grid up to the next one,
+// and the very first one also affects everything to the left of it
+static Range<float> getAffectedBeatRange(const MidiSequence &signatures, float beat) noexcept
+{
+    auto firstAffectedBeat = -FLT_MAX;
+    auto lastAffectedBeat = FLT_MAX;
+
+    for (const auto *signature : signatures)
+    {
+        if (signature->getBeat() < beat)
+        {
+            firstAffectedBeat = beat;
+        }
+        else if (signature->getBeat() > beat)
+        {
+            lastAffectedBeat = signature->getBeat();
+            break;
+        }
+    }
+
+    return { firstAffectedBeat, lastAffectedBeat };
+}
+
 void TimeSignaturesAggregator::onAddMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::TimeSignature) &&
         !this->isAggregatingTimeSignatureOverrides())
     {
         jassert(event.getSequence() == this->getSequence());
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        const auto affectedRange = getAffectedBeatRange(*this->getSequence(), event.getBeat());
+        this->notifyTimeSignaturesUpdated(affectedRange.getStart(), affectedRange.getEnd());
     }
 }
 
@@ -195,7 +249,10 @@ void TimeSignaturesAggregator::onChangeMidiEvent(const MidiEvent &oldEvent, cons
     {
         jassert(oldEvent.getSequence() == this->getSequence());
         jassert(newEvent.getSequence() == this->getSequence());
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        const auto affectedRange =
+            getAffectedBeatRange(*this->getSequence(), oldEvent.getBeat())
+                .getUnionWith(getAffectedBeatRange(*this->getSequence(), newEvent.getBeat()));
+        this->notifyTimeSignaturesUpdated(affectedRange.getStart(), affectedRange.getEnd());
     }
 }
 
@@ -204,53 +261,76 @@ void TimeSignaturesAggregator::onPostRemoveMidiEvent(MidiSequence *const sequenc
     if (sequence == this->getSequence() &&
         !this->isAggregatingTimeSignatureOverrides())
     {
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        // the removed event is unknown at this point
+        this->notifyTimeSignaturesUpdated(-FLT_MAX, FLT_MAX);
     }
 }
 
 void TimeSignaturesAggregator::onAddClip(const Clip &clip)
 {
-    if (this->isAggregatingTimeSignatureOverrides())
+    if (this->isAggregatingClipSignatures(clip))
     {
-        this->rebuildAll();
+        this->addClipSignature(clip);
+        this->updateOrderedEvents(false);
     }
 }
 
 void TimeSignaturesAggregator::onChangeClip(const Clip &oldClip, const Clip &newClip)
 {
-    if (this->isAggregatingTimeSignatureOverrides() &&
-        oldClip.getBeat() != newClip.getBeat())
+    if (oldClip.getBeat() != newClip.getBeat() &&
+        this->isAggregatingClipSignatures(newClip))
     {
-        this->rebuildAll();
+        this->removeClipSignature(oldClip);
+        this->addClipSignature(newClip);
+        this->updateOrderedEvents(false);
     }
 }
 
 void TimeSignaturesAggregator::onRemoveClip(const Clip &clip)
 {
-    if (this->isAggregatingTimeSignatureOverrides())
+    if (this->isAggregatingClipSignatures(clip) &&
+        this->removeClipSignature(clip))
     {
         this->resetGridOverrides();
-        this->rebuildAll();
+        this->updateOrderedEvents(false);
     }
 }
 
 void TimeSignaturesAggregator::onChangeTrackProperties(MidiTrack *const track)
 {
-    if (this->selectedTracks.contains(track))
+    if (!this->selectedTracks.contains(track))
+    {
+        return;
+    }
+
+    this->resetGridOverrides();
+
+    // switching between the timeline and the aggregated signatures
+    // replaces the whole sequence, so there's nothing to splice:
+    if (this->orderedEvents == nullptr ||
+        !this->isAggregatingTimeSignatureOverrides())
     {
-        // track color might have changed, or its time signature override
-        // might have been added, changed or removed:
-        this->resetGridOverrides();
         this->rebuildAll();
+        return;
     }
+
+    // track color might have changed, or its time signature override
+    // might have been added, changed or removed:
+    this->removeClipSignatures(track);
+    this->addClipSignatures(track);
+    this->updateOrderedEvents(true);
 }
 
 void TimeSignaturesAggregator::onChangeTrackBeatRange(MidiTrack *const track)
 {
-    if (this->isAggregatingTimeSignatureOverrides() &&
+    if (this->orderedEvents != nullptr &&
+        trackHasTimeSignature(track) &&
         this->selectedTracks.contains(track))
     {
-        this->rebuildAll();
+        // the sequence's first beat is a part of absolute positions
+        this->removeClipSignatures(track);
+        this->addClipSignatures(track);
+        this->updateOrderedEvents(false);
     }
 }
 
@@ -265,12 +345,23 @@ void TimeSignaturesAggregator::onRemoveTrack(MidiTrack *const track)
     jassert(this->project.getTimeline() != nullptr);
     jassert(track != this->project.getTimeline()->getTimeSignatures());
 
-    if (this->selectedTracks.contains(track))
+    if (!this->selectedTracks.contains(track))
+    {
+        return;
+    }
+
+    this->selectedTracks.removeAllInstancesOf(track);
+    this->resetGridOverrides();
+
+    if (this->orderedEvents == nullptr ||
+        !this->isAggregatingTimeSignatureOverrides())
     {
-        this->selectedTracks.removeAllInstancesOf(track);
-        this->resetGridOverrides();
         this->rebuildAll();
+        return;
     }
+
+    this->removeClipSignatures(track);
+    this->updateOrderedEvents(false);
 }
 
 void TimeSignaturesAggregator::onChangeProjectBeatRange(float firstBeat, float lastBeat)
@@ -280,113 +371,260 @@ void TimeSignaturesAggregator::onChangeProjectBeatRange(float firstBeat, float l
 
 void TimeSignaturesAggregator::onChangeViewBeatRange(float firstBeat, float lastBeat) {}
 
-struct SortByTimeSignatureAbsolutePosition final
+//===----------------------------------------------------------------------===//
+// Aggregation
+//===----------------------------------------------------------------------===//
+
+float TimeSignaturesAggregator::getClipSignatureBeat(const Clip &clip) noexcept
+{
+    const auto *track = clip.getPattern()->getTrack();
+    jassert(track->hasTimeSignatureOverride());
+
+    return clip.getBeat() +
+        track->getTimeSignatureOverride()->getBeat() +
+        track->getSequence()->getFirstBeat();
+}
+
+bool TimeSignaturesAggregator::isAggregatingClipSignatures(const Clip &clip) const noexcept
 {
-    static int compareElements(const Clip *const first, const Clip *const second)
+    if (this->orderedEvents == nullptr || clip.getPattern() == nullptr)
     {
-        const auto *firstTrack = first->getPattern()->getTrack();
-        jassert(firstTrack->hasTimeSignatureOverride());
+        return false;
+    }
+
+    auto *track = clip.getPattern()->getTrack();
+    return trackHasTimeSignature(track) && this->selectedTracks.contains(track);
+}
+
+void TimeSignaturesAggregator::addClipSignature(const Clip &clip)
+{
+    const ClipSignature clipSignature = {
+        getClipSignatureBeat(clip),
+        clip.getPattern()->getTrack(),
+        clip.getId()
+    };
+
+    // after all the signatures at the same beat, duplicate positions won't be a problem
+    const auto position = std::upper_bound(this->clipSignatures.begin(), this->clipSignatures.end(),
+        clipSignature.beat, [](float beat, const ClipSignature &other) { return beat < other.beat; });
+
+    this->clipSignatures.insert(int(position - this->clipSignatures.begin()), clipSignature);
+}
+
+bool TimeSignaturesAggregator::removeClipSignature(const Clip &clip)
+{
+    const auto *track = clip.getPattern()->getTrack();
 
-        const auto firstBeat = first->getBeat() +
-            firstTrack->getTimeSignatureOverride()->getBeat() +
-            firstTrack->getSequence()->getFirstBeat();
+    for (int i = 0; i < this->clipSignatures.size(); ++i)
+    {
+        const auto &clipSignature = this->clipSignatures.getReference(i);
+        if (clipSignature.track == track && clipSignature.clipId == clip.getId())
+        {
+            this->clipSignatures.remove(i);
+            return true;
+        }
+    }
 
-        const auto *secondTrack = second->getPattern()->getTrack();
-        jassert(secondTrack->hasTimeSignatureOverride());
+    return false;
+}
 
-        const auto secondBeat = second->getBeat() +
-            secondTrack->getTimeSignatureOverride()->getBeat() +
-            secondTrack->getSequence()->getFirstBeat();
+void TimeSignaturesAggregator::addClipSignatures(const MidiTrack *track)
+{
+    if (!track->hasTimeSignatureOverride())
+    {
+        return;
+    }
 
-        const float diff = firstBeat - secondBeat;
-        return (diff > 0.f) - (diff < 0.f);
+    // todo: multiple time signatures per track? now there can be only one
+    for (const auto *clip : track->getPattern()->getClips())
+    {
+        this->addClipSignature(*clip);
     }
-};
+}
+
+void TimeSignaturesAggregator::removeClipSignatures(const MidiTrack *track)
+{
+    this->clipSignatures.removeIf([track](const ClipSignature &clipSignature)
+    {
+        return clipSignature.track == track;
+    });
+}
 
 void TimeSignaturesAggregator::rebuildAll()
 {
+    this->clipSignatures.clearQuick();
+
     if (!this->isAggregatingTimeSignatureOverrides())
     {
         // now it will return the timeline's sequence in getSequence():
         this->orderedEvents = nullptr;
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        this->notifyTimeSignaturesUpdated(-FLT_MAX, FLT_MAX);
         return;
     }
 
-    // clear all
-    this->orderedEvents = make<TimeSignaturesSequence>(*this, *this->dummyEventDispatcher.get());
-
-    // todo: multiple time signatures per track? now there can be only one
-
-    Array<Clip *> allOrdererClips; // duplicate positions won't be a problem
     for (const auto &selectedTrack : this->selectedTracks)
     {
-        if (selectedTrack->hasTimeSignatureOverride())
+        if (trackHasTimeSignature(selectedTrack))
         {
-            allOrdererClips.addArray(selectedTrack->getPattern()->getClips());
+            this->addClipSignatures(selectedTrack);
         }
     }
-    jassert(!allOrdererClips.isEmpty());
-    static SortByTimeSignatureAbsolutePosition kSort;
-    allOrdererClips.sort(kSort);
 
+    jassert(!this->clipSignatures.isEmpty());
+
+    // the whole sequence is replaced, so everything is affected:
+    this->orderedEvents = make<TimeSignaturesSequence>(*this, *this->dummyEventDispatcher.get());
+    this->updateOrderedEvents(true);
+}
+
+static bool isSameAggregatedSignature(const TimeSignatureEvent &a, const TimeSignatureEvent &b) noexcept
+{
+    return a.getBeat() == b.getBeat() &&
+        a.getMeter() == b.getMeter() &&
+        a.getTrack() == b.getTrack();
+}
+
+void TimeSignaturesAggregator::updateOrderedEvents(bool forceNotify)
+{
+    jassert(this->orderedEvents != nullptr);
+
+    aggregateClipSignatures(this->clipSignatures, this->aggregatedSignatures);
+
+    // for now, simple as that: remember the very first one
+    // of the aggregated time signatures, and use it as the grid default
+
+    if (!this->aggregatedSignatures.isEmpty())
+    {
+        const auto &firstTimeSignature = this->aggregatedSignatures.getReference(0);
+        this->defaultNumeratorOverride = firstTimeSignature.getNumerator();
+        this->defaultDenominatorOverride = firstTimeSignature.getDenominator();
+        this->gridStartBeatOverride = firstTimeSignature.getBeat();
+    }
+
+    Range<float> affectedRange;
+    if (spliceSignatures(*this->orderedEvents, this->aggregatedSignatures,
+        this->lastGeneratedSignatureId, affectedRange))
+    {
+        this->notifyTimeSignaturesUpdated(affectedRange.getStart(), affectedRange.getEnd());
+    }
+    else if (forceNotify)
+    {
+        this->notifyTimeSignaturesUpdated(-FLT_MAX, FLT_MAX);
+    }
+}
+
+void TimeSignaturesAggregator::aggregateClipSignatures(const Array<ClipSignature> &clipSignatures,
+    Array<TimeSignatureEvent> &outSignatures)
+{
     // we're adding time signatures in such a way that continuous chunks of clips
     // will only have a time signature at the start of each chunk, instead of
     // time signatures at the start of each clip, which would be a visual noise:
+    outSignatures.clearQuick();
+
     Meter chunkStartMeter;
     float chunkStartBeat = 0.f;
-    // we'll also make sure all those time signatures have unique ids:
-    MidiEvent::Id generatedTimeSignatureId = 0;
 
-    for (const auto *clip : allOrdererClips)
+    for (const auto &clipSignature : clipSignatures)
     {
-        const auto *track = clip->getPattern()->getTrack();
-        jassert(track->hasTimeSignatureOverride());
-
-        const auto *timeSignatureOverride = track->getTimeSignatureOverride();
-        const auto sequenceFirstBeat = track->getSequence()->getFirstBeat();
-
-        const auto startBeat = clip->getBeat() +
-            timeSignatureOverride->getBeat() + sequenceFirstBeat;
-
-        // the very first chunk
-        if (!chunkStartMeter.isValid())
-        {
-            chunkStartBeat = startBeat;
-            chunkStartMeter = timeSignatureOverride->getMeter();
-            this->orderedEvents->appendUnsafe(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
-            generatedTimeSignatureId++;
+        const auto *timeSignatureOverride = clipSignature.track->getTimeSignatureOverride();
 
-            continue;
-        }
-
-        if (chunkStartMeter.isEquivalentTo(timeSignatureOverride->getMeter()) &&
-            fmodf(startBeat - chunkStartBeat, timeSignatureOverride->getBarLengthInBeats()) == 0.f)
+        if (chunkStartMeter.isValid() &&
+            chunkStartMeter.isEquivalentTo(timeSignatureOverride->getMeter()) &&
+            fmodf(clipSignature.beat - chunkStartBeat, timeSignatureOverride->getBarLengthInBeats()) == 0.f)
         {
             // this time signature is the "continuation" of the previous one, skip it:
             continue;
         }
 
         // new chunk starts here, add time signature
-        chunkStartBeat = startBeat;
+        chunkStartBeat = clipSignature.beat;
         chunkStartMeter = timeSignatureOverride->getMeter();
-        this->orderedEvents->appendUnsafe(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
-        generatedTimeSignatureId++;
+        outSignatures.add(timeSignatureOverride->withBeat(clipSignature.beat));
     }
+}
 
-    // for now, simple as that: remember the very first one
-    // of the aggregated time signatures, and use it as the grid default
+bool TimeSignaturesAggregator::spliceSignatures(TimeSignaturesSequence &sequence,
+    Array<TimeSignatureEvent> &newSignatures, MidiEvent::Id &lastGeneratedId,
+    Range<float> &outAffectedRange)
+{
+    // a clip change typically adds, removes or moves a chunk or two,
+    // so only the part between the common head and tail is replaced:
+    const auto numOldEvents = sequence.size();
+    const auto numNewEvents = newSignatures.size();
+    const auto getOldEvent = [&sequence](int index) -> const TimeSignatureEvent &
+    {
+        return *static_cast<const TimeSignatureEvent *>(sequence.getUnchecked(index));
+    };
+
+    int numCommonHead = 0;
+    while (numCommonHead < numOldEvents && numCommonHead < numNewEvents &&
+        isSameAggregatedSignature(getOldEvent(numCommonHead),
+            newSignatures.getReference(numCommonHead)))
+    {
+        numCommonHead++;
+    }
+
+    int numCommonTail = 0;
+    while (numCommonTail < numOldEvents - numCommonHead &&
+        numCommonTail < numNewEvents - numCommonHead &&
+        isSameAggregatedSignature(getOldEvent(numOldEvents - 1 - numCommonTail),
+            newSignatures.getReference(numNewEvents - 1 - numCommonTail)))
+    {
+        numCommonTail++;
+    }
+
+    const auto numEventsToRemove = numOldEvents - numCommonHead - numCommonTail;
+    const auto numEventsToInsert = numNewEvents - numCommonHead - numCommonTail;
+
+    if (numEventsToRemove == 0 && numEventsToInsert == 0)
+    {
+        return false;
+    }
+
+    // the grid is only affected from the first changed signature,
+    // or from the very left, since the first meter extends there,
+    // and up to the first unchanged signature after the changes:
+    auto firstAffectedBeat = FLT_MAX;
+    if (numCommonHead == 0)
+    {
+        firstAffectedBeat = -FLT_MAX;
+    }
+    else
+    {
+        if (numEventsToRemove > 0)
+        {
+            firstAffectedBeat = getOldEvent(numCommonHead).getBeat();
+        }
+
+        if (numEventsToInsert > 0)
+        {
+            firstAffectedBeat = jmin(firstAffectedBeat,
+                newSignatures.getReference(numCommonHead).getBeat());
+        }
+    }
+
+    const auto lastAffectedBeat = numCommonTail > 0 ?
+        getOldEvent(numOldEvents - numCommonTail).getBeat() : FLT_MAX;
+
+    outAffectedRange = { firstAffectedBeat, lastAffectedBeat };
 
-    jassert(!this->orderedEvents->isEmpty());
-    if (!this->orderedEvents->isEmpty())
+    // the unchanged time signatures keep their ids,
+    // and we'll make sure all new ones have unique ids:
+    for (int i = numCommonHead; i < numCommonHead + numEventsToInsert; ++i)
     {
-        const auto *firstTimeSignature = static_cast<const TimeSignatureEvent *>(this->orderedEvents->getUnchecked(0));
-        this->defaultNumeratorOverride = firstTimeSignature->getNumerator();
-        this->defaultDenominatorOverride = firstTimeSignature->getDenominator();
-        this->gridStartBeatOverride = firstTimeSignature->getBeat();
+        auto &signature = newSignatures.getReference(i);
+        signature = signature.withId(++lastGeneratedId);
     }
 
-    this->listeners.call(&Listener::onTimeSignaturesUpdated);
+    sequence.spliceUnsafe(numCommonHead, numEventsToRemove,
+        newSignatures.begin() + numCommonHead, numEventsToInsert);
+
+    return true;
+}
+
+void TimeSignaturesAggregator::notifyTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat)
+{
+    this->listeners.call(&Listener::onTimeSignaturesUpdated, firstAffectedBeat, lastAffectedBeat);
 }
 
 void TimeSignaturesAggregator::resetGridOverrides()
@@ -395,3 +633,188 @@ void TimeSignaturesAggregator::resetGridOverrides()
     this->defaultDenominatorOverride.reset();
     this->gridStartBeatOverride.reset();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+// a track which owns a sequence of time signatures,
+// and also has a time signature override of its own
+class TimeSignaturesTestTrack final : public VirtualMidiTrack, public ProjectEventDispatcher
+{
+public:
+
+    TimeSignaturesTestTrack(int numerator = Globals::Defaults::timeSignatureNumerator,
+        int denominator = Globals::Defaults::timeSignatureDenominator) :
+        sequence(make<TimeSignaturesSequence>(*this, *this)),
+        timeSignatureOverride(TimeSignatureEvent(WeakReference<MidiTrack>(this))
+            .withMeter(Meter({}, {}, numerator, denominator))) {}
+
+    MidiSequence *getSequence() const noexcept override { return this->sequence.get(); }
+
+    TimeSignaturesSequence &getSignatures() const noexcept { return *this->sequence; }
+
+    bool hasTimeSignatureOverride() const noexcept override { return true; }
+    const TimeSignatureEvent *getTimeSignatureOverride() const noexcept override
+    {
+        return &this->timeSignatureOverride;
+    }
+
+    void dispatchAddEvent(const MidiEvent &event) override {}
+    void dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override {}
+    void dispatchRemoveEvent(const MidiEvent &event) override {}
+    void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
+
+    void dispatchAddClip(const Clip &clip) override {}
+    void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
+    void dispatchRemoveClip(const Clip &clip) override {}
+    void dispatchPostRemoveClip(Pattern *const pattern) override {}
+
+    void dispatchChangeTrackProperties() override {}
+    void dispatchChangeTrackBeatRange() override {}
+    void dispatchChangeProjectBeatRange() override {}
+
+private:
+
+    UniquePointer<TimeSignaturesSequence> sequence;
+    TimeSignatureEvent timeSignatureOverride;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeSignaturesTestTrack)
+};
+
+class TimeSignaturesAggregatorTests final : public UnitTest
+{
+public:
+    TimeSignaturesAggregatorTests() : UnitTest("Time signatures aggregator tests", UnitTestCategories::helio) {}
+
+    using ClipSignature = TimeSignaturesAggregator::ClipSignature;
+
+    void runTest() override
+    {
+        Random random(43);
+
+        TimeSignaturesTestTrack threeFourTrack(3, 4);
+        TimeSignaturesTestTrack fourFourTrack(4, 4);
+        TimeSignaturesTestTrack fiveEightTrack(5, 8);
+        const Array<const MidiTrack *> tracks(&threeFourTrack, &fourFourTrack, &fiveEightTrack);
+
+        TimeSignaturesTestTrack splicedTrack;
+        auto &splicedSequence = splicedTrack.getSignatures();
+        MidiEvent::Id lastGeneratedId = 0;
+
+        Array<ClipSignature> clipSignatures;
+        Clip::Id lastClipId = 0;
+
+        const auto addRandomClip = [&]()
+        {
+            // the beats in bars of 3/4 and 4/4 make lots of continuous chunks
+            const ClipSignature clipSignature = {
+                float(random.nextInt(32)) * (random.nextBool() ? 3.f : 4.f),
+                tracks[random.nextInt(tracks.size())],
+                ++lastClipId
+            };
+
+            // sorted by beats the same way as in addClipSignature
+            int index = 0;
+            while (index < clipSignatures.size() &&
+                clipSignatures.getReference(index).beat <= clipSignature.beat)
+            {
+                index++;
+            }
+
+            clipSignatures.insert(index, clipSignature);
+        };
+
+        const auto spliceAndCompareWithFullRebuild = [&]()
+        {
+            Array<MidiEvent::Id> oldIds;
+            for (const auto *event : splicedSequence)
+            {
+                oldIds.add(event->getId());
+            }
+
+            Array<TimeSignatureEvent> signatures;
+            TimeSignaturesAggregator::aggregateClipSignatures(clipSignatures, signatures);
+
+            Range<float> affectedRange;
+            const auto hasChanges = TimeSignaturesAggregator::spliceSignatures(splicedSequence,
+                signatures, lastGeneratedId, affectedRange);
+
+            // a full rebuild always starts from an empty sequence
+            TimeSignaturesTestTrack rebuiltTrack;
+            auto &rebuiltSequence = rebuiltTrack.getSignatures();
+            Array<TimeSignatureEvent> rebuiltSignatures;
+            TimeSignaturesAggregator::aggregateClipSignatures(clipSignatures, rebuiltSignatures);
+            MidiEvent::Id rebuiltLastId = 0;
+            Range<float> rebuiltRange;
+            TimeSignaturesAggregator::spliceSignatures(rebuiltSequence,
+                rebuiltSignatures, rebuiltLastId, rebuiltRange);
+
+            expectEquals(splicedSequence.size(), rebuiltSequence.size());
+            for (int i = 0; i < jmin(splicedSequence.size(), rebuiltSequence.size()); ++i)
+            {
+                const auto &spliced = static_cast<const TimeSignatureEvent &>(*splicedSequence.getUnchecked(i));
+                const auto &rebuilt = static_cast<const TimeSignatureEvent &>(*rebuiltSequence.getUnchecked(i));
+                expectEquals(spliced.getBeat(), rebuilt.getBeat());
+                expect(spliced.getMeter().isEquivalentTo(rebuilt.getMeter()));
+                expect(spliced.getTrack() == rebuilt.getTrack());
+
+                // the unchanged signatures before the affected range keep their ids
+                if (hasChanges && spliced.getBeat() < affectedRange.getStart())
+                {
+                    expectEquals(spliced.getId(), oldIds[i]);
+                }
+
+                if (i > 0)
+                {
+                    expect(splicedSequence.getUnchecked(i - 1)->getBeat() <= spliced.getBeat());
+                }
+            }
+
+            FlatHashSet<MidiEvent::Id> uniqueIds;
+            for (const auto *event : splicedSequence)
+            {
+                uniqueIds.insert(event->getId());
+            }
+
+            expectEquals(int(uniqueIds.size()), splicedSequence.size());
+        };
+
+        beginTest("Splicing matches the full rebuild after adding clips");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                addRandomClip();
+                spliceAndCompareWithFullRebuild();
+            }
+        }
+
+        beginTest("Splicing matches the full rebuild after changing clips");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                // moving a clip is removing it and adding it elsewhere
+                clipSignatures.remove(random.nextInt(clipSignatures.size()));
+                addRandomClip();
+                spliceAndCompareWithFullRebuild();
+            }
+        }
+
+        beginTest("Splicing matches the full rebuild after removing clips");
+        {
+            while (!clipSignatures.isEmpty())
+            {
+                clipSignatures.remove(random.nextInt(clipSignatures.size()));
+                spliceAndCompareWithFullRebuild();
+            }
+
+            expect(splicedSequence.isEmpty());
+        }
+    }
+};
+
+static TimeSignaturesAggregatorTests timeSignaturesAggregatorTests;
+
+#endif
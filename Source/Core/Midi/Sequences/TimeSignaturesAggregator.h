@@ -19,11 +19,12 @@
 
 class ProjectNode;
 class MidiSequence;
-class TimeSignatureEvent;
 class TimeSignaturesSequence;
 class DummyProjectEventDispatcher;
 
 #include "MidiTrack.h"
+#include "TimeSignatureEvent.h"
+#include "Clip.h"
 #include "ProjectListener.h"
 
 // A class responsible for maintaining an ordered list of
@@ -33,6 +34,10 @@ class DummyProjectEventDispatcher;
 // It is used by RollBase to determine where to draw the grid lines,
 // and by TimeSignaturesProjectMap for displaying the time signatures.
 
+// Clip and track changes are applied incrementally: the aggregated list
+// is spliced only where it differs, the unchanged time signatures keep
+// their ids, and the listeners are told which beat range was affected.
+
 // It is also a "virtual" MidiTrack, which allows us to use it
 // as a drop-in replacement for the timeline's time signatures track.
 
@@ -49,6 +54,11 @@ public:
     void setActiveScope(Array<WeakReference<MidiTrack>> selectedTracks,
         bool forceRebuildAll = false);
 
+    // a detached copy of the currently used time signatures: it doesn't
+    // listen to the project and never changes, so it's safe to read it
+    // from other threads, e.g. when generating sequences in background
+    UniquePointer<TimeSignaturesAggregator> makeSnapshot() const;
+
     int getDefaultNumerator() const noexcept;
     int getDefaultDenominator() const noexcept;
     float getDefaultMeterBarLength() const noexcept;
@@ -62,7 +72,10 @@ public:
     {
         Listener() = default;
         virtual ~Listener() = default;
-        virtual void onTimeSignaturesUpdated() {}
+        // the grid lines outside of the affected range stay the same;
+        // the range is unbounded on the side where the change propagates
+        // all the way (e.g. the first meter extends to the left infinitely)
+        virtual void onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat) {}
     };
 
     void addListener(Listener *listener);
@@ -100,14 +113,56 @@ public:
 
 private:
 
+    struct Snapshot final {};
+    TimeSignaturesAggregator(const TimeSignaturesAggregator &source, Snapshot);
+
     ProjectNode &project;
     MidiSequence &timelineSignatures;
 
+    const bool isSnapshot = false;
+
     Array<WeakReference<MidiTrack>> selectedTracks;
 
     void rebuildAll();
     bool isAggregatingTimeSignatureOverrides() const noexcept;
 
+    // the time signature overrides of all clips of the selected tracks,
+    // kept sorted by their absolute beats, and spliced on clip changes,
+    // so that no clip list ever needs to be collected and sorted again
+    struct ClipSignature final
+    {
+        float beat = 0.f;
+        const MidiTrack *track = nullptr;
+        Clip::Id clipId = 0;
+    };
+
+    Array<ClipSignature> clipSignatures;
+
+    static float getClipSignatureBeat(const Clip &clip) noexcept;
+    bool isAggregatingClipSignatures(const Clip &clip) const noexcept;
+    void addClipSignature(const Clip &clip);
+    bool removeClipSignature(const Clip &clip);
+    void addClipSignatures(const MidiTrack *track);
+    void removeClipSignatures(const MidiTrack *track);
+
+    // collects the chunks of clip signatures and splices
+    // the differences into orderedEvents, then notifies listeners
+    void updateOrderedEvents(bool forceNotify);
+    Array<TimeSignatureEvent> aggregatedSignatures;
+    MidiEvent::Id lastGeneratedSignatureId = 0;
+
+    static void aggregateClipSignatures(const Array<ClipSignature> &clipSignatures,
+        Array<TimeSignatureEvent> &outSignatures);
+
+    // returns false if the sequence already matches the new signatures,
+    // otherwise gives new ids to the inserted ones, and returns the
+    // beat range between the unchanged signatures before and after
+    static bool spliceSignatures(TimeSignaturesSequence &sequence,
+        Array<TimeSignatureEvent> &newSignatures, MidiEvent::Id &lastGeneratedId,
+        Range<float> &outAffectedRange);
+
+    void notifyTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat);
+
     UniquePointer<DummyProjectEventDispatcher> dummyEventDispatcher;
     UniquePointer<TimeSignaturesSequence> orderedEvents;
 
@@ -125,6 +180,8 @@ private:
 
     ListenerList<Listener> listeners;
 
+    friend class TimeSignaturesAggregatorTests;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeSignaturesAggregator)
     JUCE_DECLARE_WEAK_REFERENCEABLE(TimeSignaturesAggregator)
 };
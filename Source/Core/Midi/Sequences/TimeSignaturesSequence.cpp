@@ -33,8 +33,7 @@ TimeSignaturesSequence::TimeSignaturesSequence(MidiTrack &track,
 // Import/export
 //===----------------------------------------------------------------------===//
 
-void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence,
-    short timeFormat, Optional<int> customFilter)
+void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
     this->clearUndoHistory();
     this->checkpoint();
@@ -140,8 +139,6 @@ void TimeSignaturesSequence::exportMidi(MidiMessageSequence &outSequence,
     {
         event->exportMessages(outSequence, clip, keyMap, timeFactor);
     }
-
-    outSequence.updateMatchedPairs();
 }
 
 //===----------------------------------------------------------------------===//
@@ -177,6 +174,28 @@ MidiEvent *TimeSignaturesSequence::appendUnsafe(const TimeSignatureEvent &eventP
     return ownedEvent;
 }
 
+void TimeSignaturesSequence::spliceUnsafe(int startIndex, int numEventsToRemove,
+    const TimeSignatureEvent *orderedEvents, int numEventsToInsert)
+{
+    jassert(startIndex >= 0 && startIndex + numEventsToRemove <= this->midiEvents.size());
+
+    for (int i = startIndex; i < startIndex + numEventsToRemove; ++i)
+    {
+        this->eventDispatcher.dispatchRemoveEvent(*this->midiEvents.getUnchecked(i));
+    }
+
+    this->midiEvents.removeRange(startIndex, numEventsToRemove, true);
+
+    for (int i = 0; i < numEventsToInsert; ++i)
+    {
+        auto *ownedEvent = new TimeSignatureEvent(this, orderedEvents[i]);
+        this->midiEvents.insert(startIndex + i, ownedEvent);
+        this->eventDispatcher.dispatchAddEvent(*ownedEvent);
+    }
+
+    this->updateBeatRange(true);
+}
+
 bool TimeSignaturesSequence::remove(const TimeSignatureEvent &signature, bool undoable)
 {
     if (undoable)
@@ -31,8 +31,7 @@ public:
     // Import/export
     //===------------------------------------------------------------------===//
 
-    void importMidi(const MidiMessageSequence &sequence,
-        short timeFormat, Optional<int> customFilter) override;
+    void importMidi(const MidiMessageSequence &sequence, short timeFormat);
     void exportMidi(MidiMessageSequence &outSequence,
         const Clip &clip, const KeyboardMapping &keyMap,
         GeneratedSequenceBuilder &generatedSequences,
@@ -70,6 +69,11 @@ private:
     // only use it for better performance, if you know what you're doing
     MidiEvent *appendUnsafe(const TimeSignatureEvent &orderedEvent);
 
+    // replaces a range of events with the new ones in one go,
+    // again assuming that the list will remain sorted after that
+    void spliceUnsafe(int startIndex, int numEventsToRemove,
+        const TimeSignatureEvent *orderedEvents, int numEventsToInsert);
+
     friend class TimeSignaturesAggregator;
 
 private:
@@ -113,14 +113,16 @@ void BackendRequest::processResponse(BackendRequest::Response &response, InputSt
         return;
     }
 
-    // Try to parse response as JSON object wrapping all properties
-    const String responseBody = stream->readEntireStreamAsString();
-    if (responseBody.isNotEmpty())
+    // Try to parse response as JSON object wrapping all properties,
+    // reading it right from the network stream chunk by chunk
+    response.body = this->serializer.loadFromStream(*stream);
+
+    // an empty response body is not an error
+    if (stream->getPosition() > 0)
     {
-        DBG("<< Received " << response.statusCode << " " // << responseBody);
-            << responseBody.substring(0, 128) << (responseBody.length() > 128 ? ".." : ""));
+        DBG("<< Received " << response.statusCode << " "
+            << String(stream->getPosition()) << " bytes");
 
-        response.body = this->serializer.loadFromString(responseBody);
         if (!response.body.isValid())
         {
             response.errors.add(TRANS(I18n::Common::networkError));
@@ -198,20 +200,20 @@ BackendRequest::Response BackendRequest::doRequest(const SerializedData &payload
     Response response;
     UniquePointer<InputStream> stream;
 
-    String jsonPayload;
-    if (this->serializer.saveToString(jsonPayload, payload).failed())
+    MemoryOutputStream jsonPayload;
+    if (this->serializer.saveToStream(jsonPayload, payload).failed())
     {
         return response;
     }
 
     const auto url = URL(Routes::Api::baseURL + this->apiEndpoint)
-        .withPOSTData(MemoryBlock(jsonPayload.toRawUTF8(), jsonPayload.getNumBytesAsUTF8()));
+        .withPOSTData(jsonPayload.getMemoryBlock());
 
     int i = 0;
     do
     {
-        DBG(">> " << verb << " " << this->apiEndpoint << " " 
-            << jsonPayload.substring(0, 128) + (jsonPayload.length() > 128 ? ".." : ""));
+        DBG(">> " << verb << " " << this->apiEndpoint << " "
+            << String(jsonPayload.getDataSize()) << " bytes");
 
         stream = url.createInputStream(
             URL::InputStreamOptions(URL::ParameterHandling::inPostData)
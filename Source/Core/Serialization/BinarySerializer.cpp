@@ -78,6 +78,24 @@ SerializedData BinarySerializer::loadFromString(const String &string) const
     return {};
 }
 
+Result BinarySerializer::saveToStream(OutputStream &stream, const SerializedData &tree) const
+{
+    stream.writeInt64(kHelioHeaderV2);
+    tree.writeToStream(stream);
+    return Result::ok();
+}
+
+SerializedData BinarySerializer::loadFromStream(InputStream &stream) const
+{
+    const auto magicNumber = static_cast<uint64>(stream.readInt64());
+    if (magicNumber == kHelioHeaderV2)
+    {
+        return SerializedData::readFromStream(stream);
+    }
+
+    return {};
+}
+
 bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 {
     return extension.endsWithIgnoreCase("hp") ||
@@ -0,0 +1,85 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A forward-only byte reader used by the streaming text parsers:
+// reads the input stream in fixed-size chunks and allows to peek
+// at the next byte, so that documents are parsed straight from the file
+// or network stream, without loading the whole text into memory first.
+// The end of input is reported as 0, just like the end of a C string.
+
+class BufferedStreamReader final
+{
+public:
+
+    explicit BufferedStreamReader(InputStream &input) :
+        input(input),
+        buffer(bufferSize) {}
+
+    inline char peek()
+    {
+        if (this->position == this->numBytes && !this->fill())
+        {
+            return 0;
+        }
+
+        return this->buffer[this->position];
+    }
+
+    inline char next()
+    {
+        const auto c = this->peek();
+        this->position += (c != 0) ? 1 : 0;
+        return c;
+    }
+
+    inline void skipWhitespace()
+    {
+        while (CharacterFunctions::isWhitespace(this->peek()))
+        {
+            ++this->position;
+        }
+    }
+
+    // for error messages only
+    int64 getNumBytesRead() const noexcept
+    {
+        return this->totalBytesRead - (this->numBytes - this->position);
+    }
+
+private:
+
+    bool fill()
+    {
+        this->position = 0;
+        this->numBytes = jmax(0, this->input.read(this->buffer.get(), bufferSize));
+        this->totalBytesRead += this->numBytes;
+        return this->numBytes > 0;
+    }
+
+    static constexpr auto bufferSize = 64 * 1024;
+
+    InputStream &input;
+
+    HeapBlock<char> buffer;
+    int position = 0;
+    int numBytes = 0;
+    int64 totalBytesRead = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(BufferedStreamReader)
+};
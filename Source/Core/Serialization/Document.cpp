@@ -194,6 +194,26 @@ bool Document::load(const File &file)
     return true;
 }
 
+bool Document::loadAsync(const File &file)
+{
+    if (!file.existsAsFile())
+    {
+        jassertfalse;
+        return false;
+    }
+
+    this->workingFile = file;
+    this->hasChanges = false;
+
+    if (!this->owner.onDocumentLoadAsync(file))
+    {
+        DBG("Document load failed: " + this->workingFile.getFullPathName());
+        return false;
+    }
+
+    return true;
+}
+
 void Document::import(const String &filePattern)
 {
     if (!FileChooser::isPlatformDialogAvailable())
@@ -51,6 +51,7 @@ public:
     //===------------------------------------------------------------------===//
 
     bool load(const File &file);
+    bool loadAsync(const File &file);
     void import(const String &filePattern);
 
     void changeListenerCallback(ChangeBroadcaster* source) override;
@@ -37,6 +37,7 @@ public:
 protected:
 
     virtual bool onDocumentLoad(const File &file) = 0;
+    virtual bool onDocumentLoadAsync(const File &file) = 0;
     virtual bool onDocumentSave(const File &file) = 0;
     virtual void onDocumentImport(InputStream &stream) = 0;
     virtual bool onDocumentExport(OutputStream &stream) = 0;
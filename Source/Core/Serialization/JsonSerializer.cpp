@@ -17,6 +17,7 @@
 
 #include "Common.h"
 #include "JsonSerializer.h"
+#include "BufferedStreamReader.h"
 
 //===----------------------------------------------------------------------===//
 // Json parser
@@ -25,254 +26,322 @@
 // Slightly modified JSONParser from JUCE classes,
 // but returns SerializedData instead of var, and supports comments like `//` and `/* */`.
 // Parses arrays and objects as nodes/children, and all others as properties.
+// Reads the input stream chunk by chunk and fills the tree as it goes,
+// so that large documents never exist as a whole string in memory.
 
 struct JsonParser final
 {
-    static Result parseObjectOrArray(String::CharPointerType t, SerializedData &result)
+    explicit JsonParser(InputStream &input) :
+        reader(input),
+        buffer(256) {}
+
+    Result parseObjectOrArray(SerializedData &result)
     {
-        skipCommentsAndWhitespaces(t);
+        this->skipCommentsAndWhitespaces();
 
-        switch (t.getAndAdvance())
+        auto r = Result::ok();
+        switch (this->reader.next())
         {
         case 0:      result = SerializedData(); return Result::ok();
-        case '{':    return parseObject(t, result);
-        case '[':    return parseArray(t, result, result.getType());
+        case '{':    r = this->parseObject(result); break;
+        case '[':    r = this->parseArray(result, result.getType()); break;
+        default:     return this->createFail("Expected '{' or '['");
         }
 
-        return createFail("Expected '{' or '['", &t);
-    }
-
-    static Result parseStringProperty(const juce_wchar quoteChar, String::CharPointerType &t, const Identifier &propertyName, SerializedData &tree)
-    {
-        String property;
-        const auto r = parseString(quoteChar, t, property);
-        if (r.wasOk())
+        if (r.wasOk() && this->hasStrayCharacters)
         {
-            tree.setProperty(propertyName, property);
+            return this->createFail("Syntax error");
         }
 
         return r;
     }
 
-    static Result parseString(const juce_wchar quoteChar, String::CharPointerType &t, String &result)
+private:
+
+    BufferedStreamReader reader;
+    MemoryOutputStream buffer;
+    bool hasStrayCharacters = false;
+
+    Result parseAny(SerializedData &result, const Identifier &nodeOrProperty)
     {
-        static MemoryOutputStream buffer(256);
-        buffer.reset();
+        this->skipCommentsAndWhitespaces();
 
-        for (;;)
+        switch (this->reader.peek())
         {
-            auto c = t.getAndAdvance();
-
-            if (c == quoteChar)
+        case '{':
             {
-                break;
+                this->reader.next();
+                SerializedData child(nodeOrProperty);
+                result.appendChild(child);
+                return this->parseObject(child);
             }
 
-            if (c == '\\')
-            {
-                c = t.getAndAdvance();
+        case '[':
+            this->reader.next();
+            return this->parseArray(result, nodeOrProperty);
 
-                switch (c)
-                {
-                case '"':
-                case '\'':
-                case '\\':
-                case '/':  break;
-
-                case 'a':  c = '\a'; break;
-                case 'b':  c = '\b'; break;
-                case 'f':  c = '\f'; break;
-                case 'n':  c = '\n'; break;
-                case 'r':  c = '\r'; break;
-                case 't':  c = '\t'; break;
-
-                case 'u':
-                {
-                    c = 0;
+        case '"':
+        case '\'':
+            return this->parseStringProperty(this->reader.next(), nodeOrProperty, result);
 
-                    for (int i = 4; --i >= 0;)
-                    {
-                        auto digitValue = CharacterFunctions::getHexDigitValue(t.getAndAdvance());
-                        if (digitValue < 0) { return createFail("Syntax error in Unicode escape sequence"); }
-                        c = (juce_wchar)((c << 4) + static_cast<juce_wchar> (digitValue));
-                    }
+        case '-':
+            this->reader.next();
+            this->skipCommentsAndWhitespaces();
+            if (!CharacterFunctions::isDigit(this->reader.peek()))
+                break;
 
-                    break;
-                }
-                }
+            return this->parseNumberProperty(nodeOrProperty, result, true);
+
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return this->parseNumberProperty(nodeOrProperty, result, false);
+
+        case 't':
+            if (this->skipKeyword("true"))
+            {
+                result.setProperty(nodeOrProperty, true);
+                return Result::ok();
+            }
+            break;
+
+        case 'f':
+            if (this->skipKeyword("false"))
+            {
+                result.setProperty(nodeOrProperty, false);
+                return Result::ok();
             }
+            break;
 
-            if (c == 0) { return createFail("Unexpected end-of-input in string constant"); }
-            buffer.appendUTF8Char(c);
+        case 'n':
+            if (this->skipKeyword("null"))
+            {
+                // no need to set any property in this case?
+                return Result::ok();
+            }
+            break;
+
+        default:
+            break;
         }
 
-        result = buffer.toUTF8();
-        return Result::ok();
+        return this->createFail("Syntax error");
     }
 
-    static void findNextNewline(String::CharPointerType &t)
+    Result createFail(const char *const message) const
     {
-        juce_wchar c = 0;
-        do { c = t.getAndAdvance(); } while (c != '\n' && c != '\r');
+        String m(message);
+        m << " at position " << this->reader.getNumBytesRead();
+        return Result::fail(m);
     }
 
-    static void findEndOfMultilineComment(String::CharPointerType &t)
+    bool skipKeyword(const char *keyword)
     {
-        juce_wchar c1 = 0;
-        juce_wchar c2 = 0;
-        do
-        { 
-            c1 = c2;
-            c2 = t.getAndAdvance();
-            if (c2 == 0) { return; }
-        } while (c1 != '*' || c2 != '/');
+        for (auto *c = keyword; *c != 0; ++c)
+        {
+            if (this->reader.next() != *c)
+            {
+                return false;
+            }
+        }
+
+        return true;
     }
 
-    static void skipCommentsAndWhitespaces(String::CharPointerType &t)
+    void skipCommentsAndWhitespaces()
     {
-        t = t.findEndOfWhitespace();
-        auto t2 = t;
-        switch (t2.getAndAdvance())
+        for (;;)
         {
-        case '/':
-            const auto c = t2.getAndAdvance();
+            this->reader.skipWhitespace();
+            if (this->reader.peek() != '/')
+            {
+                return;
+            }
+
+            this->reader.next();
+            const auto c = this->reader.next();
             if (c == '/')
             {
-                t = t2;
-                findNextNewline(t);
-                skipCommentsAndWhitespaces(t);
+                this->skipUntilNewline();
             }
             else if (c == '*')
             {
-                t = t2;
-                findEndOfMultilineComment(t);
-                skipCommentsAndWhitespaces(t);
+                this->skipUntilEndOfMultilineComment();
+            }
+            else
+            {
+                // the slash has been consumed already, so just remember
+                // the document is malformed and report it in the end
+                this->hasStrayCharacters = true;
+                return;
             }
         }
     }
 
-    static Result parseAny(String::CharPointerType &t, SerializedData &result, const Identifier &nodeOrProperty)
+    void skipUntilNewline()
     {
-        skipCommentsAndWhitespaces(t);
-        auto t2 = t;
+        char c = 0;
+        do { c = this->reader.next(); } while (c != '\n' && c != '\r' && c != 0);
+    }
 
-        switch (t2.getAndAdvance())
+    void skipUntilEndOfMultilineComment()
+    {
+        char c1 = 0;
+        char c2 = 0;
+        do
         {
-        case '{':
-            {
-                t = t2;
-                SerializedData child(nodeOrProperty);
-                result.appendChild(child);
-                return parseObject(t, child);
-            }
-
-        case '[':
-            t = t2;
-            return parseArray(t, result, nodeOrProperty);
+            c1 = c2;
+            c2 = this->reader.next();
+            if (c2 == 0) { return; }
+        } while (c1 != '*' || c2 != '/');
+    }
 
-        case '"':
-            t = t2;
-            return parseStringProperty('"', t, nodeOrProperty, result);
+    Result parseStringProperty(const char quoteChar, const Identifier &propertyName, SerializedData &tree)
+    {
+        String property;
+        const auto r = this->parseString(quoteChar, property);
+        if (r.wasOk())
+        {
+            tree.setProperty(propertyName, property);
+        }
 
-        case '\'':
-            t = t2;
-            return parseStringProperty('\'', t, nodeOrProperty, result);
+        return r;
+    }
 
-        case '-':
-            skipCommentsAndWhitespaces(t2);
-            if (!CharacterFunctions::isDigit(*t2))
-                break;
+    // the input is UTF-8, so all the multi-byte sequences
+    // are copied as is, and only the escapes need decoding
+    Result parseString(const char quoteChar, String &result)
+    {
+        this->buffer.reset();
+        juce_wchar highSurrogate = 0;
 
-            t = t2;
-            return parseNumberProperty(t, nodeOrProperty, result, true);
+        for (;;)
+        {
+            const auto c = this->reader.next();
 
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            return parseNumberProperty(t, nodeOrProperty, result, false);
+            if (c == quoteChar)
+            {
+                break;
+            }
 
-        case 't':   // "true"
-            if (t2.getAndAdvance() == 'r' && t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'e')
+            if (c == 0)
             {
-                t = t2;
-                result.setProperty(nodeOrProperty, true);
-                return Result::ok();
+                return this->createFail("Unexpected end-of-input in string constant");
             }
-            break;
 
-        case 'f':   // "false"
-            if (t2.getAndAdvance() == 'a' && t2.getAndAdvance() == 'l'
-                && t2.getAndAdvance() == 's' && t2.getAndAdvance() == 'e')
+            if (c != '\\')
             {
-                t = t2;
-                result.setProperty(nodeOrProperty, false);
-                return Result::ok();
+                this->buffer.writeByte(c);
+                continue;
             }
-            break;
 
-        case 'n':   // "null"
-            if (t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'l' && t2.getAndAdvance() == 'l')
+            juce_wchar escaped = this->reader.next();
+            switch (escaped)
             {
-                t = t2;
-                // no need to set any property in this case?
-                return Result::ok();
+            case '"':
+            case '\'':
+            case '\\':
+            case '/':  break;
+
+            case 'a':  escaped = '\a'; break;
+            case 'b':  escaped = '\b'; break;
+            case 'f':  escaped = '\f'; break;
+            case 'n':  escaped = '\n'; break;
+            case 'r':  escaped = '\r'; break;
+            case 't':  escaped = '\t'; break;
+
+            case 'u':
+            {
+                escaped = 0;
+
+                for (int i = 4; --i >= 0;)
+                {
+                    const auto digitValue = CharacterFunctions::getHexDigitValue(this->reader.next());
+                    if (digitValue < 0) { return this->createFail("Syntax error in Unicode escape sequence"); }
+                    escaped = (juce_wchar)((escaped << 4) + static_cast<juce_wchar>(digitValue));
+                }
+
+                // characters outside of the BMP are written as surrogate pairs
+                if (escaped >= 0xd800 && escaped <= 0xdbff)
+                {
+                    highSurrogate = escaped;
+                    continue;
+                }
+
+                if (escaped >= 0xdc00 && escaped <= 0xdfff && highSurrogate != 0)
+                {
+                    escaped = 0x10000 + ((highSurrogate - 0xd800) << 10) + (escaped - 0xdc00);
+                }
+
+                break;
             }
-            break;
 
-        default:
-            break;
-        }
+            case 0:
+                return this->createFail("Unexpected end-of-input in string constant");
+            }
 
-        return createFail("Syntax error", &t);
-    }
+            highSurrogate = 0;
+            this->buffer.appendUTF8Char(escaped);
+        }
 
-private:
-    static Result createFail(const char *const message, const String::CharPointerType *location = nullptr)
-    {
-        String m(message);
-        if (location != nullptr)
-            m << ": \"" << String(*location, 20) << '"';
+        result = String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+            static_cast<int>(this->buffer.getDataSize()));
 
-        return Result::fail(m);
+        return Result::ok();
     }
 
-    static Result parseNumberProperty(String::CharPointerType &t, const Identifier &propertyName, SerializedData &result, const bool isNegative)
+    Result parseNumberProperty(const Identifier &propertyName, SerializedData &result, const bool isNegative)
     {
-        auto oldT = t;
+        // enough for any sane number representation
+        static constexpr auto maxNumberLength = 64;
+        char numberText[maxNumberLength + 1];
+        int numberLength = 0;
+        bool isDouble = false;
 
-        int64 intValue = t.getAndAdvance() - '0';
-        jassert(intValue >= 0 && intValue < 10);
+        int64 intValue = 0;
 
         for (;;)
         {
-            auto previousChar = t;
-            auto c = t.getAndAdvance();
-            auto digit = ((int)c) - '0';
+            const auto c = this->reader.peek();
+            const auto digit = ((int)c) - '0';
 
             if (isPositiveAndBelow(digit, 10))
             {
                 intValue = intValue * 10 + digit;
-                continue;
             }
-
-            if (c == 'e' || c == 'E' || c == '.')
+            else if (c == 'e' || c == 'E' || c == '.' ||
+                (isDouble && (c == '+' || c == '-')))
             {
-                t = oldT;
-                auto asDouble = CharacterFunctions::readDoubleValue(t);
-                result.setProperty(propertyName, isNegative ? -asDouble : asDouble);
-                return Result::ok();
+                isDouble = true;
             }
-
-            if (CharacterFunctions::isWhitespace(c)
+            else if (CharacterFunctions::isWhitespace(c)
                 || c == ',' || c == '}' || c == ']' || c == 0)
             {
-                t = previousChar;
                 break;
             }
+            else
+            {
+                return this->createFail("Syntax error in number");
+            }
+
+            if (numberLength == maxNumberLength)
+            {
+                return this->createFail("Syntax error in number");
+            }
 
-            return createFail("Syntax error in number", &oldT);
+            numberText[numberLength++] = this->reader.next();
         }
 
-        auto correctedValue = isNegative ? -intValue : intValue;
+        numberText[numberLength] = 0;
+
+        if (isDouble)
+        {
+            CharPointer_ASCII t(numberText);
+            const auto asDouble = CharacterFunctions::readDoubleValue(t);
+            result.setProperty(propertyName, isNegative ? -asDouble : asDouble);
+            return Result::ok();
+        }
+
+        const auto correctedValue = isNegative ? -intValue : intValue;
 
         if ((intValue >> 31) != 0)
             result.setProperty(propertyName, correctedValue);
@@ -282,79 +351,72 @@ private:
         return Result::ok();
     }
 
-    static Result parseObject(String::CharPointerType &t, SerializedData &result)
+    Result parseObject(SerializedData &result)
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            this->skipCommentsAndWhitespaces();
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
+            const auto c = this->reader.next();
 
             if (c == '}') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in object declaration"); }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in object declaration"); }
             if (c == '"')
             {
                 String nodeNameVar;
-                const auto r = parseString('"', t, nodeNameVar);
+                const auto r = this->parseString('"', nodeNameVar);
                 if (r.failed()) { return r; }
 
                 const Identifier nodeName(nodeNameVar);
                 if (nodeName.isValid())
                 {
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
-
-                    auto c2 = t.getAndAdvance();
+                    this->skipCommentsAndWhitespaces();
 
-                    if (c2 != ':') { return createFail("Expected ':', but found", &oldT); }
+                    if (this->reader.next() != ':') { return this->createFail("Expected ':'"); }
 
-                    const auto r2 = parseAny(t, result, nodeName);
+                    const auto r2 = this->parseAny(result, nodeName);
                     if (r2.failed()) { return r2; }
 
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
+                    this->skipCommentsAndWhitespaces();
 
-                    auto nextChar = t.getAndAdvance();
+                    const auto nextChar = this->reader.next();
                     if (nextChar == ',') { continue; }
                     if (nextChar == '}') { break; }
                 }
             }
 
-            return createFail("Expected object member declaration, but found", &oldT);
+            return this->createFail("Expected object member declaration");
         }
 
         return Result::ok();
     }
 
-    static Result parseArray(String::CharPointerType &t, SerializedData &result, const Identifier &nodeName)
+    Result parseArray(SerializedData &result, const Identifier &nodeName)
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            this->skipCommentsAndWhitespaces();
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
-
-            if (c == ']') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in array declaration"); }
+            const auto c = this->reader.peek();
 
-            t = oldT;
-            auto r = parseAny(t, result, nodeName);
+            if (c == ']') { this->reader.next(); break; }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in array declaration"); }
 
+            const auto r = this->parseAny(result, nodeName);
             if (r.failed()) { return r; }
 
-            skipCommentsAndWhitespaces(t);
-            oldT = t;
+            this->skipCommentsAndWhitespaces();
 
-            auto nextChar = t.getAndAdvance();
+            const auto nextChar = this->reader.next();
             if (nextChar == ',') { continue; }
             if (nextChar == ']') { break; }
-            return createFail("Expected object array item, but found", &oldT);
+            return this->createFail("Expected object array item");
         }
 
         return Result::ok();
     }
+
+    JUCE_DECLARE_NON_COPYABLE(JsonParser)
 };
 
 //===----------------------------------------------------------------------===//
@@ -431,23 +493,18 @@ struct JsonFormatter final
             }
         }
 
-        using GroupedChildren = FlatHashMap<Identifier, Array<SerializedData>, IdentifierHash>;
-        GroupedChildren children;
+        // children of the same type are grouped into arrays; types are written
+        // in the order they first appear, which also keeps the output stable,
+        // and the children are not copied into any intermediate containers
+        Array<Identifier> childTypes;
         for (const auto &child : tree)
         {
-            if (!children.contains(child.getType()))
-            {
-                children[child.getType()] = Array<SerializedData>(child);
-                continue;
-            }
-
-            children.at(child.getType()).add(child);
+            childTypes.addIfNotAlreadyThere(child.getType());
         }
 
-        for (auto i = children.begin(); i != children.end(); ++i)
+        for (int i = 0; i < childTypes.size(); ++i)
         {
-            const auto &childrenType = i->first;
-            const auto &childGroupOfSameType = i->second;
+            const auto &childrenType = childTypes.getReference(i);
 
             if (!allOnOneLine)
             {
@@ -458,18 +515,24 @@ struct JsonFormatter final
             writeString(out, childrenType);
             out << "\": ";
 
-            if (childGroupOfSameType.size() == 1)
+            int numChildrenOfSameType = 0;
+            forEachChildWithType(tree, child, childrenType)
             {
-                writeObject(out, childGroupOfSameType.getFirst(),
+                numChildrenOfSameType++;
+            }
+
+            if (numChildrenOfSameType == 1)
+            {
+                writeObject(out, tree.getChildWithName(childrenType),
                     indentLevel + indentSize, allOnOneLine, maximumDecimalPlaces);
             }
             else
             {
-                writeArray(out, childGroupOfSameType,
+                writeArray(out, tree, childrenType, numChildrenOfSameType,
                     indentLevel + indentSize, allOnOneLine, maximumDecimalPlaces);
             }
 
-            if (i != children.end() && std::next(i) != children.end())
+            if (i < childTypes.size() - 1)
             {
                 if (allOnOneLine) { out << ", "; } else { out << ',' << newLine; }
             }
@@ -581,23 +644,25 @@ struct JsonFormatter final
         out.writeRepeatedByte(' ', (size_t)numSpaces);
     }
 
-    static void writeArray(OutputStream &out, const Array<SerializedData> &array,
+    static void writeArray(OutputStream &out, const SerializedData &parent,
+        const Identifier &childrenType, int numChildrenOfSameType,
         int indentLevel, bool allOnOneLine, int maximumDecimalPlaces)
     {
         out << '[';
 
-        if (!array.isEmpty())
+        if (numChildrenOfSameType > 0)
         {
             if (!allOnOneLine) { out << newLine; }
 
-            for (int i = 0; i < array.size(); ++i)
+            int i = 0;
+            forEachChildWithType(parent, child, childrenType)
             {
                 if (!allOnOneLine) { writeSpaces(out, indentLevel + indentSize); }
 
-                writeObject(out, array.getReference(i),
+                writeObject(out, child,
                     indentLevel + indentSize, allOnOneLine, maximumDecimalPlaces);
 
-                if (i < array.size() - 1)
+                if (++i < numChildrenOfSameType)
                 {
                     if (allOnOneLine) { out << ", "; } else { out << ',' << newLine; }
                 }
@@ -638,8 +703,10 @@ Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
         fileStream.setPosition(0);
         fileStream.truncate();
 
-        JsonFormatter::write(fileStream, tree, this->headerComments, 0, this->allOnOneLine, 6);
-        return Result::ok();
+        this->saveToStream(fileStream, tree);
+
+        fileStream.flush();
+        return fileStream.getStatus();
     }
 
     return Result::fail("Failed to save");
@@ -647,10 +714,16 @@ Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
 
 SerializedData JsonSerializer::loadFromFile(const File &file) const
 {
-    const String text(file.loadFileAsString());
+    FileInputStream fileStream(file);
+    if (!fileStream.openedOk())
+    {
+        return {};
+    }
+
     SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(text.getCharPointer(), root);
-    if (result.wasOk())
+    JsonParser parser(fileStream);
+    const auto result = parser.parseObjectOrArray(root);
+    if (result.wasOk() && root.isValid())
     {
         return root.getChild(0);
     }
@@ -661,16 +734,30 @@ SerializedData JsonSerializer::loadFromFile(const File &file) const
 Result JsonSerializer::saveToString(String &string, const SerializedData &tree) const
 {
     MemoryOutputStream mo(1024);
-    JsonFormatter::write(mo, tree, this->headerComments, 0, this->allOnOneLine, 6);
+    this->saveToStream(mo, tree);
     string = mo.toUTF8();
     return Result::ok();
 }
 
 SerializedData JsonSerializer::loadFromString(const String &string) const
+{
+    // juce::String keeps its text as UTF-8, so no copies are made here
+    MemoryInputStream stream(string.toRawUTF8(), string.getNumBytesAsUTF8(), false);
+    return this->loadFromStream(stream);
+}
+
+Result JsonSerializer::saveToStream(OutputStream &stream, const SerializedData &tree) const
+{
+    JsonFormatter::write(stream, tree, this->headerComments, 0, this->allOnOneLine, 6);
+    return Result::ok();
+}
+
+SerializedData JsonSerializer::loadFromStream(InputStream &stream) const
 {
     SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(string.getCharPointer(), root);
-    if (result.wasOk())
+    JsonParser parser(stream);
+    const auto result = parser.parseObjectOrArray(root);
+    if (result.wasOk() && root.isValid())
     {
         if (root.getNumChildren() == 1 && root.getNumProperties() == 0)
         {
@@ -697,3 +784,95 @@ bool JsonSerializer::supportsFileWithHeader(const String &header) const
     // Enough for all our cases:
     return header.startsWithChar('[') || header.startsWithChar('{');
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+#include "BinarySerializer.h"
+#include "SerializerTestTree.h"
+
+class JsonSerializerTests final : public UnitTest
+{
+public:
+    JsonSerializerTests() : UnitTest("Streaming json serializer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        const JsonSerializer serializer;
+        const JsonSerializer oneLineSerializer(true);
+
+        beginTest("Json round trip");
+
+        const auto tree = SerializerTestTree::create(4, 4);
+
+        String text;
+        expect(serializer.saveToString(text, tree).wasOk());
+        expect(serializer.loadFromString(text).isEquivalentTo(tree));
+
+        String oneLineText;
+        expect(oneLineSerializer.saveToString(oneLineText, tree).wasOk());
+        expect(!oneLineText.containsChar('\n'));
+        expect(serializer.loadFromString(oneLineText).isEquivalentTo(tree));
+
+        beginTest("Json streams are consistent with strings and binary format");
+
+        MemoryOutputStream streamedText;
+        expect(serializer.saveToStream(streamedText, tree).wasOk());
+        expectEquals(streamedText.toUTF8(), text);
+
+        MemoryInputStream input(streamedText.getData(), streamedText.getDataSize(), false);
+        const auto streamedTree = serializer.loadFromStream(input);
+        expect(streamedTree.isEquivalentTo(tree));
+
+        const BinarySerializer binarySerializer;
+        MemoryOutputStream binaryData;
+        binarySerializer.saveToStream(binaryData, tree);
+        MemoryInputStream binaryInput(binaryData.getData(), binaryData.getDataSize(), false);
+        expect(binarySerializer.loadFromStream(binaryInput).isEquivalentTo(streamedTree));
+
+        beginTest("Json comments, escapes and malformed input");
+
+        const auto parsed = serializer.loadFromString(
+            "// header comment\n"
+            "{ /* inline */ \"a\": { \"x\": -1, \"y\": 2.5e1, \"s\": \"\\u0041\\ud83c\\udfb5\\n\", "
+            "\"b\": [ { \"z\": true }, { \"z\": false } ] } }");
+        expect(parsed.hasType("a"));
+        expectEquals(int(parsed.getProperty("x")), -1);
+        expectEquals(double(parsed.getProperty("y")), 25.0);
+        expectEquals(parsed.getProperty("s").toString(), String(CharPointer_UTF8("A\xf0\x9f\x8e\xb5\n")));
+        expectEquals(parsed.getNumChildren(), 2);
+
+        expect(!serializer.loadFromString("{ \"a\": { \"x\": 1 }").isValid());
+        expect(!serializer.loadFromString("{ \"a\": { \"x\": 1x } }").isValid());
+        expect(!serializer.loadFromString("{ \"a\": / { } }").isValid());
+
+        beginTest("Json streams are consistent with strings and JSON parser on a large tree");
+
+        const auto largeTree = SerializerTestTree::create(3, 32);
+
+        String largeText;
+        expect(serializer.saveToString(largeText, largeTree).wasOk());
+
+        MemoryOutputStream largeStreamedText;
+        expect(serializer.saveToStream(largeStreamedText, largeTree).wasOk());
+        expectEquals(largeStreamedText.toUTF8(), largeText);
+
+        MemoryInputStream largeInput(largeStreamedText.getData(), largeStreamedText.getDataSize(), false);
+        expect(serializer.loadFromStream(largeInput).isEquivalentTo(largeTree));
+
+        // the same text parsed by JUCE into the var tree should contain
+        // the root properties and the children grouped by type:
+        const auto largeVar = JSON::parse(largeText);
+        const auto &rootVar = largeVar[largeTree.getType()];
+        expect(rootVar.isObject());
+        expectEquals(rootVar["id"].toString(), largeTree.getProperty("id").toString());
+        expectEquals(rootVar[largeTree.getChild(0).getType()].size(), 32);
+    }
+};
+
+static JsonSerializerTests jsonSerializerTests;
+
+#endif
@@ -33,6 +33,9 @@ public:
     Result saveToString(String &string, const SerializedData &tree) const override;
     SerializedData loadFromString(const String &string) const override;
 
+    Result saveToStream(OutputStream &stream, const SerializedData &tree) const override;
+    SerializedData loadFromStream(InputStream &stream) const override;
+
     bool supportsFileWithExtension(const String &extension) const override;
     bool supportsFileWithHeader(const String &header) const override;
 
@@ -148,6 +148,7 @@ namespace Serialization
         static const Identifier refactoringModifier = "refactoring";
         static const Identifier arpeggiationModifier = "arpeggiation";
         static const Identifier tuningModifier = "tuning";
+        static const Identifier parametricModifier = "parametric";
 
         static const Identifier isEnabled = "enabled";
 
@@ -163,6 +164,9 @@ namespace Serialization
         static const Identifier refactoringCleanupOverlaps = "cleanup";
 
         static const Identifier arpeggiationSpeed = "speed";
+
+        static const Identifier parametricSource = "source";
+        static const Identifier parametricSeed = "seed";
     } // namespace Modifiers
 
     namespace Audio
@@ -200,6 +204,11 @@ namespace Serialization
         static const Identifier pluginNumInputs = "numInputs";
         static const Identifier pluginNumOutputs = "numOutputs";
 
+        static const Identifier pluginScanCache = "pluginScanCache";
+        static const Identifier pluginScanCacheEntry = "scannedFile";
+        static const Identifier pluginFileSize = "fileSize";
+        static const Identifier pluginScanFailed = "failed";
+
         static const Identifier midiInputName = "midiInputName";
         static const Identifier midiInputId = "midiInputId";
         static const Identifier midiInputReadjusting = "midiInputReadjusting";
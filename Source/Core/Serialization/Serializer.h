@@ -32,6 +32,9 @@ public:
     virtual Result saveToString(String &string, const SerializedData &tree) const = 0;
     virtual SerializedData loadFromString(const String &string) const = 0;
 
+    virtual Result saveToStream(OutputStream &stream, const SerializedData &tree) const = 0;
+    virtual SerializedData loadFromStream(InputStream &stream) const = 0;
+
     virtual bool supportsFileWithExtension(const String &extension) const = 0;
     virtual bool supportsFileWithHeader(const String &header) const = 0;
 
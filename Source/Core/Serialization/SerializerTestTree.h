@@ -0,0 +1,65 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#if JUCE_UNIT_TESTS
+
+// The test tree shared by the serializers' tests: project-like nodes
+// with a few typical attributes, including the ones which need escaping,
+// non-ascii characters, long lines and 64-bit values.
+// Json groups children by type, so all children of the same type
+// are placed next to each other, otherwise the round trip
+// would change the children order.
+
+class SerializerTestTree final
+{
+public:
+
+    static SerializedData create(int depth, int numChildren)
+    {
+        static const Identifier nodeType("node");
+        static const Identifier leafType("event");
+        static const Identifier metaType("meta");
+
+        auto &random = Random::getSystemRandom();
+        SerializedData node(depth > 0 ? nodeType : leafType);
+        node.setProperty("id", String::toHexString(random.nextInt()));
+        node.setProperty("key", random.nextInt(128) - 64);
+        node.setProperty("beat", random.nextInt(1000) * 0.25);
+        node.setProperty("mute", random.nextBool());
+        node.setProperty("name", String(CharPointer_UTF8("\"quoted\" & <escaped>\t\\ /\n"
+            "\xd0\xbd\xd0\xbe\xd1\x82\xd0\xb0 \xf0\x9f\x8e\xb5")));
+        node.setProperty("longValue", String::repeatedString("abc", 50));
+
+        if (depth > 0)
+        {
+            for (int i = 0; i < numChildren; ++i)
+            {
+                node.appendChild(SerializerTestTree::create(depth - 1, numChildren));
+            }
+
+            SerializedData meta(metaType);
+            meta.setProperty("size", int64(1) << 40);
+            node.appendChild(meta);
+        }
+
+        return node;
+    }
+};
+
+#endif
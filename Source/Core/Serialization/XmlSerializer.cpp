@@ -17,6 +17,7 @@
 
 #include "Common.h"
 #include "XmlSerializer.h"
+#include "BufferedStreamReader.h"
 
 static const String xmlEncoding = "UTF-8";
 
@@ -29,25 +30,477 @@ static XmlElement::TextFormat getXmlFormat()
     return format;
 }
 
+//===----------------------------------------------------------------------===//
+// Xml parser
+//===----------------------------------------------------------------------===//
+
+// A SAX-style parser, which reads the stream chunk by chunk and fills
+// SerializedData right away, without building a temporary XmlElement tree;
+// supports the subset of xml which we write: elements with attributes,
+// plus the header, comments, doctype and cdata sections, which are skipped;
+// text elements are ignored, like SerializedData::readFromXml does.
+
+struct XmlParser final
+{
+    explicit XmlParser(InputStream &input) :
+        reader(input),
+        buffer(256) {}
+
+    Result parseDocument(SerializedData &result)
+    {
+        for (;;)
+        {
+            this->reader.skipWhitespace();
+
+            const auto c = this->reader.next();
+            if (c == 0)
+            {
+                return this->createFail("No root element found");
+            }
+
+            if (c != '<')
+            {
+                return this->createFail("Expected '<'");
+            }
+
+            if (this->reader.peek() == '?' || this->reader.peek() == '!')
+            {
+                const auto r = this->skipMarkup();
+                if (r.failed()) { return r; }
+                continue;
+            }
+
+            return this->parseElement(result);
+        }
+    }
+
+private:
+
+    BufferedStreamReader reader;
+    MemoryOutputStream buffer;
+    MemoryOutputStream valueBuffer;
+    juce_wchar entity = 0;
+
+    Result createFail(const char *const message) const
+    {
+        String m(message);
+        m << " at position " << this->reader.getNumBytesRead();
+        return Result::fail(m);
+    }
+
+    static inline bool isNameCharacter(const char c) noexcept
+    {
+        return CharacterFunctions::isLetterOrDigit(c) || (c & 0x80) != 0 ||
+            c == '_' || c == '-' || c == ':' || c == '.';
+    }
+
+    Result readName(Identifier &result)
+    {
+        this->buffer.reset();
+        while (isNameCharacter(this->reader.peek()))
+        {
+            this->buffer.writeByte(this->reader.next());
+        }
+
+        if (this->buffer.getDataSize() == 0)
+        {
+            return this->createFail("Expected a name");
+        }
+
+        result = Identifier(String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+            static_cast<int>(this->buffer.getDataSize())));
+
+        return Result::ok();
+    }
+
+    // handles <?xml .. ?>, <!-- .. -->, <!DOCTYPE .. > and <![CDATA[ .. ]]>,
+    // assuming the opening '<' has been consumed already
+    Result skipMarkup()
+    {
+        const auto type = this->reader.next();
+        if (type == '?')
+        {
+            return this->skipUntil("?>");
+        }
+
+        jassert(type == '!');
+        if (this->reader.peek() == '-')
+        {
+            return this->skipUntil("-->");
+        }
+        else if (this->reader.peek() == '[')
+        {
+            return this->skipUntil("]]>");
+        }
+
+        // doctype, possibly with an internal subset in square brackets
+        int depth = 0;
+        for (;;)
+        {
+            const auto c = this->reader.next();
+            if (c == 0) { return this->createFail("Unexpected end-of-input in doctype"); }
+            if (c == '[') { depth++; }
+            if (c == ']') { depth--; }
+            if (c == '>' && depth <= 0) { return Result::ok(); }
+        }
+    }
+
+    Result skipUntil(const char *const terminator)
+    {
+        const auto length = int(strlen(terminator));
+        int numMatched = 0;
+        while (numMatched < length)
+        {
+            const auto c = this->reader.next();
+            if (c == 0)
+            {
+                return this->createFail("Unexpected end-of-input");
+            }
+
+            if (c == terminator[numMatched])
+            {
+                numMatched++;
+            }
+            else
+            {
+                numMatched = (c == terminator[0]) ? 1 : 0;
+            }
+        }
+
+        return Result::ok();
+    }
+
+    Result readEntity()
+    {
+        this->buffer.reset();
+        for (;;)
+        {
+            const auto c = this->reader.next();
+            if (c == ';') { break; }
+            if (c == 0 || this->buffer.getDataSize() > 16)
+            {
+                return this->createFail("Malformed entity");
+            }
+
+            this->buffer.writeByte(c);
+        }
+
+        this->buffer.writeByte(0);
+        const auto *entity = static_cast<const char *>(this->buffer.getData());
+
+        juce_wchar result = 0;
+        if (strcmp(entity, "amp") == 0) { result = '&'; }
+        else if (strcmp(entity, "quot") == 0) { result = '"'; }
+        else if (strcmp(entity, "apos") == 0) { result = '\''; }
+        else if (strcmp(entity, "lt") == 0) { result = '<'; }
+        else if (strcmp(entity, "gt") == 0) { result = '>'; }
+        else if (entity[0] == '#')
+        {
+            const bool isHex = (entity[1] == 'x' || entity[1] == 'X');
+            const String digits(entity + (isHex ? 2 : 1));
+            result = static_cast<juce_wchar>(isHex ?
+                digits.getHexValue32() : digits.getIntValue());
+        }
+
+        if (result == 0)
+        {
+            return this->createFail("Unknown entity");
+        }
+
+        this->entity = result;
+        return Result::ok();
+    }
+
+    Result readAttributeValue(const char quoteChar, String &result)
+    {
+        // the attribute value is collected in a separate buffer,
+        // since readEntity() reuses the shared one
+        this->valueBuffer.reset();
+        for (;;)
+        {
+            const auto c = this->reader.next();
+            if (c == quoteChar)
+            {
+                break;
+            }
+
+            if (c == 0)
+            {
+                return this->createFail("Unexpected end-of-input in attribute value");
+            }
+
+            if (c == '&')
+            {
+                const auto r = this->readEntity();
+                if (r.failed()) { return r; }
+                this->valueBuffer.appendUTF8Char(this->entity);
+                continue;
+            }
+
+            this->valueBuffer.writeByte(c);
+        }
+
+        result = String::fromUTF8(static_cast<const char *>(this->valueBuffer.getData()),
+            static_cast<int>(this->valueBuffer.getDataSize()));
+
+        return Result::ok();
+    }
+
+    // assumes the opening '<' has been consumed already
+    Result parseElement(SerializedData &result)
+    {
+        Identifier tagName;
+        auto r = this->readName(tagName);
+        if (r.failed()) { return r; }
+
+        result = SerializedData(tagName);
+
+        // attributes
+        for (;;)
+        {
+            this->reader.skipWhitespace();
+
+            const auto c = this->reader.peek();
+            if (c == '/')
+            {
+                this->reader.next();
+                if (this->reader.next() != '>') { return this->createFail("Expected '>'"); }
+                return Result::ok();
+            }
+
+            if (c == '>')
+            {
+                this->reader.next();
+                break;
+            }
+
+            Identifier attributeName;
+            r = this->readName(attributeName);
+            if (r.failed()) { return r; }
+
+            this->reader.skipWhitespace();
+            if (this->reader.next() != '=') { return this->createFail("Expected '='"); }
+            this->reader.skipWhitespace();
+
+            const auto quoteChar = this->reader.next();
+            if (quoteChar != '"' && quoteChar != '\'')
+            {
+                return this->createFail("Expected a quoted attribute value");
+            }
+
+            String value;
+            r = this->readAttributeValue(quoteChar, value);
+            if (r.failed()) { return r; }
+
+            result.setProperty(attributeName, value);
+        }
+
+        // children, until the closing tag
+        for (;;)
+        {
+            const auto c = this->reader.next();
+            if (c == 0)
+            {
+                return this->createFail("Unexpected end-of-input in element");
+            }
+
+            if (c != '<')
+            {
+                // text content is not supported, so just skip it
+                continue;
+            }
+
+            const auto c2 = this->reader.peek();
+            if (c2 == '/')
+            {
+                this->reader.next();
+                Identifier closingTagName;
+                r = this->readName(closingTagName);
+                if (r.failed()) { return r; }
+                if (closingTagName != tagName) { return this->createFail("Mismatched closing tag"); }
+
+                this->reader.skipWhitespace();
+                if (this->reader.next() != '>') { return this->createFail("Expected '>'"); }
+                return Result::ok();
+            }
+
+            if (c2 == '?' || c2 == '!')
+            {
+                r = this->skipMarkup();
+                if (r.failed()) { return r; }
+                continue;
+            }
+
+            SerializedData child;
+            r = this->parseElement(child);
+            if (r.failed()) { return r; }
+
+            result.appendChild(child);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(XmlParser)
+};
+
+//===----------------------------------------------------------------------===//
+// Xml formatter
+//===----------------------------------------------------------------------===//
+
+// Writes SerializedData straight into the stream, without creating XmlElement's;
+// the output is meant to be exactly the same as XmlElement::writeTo() produces
+// with the format options above, so that files don't change between versions.
+
+struct XmlFormatter final
+{
+    static void write(OutputStream &out, const SerializedData &tree,
+        const XmlElement::TextFormat &format)
+    {
+        out << "<?xml version=\"1.0\" encoding=\"" << format.customEncoding << "\"?>";
+        out << format.newLineChars << format.newLineChars;
+
+        writeElement(out, tree, 0, format.lineWrapLength, format.newLineChars);
+
+        out << format.newLineChars;
+    }
+
+    static void writeElement(OutputStream &out, const SerializedData &tree,
+        int indentLevel, int lineWrapLength, const char *newLineChars)
+    {
+        writeSpaces(out, indentLevel);
+
+        const auto tagName = tree.getType();
+        out.writeByte('<');
+        out << tagName.toString();
+
+        const auto attributeIndent = indentLevel + tagName.toString().length() + 1;
+        int lineLength = 0;
+
+        for (int i = 0; i < tree.getNumProperties(); ++i)
+        {
+            if (lineLength > lineWrapLength)
+            {
+                out << newLineChars;
+                writeSpaces(out, attributeIndent);
+                lineLength = 0;
+            }
+
+            const auto propertyName = tree.getPropertyName(i);
+            const auto startPosition = out.getPosition();
+
+            out.writeByte(' ');
+            out << propertyName.toString();
+            out.write("=\"", 2);
+            writeEscaped(out, tree.getProperty(propertyName).toString(), true);
+            out.writeByte('"');
+
+            lineLength += int(out.getPosition() - startPosition);
+        }
+
+        if (tree.getNumChildren() == 0)
+        {
+            out.write("/>", 2);
+            return;
+        }
+
+        out.writeByte('>');
+
+        for (const auto &child : tree)
+        {
+            out << newLineChars;
+            writeElement(out, child, indentLevel + 2, lineWrapLength, newLineChars);
+        }
+
+        out << newLineChars;
+        writeSpaces(out, indentLevel);
+
+        out.write("</", 2);
+        out << tagName.toString();
+        out.writeByte('>');
+    }
+
+    static inline bool isLegalXmlChar(const uint32 c) noexcept
+    {
+        static const unsigned char legalChars[] =
+            { 0, 0, 0, 0, 187, 255, 255, 175, 255, 255, 255, 191, 254, 255, 255, 127 };
+
+        return c < sizeof(legalChars) * 8 && (legalChars[c >> 3] & (1 << (c & 7))) != 0;
+    }
+
+    static void writeEscaped(OutputStream &out, const String &text, bool changeNewLines)
+    {
+        auto t = text.getCharPointer();
+
+        for (;;)
+        {
+            const auto c = static_cast<uint32>(t.getAndAdvance());
+            if (c == 0)
+            {
+                break;
+            }
+
+            if (isLegalXmlChar(c))
+            {
+                out.writeByte(static_cast<char>(c));
+                continue;
+            }
+
+            switch (c)
+            {
+            case '&':   out << "&amp;"; break;
+            case '"':   out << "&quot;"; break;
+            case '>':   out << "&gt;"; break;
+            case '<':   out << "&lt;"; break;
+
+            case '\n':
+            case '\r':
+                if (!changeNewLines)
+                {
+                    out.writeByte(static_cast<char>(c));
+                    break;
+                }
+                out << "&#" << static_cast<int>(c) << ';';
+                break;
+
+            default:
+                out << "&#" << static_cast<int>(c) << ';';
+                break;
+            }
+        }
+    }
+
+    static void writeSpaces(OutputStream &out, int numSpaces)
+    {
+        out.writeRepeatedByte(' ', size_t(numSpaces));
+    }
+};
+
+//===----------------------------------------------------------------------===//
+// Xml serializer
+//===----------------------------------------------------------------------===//
+
 Result XmlSerializer::saveToFile(File file, const SerializedData &tree) const
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    FileOutputStream fileStream(file);
+    if (fileStream.openedOk())
     {
-        const auto saved = xml->writeTo(file, getXmlFormat());
-        return saved ? Result::ok() : Result::fail({});
+        fileStream.setPosition(0);
+        fileStream.truncate();
+
+        const auto result = this->saveToStream(fileStream, tree);
+
+        fileStream.flush();
+        return result.failed() ? result : fileStream.getStatus();
     }
 
-    return Result::fail({});
+    return Result::fail("Failed to save");
 }
 
 SerializedData XmlSerializer::loadFromFile(const File &file) const
 {
-    XmlDocument document(file);
-    UniquePointer<XmlElement> xml(document.getDocumentElement());
-    if (xml != nullptr)
+    FileInputStream fileStream(file);
+    if (fileStream.openedOk())
     {
-        return SerializedData::readFromXml(*xml);
+        return this->loadFromStream(fileStream);
     }
 
     return {};
@@ -55,21 +508,46 @@ SerializedData XmlSerializer::loadFromFile(const File &file) const
 
 Result XmlSerializer::saveToString(String &string, const SerializedData &tree) const
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    MemoryOutputStream mo(1024);
+    const auto result = this->saveToStream(mo, tree);
+    if (result.wasOk())
     {
-        string = xml->toString(getXmlFormat());
-        return Result::ok();
+        string = mo.toUTF8();
     }
 
-    return Result::fail({});
+    return result;
 }
 
 SerializedData XmlSerializer::loadFromString(const String &string) const
 {
-    XmlDocument document(string);
-    UniquePointer<XmlElement> xml(document.getDocumentElement());
-    return SerializedData::readFromXml(*xml);
+    // juce::String keeps its text as UTF-8, so no copies are made here
+    MemoryInputStream stream(string.toRawUTF8(), string.getNumBytesAsUTF8(), false);
+    return this->loadFromStream(stream);
+}
+
+Result XmlSerializer::saveToStream(OutputStream &stream, const SerializedData &tree) const
+{
+    if (!tree.isValid())
+    {
+        return Result::fail({});
+    }
+
+    XmlFormatter::write(stream, tree, getXmlFormat());
+    return Result::ok();
+}
+
+SerializedData XmlSerializer::loadFromStream(InputStream &stream) const
+{
+    SerializedData root;
+    XmlParser parser(stream);
+    const auto result = parser.parseDocument(root);
+    if (result.wasOk())
+    {
+        return root;
+    }
+
+    DBG(result.getErrorMessage());
+    return {};
 }
 
 bool XmlSerializer::supportsFileWithExtension(const String &extension) const
@@ -81,3 +559,80 @@ bool XmlSerializer::supportsFileWithHeader(const String &header) const
 {
     return header.startsWithIgnoreCase("<?xml");
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+#include "SerializerTestTree.h"
+
+class XmlSerializerTests final : public UnitTest
+{
+public:
+    XmlSerializerTests() : UnitTest("Streaming xml serializer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        const XmlSerializer serializer;
+
+        beginTest("Streaming writer matches XmlElement output");
+
+        const auto tree = SerializerTestTree::create(5, 4);
+        String streamedText;
+        expect(serializer.saveToString(streamedText, tree).wasOk());
+
+        const auto xml = tree.writeToXml();
+        const auto domText = xml->toString(getXmlFormat());
+        expectEquals(streamedText, domText);
+
+        beginTest("Streaming reader matches XmlDocument");
+
+        XmlDocument document(domText);
+        const UniquePointer<XmlElement> parsedXml(document.getDocumentElement());
+        expect(parsedXml != nullptr);
+
+        const auto domTree = SerializedData::readFromXml(*parsedXml);
+        const auto streamedTree = serializer.loadFromString(domText);
+        expect(streamedTree.isEquivalentTo(domTree));
+        expect(streamedTree.isEquivalentTo(tree));
+
+        beginTest("Streaming reader skips comments and handles malformed input");
+
+        const auto withComments = serializer.loadFromString(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n<!-- comment -->\r\n"
+            "<a x='1' y=\"&lt;&#65;&#x42;&gt;\"><!-- another one --><b/></a>");
+        expect(withComments.hasType("a"));
+        expectEquals(withComments.getProperty("y").toString(), String("<AB>"));
+        expectEquals(withComments.getNumChildren(), 1);
+
+        expect(!serializer.loadFromString("<a><b></a>").isValid());
+        expect(!serializer.loadFromString("<a x=\"1></a>").isValid());
+        expect(!serializer.loadFromString({}).isValid());
+
+        beginTest("Streaming writer and reader match XmlElement on a large tree");
+
+        const auto largeTree = SerializerTestTree::create(3, 32);
+        const auto largeXml = largeTree.writeToXml();
+        const auto largeDomText = largeXml->toString(getXmlFormat());
+
+        MemoryOutputStream largeStreamedText;
+        expect(serializer.saveToStream(largeStreamedText, largeTree).wasOk());
+        expectEquals(largeStreamedText.toUTF8(), largeDomText);
+
+        XmlDocument largeDocument(largeDomText);
+        const UniquePointer<XmlElement> largeParsedXml(largeDocument.getDocumentElement());
+        expect(largeParsedXml != nullptr);
+        const auto largeDomTree = SerializedData::readFromXml(*largeParsedXml);
+
+        MemoryInputStream largeInput(largeStreamedText.getData(), largeStreamedText.getDataSize(), false);
+        const auto largeStreamedTree = serializer.loadFromStream(largeInput);
+        expect(largeStreamedTree.isEquivalentTo(largeDomTree));
+        expect(largeStreamedTree.isEquivalentTo(largeTree));
+    }
+};
+
+static XmlSerializerTests xmlSerializerTests;
+
+#endif
@@ -0,0 +1,332 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ProjectLoader.h"
+#include "ProjectNode.h"
+#include "PianoTrackNode.h"
+#include "AutomationTrackNode.h"
+#include "PatternEditorNode.h"
+#include "TreeNodeSerializer.h"
+#include "DocumentHelpers.h"
+#include "MainLayout.h"
+#include "Workspace.h"
+
+ProjectLoader::ProjectLoader(ProjectNode &project) :
+    Thread("ProjectLoader"),
+    project(project) {}
+
+ProjectLoader::~ProjectLoader()
+{
+    this->stopTimer();
+    // the parser can't be interrupted, so give it some time to finish:
+    this->stopThread(5000);
+}
+
+void ProjectLoader::loadAsync(const File &file)
+{
+    if (this->isThreadRunning())
+    {
+        DBG("Warning: failed to start project loader thread, already running");
+        return;
+    }
+
+    {
+        const ScopedLock lock(this->readyNodesLock);
+        this->parsedRoot = {};
+        this->hasParsingFailed = false;
+        this->hasParsingFinished = false;
+        this->numTotalNodes = 0;
+        this->readyNodesData.clearQuick();
+        this->readyNodes.clearQuick(true);
+    }
+
+    this->file = file;
+    this->root = {};
+    this->state = State::Loading;
+    this->hasRestoredProperties = false;
+    this->numRestoredNodes = 0;
+    this->loadingStartTimeMs = Time::getMillisecondCounterHiRes();
+
+    this->startThread(7);
+    this->startTimer(ProjectLoader::minUpdateIntervalMs);
+}
+
+bool ProjectLoader::isLoading() const noexcept
+{
+    return this->state == State::Loading || this->state == State::Failed;
+}
+
+void ProjectLoader::selectFirstTrackWhenAvailable() noexcept
+{
+    this->shouldSelectFirstTrack = true;
+}
+
+//===----------------------------------------------------------------------===//
+// Thread
+//===----------------------------------------------------------------------===//
+
+void ProjectLoader::run()
+{
+    const auto tree = DocumentHelpers::load(this->file);
+
+    const auto projectRoot = tree.hasType(Serialization::Core::project) ?
+        tree : tree.getChildWithName(Serialization::Core::project);
+
+    if (!projectRoot.isValid())
+    {
+        const ScopedLock lock(this->readyNodesLock);
+        this->hasParsingFailed = true;
+        return;
+    }
+
+    {
+        int numNodes = 0;
+        for (const auto &child : projectRoot)
+        {
+            numNodes += child.hasType(Serialization::Core::treeNode) ? 1 : 0;
+        }
+
+        const ScopedLock lock(this->readyNodesLock);
+        this->parsedRoot = projectRoot;
+        this->numTotalNodes = numNodes;
+    }
+
+    forEachChildWithType(projectRoot, e, Serialization::Core::treeNode)
+    {
+        if (this->threadShouldExit())
+        {
+            return;
+        }
+
+        // the tracks don't depend on the rest of the project,
+        // so they are safe to be deserialized while detached from the tree:
+        UniquePointer<TreeNode> node;
+        const Identifier type(e.getProperty(Serialization::Core::treeNodeType));
+        if (type == Serialization::Core::pianoTrack)
+        {
+            node = make<PianoTrackNode>("");
+        }
+        else if (type == Serialization::Core::automationTrack)
+        {
+            node = make<AutomationTrackNode>("");
+        }
+
+        if (node != nullptr)
+        {
+            node->deserialize(e);
+        }
+
+        const ScopedLock lock(this->readyNodesLock);
+        this->readyNodesData.add(e);
+        this->readyNodes.add(node.release());
+    }
+
+    const ScopedLock lock(this->readyNodesLock);
+    this->hasParsingFinished = true;
+}
+
+//===----------------------------------------------------------------------===//
+// Timer
+//===----------------------------------------------------------------------===//
+
+void ProjectLoader::timerCallback()
+{
+    jassert(this->state == State::Loading);
+
+    bool parsingFailed = false;
+
+    {
+        const ScopedLock lock(this->readyNodesLock);
+        parsingFailed = this->hasParsingFailed;
+        this->root = this->parsedRoot;
+    }
+
+    if (parsingFailed)
+    {
+        DBG("Failed to load project: " + this->file.getFullPathName());
+        this->failLoading(true);
+        return;
+    }
+
+    if (!this->root.isValid())
+    {
+        return; // still parsing
+    }
+
+    if (!this->hasRestoredProperties && !this->restoreProjectProperties())
+    {
+        return;
+    }
+
+    this->restoreReadyNodes();
+}
+
+bool ProjectLoader::restoreProjectProperties()
+{
+    const String projectId = this->root.getProperty(Serialization::Core::projectId);
+
+    for (auto *loadedProject : App::Workspace().getLoadedProjects())
+    {
+        if (loadedProject != &this->project && loadedProject->getId() == projectId)
+        {
+            DBG("The project is already loaded: " + projectId);
+            loadedProject->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+            this->failLoading(false);
+            return false;
+        }
+    }
+
+    // the timeline is restored first, so that
+    // the sequencer is usable before any tracks arrive
+    this->project.loadProjectProperties(this->root);
+    this->project.broadcastReloadProjectContentAndBeatRange();
+    this->hasRestoredProperties = true;
+    return true;
+}
+
+void ProjectLoader::restoreReadyNodes()
+{
+    Array<SerializedData> nodesData;
+    OwnedArray<TreeNode> nodes;
+    bool parsingFinished = false;
+    int numNodes = 0;
+
+    {
+        const ScopedLock lock(this->readyNodesLock);
+        nodesData.swapWith(this->readyNodesData);
+        nodes.swapWith(this->readyNodes);
+        parsingFinished = this->hasParsingFinished;
+        numNodes = this->numTotalNodes;
+    }
+
+    jassert(nodesData.size() == nodes.size());
+
+    if (!nodesData.isEmpty())
+    {
+        const auto updateStartTimeMs = Time::getMillisecondCounterHiRes();
+
+        for (const auto &data : nodesData)
+        {
+            UniquePointer<TreeNode> node(nodes.removeAndReturn(0));
+            if (node != nullptr)
+            {
+                this->project.attachLoadedNode(node.release());
+            }
+            else
+            {
+                TreeNodeSerializer::deserializeChild(this->project, data);
+            }
+        }
+
+        this->numRestoredNodes += nodesData.size();
+        this->project.broadcastReloadProjectContentAndBeatRange();
+
+        if (this->shouldSelectFirstTrack &&
+            this->project.selectFirstChildOfType<PianoTrackNode>())
+        {
+            this->shouldSelectFirstTrack = false;
+        }
+
+        App::Workspace().selectPendingTreeNode();
+
+        // reloading the views is the most expensive part here, and it gets slower
+        // as more tracks are loaded, so let the message thread breathe in between
+        const auto updateTimeMs = Time::getMillisecondCounterHiRes() - updateStartTimeMs;
+        this->startTimer(jmax(ProjectLoader::minUpdateIntervalMs, int(updateTimeMs * 2.0)));
+    }
+
+    if (parsingFinished && this->numRestoredNodes == numNodes)
+    {
+        this->finishLoading();
+        return;
+    }
+
+    this->showProgress(this->numRestoredNodes, numNodes);
+}
+
+void ProjectLoader::finishLoading()
+{
+    this->stopTimer();
+
+    this->project.loadProjectState(this->root);
+    this->state = State::Loaded;
+    this->root = {};
+
+    if (this->shouldSelectFirstTrack)
+    {
+        this->project.selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+        this->shouldSelectFirstTrack = false;
+    }
+
+    App::Workspace().selectPendingTreeNode();
+
+    if (this->isShowingProgress)
+    {
+        App::Layout().hideTooltipIfAny();
+        this->isShowingProgress = false;
+    }
+
+    App::Workspace().getUserProfile()
+        .onProjectLocalInfoUpdated(this->project.getId(), this->project.getName(),
+            this->project.getDocument()->getFullPath());
+
+    DBG("Project loaded in " +
+        String(Time::getMillisecondCounterHiRes() - this->loadingStartTimeMs) + "ms");
+}
+
+void ProjectLoader::failLoading(bool showFailureMessage)
+{
+    this->stopTimer();
+
+    this->state = State::Failed;
+    this->root = {};
+
+    if (this->isShowingProgress)
+    {
+        App::Layout().hideTooltipIfAny();
+        this->isShowingProgress = false;
+    }
+
+    if (showFailureMessage)
+    {
+        App::Layout().showTooltip({}, MainLayout::TooltipIcon::Failure);
+    }
+
+    // the project owns this loader, so it can't be deleted right here
+    MessageManager::callAsync([project = WeakReference<TreeNode>(&this->project)]()
+    {
+        if (project != nullptr)
+        {
+            TreeNode::deleteNode(project.get(), true);
+        }
+    });
+}
+
+void ProjectLoader::showProgress(int numRestored, int numTotal)
+{
+    // don't show anything for the projects which load fast enough
+    const auto loadingTimeMs = Time::getMillisecondCounterHiRes() - this->loadingStartTimeMs;
+    if (loadingTimeMs < ProjectLoader::progressDelayMs)
+    {
+        return;
+    }
+
+    const auto percent = (numTotal > 0) ? ((numRestored * 100) / numTotal) : 0;
+    App::Layout().showTooltip(this->project.getName() + ": " + String(percent) + "%");
+    this->isShowingProgress = true;
+}
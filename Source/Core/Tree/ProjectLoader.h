@@ -0,0 +1,98 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class ProjectNode;
+class TreeNode;
+
+// Opens the project file in two stages: the document is read, parsed,
+// and the tracks are deserialized on a background thread, while
+// the message thread periodically picks up whatever is ready so far,
+// attaches it to the project and updates the views;
+// this way the app doesn't freeze on large projects, and the sequencer
+// becomes navigable as soon as the timeline and the first tracks are there.
+
+class ProjectLoader final : private Thread, private Timer
+{
+public:
+
+    explicit ProjectLoader(ProjectNode &project);
+    ~ProjectLoader() override;
+
+    void loadAsync(const File &file);
+
+    // also true if the project has failed to load,
+    // so that the incomplete project never overwrites its file
+    bool isLoading() const noexcept;
+
+    void selectFirstTrackWhenAvailable() noexcept;
+
+private:
+
+    void run() override;
+    void timerCallback() override;
+
+    bool restoreProjectProperties();
+    void restoreReadyNodes();
+    void finishLoading();
+    void failLoading(bool showFailureMessage);
+
+    void showProgress(int numRestored, int numTotal);
+
+    ProjectNode &project;
+    File file;
+
+    // the project data, as seen from the message thread
+    SerializedData root;
+
+    enum class State : int8
+    {
+        Idle,
+        Loading,
+        Loaded,
+        Failed
+    };
+
+    State state = State::Idle;
+
+    bool hasRestoredProperties = false;
+    bool shouldSelectFirstTrack = false;
+    bool isShowingProgress = false;
+    double loadingStartTimeMs = 0.0;
+    int numRestoredNodes = 0;
+
+    // all below is written by the loader thread and is guarded by this lock:
+    CriticalSection readyNodesLock;
+    SerializedData parsedRoot;
+    bool hasParsingFailed = false;
+    bool hasParsingFinished = false;
+    int numTotalNodes = 0;
+
+    // the nodes are picked up in the order they appear in the document,
+    // because the tree node ids are index paths; the tracks arrive here
+    // already deserialized, and the rest of the nodes, which would need
+    // to be attached to the tree in order to deserialize, are null,
+    // so that the message thread deserializes them from their data
+    Array<SerializedData> readyNodesData;
+    OwnedArray<TreeNode> readyNodes;
+
+    static constexpr auto minUpdateIntervalMs = 50;
+    static constexpr auto progressDelayMs = 500;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProjectLoader)
+};
@@ -19,6 +19,7 @@
 #include "ProjectNode.h"
 
 #include "TreeNodeSerializer.h"
+#include "ProjectLoader.h"
 #include "TrackGroupNode.h"
 #include "PianoTrackNode.h"
 #include "AutomationTrackNode.h"
@@ -40,6 +41,12 @@
 #include "MidiRecorder.h"
 #include "KeyboardMapping.h"
 #include "GeneratedSequenceBuilder.h"
+#include "PianoSequence.h"
+#include "AutomationSequence.h"
+#include "AnnotationsSequence.h"
+#include "KeySignaturesSequence.h"
+#include "TimeSignaturesSequence.h"
+#include "MidiFileWriter.h"
 #include "CommandPaletteTimelineEvents.h"
 
 #include "ProjectMetadata.h"
@@ -103,6 +110,7 @@ void ProjectNode::initialize()
 ProjectNode::~ProjectNode()
 {
     this->getDocument()->save();
+    this->loader = nullptr;
 
     this->transport->stopPlaybackAndRecording();
     this->transport->stopRender();
@@ -133,6 +141,22 @@ String ProjectNode::getId() const noexcept
     return this->id;
 }
 
+bool ProjectNode::isLoading() const noexcept
+{
+    return this->loader != nullptr && this->loader->isLoading();
+}
+
+void ProjectNode::selectFirstTrackWhenAvailable()
+{
+    if (this->isLoading())
+    {
+        this->loader->selectFirstTrackWhenAvailable();
+        return;
+    }
+
+    this->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+}
+
 String ProjectNode::getStats() const
 {
     const auto tracks = this->findChildrenOfType<MidiTrackNode>();
@@ -508,12 +532,12 @@ void ProjectNode::deserialize(const SerializedData &data)
     
     if (fullPathFile.existsAsFile())
     {
-        this->getDocument()->load(fullPathFile);
+        this->getDocument()->loadAsync(fullPathFile);
         return;
     }
     else if (relativePathFile.existsAsFile())
     {
-        this->getDocument()->load(relativePathFile);
+        this->getDocument()->loadAsync(relativePathFile);
         return;
     }
 
@@ -553,25 +577,37 @@ SerializedData ProjectNode::save() const
 
 void ProjectNode::load(const SerializedData &tree)
 {
-    this->broadcastBeforeReloadProjectContent();
-    this->reset();
-
     const auto root = tree.hasType(Serialization::Core::project) ?
         tree : tree.getChildWithName(Serialization::Core::project);
 
     if (!root.isValid()) { return; }
 
+    this->loadProjectProperties(root);
+
+    // Proceed with basic properties and children
+    TreeNode::deserialize(root);
+
+    this->broadcastReloadProjectContentAndBeatRange();
+    this->loadProjectState(root);
+}
+
+void ProjectNode::loadProjectProperties(const SerializedData &root)
+{
+    this->broadcastBeforeReloadProjectContent();
+    this->reset();
+
     this->id = root.getProperty(Serialization::Core::projectId, Uuid().toString());
-    
+    this->name = root.getProperty(Serialization::Core::treeNodeName, this->name);
+
     const auto grouping = root.getProperty(Serialization::UI::trackGrouping, int(this->trackGroupingMode));
     this->trackGroupingMode = MidiTrack::Grouping(int(grouping));
 
     this->metadata->deserialize(root);
     this->timeline->deserialize(root);
+}
 
-    // Proceed with basic properties and children
-    TreeNode::deserialize(root);
-
+void ProjectNode::loadProjectState(const SerializedData &root)
+{
     // Legacy support: if no pattern set manager found, create one
     if (nullptr == this->findChildOfType<PatternEditorNode>())
     {
@@ -579,6 +615,30 @@ void ProjectNode::load(const SerializedData &tree)
         this->addChildNode(new PatternEditorNode(), 1);
     }
 
+    this->undoStack->deserialize(root);
+
+    // At least, when all tracks are ready:
+    this->transport->deserialize(root);
+    this->sequencerLayout->deserialize(root);
+}
+
+void ProjectNode::attachLoadedNode(TreeNode *node)
+{
+    // the node is already deserialized, and is attached silently,
+    // the views are supposed to be updated with a reload broadcast,
+    // but the tracks cache and the vcs should know about it right away:
+    this->addChildNode(node, -1, false);
+    this->isTracksCacheOutdated = true;
+
+    if (auto *tracked = dynamic_cast<VCS::TrackedItem *>(node))
+    {
+        const ScopedWriteLock lock(this->vcsInfoLock);
+        this->vcsItems.addIfNotAlreadyThere(tracked);
+    }
+}
+
+void ProjectNode::broadcastReloadProjectContentAndBeatRange()
+{
     this->broadcastReloadProjectContent();
     const auto range = this->broadcastChangeProjectBeatRange();
 
@@ -591,18 +651,15 @@ void ProjectNode::load(const SerializedData &tree)
     const float viewFirstBeat = floorf(viewStartWithMargin / r) * r;
     const float viewLastBeat = ceilf(viewEndWithMargin / r) * r;
     this->broadcastChangeViewBeatRange(viewFirstBeat, viewLastBeat);
-
-    this->undoStack->deserialize(root);
-
-    // At least, when all tracks are ready:
-    this->transport->deserialize(root);
-    this->sequencerLayout->deserialize(root);
 }
 
 void ProjectNode::importMidi(InputStream &stream)
 {
+    // not creating matching note-offs here: JUCE does that by rescanning
+    // the track for each note-on, while the demultiplexer does the same
+    // pairing in a single pass (see MidiTrackDemultiplexer)
     MidiFile tempFile;
-    if (!tempFile.readFrom(stream))
+    if (!tempFile.readFrom(stream, false))
     {
         DBG("Midi file appears corrupted");
         jassertfalse;
@@ -616,55 +673,27 @@ void ProjectNode::importMidi(InputStream &stream)
     const auto colours = ColourIDs::getColoursList();
     const auto timeFormat = tempFile.getTimeFormat();
 
+    auto demultiplexer = make<MidiTrackDemultiplexer>();
+
     for (int i = 0; i < tempFile.getNumTracks(); i++)
     {
         const auto *importedTrack = tempFile.getTrack(i);
+        demultiplexer->demultiplex(*importedTrack);
 
-        auto trackName = "Track " + String(i);
-        const auto trackColour = colours[r.nextInt(colours.size())];
-
-        // the MIDI standard allows to set channels and controller numbers per-message,
-        // while in Helio channels and controllers are per-track for simplicity,
-        // so let's group all found notes in each track by channel
-        // (a different channel often means a different instrument):
-        FlatHashSet<int> pianoChannels;
-        
-        // and group automation events by controller number, picking the last
-        // found channel for it, which is not ideal but should be ok in practice:
-        FlatHashMap<int, int> automationControllers;
+        const auto trackName = demultiplexer->getTrackName().isNotEmpty() ?
+            demultiplexer->getTrackName() : "Track " + String(i);
 
-        for (int j = 0; j < importedTrack->getNumEvents(); ++j)
-        {
-            const auto *event = importedTrack->getEventPointer(j);
-            const auto channel = jlimit(1, Globals::numChannels, event->message.getChannel());
-
-            if (event->message.isTrackNameEvent())
-            {
-                trackName = event->message.getTextFromTextMetaEvent();
-            }
-            else if (event->message.isController())
-            {
-                automationControllers.insert({ event->message.getControllerNumber(), channel });
-            }
-            else if (event->message.isTempoMetaEvent())
-            {
-                automationControllers.insert({ MidiTrack::DefaultControllers::tempoController, channel });
-            }
-            else if (event->message.isNoteOnOrOff())
-            {
-                pianoChannels.insert(channel);
-            }
-        }
+        const auto trackColour = colours[r.nextInt(colours.size())];
 
         // split into several automation tracks, if needed
-        for (const auto &trackInfo : automationControllers)
+        for (const auto &trackInfo : demultiplexer->getControllers())
         {
             const auto trackControllerNumber = trackInfo.first;
-            const auto trackChannel = trackInfo.second;
+            const auto trackChannel = trackInfo.second.channel;
             const bool isTempoTrack = trackControllerNumber == MidiTrack::DefaultControllers::tempoController;
             const String controllerName(MidiMessage::getControllerName(trackControllerNumber));
 
-            MidiTrackNode *trackNode = new AutomationTrackNode(isTempoTrack ?
+            auto *trackNode = new AutomationTrackNode(isTempoTrack ?
                 TRANS(I18n::Defaults::tempoTrackName) :
                 (controllerName.isEmpty() ? trackName : trackName + " - " + controllerName));
 
@@ -679,15 +708,14 @@ void ProjectNode::importMidi(InputStream &stream)
             trackNode->setTrackChannel(trackChannel, false, dontSendNotification);
             trackNode->setTrackColour(trackColour, false, dontSendNotification);
 
-            const auto isSingleControllerTrack = automationControllers.size() == 1;
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat,
-                isSingleControllerTrack ? Optional<int>() : trackControllerNumber);
+            auto *sequence = static_cast<AutomationSequence *>(trackNode->getSequence());
+            sequence->importMidi(trackInfo.second.messages, timeFormat);
         }
 
         // split into several piano tracks, if needed
-        for (const auto trackChannel : pianoChannels)
+        for (const auto trackChannel : demultiplexer->getNoteChannels())
         {
-            MidiTrackNode *trackNode = new PianoTrackNode(trackChannel == 1 ?
+            auto *trackNode = new PianoTrackNode(trackChannel == 1 ?
                 trackName : trackName + " - " + String(trackChannel));
 
             const Clip clip(trackNode->getPattern());
@@ -700,17 +728,20 @@ void ProjectNode::importMidi(InputStream &stream)
             trackNode->setTrackChannel(trackChannel, false, dontSendNotification);
             trackNode->setTrackColour(trackColour, false, dontSendNotification);
 
-            const auto isSingleChannelTrack = pianoChannels.size() == 1;
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat,
-                isSingleChannelTrack ? Optional<int>() : trackChannel);
+            auto *sequence = static_cast<PianoSequence *>(trackNode->getSequence());
+            sequence->importMidi(demultiplexer->getNotes(trackChannel), timeFormat);
         }
 
         // if the track contains any key/time signatures, try importing them all,
         // skipping others (assuming that there might be cases where tracks contain
         // events of different types, e.g. mostly notes but also some meta events):
-        this->timeline->getAnnotations()->getSequence()->importMidi(*importedTrack, timeFormat, {});
-        this->timeline->getKeySignatures()->getSequence()->importMidi(*importedTrack, timeFormat, {});
-        this->timeline->getTimeSignatures()->getSequence()->importMidi(*importedTrack, timeFormat, {});
+        const auto &timelineEvents = demultiplexer->getTimelineEvents();
+        static_cast<AnnotationsSequence *>(this->timeline->getAnnotations()->getSequence())->
+            importMidi(timelineEvents, timeFormat);
+        static_cast<KeySignaturesSequence *>(this->timeline->getKeySignatures()->getSequence())->
+            importMidi(timelineEvents, timeFormat);
+        static_cast<TimeSignaturesSequence *>(this->timeline->getTimeSignatures()->getSequence())->
+            importMidi(timelineEvents, timeFormat);
     }
     
     this->isTracksCacheOutdated = true;
@@ -947,8 +978,24 @@ bool ProjectNode::onDocumentLoad(const File &file)
     return false;
 }
 
+bool ProjectNode::onDocumentLoadAsync(const File &file)
+{
+    if (this->loader == nullptr)
+    {
+        this->loader = make<ProjectLoader>(*this);
+    }
+
+    this->loader->loadAsync(file);
+    return true;
+}
+
 bool ProjectNode::onDocumentSave(const File &file)
 {
+    if (this->isLoading())
+    {
+        return false; // never overwrite the file with an incomplete project
+    }
+
     const auto projectNode = this->save();
 #if DEBUG
     DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
@@ -968,12 +1015,9 @@ bool ProjectNode::onDocumentExport(OutputStream &stream)
     return this->exportMidi(stream);
 }
 
-bool ProjectNode::exportMidi(OutputStream &stream) const
+bool ProjectNode::exportMidi(OutputStream &stream,
+    int ticksPerQuarterNote /*= 960*/, int midiFileType /*= 1*/) const
 {
-    MidiFile tempFile;
-    static const double midiClock = 960.0;
-    tempFile.setTicksPerQuarterNote(int(midiClock));
-
     static Clip noTransform;
     static KeyboardMapping simpleMapping;
 
@@ -984,52 +1028,105 @@ bool ProjectNode::exportMidi(OutputStream &stream) const
     // Metronome track flag is only needed for playback:
     const bool metronomeFlag = false;
 
+    const auto timeFactor = double(ticksPerQuarterNote);
+
+    // the project will not necessarily start from 0 timestamp;
+    // normally we don't care (not caring about that also makes the code simpler),
+    // but when exporting to MIDI file, let's make sure the start is at zero:
+    const auto ticksOffset = -this->beatRange.getStart() * timeFactor;
+
+    // the groups of tracks to be written as track chunks,
+    // in the order of their first appearance in the project
     const auto grouping = this->getTrackGroupingMode();
-    FlatHashMap<String, MidiMessageSequence, StringHash> sequences;
+    Array<String> groupKeys;
+    FlatHashMap<String, Array<const MidiTrack *>, StringHash> groups;
 
     for (const auto *track : this->getTracks())
     {
+        // plugin parameters automation only makes sense for playback:
+        if (track->isPluginParameterAutomationTrack())
+        {
+            continue;
+        }
+
         const auto groupKey = track->getTrackGroupKey(grouping);
-        if (!sequences.contains(groupKey))
+        if (!groups.contains(groupKey))
         {
-            sequences.insert({ groupKey, {} });
+            groupKeys.add(groupKey);
         }
 
-        auto &sequence = sequences[groupKey];
+        groups[groupKey].add(track);
+    }
 
+    // each clip is exported into its own sorted sequence, and the writer
+    // merges them into the track chunk, so that only the tracks of
+    // the current chunk are kept in memory at a time
+    OwnedArray<MidiMessageSequence> clipSequences;
+    const auto exportTracks = [&](const Array<const MidiTrack *> &tracks)
+    {
         // todo add more meta events like track name
-        if (track->getPattern() != nullptr)
+        for (const auto *track : tracks)
         {
-            for (const auto *clip : track->getPattern()->getClips())
+            if (track->getPattern() != nullptr)
+            {
+                for (const auto *clip : track->getPattern()->getClips())
+                {
+                    track->getSequence()->exportMidi(*clipSequences.add(new MidiMessageSequence()),
+                        *clip, simpleMapping, *this->generatedSequenceBuilder,
+                        soloFlag, metronomeFlag,
+                        this->beatRange.getStart(), this->beatRange.getEnd(),
+                        timeFactor);
+                }
+            }
+            else
             {
-                track->getSequence()->exportMidi(sequence, *clip,
-                    simpleMapping, *this->generatedSequenceBuilder,
+                track->getSequence()->exportMidi(*clipSequences.add(new MidiMessageSequence()),
+                    noTransform, simpleMapping, *this->generatedSequenceBuilder,
                     soloFlag, metronomeFlag,
                     this->beatRange.getStart(), this->beatRange.getEnd(),
-                    midiClock);
+                    timeFactor);
             }
         }
-        else
+    };
+
+    // the retriggered notes are closed in each track chunk,
+    // like the export through MidiFile used to do it:
+    MidiFileWriter writer(stream, ticksPerQuarterNote, midiFileType, true);
+
+    if (midiFileType == 0)
+    {
+        for (const auto &groupKey : groupKeys)
+        {
+            exportTracks(groups.at(groupKey));
+        }
+
+        if (!writer.writeHeader(1) ||
+            !writer.writeTrack(clipSequences, ticksOffset))
         {
-            track->getSequence()->exportMidi(sequence, noTransform,
-                simpleMapping, *this->generatedSequenceBuilder,
-                soloFlag, metronomeFlag,
-                this->beatRange.getStart(), this->beatRange.getEnd(),
-                midiClock);
+            return false;
         }
     }
-
-    for (const auto &i : sequences)
+    else
     {
-        // the project will not necessarily start from 0 timestamp;
-        // normally we don't care (not caring about that also makes the code simpler),
-        // but when exporting to MIDI file, let's make sure the start is at zero:
-        auto &sequence = sequences[i.first];
-        sequence.addTimeToMessages(-this->beatRange.getStart() * midiClock);
-        tempFile.addTrack(sequence);
+        if (!writer.writeHeader(groupKeys.size()))
+        {
+            return false;
+        }
+
+        for (const auto &groupKey : groupKeys)
+        {
+            clipSequences.clearQuick(true);
+            exportTracks(groups.at(groupKey));
+
+            if (!writer.writeTrack(clipSequences, ticksOffset))
+            {
+                return false;
+            }
+        }
     }
 
-    return tempFile.writeTo(stream);
+    stream.flush();
+    return true;
 }
 
 //===----------------------------------------------------------------------===//
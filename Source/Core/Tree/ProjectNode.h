@@ -33,6 +33,7 @@ class GeneratedSequenceBuilder;
 class UndoStack;
 class Pattern;
 class Clip;
+class ProjectLoader;
 
 #include "TreeNode.h"
 #include "DocumentOwner.h"
@@ -62,6 +63,11 @@ public:
     String getId() const noexcept;
     String getStats() const;
 
+    // true until the project is fully restored from the file,
+    // see Document::loadAsync and ProjectLoader
+    bool isLoading() const noexcept;
+    void selectFirstTrackWhenAvailable();
+
     Transport &getTransport() const noexcept;
     ProjectMetadata *getProjectInfo() const noexcept;
     ProjectTimeline *getTimeline() const noexcept;
@@ -70,7 +76,8 @@ public:
     GeneratedSequenceBuilder *getGeneratedSequences() const;
     
     void importMidi(InputStream &stream);
-    bool exportMidi(OutputStream &stream) const;
+    bool exportMidi(OutputStream &stream,
+        int ticksPerQuarterNote = 960, int midiFileType = 1) const;
 
     Image getIcon() const noexcept override;
 
@@ -201,6 +208,7 @@ protected:
     //===------------------------------------------------------------------===//
 
     bool onDocumentLoad(const File &file) override;
+    bool onDocumentLoadAsync(const File &file) override;
     bool onDocumentSave(const File &file) override;
     void onDocumentImport(InputStream &stream) override;
     bool onDocumentExport(OutputStream &stream) override;
@@ -243,6 +251,15 @@ private:
     SerializedData save() const;
     void load(const SerializedData &tree);
 
+    // the loading stages shared by load() and ProjectLoader
+    void loadProjectProperties(const SerializedData &root);
+    void loadProjectState(const SerializedData &root);
+    void attachLoadedNode(TreeNode *node);
+    void broadcastReloadProjectContentAndBeatRange();
+
+    UniquePointer<ProjectLoader> loader;
+    friend class ProjectLoader;
+
 private:
 
     String id;
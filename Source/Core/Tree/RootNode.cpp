@@ -86,22 +86,14 @@ ProjectNode *RootNode::openProject(const File &file)
         auto project = make<ProjectNode>(file);
         this->addChildNode(project.get(), 1);
 
-        if (!project->getDocument()->load(file))
+        // the project is restored in the background, and the second check
+        // for duplicates (project id) is done by the loader, when the id is known
+        if (!project->getDocument()->loadAsync(file))
         {
             return nullptr;
         }
 
-        // second check for duplicates (project id)
-        for (auto *myProject : myProjects)
-        {
-            if (myProject->getId() == project->getId())
-            {
-                myProject->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
-                return nullptr;
-            }
-        }
-
-        project->selectFirstChildOfType<PianoTrackNode, PatternEditorNode>();
+        project->selectFirstTrackWhenAvailable();
         return project.release();
     }
 
@@ -40,29 +40,36 @@ void TreeNodeSerializer::serializeChildren(const TreeNode &parentItem, Serialize
 }
 
 void TreeNodeSerializer::deserializeChildren(TreeNode &parentItem, const SerializedData &parent)
+{
+    forEachChildWithType(parent, e, Serialization::Core::treeNode)
+    {
+        TreeNodeSerializer::deserializeChild(parentItem, e);
+    }
+}
+
+TreeNode *TreeNodeSerializer::deserializeChild(TreeNode &parentItem, const SerializedData &child)
 {
     using namespace Serialization;
 
-    forEachChildWithType(parent, e, Core::treeNode)
-    {
-        const auto type = Identifier(e.getProperty(Core::treeNodeType));
+    const auto type = Identifier(child.getProperty(Core::treeNodeType));
 
-        TreeNode *child = nullptr;
+    TreeNode *node = nullptr;
 
-        if (type == Core::project)              { child = new ProjectNode(); }
-        else if (type == Core::settings)        { child = new SettingsNode(); }
-        else if (type == Core::trackGroup)      { child = new TrackGroupNode(""); }
-        else if (type == Core::pianoTrack)      { child = new PianoTrackNode(""); }
-        else if (type == Core::automationTrack) { child = new AutomationTrackNode(""); }
-        else if (type == Core::instrumentsList) { child = new OrchestraPitNode(); }
-        else if (type == Core::instrumentRoot)  { child = new InstrumentNode(); }
-        else if (type == Core::versionControl)  { child = new VersionControlNode(); }
-        else if (type == Core::patternSet)      { child = new PatternEditorNode(); }
+    if (type == Core::project)              { node = new ProjectNode(); }
+    else if (type == Core::settings)        { node = new SettingsNode(); }
+    else if (type == Core::trackGroup)      { node = new TrackGroupNode(""); }
+    else if (type == Core::pianoTrack)      { node = new PianoTrackNode(""); }
+    else if (type == Core::automationTrack) { node = new AutomationTrackNode(""); }
+    else if (type == Core::instrumentsList) { node = new OrchestraPitNode(); }
+    else if (type == Core::instrumentRoot)  { node = new InstrumentNode(); }
+    else if (type == Core::versionControl)  { node = new VersionControlNode(); }
+    else if (type == Core::patternSet)      { node = new PatternEditorNode(); }
 
-        if (child != nullptr)
-        {
-            parentItem.addChildNode(child);
-            child->deserialize(e);
-        }
+    if (node != nullptr)
+    {
+        parentItem.addChildNode(node);
+        node->deserialize(child);
     }
+
+    return node;
 }
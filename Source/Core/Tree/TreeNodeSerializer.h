@@ -25,4 +25,5 @@ public:
 
     static void serializeChildren(const TreeNode &parentItem, SerializedData &parent);
     static void deserializeChildren(TreeNode &parentItem, const SerializedData &parent);
+    static TreeNode *deserializeChild(TreeNode &parentItem, const SerializedData &child);
 };
@@ -42,6 +42,8 @@ void Workspace::init()
 {
     if (! this->wasInitialized)
     {
+        StartupPhase phase("workspace");
+
         this->audioCore = make<AudioCore>();
         this->pluginManager = make<PluginScanner>();
         this->treeRoot = make<RootNode>("Workspace");
@@ -407,10 +409,9 @@ void Workspace::importProject(const String &filePattern)
             }
             else
             {
-                if (auto *p = this->treeRoot->openProject(file))
+                // the project will update its recent files info, when loaded
+                if (this->treeRoot->openProject(file) != nullptr)
                 {
-                    this->userProfile.onProjectLocalInfoUpdated(p->getId(),
-                        p->getName(), p->getDocument()->getFullPath());
                     this->autosave();
                 }
             }
@@ -488,6 +489,26 @@ void Workspace::selectTreeNodeWithId(const String &id)
     selectActiveSubItemWithId(this->treeRoot.get(), id);
 }
 
+void Workspace::selectPendingTreeNode()
+{
+    if (this->pendingTreeNodeId.isEmpty())
+    {
+        return;
+    }
+
+    // the user has navigated somewhere else while the projects were loading
+    if (!this->treeRoot->isSelected())
+    {
+        this->pendingTreeNodeId = {};
+        return;
+    }
+
+    if (nullptr != selectActiveSubItemWithId(this->treeRoot.get(), this->pendingTreeNodeId))
+    {
+        this->pendingTreeNodeId = {};
+    }
+}
+
 SerializedData Workspace::serialize() const
 {
     using namespace Serialization;
@@ -526,14 +547,28 @@ void Workspace::deserialize(const SerializedData &data)
         return;
     }
 
-    this->userProfile.deserialize(root);
-    this->audioCore->deserialize(root);
-    this->pluginManager->deserialize(root);
+    {
+        StartupPhase phase("user profile");
+        this->userProfile.deserialize(root);
+    }
+
+    {
+        StartupPhase phase("audio and midi devices");
+        this->audioCore->deserialize(root);
+    }
+
+    {
+        StartupPhase phase("plugins list");
+        this->pluginManager->deserialize(root);
+    }
 
     const auto treeRootNode = root.getChildWithName(Core::treeRoot);
     jassert(treeRootNode.isValid());
 
-    this->treeRoot->deserialize(treeRootNode);
+    {
+        StartupPhase phase("projects");
+        this->treeRoot->deserialize(treeRootNode);
+    }
     
     bool foundActiveNode = false;
     const auto treeStateNode = root.getChildWithName(Core::treeState);
@@ -543,6 +578,7 @@ void Workspace::deserialize(const SerializedData &data)
         {
             const String id = e.getProperty(Core::treeNodeId);
             foundActiveNode = (nullptr != selectActiveSubItemWithId(this->treeRoot.get(), id));
+            this->pendingTreeNodeId = foundActiveNode ? String() : id;
         }
     }
     
@@ -575,4 +611,5 @@ void Workspace::reset()
     this->userProfile.reset();
     this->audioCore->reset();
     this->treeRoot->reset();
+    this->pendingTreeNodeId = {};
 }
@@ -41,6 +41,7 @@ public:
     void stopPlaybackForAllProjects(); // on app suspend / shutdown
 
     void selectTreeNodeWithId(const String &id);
+    void selectPendingTreeNode();
 
     NavigationHistory &getNavigationHistory();
     void navigateBackwardIfPossible();
@@ -96,6 +97,10 @@ private:
     UniquePointer<RootNode> treeRoot;
     NavigationHistory navigationHistory;
 
+    // the projects are loaded asynchronously, so the tree node which was
+    // active when the workspace was saved might not be available right away
+    String pendingTreeNodeId;
+
     UniquePointer<CommandPaletteProjectsList> consoleProjectsList;
 
     UniquePointer<FileChooser> newProjectFileChooser;
@@ -65,9 +65,15 @@ public:
     }
 
     void repositionAtTargetTop(Component *component)
+    {
+        this->repositionAtTargetTop(component, component->getLocalBounds());
+    }
+
+    // for the targets painted by the component instead of being its children
+    void repositionAtTargetTop(Component *component, const Rectangle<int> &targetArea)
     {
         const auto topRelativeToMyParent = this->getParentComponent()->
-            getLocalPoint(component, Point<int>(component->getWidth() / 2, 0));
+            getLocalPoint(component, Point<int>(targetArea.getCentreX(), targetArea.getY()));
 
         this->setTopLeftPosition(topRelativeToMyParent -
             Point<int>(this->getWidth() / 2, this->getHeight() - 8));
@@ -0,0 +1,154 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "FrameClock.h"
+
+FrameClock::~FrameClock()
+{
+    // static clients, like the kinetic slider, may outlive the clock,
+    // make sure they won't try to unsubscribe when destroyed
+    for (auto *client : this->clients)
+    {
+        client->isSubscribed = false;
+    }
+}
+
+void FrameClock::setSuspended(bool shouldBeSuspended)
+{
+    if (this->isSuspended != shouldBeSuspended)
+    {
+        this->isSuspended = shouldBeSuspended;
+        this->updateRate();
+    }
+}
+
+void FrameClock::subscribe(Client *client)
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+    this->clients.add(client);
+    this->updateRate();
+}
+
+void FrameClock::unsubscribe(Client *client)
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+
+    const auto index = this->clients.indexOf(client);
+    if (index < 0)
+    {
+        jassertfalse;
+        return;
+    }
+
+    this->clients.remove(index);
+
+    if (index <= this->currentClientIndex)
+    {
+        this->currentClientIndex--;
+    }
+
+    if (this->clients.isEmpty())
+    {
+        // nothing to animate, let the app idle
+        this->currentRate = 0;
+        this->stopTimer();
+    }
+}
+
+void FrameClock::timerCallback()
+{
+    // clients may start or stop animating here, including other clients;
+    // the ones subscribed during this pass will be ticked in this pass too
+    for (this->currentClientIndex = 0;
+        this->currentClientIndex < this->clients.size();
+        ++this->currentClientIndex)
+    {
+        this->clients.getUnchecked(this->currentClientIndex)->onAnimationFrame();
+    }
+
+    this->currentClientIndex = -1;
+
+    // picks up minimising or restoring the window
+    this->updateRate();
+}
+
+void FrameClock::updateRate()
+{
+    if (this->clients.isEmpty())
+    {
+        return;
+    }
+
+    auto rate = FrameClock::framesPerSecond;
+    if (this->isInBackground())
+    {
+        rate = FrameClock::backgroundFramesPerSecond;
+    }
+
+    if (this->currentRate != rate)
+    {
+        this->currentRate = rate;
+        this->startTimerHz(rate);
+    }
+}
+
+bool FrameClock::isInBackground() const
+{
+    if (this->isSuspended)
+    {
+        return true;
+    }
+
+    for (int i = 0; i < ComponentPeer::getNumPeers(); ++i)
+    {
+        if (!ComponentPeer::getPeer(i)->isMinimised())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Client
+//===----------------------------------------------------------------------===//
+
+FrameClock::Client::~Client()
+{
+    this->stopAnimating();
+}
+
+void FrameClock::Client::startAnimating()
+{
+    if (!this->isSubscribed)
+    {
+        this->isSubscribed = true;
+        App::FrameClock().subscribe(this);
+    }
+}
+
+void FrameClock::Client::stopAnimating()
+{
+    if (this->isSubscribed)
+    {
+        this->isSubscribed = false;
+        App::FrameClock().unsubscribe(this);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// A single timer that drives all UI animations:
+// instead of each animated component running its own 60 Hz timer,
+// they subscribe to the clock while they have something to animate,
+// so that all of them are ticked in one pass, and all the repaints
+// they request end up in the same paint cycle
+
+class FrameClock final : private Timer
+{
+public:
+
+    FrameClock() = default;
+    ~FrameClock() override;
+
+    class Client
+    {
+    public:
+
+        Client() = default;
+        virtual ~Client();
+
+        // starts receiving onAnimationFrame() callbacks
+        // on every frame until stopAnimating() is called
+        void startAnimating();
+        void stopAnimating();
+
+        bool isAnimating() const noexcept
+        {
+            return this->isSubscribed;
+        }
+
+        virtual void onAnimationFrame() = 0;
+
+    private:
+
+        bool isSubscribed = false;
+
+        friend class FrameClock;
+
+        JUCE_DECLARE_NON_COPYABLE(Client)
+    };
+
+    // on mobile, the app keeps running when suspended,
+    // there's no need to animate anything at full rate then
+    void setSuspended(bool shouldBeSuspended);
+
+    static constexpr auto framesPerSecond = 60;
+    static constexpr auto backgroundFramesPerSecond = 10;
+
+private:
+
+    void subscribe(Client *client);
+    void unsubscribe(Client *client);
+
+    void timerCallback() override;
+    void updateRate();
+    bool isInBackground() const;
+
+    Array<Client *> clients;
+
+    // the index of the client being ticked, if any,
+    // so that clients can unsubscribe within their callbacks
+    int currentClientIndex = -1;
+
+    bool isSuspended = false;
+    int currentRate = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameClock)
+};
@@ -18,8 +18,9 @@
 #include "Common.h"
 #include "ModeIndicatorComponent.h"
 #include "ComponentIDs.h"
+#include "FrameClock.h"
 
-class ModeIndicatorBar final : public Component, private Timer
+class ModeIndicatorBar final : public Component, private FrameClock::Client
 {
 public:
 
@@ -35,7 +36,7 @@ public:
         this->animationDirection = shouldBeHighlighted ? 1.f : -1.f;
         this->animationSpeed = ModeIndicatorBar::animationStartingSpeed;
         this->isHighlighted = shouldBeHighlighted;
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
     void paint(Graphics &g) override
@@ -55,7 +56,7 @@ private:
     float animationDirection = 1.f;
     float animationSpeed = 0.f;
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         this->brightness += this->animationDirection * this->animationSpeed;
         this->animationSpeed *= ModeIndicatorBar::animationAcceleration;
@@ -63,7 +64,7 @@ private:
         if (this->brightness < 0.001f || this->brightness > 0.999f)
         {
             this->brightness = jlimit(0.f, 1.f, this->brightness);
-            this->stopTimer();
+            this->stopAnimating();
         }
 
         this->repaint();
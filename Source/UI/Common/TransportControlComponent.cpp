@@ -24,8 +24,9 @@
 #include "MenuPanel.h"
 #include "ModalCallout.h"
 #include "ColourIDs.h"
+#include "FrameClock.h"
 
-class TransportControlButton : public Component, private Timer
+class TransportControlButton : public Component, private FrameClock::Client
 {
 public:
 
@@ -83,21 +84,21 @@ public:
     {
         this->state = State::Inactive;
         this->targetColour = this->inactiveColour;
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
     void setHighlighted()
     {
         this->state = State::Highlighted;
         this->targetColour = this->highlightColour;
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
     void setActive()
     {
         this->state = State::Active;
         this->targetColour = this->activeColour;
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
 protected:
@@ -126,15 +127,15 @@ private:
     State state = State::Inactive;
     Colour targetColour;
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         const auto newColour = this->currentColour.interpolatedWith(this->targetColour, 0.3f);
         //DBG(this->currentColour.toDisplayString(true));
 
         if (this->currentColour == newColour)
         {
-            //DBG("--- stop timer");
-            this->stopTimer();
+            //DBG("--- stop animating");
+            this->stopAnimating();
         }
         else
         {
@@ -20,6 +20,7 @@
 #include "CommandIDs.h"
 #include "HelioTheme.h"
 #include "ColourIDs.h"
+#include "FrameClock.h"
 
 // a hack to pass the TextEditor's mousewheel to the dialog,
 // which needs it for adjusting the tempo with mouse wheel:
@@ -56,7 +57,7 @@ private:
     MouseWheelDetails details;
 };
 
-class TapTempoComponent final : public Component, private Timer
+class TapTempoComponent final : public Component, private FrameClock::Client
 {
 public:
 
@@ -95,7 +96,7 @@ public:
     {
         this->detectAndSendTapTempo();
         this->currentFillColour = this->highlightColour; // then animate
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
 private:
@@ -148,14 +149,14 @@ private:
         this->onTempoChanged(bpm);
     }
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         const auto newColour = this->currentFillColour.
             interpolatedWith(this->targetColour, 0.1f);
 
         if (this->currentFillColour == newColour)
         {
-            this->stopTimer();
+            this->stopAnimating();
         }
         else
         {
@@ -19,6 +19,7 @@
 
 #include "DialogBase.h"
 #include "Meter.h"
+#include "ConfigurationResourceCollection.h"
 #include "TimeSignatureEvent.h"
 #include "MobileComboBox.h"
 #include "UndoStack.h"
@@ -66,7 +67,7 @@ private:
 
     Component &ownerComponent;
 
-    const Array<Meter::Ptr> defaultMeters;
+    const ConfigurationResourcesSnapshot<Meter> defaultMeters;
 
     Component *getPrimaryFocusTarget() override;
 
@@ -18,8 +18,9 @@
 #pragma once
 
 #include "SmoothPanListener.h"
+#include "FrameClock.h"
 
-class SmoothPanController final : private Timer
+class SmoothPanController final : private FrameClock::Client
 {
 public:
 
@@ -38,7 +39,7 @@ public:
 
     void cancelPan()
     {
-        this->stopTimer();
+        this->stopAnimating();
     }
 
     void panByOffset(Point<float> offset)
@@ -54,9 +55,9 @@ public:
             return;
         }
 
-        if (!this->isTimerRunning())
+        if (!this->isAnimating())
         {
-            this->startTimerHz(60);
+            this->startAnimating();
             this->process();
         }
         else
@@ -73,7 +74,7 @@ private:
     static constexpr auto slowdownFactor = 0.5f;
     static constexpr auto initialPanSpeed = 155.f;
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         this->process();
     }
@@ -89,7 +90,7 @@ private:
 
         if (hitTheBorder || diff.getDistanceFromOrigin() < SmoothPanController::stopDistance)
         {
-            this->stopTimer();
+            this->stopAnimating();
         }
     }
 
@@ -40,8 +40,9 @@
 #include "ColourIDs.h"
 #include "ColourSchemesCollection.h"
 #include "CommandPaletteCommonActions.h"
+#include "FrameClock.h"
 
-class InitScreen final : public Component, private Timer
+class InitScreen final : public Component, private FrameClock::Client
 {
 public:
 
@@ -80,13 +81,13 @@ public:
 
 private:
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         const auto newFill = this->fillColour.interpolatedWith(Colours::transparentBlack, 0.2f);
 
         if (this->fillColour == newFill)
         {
-            this->stopTimer();
+            this->stopAnimating();
             App::Layout().clearInitScreen();
         }
         else
@@ -99,7 +100,7 @@ private:
     inline void startFadeOut()
     {
         this->toFront(false);
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
     Colour fillColour = findDefaultColour(ColourIDs::Backgrounds::pageFillA);
@@ -28,6 +28,7 @@
 #include "PatternEditorNode.h"
 #include "KeySignaturesSequence.h"
 #include "AudioCore.h"
+#include "ParameterAutomation.h"
 #include "PianoSequence.h"
 #include "RollBase.h"
 #include "SequencerOperations.h"
@@ -274,10 +275,79 @@ void ProjectMenu::showControllersMenuForInstrument(const WeakReference<Instrumen
                 }));
         }
     }
+
+    // plugin nodes which have any parameters to automate
+    if (instrument != nullptr)
+    {
+        for (int i = 0; i < instrument->getNumNodes(); ++i)
+        {
+            const auto node = instrument->getNode(i);
+            if (instrument->isNodeStandardIOProcessor(node) ||
+                node->getProcessor()->getParameters().isEmpty() ||
+                !ParameterAutomation::canAutomate(node->nodeID, 0))
+            {
+                continue;
+            }
+
+            const auto nodeId = node->nodeID;
+            menu.add(MenuItem::item(Icons::audioPlugin,
+                node->getProcessor()->getName())->withSubmenu()->withAction([this, instrument, nodeId]()
+                {
+                    this->showParametersMenuForNode(instrument, nodeId);
+                }));
+        }
+    }
     
     this->updateContent(menu, MenuPanel::SlideLeft);
 }
 
+void ProjectMenu::showParametersMenuForNode(const WeakReference<Instrument> instrument,
+    AudioProcessorGraph::NodeID nodeId)
+{
+    MenuPanel::Menu menu;
+    menu.add(MenuItem::item(Icons::back,
+        TRANS(I18n::Menu::back))->withAction([this, instrument]()
+        {
+            this->showControllersMenuForInstrument(instrument);
+        }));
+
+    const auto node = instrument != nullptr ? instrument->getNodeForId(nodeId) : nullptr;
+    if (node != nullptr)
+    {
+        const auto &parameters = node->getProcessor()->getParameters();
+        for (int parameterIndex = 0; parameterIndex < parameters.size(); ++parameterIndex)
+        {
+            auto *parameter = parameters.getUnchecked(parameterIndex);
+            if (!parameter->isAutomatable() ||
+                !ParameterAutomation::canAutomate(nodeId, parameterIndex))
+            {
+                continue;
+            }
+
+            const auto parameterName = parameter->getName(64);
+            menu.add(MenuItem::item(Icons::automationTrack,
+                String(parameterIndex) + ": " + parameterName)->
+                closesMenu()->
+                withAction([this, instrument, nodeId, parameterIndex, parameterName]()
+                {
+                    String outTrackId;
+                    const String instrumentId = instrument ? instrument->getIdAndHash() : "";
+                    const String trackName = TreeNode::createSafeName(parameterName);
+                    const auto controllerNumber = ParameterAutomation::makeControllerNumber(nodeId, parameterIndex);
+                    const auto autoTrackParams =
+                        SequencerOperations::createAutoTrackTemplate(this->project,
+                            trackName, controllerNumber, instrumentId, outTrackId);
+
+                    this->project.getUndoStack()->beginNewTransaction();
+                    this->project.getUndoStack()->perform(new AutomationTrackInsertAction(this->project,
+                        &this->project, autoTrackParams, trackName));
+                }));
+        }
+    }
+
+    this->updateContent(menu, MenuPanel::SlideLeft);
+}
+
 void ProjectMenu::showRenderMenu()
 {
     MenuPanel::Menu menu;
@@ -399,7 +469,7 @@ void ProjectMenu::showTemperamentsMenu(bool convertTracks)
             // let's also update key signatures (todo move this code somewhere):
             auto *harmonicContext = this->project.getTimeline()->getKeySignaturesSequence();
             SequencerOperations::remapKeySignaturesToTemperament(harmonicContext,
-                currentTemperament, otherTemperament, App::Config().getScales()->getAll(),
+                currentTemperament, otherTemperament, App::Config().getScales()->getAll().getResources(),
                 false); // false == already did checkpoint earlier
 
             // finally, the temperament itself:
@@ -48,5 +48,7 @@ private:
     void showNewTrackMenu(AnimationType animationType);
     void showNewAutomationMenu(AnimationType animationType);
     void showControllersMenuForInstrument(const WeakReference<Instrument> instrument);
+    void showParametersMenuForNode(const WeakReference<Instrument> instrument,
+        AudioProcessorGraph::NodeID nodeId);
 
 };
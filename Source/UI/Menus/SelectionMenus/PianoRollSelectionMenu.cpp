@@ -211,7 +211,7 @@ MenuPanel::Menu PianoRollSelectionMenu::makeRescalingMenu()
         this->updateContent(this->makeRefactoringMenu(), MenuPanel::SlideRight);
     }));
 
-    const auto &scales = App::Config().getScales()->getAll();
+    const auto scales = App::Config().getScales()->getAll();
     for (int i = 0; i < scales.size(); ++i)
     {
         if (scales.getUnchecked(i)->getBasePeriod() !=
@@ -231,7 +231,7 @@ MenuPanel::Menu PianoRollSelectionMenu::makeRescalingMenu()
                     return;
                 }
 
-                const auto &scales = App::Config().getScales()->getAll();
+                const auto scales = App::Config().getScales()->getAll();
                 const auto &clip = this->lasso->getFirstAs<NoteComponent>()->getClip();
 
                 SequencerOperations::rescale(*this->lasso.get(), clip,
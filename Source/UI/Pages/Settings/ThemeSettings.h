@@ -18,6 +18,7 @@
 #pragma once
 
 #include "ColourScheme.h"
+#include "ConfigurationResourceCollection.h"
 
 class ThemeSettings final : public Component,
     public ListBoxModel,
@@ -60,7 +61,7 @@ private:
 
     void changeListenerCallback(ChangeBroadcaster *source) override;
 
-    Array<ColourScheme::Ptr> schemes;
+    ConfigurationResourcesSnapshot<ColourScheme> schemes;
     ColourScheme::Ptr currentScheme;
 
     UniquePointer<ListBox> themesList;
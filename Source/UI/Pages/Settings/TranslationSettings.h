@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Translation.h"
+#include "ConfigurationResourceCollection.h"
 
 class TranslationSettings final : public Component, public ListBoxModel, private ChangeListener
 {
@@ -45,7 +46,7 @@ private:
     void changeListenerCallback(ChangeBroadcaster *source) override;
     void scrollToSelectedLocale();
 
-    Array<Translation::Ptr> availableTranslations;
+    ConfigurationResourcesSnapshot<Translation> availableTranslations;
     Translation::Ptr currentTranslation;
 
 #if PLATFORM_DESKTOP
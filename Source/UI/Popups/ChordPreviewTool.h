@@ -27,6 +27,7 @@ class TimeSignaturesAggregator;
 #include "Note.h"
 #include "Clip.h"
 #include "Chord.h"
+#include "ConfigurationResourceCollection.h"
 #include "Scale.h"
 #include "PopupMenuComponent.h"
 #include "PopupCustomButton.h"
@@ -82,7 +83,7 @@ private:
 
     bool detectKeyBeatAndContext();
 
-    Array<Chord::Ptr> defaultChords;
+    ConfigurationResourcesSnapshot<Chord> defaultChords;
 
     OwnedArray<PopupCustomButton> chordButtons;
 
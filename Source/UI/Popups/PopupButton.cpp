@@ -112,7 +112,7 @@ PopupButton::PopupButton(bool shouldShowConfirmImage, Shape shapeType, Colour co
 
     if (this->shapeType == Shape::Circle)
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 }
 
@@ -272,14 +272,14 @@ void PopupButton::mouseUp(const MouseEvent &e)
     this->fader.fadeOut(this->mouseDownHighlighter.get(), Globals::UI::fadeOutShort);
 }
 
-void PopupButton::timerCallback()
+void PopupButton::onAnimationFrame()
 {
     this->raduisAnimation += PopupButton::radiusAnimationStep;
 
     if (this->raduisAnimation >= PopupButton::radiusAnimationEnd)
     {
         this->raduisAnimation = PopupButton::radiusAnimationEnd;
-        this->stopTimer();
+        this->stopAnimating();
     }
 
     this->repaint();
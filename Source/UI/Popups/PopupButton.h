@@ -19,6 +19,7 @@
 
 #include "PopupButtonOwner.h"
 #include "ComponentFader.h"
+#include "FrameClock.h"
 
 class PopupButtonHighlighter final : public Component
 {
@@ -39,7 +40,7 @@ private:
     Path clickConfirmImage;
 };
 
-class PopupButton : public Component, private Timer
+class PopupButton : public Component, private FrameClock::Client
 {
 public:
 
@@ -70,7 +71,7 @@ public:
 
 private:
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
 
     float raduisAnimation = 0.f;
     static constexpr auto radiusAnimationEnd = 1.f;
@@ -19,8 +19,9 @@
 
 #include "Common.h"
 #include "Icons.h"
+#include "FrameClock.h"
 
-class ProgressIndicator final : public Component, private Timer
+class ProgressIndicator final : public Component, private FrameClock::Client
 {
 public:
 
@@ -30,20 +31,8 @@ public:
         this->indicatorShape = Icons::getDrawableByName(Icons::progressIndicator);
     }
 
-    ~ProgressIndicator() override
-    {
-        this->stopAnimating();
-    }
-    
-    void startAnimating()
-    {
-        this->startTimerHz(60);
-    }
-    
-    void stopAnimating()
-    {
-        this->stopTimer();
-    }
+    using FrameClock::Client::startAnimating;
+    using FrameClock::Client::stopAnimating;
     
     void paint(Graphics &g) override
     {
@@ -93,7 +82,7 @@ public:
 
 private:
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         this->indicatorDegree = (this->indicatorDegree + 7) % 360;
         this->repaint();
@@ -56,7 +56,7 @@ void AutomationCurveEventsConnector::resizeToFit(float newCurvature)
 
     this->curvature = newCurvature;
     this->setBounds(newBounds);
-    this->rebuildLinePath();
+    this->updateLineWidth();
 }
 
 Point<float> AutomationCurveEventsConnector::getCentrePoint() const
@@ -76,59 +76,88 @@ Point<float> AutomationCurveEventsConnector::getCentrePoint() const
 
 void AutomationCurveEventsConnector::paint(Graphics &g)
 {
-    if (this->component1 != nullptr)
+    if (this->component1 == nullptr || this->component2 == nullptr)
     {
-        g.setColour(this->component1->getColour());
+        return;
     }
 
-    for (const auto &p : this->linePath)
+    g.setColour(this->component1->getColour());
+
+    const auto &points = this->segment.getPoints(this->component1->getEvent(),
+        this->component2->getEvent());
+
+    const float height = float(this->getParentHeight());
+    for (const auto &p : points)
     {
-        g.fillRect(p.getX() - 1.f, p.getY() - 0.75f, 2.f, 1.5f);
+        const float x = this->lineWidth * p.getX();
+        const float y = height * (1.f - p.getY());
+        g.fillRect(x - 1.f, y - 0.75f, 2.f, 1.5f);
     }
 }
 
 void AutomationCurveEventsConnector::resized()
 {
-    this->rebuildLinePath();
+    this->updateLineWidth();
 }
 
-void AutomationCurveEventsConnector::rebuildLinePath()
+void AutomationCurveEventsConnector::updateLineWidth()
 {
     jassert(this->component1);
     jassert(this->component2);
 
-    if (this->getParentWidth() == 0 ||
-        this->component1 == nullptr || this->component2 == nullptr)
+    if (this->component1 == nullptr || this->component2 == nullptr)
     {
         return;
     }
 
     const float x1 = this->component1->getFloatBounds().getCentreX();
     const float x2 = this->component2->getFloatBounds().getCentreX();
+    this->lineWidth = x2 - x1;
+}
 
-    this->linePath.clearQuick();
+//===----------------------------------------------------------------------===//
+// AutomationCurveSegment
+//===----------------------------------------------------------------------===//
 
-    const auto &e1 = this->component1->getEvent();
-    const auto &e2 = this->component2->getEvent();
-    float lastAppliedValue = e1.getControllerValue();
-    float interpolatedBeat = e1.getBeat(); // + AutomationEvent::curveInterpolationStepBeat;
-    while (interpolatedBeat < e2.getBeat())
+const Array<Point<float>> &AutomationCurveSegment::getPoints(
+    const AutomationEvent &e1, const AutomationEvent &e2)
+{
+    if (this->isValid &&
+        this->beat1 == e1.getBeat() &&
+        this->beat2 == e2.getBeat() &&
+        this->value1 == e1.getControllerValue() &&
+        this->value2 == e2.getControllerValue() &&
+        this->curvature == e1.getCurvature())
     {
-        const float factor = (interpolatedBeat - e1.getBeat()) / (e2.getBeat() - e1.getBeat());
-        const float interpolatedValue =
-            AutomationEvent::interpolateEvents(e1.getControllerValue(),
-                e2.getControllerValue(), factor, e1.getCurvature());
+        return this->points;
+    }
+
+    this->isValid = true;
+    this->beat1 = e1.getBeat();
+    this->beat2 = e2.getBeat();
+    this->value1 = e1.getControllerValue();
+    this->value2 = e2.getControllerValue();
+    this->curvature = e1.getCurvature();
 
-        const float x = (x2 - x1) * factor;
-        const float y = float(this->getParentHeight()) * (1.f - interpolatedValue);
+    this->points.clearQuick();
+
+    float lastAppliedValue = this->value1;
+    float interpolatedBeat = this->beat1; // + AutomationEvent::curveInterpolationStepBeat;
+    while (interpolatedBeat < this->beat2)
+    {
+        const float factor = (interpolatedBeat - this->beat1) / (this->beat2 - this->beat1);
+        const float interpolatedValue = AutomationEvent::interpolateEvents(this->value1,
+            this->value2, factor, this->curvature);
 
         const float controllerDelta = fabs(interpolatedValue - lastAppliedValue);
         if (controllerDelta > AutomationEvent::curveInterpolationThreshold)
         {
-            this->linePath.add({ x, y });
+            this->points.add({ factor, interpolatedValue });
             lastAppliedValue = interpolatedValue;
         }
 
         interpolatedBeat += AutomationEvent::curveInterpolationStepBeat;
     }
+
+    return this->points;
 }
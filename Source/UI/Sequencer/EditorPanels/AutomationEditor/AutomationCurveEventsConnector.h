@@ -19,6 +19,33 @@
 
 #include "AutomationEditorBase.h"
 
+// the interpolated points of the curve between two events, kept in
+// zoom-invariant units: x is the factor between the events' beats,
+// and y is the controller value; the points are only rebuilt when
+// the events change, and resizing or zooming just rescales them
+class AutomationCurveSegment final
+{
+public:
+
+    AutomationCurveSegment() = default;
+
+    const Array<Point<float>> &getPoints(const AutomationEvent &e1,
+        const AutomationEvent &e2);
+
+private:
+
+    float beat1 = 0.f;
+    float beat2 = 0.f;
+    float value1 = 0.f;
+    float value2 = 0.f;
+    float curvature = 0.f;
+    bool isValid = false;
+
+    Array<Point<float>> points;
+
+    JUCE_LEAK_DETECTOR(AutomationCurveSegment)
+};
+
 class AutomationCurveEventsConnector final : public Component
 {
 public:
@@ -46,8 +73,9 @@ private:
     SafePointer<AutomationEditorBase::EventComponentBase> component1;
     SafePointer<AutomationEditorBase::EventComponentBase> component2;
 
-    Array<Point<float>> linePath;
-    void rebuildLinePath();
+    AutomationCurveSegment segment;
+    float lineWidth = 0.f;
+    void updateLineWidth();
 
     float curvature = 0.5f;
 
@@ -237,7 +237,6 @@ AutomationEditor::AutomationEditor(ProjectNode &project, SafePointer<RollBase> r
     roll(roll)
 {
     this->setInterceptsMouseClicks(true, true);
-    this->setPaintingIsUnclipped(true);
 
     this->multiTouchController = make<MultiTouchController>(*this);
     this->addMouseListener(this->multiTouchController.get(), true);
@@ -330,7 +329,7 @@ void AutomationEditor::applyHandDrawnCurve(bool isAnyModifierKeyDown)
     }
 
     const auto activeClip = *this->activeClip;
-    if (!this->patternMap.contains(activeClip))
+    if (this->getActiveTrack() == nullptr)
     {
         jassertfalse;
         return;
@@ -338,7 +337,6 @@ void AutomationEditor::applyHandDrawnCurve(bool isAnyModifierKeyDown)
 
     jassert(!activeClip.getPattern()->getTrack()->isOnOffAutomationTrack());
 
-    const auto *activeMap = this->patternMap.at(activeClip).get();
     auto *sequence = static_cast<AutomationSequence *>(activeClip.getPattern()->getTrack()->getSequence());
 
     const auto &simplifiedCurve = this->handDrawingHelper->getSimplifiedCurve();
@@ -355,7 +353,7 @@ void AutomationEditor::applyHandDrawnCurve(bool isAnyModifierKeyDown)
         Array<AutomationEvent> eventsToDelete;
 
         constexpr auto threshold = 2.f;
-        for (const auto &i : activeMap->eventsMap)
+        for (const auto &i : this->activeMap.eventsMap)
         {
             const auto eventFullBeat =
                 i.second->getEvent().getBeat() + i.second->getClip().getBeat();
@@ -447,10 +445,7 @@ void AutomationEditor::resized()
 {
     AUTO_EDITOR_BATCH_REPAINT_START
 
-    for (const auto &map : this->patternMap)
-    {
-        this->applyEventsBounds(map.second.get());
-    }
+    this->applyEventsBounds(&this->activeMap);
 
     if (this->handDrawingHelper != nullptr)
     {
@@ -461,6 +456,218 @@ void AutomationEditor::resized()
     AUTO_EDITOR_BATCH_REPAINT_END
 }
 
+// returns the sorted events within the beat range, plus one more event
+// on each side, because their connectors are crossing the range edges
+static Range<int> findAutomationEventsToPaint(const MidiSequence &sequence,
+    float startBeat, float endBeat)
+{
+    const auto *first = std::lower_bound(sequence.begin(), sequence.end(), startBeat,
+        [](const MidiEvent *event, float beat) { return event->getBeat() < beat; });
+
+    const auto *last = std::upper_bound(first, sequence.end(), endBeat,
+        [](float beat, const MidiEvent *event) { return beat < event->getBeat(); });
+
+    return { jmax(0, int(first - sequence.begin()) - 1),
+        jmin(sequence.size(), int(last - sequence.begin()) + 1) };
+}
+
+void AutomationEditor::paint(Graphics &g)
+{
+    if (this->roll == nullptr || this->roll->getBeatWidth() <= 0.f)
+    {
+        return;
+    }
+
+    // event shapes are extending a bit to the left and to the right of their beats
+    const auto margin = jmax(float(AutomationEditor::curveEventComponentDiameter),
+        this->getOnOffEventBounds(0.f, false).getWidth());
+
+    const auto area = g.getClipBounds().toFloat().expanded(margin, 0.f);
+    const auto startBeat = this->getRollBeatByXPosition(area.getX());
+    const auto endBeat = this->getRollBeatByXPosition(area.getRight());
+
+    for (const auto *track : this->automationTracks)
+    {
+        const auto *sequence = track->getSequence();
+        const auto *pattern = track->getPattern();
+        if (sequence->isEmpty())
+        {
+            continue;
+        }
+
+        for (int i = 0; i < pattern->size(); ++i)
+        {
+            const auto &clip = *pattern->getUnchecked(i);
+
+            // the active clip has its own components
+            if (this->activeClip == clip ||
+                clip.getBeat() + sequence->getFirstBeat() > endBeat ||
+                clip.getBeat() + sequence->getLastBeat() < startBeat)
+            {
+                continue;
+            }
+
+            const auto eventIndices = findAutomationEventsToPaint(*sequence,
+                startBeat - clip.getBeat(), endBeat - clip.getBeat());
+
+            if (track->isOnOffAutomationTrack())
+            {
+                this->paintInactiveStepEvents(g, *sequence, clip, eventIndices);
+            }
+            else
+            {
+                this->paintInactiveCurveEvents(g, *sequence, clip, eventIndices);
+            }
+        }
+    }
+}
+
+// the same shapes and colours as non-editable AutomationCurveEventComponent,
+// AutomationCurveEventsConnector and AutomationCurveHelper have:
+void AutomationEditor::paintInactiveCurveEvents(Graphics &g,
+    const MidiSequence &sequence, const Clip &clip, const Range<int> &eventIndices)
+{
+    constexpr auto diameter = AutomationEditor::curveEventComponentDiameter;
+    constexpr auto circleMargin = 2.f;
+    constexpr auto helperDiameter = diameter * 0.65f;
+
+    const auto height = float(this->getHeight());
+    auto &segments = this->curveSegments[&sequence];
+
+    const auto *previousEvent = static_cast<const AutomationEvent *>(nullptr);
+    Point<float> previousCentre;
+
+    for (int i = eventIndices.getStart(); i < eventIndices.getEnd(); ++i)
+    {
+        const auto &event = *static_cast<const AutomationEvent *>(sequence.getUnchecked(i));
+        const auto centre = this->getCurveEventBounds(event.getBeat() + clip.getBeat(),
+            event.getControllerValue()).getCentre();
+
+        if (previousEvent == nullptr)
+        {
+            g.setColour(this->getColour(event)
+                .withMultipliedSaturation(0.4f)
+                .withMultipliedAlpha(0.2f));
+        }
+
+        g.fillEllipse(centre.x - 3.f, centre.y - 3.f, 6.f, 6.f);
+        g.fillEllipse(centre.x - diameter / 2.f + circleMargin,
+            centre.y - diameter / 2.f + circleMargin,
+            diameter - circleMargin * 2.f, diameter - circleMargin * 2.f);
+
+        if (previousEvent != nullptr)
+        {
+            const auto lineWidth = centre.x - previousCentre.x;
+            for (const auto &p : segments[previousEvent->getId()].getPoints(*previousEvent, event))
+            {
+                g.fillRect(previousCentre.x + lineWidth * p.getX() - 1.f,
+                    height * (1.f - p.getY()) - 0.75f, 2.f, 1.5f);
+            }
+
+            const auto y1 = jmin(previousCentre.y, centre.y);
+            const auto y2 = jmax(previousCentre.y, centre.y);
+            const Point<float> helperCentre(previousCentre.x + lineWidth / 2.f,
+                y1 + (y2 - y1) * (1.f - previousEvent->getCurvature()));
+
+            g.fillEllipse(Rectangle<float>(helperDiameter, helperDiameter).withCentre(helperCentre));
+        }
+
+        previousEvent = &event;
+        previousCentre = centre;
+    }
+}
+
+// the same shapes and colours as non-editable AutomationStepEventComponent
+// and AutomationStepEventsConnector have:
+void AutomationEditor::paintInactiveStepEvents(Graphics &g,
+    const MidiSequence &sequence, const Clip &clip, const Range<int> &eventIndices)
+{
+    constexpr auto r = AutomationStepEventComponent::pointRadius;
+    constexpr auto d = r * 2.f;
+    constexpr auto top = r + AutomationStepEventComponent::marginTop;
+    const float bottom = float(this->getHeight()) - r - AutomationStepEventComponent::marginBottom;
+
+    const auto getEvent = [&sequence](int index) -> const AutomationEvent &
+    {
+        return *static_cast<const AutomationEvent *>(sequence.getUnchecked(index));
+    };
+
+    const auto getBounds = [this, &clip, &getEvent](int index)
+    {
+        const auto &event = getEvent(index);
+        return this->getOnOffEventBounds(event.getBeat() + clip.getBeat(), event.isPedalDownEvent());
+    };
+
+    const auto dotColour = this->getColour(getEvent(0))
+        .withMultipliedSaturation(0.4f)
+        .withMultipliedAlpha(0.2f);
+
+    const auto lineColour = dotColour.withMultipliedAlpha(0.75f);
+
+    for (int i = eventIndices.getStart(); i < eventIndices.getEnd(); ++i)
+    {
+        const auto &event = getEvent(i);
+        const auto bounds = getBounds(i);
+        const bool hasPreviousEvent = i > 0;
+        const bool hasNextEvent = i < sequence.size() - 1;
+
+        const float left = bounds.getX() + r;
+        const float right = jmax(left, bounds.getRight() - r);
+        const float dotY = event.isPedalDownEvent() ? bottom : top;
+
+        g.setColour(dotColour);
+        g.fillRect(right - r, dotY - r + 1.f, d, d - 2.f);
+        g.fillRect(right - r + 1.f, dotY - r, d - 2.f, d);
+
+        const bool previousIsPedalDown = hasPreviousEvent ?
+            getEvent(i - 1).isPedalDownEvent() :
+            Globals::Defaults::onOffControllerState;
+
+        const bool previousIsPedalUp = !previousIsPedalDown;
+
+        g.setColour(lineColour);
+        if (event.isPedalDownEvent() && previousIsPedalUp)
+        {
+            const bool compactMode = bounds.getWidth() <= d && hasPreviousEvent &&
+                (bounds.getX() - getBounds(i - 1).getRight()) <= 1.f;
+
+            if (!compactMode)
+            {
+                g.fillRect(right, top, 1.f, bottom - top - d);
+                g.drawHorizontalLine(int(top) - 1, left, right);
+            }
+        }
+        else if (event.isPedalUpEvent() && previousIsPedalDown)
+        {
+            const bool compactMode = bounds.getWidth() <= d && hasNextEvent &&
+                (getBounds(i + 1).getX() - bounds.getRight()) <= 1.f;
+
+            g.fillRect(right, top + d, 1.f, bottom - top - d - (compactMode ? d : 0.f));
+            g.drawHorizontalLine(int(bottom), left, compactMode ? right - d : right);
+        }
+        else if (event.isPedalDownEvent() && previousIsPedalDown)
+        {
+            g.drawHorizontalLine(int(bottom), left, right - d);
+        }
+        else if (event.isPedalUpEvent() && previousIsPedalUp)
+        {
+            g.drawHorizontalLine(int(top) - 1, left, right - d);
+        }
+
+        // the connector to the next event
+        if (hasNextEvent)
+        {
+            const float x1 = bounds.getRight();
+            const float x2 = getBounds(i + 1).getX();
+            if (x2 - x1 > r)
+            {
+                const float y = event.isPedalDownEvent() ? bottom : top - 1.f;
+                g.drawHorizontalLine(roundToInt(y), x1 + r, x2 + r);
+            }
+        }
+    }
+}
+
 void AutomationEditor::mouseDown(const MouseEvent &e)
 {
     if (this->isMultiTouchEvent(e))
@@ -574,17 +781,10 @@ void AutomationEditor::setEditableClip(Optional<Clip> clip)
     this->activeClip = clip;
 
     AUTO_EDITOR_BATCH_REPAINT_START
-
-    for (const auto &map : this->patternMap)
-    {
-        const bool isEditable = map.first == clip;
-        for (auto *component : map.second->sortedComponents)
-        {
-            component->setEditable(isEditable);
-        }
-    }
-
+    this->reloadActiveMap();
     AUTO_EDITOR_BATCH_REPAINT_END
+
+    this->repaint();
 }
 
 void AutomationEditor::setEditableClip(const Clip &selectedClip, const EventFilter &filter)
@@ -601,34 +801,36 @@ void AutomationEditor::setEditableClip(const Clip &selectedClip, const EventFilt
     Clip matchByRangeAndInstrument;
     float maxIntersectionForInstrument = -1.f;
 
-    for (const auto &map : this->patternMap)
+    for (const auto *track : this->automationTracks)
     {
-        const auto *track = map.first.getPattern()->getTrack();
         const auto *matchingSequence = track->getSequence();
         if (track->getTrackControllerNumber() != filter.id)
         {
             continue;
         }
 
-        const auto matchingRange = Range<float>(
-            matchingSequence->getFirstBeat() + map.first.getBeat(),
-            matchingSequence->getLastBeat() + map.first.getBeat());
+        for (const auto *clip : track->getPattern()->getClips())
+        {
+            const auto matchingRange = Range<float>(
+                matchingSequence->getFirstBeat() + clip->getBeat(),
+                matchingSequence->getLastBeat() + clip->getBeat());
 
-        const auto intersectionLength = selectedRange
-            .getIntersectionWith(matchingRange).getLength();
+            const auto intersectionLength = selectedRange
+                .getIntersectionWith(matchingRange).getLength();
 
-        if (track->getTrackChannel() == selectedTrack->getTrackChannel() &&
-            track->getTrackInstrumentId() == selectedTrack->getTrackInstrumentId() &&
-            intersectionLength > maxIntersectionForInstrument)
-        {
-            maxIntersectionForInstrument = intersectionLength;
-            matchByRangeAndInstrument = map.first;
-        }
+            if (track->getTrackChannel() == selectedTrack->getTrackChannel() &&
+                track->getTrackInstrumentId() == selectedTrack->getTrackInstrumentId() &&
+                intersectionLength > maxIntersectionForInstrument)
+            {
+                maxIntersectionForInstrument = intersectionLength;
+                matchByRangeAndInstrument = *clip;
+            }
 
-        if (intersectionLength > maxIntersection)
-        {
-            maxIntersection = intersectionLength;
-            matchByRange = map.first;
+            if (intersectionLength > maxIntersection)
+            {
+                maxIntersection = intersectionLength;
+                matchByRange = *clip;
+            }
         }
     }
 
@@ -656,9 +858,13 @@ bool AutomationEditor::canEditSequence(WeakReference<MidiSequence> sequence) con
 Array<AutomationEditor::EventFilter> AutomationEditor::getAllEventFilters() const
 {
     FlatHashMap<int, String> trackGrouping;
-    for (const auto &map : this->patternMap)
+    for (const auto *track : this->automationTracks)
     {
-        const auto *track = map.first.getPattern()->getTrack();
+        if (track->getPattern()->size() == 0)
+        {
+            continue;
+        }
+
         trackGrouping[track->getTrackControllerNumber()] =
             track->isTempoTrack() ? TRANS(I18n::Defaults::tempoTrackName) :
             track->getTrackName();
@@ -775,10 +981,6 @@ bool AutomationEditor::isDrawingEvent(const MouseEvent &e) const
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
-
 void AutomationEditor::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2)
 {
     if (!e1.isTypeOf(MidiEvent::Type::Auto))
@@ -790,51 +992,61 @@ void AutomationEditor::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e
     const auto &newEvent = static_cast<const AutomationEvent &>(e2);
     const auto *track = newEvent.getSequence()->getTrack();
 
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    this->repaintInactiveEvents(newEvent.getSequence(),
+        jmin(event.getBeat(), newEvent.getBeat()),
+        jmax(event.getBeat(), newEvent.getBeat()));
+
+    if (track != this->getActiveTrack())
     {
-        auto *sequenceMap = c.second.get();
-        if (auto *component = sequenceMap->eventsMap[event])
-        {
-            sequenceMap->sortedComponents.sort(*component);
+        return;
+    }
+
+    auto *sequenceMap = &this->activeMap;
+    const auto foundComponent = sequenceMap->eventsMap.find(event);
+    if (foundComponent == sequenceMap->eventsMap.end())
+    {
+        return;
+    }
 
-            const int indexOfSorted = sequenceMap->sortedComponents.indexOfSorted(*component, component);
-            auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
-            auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
+    auto *component = foundComponent->second;
+    sequenceMap->sortedComponents.sort(*component);
 
-            // if the neighbourhood has changed,
-            // connect the most recent neighbours to each other:
-            if (nextEventComponent != component->getNextNeighbour() ||
-                previousEventComponent != component->getPreviousNeighbour())
-            {
-                if (component->getPreviousNeighbour())
-                {
-                    component->getPreviousNeighbour()->setNextNeighbour(component->getNextNeighbour());
-                }
+    const int indexOfSorted = sequenceMap->sortedComponents.indexOfSorted(*component, component);
+    auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
+    auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
 
-                if (component->getNextNeighbour())
-                {
-                    component->getNextNeighbour()->setPreviousNeighbour(component->getPreviousNeighbour());
-                }
-            }
+    // if the neighbourhood has changed,
+    // connect the most recent neighbours to each other:
+    if (nextEventComponent != component->getNextNeighbour() ||
+        previousEventComponent != component->getPreviousNeighbour())
+    {
+        if (component->getPreviousNeighbour())
+        {
+            component->getPreviousNeighbour()->setNextNeighbour(component->getNextNeighbour());
+        }
 
-            component->setNextNeighbour(nextEventComponent);
-            component->setPreviousNeighbour(previousEventComponent);
-            this->applyEventBounds(component);
+        if (component->getNextNeighbour())
+        {
+            component->getNextNeighbour()->setPreviousNeighbour(component->getPreviousNeighbour());
+        }
+    }
 
-            if (previousEventComponent)
-            {
-                previousEventComponent->setNextNeighbour(component);
-            }
+    component->setNextNeighbour(nextEventComponent);
+    component->setPreviousNeighbour(previousEventComponent);
+    this->applyEventBounds(component);
 
-            if (nextEventComponent)
-            {
-                nextEventComponent->setPreviousNeighbour(component);
-            }
+    if (previousEventComponent)
+    {
+        previousEventComponent->setNextNeighbour(component);
+    }
 
-            sequenceMap->eventsMap.erase(event);
-            sequenceMap->eventsMap[newEvent] = component;
-        }
+    if (nextEventComponent)
+    {
+        nextEventComponent->setPreviousNeighbour(component);
     }
+
+    sequenceMap->eventsMap.erase(event);
+    sequenceMap->eventsMap[newEvent] = component;
 }
 
 void AutomationEditor::onAddMidiEvent(const MidiEvent &event)
@@ -846,49 +1058,51 @@ void AutomationEditor::onAddMidiEvent(const MidiEvent &event)
     
     const auto &autoEvent = static_cast<const AutomationEvent &>(event);
     const auto *track = autoEvent.getSequence()->getTrack();
-    const bool isOnOffTrack = track->isOnOffAutomationTrack();
 
-    AUTO_EDITOR_BATCH_REPAINT_START
+    this->repaintInactiveEvents(autoEvent.getSequence(),
+        autoEvent.getBeat(), autoEvent.getBeat());
 
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    if (track != this->getActiveTrack())
     {
-        auto *sequenceMap = c.second.get();
-        const auto *targetClipId = &c.first;
-        const int i = track->getPattern()->indexOfSorted(targetClipId);
-        jassert(i >= 0);
+        return;
+    }
 
-        const auto *clip = track->getPattern()->getUnchecked(i);
-        const bool isEditable = this->activeClip == *clip;
+    const int i = track->getPattern()->indexOfSorted(&*this->activeClip);
+    jassert(i >= 0);
 
-        auto *component = isOnOffTrack ?
-            this->createOnOffEventComponent(autoEvent, *clip) :
-            this->createCurveEventComponent(autoEvent, *clip);
+    const auto *clip = track->getPattern()->getUnchecked(i);
+    auto *sequenceMap = &this->activeMap;
 
-        component->setEditable(isEditable);
-        this->addAndMakeVisible(component);
+    AUTO_EDITOR_BATCH_REPAINT_START
 
-        // update links and connectors
-        const int indexOfSorted = sequenceMap->sortedComponents.addSorted(*component, component);
-        auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
-        auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
+    auto *component = track->isOnOffAutomationTrack() ?
+        this->createOnOffEventComponent(autoEvent, *clip) :
+        this->createCurveEventComponent(autoEvent, *clip);
 
-        component->setNextNeighbour(nextEventComponent);
-        component->setPreviousNeighbour(previousEventComponent);
-        this->applyEventBounds(component);
+    component->setEditable(true);
+    this->addAndMakeVisible(component);
 
-        if (previousEventComponent)
-        {
-            previousEventComponent->setNextNeighbour(component);
-        }
+    // update links and connectors
+    const int indexOfSorted = sequenceMap->sortedComponents.addSorted(*component, component);
+    auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
+    auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
 
-        if (nextEventComponent)
-        {
-            nextEventComponent->setPreviousNeighbour(component);
-        }
+    component->setNextNeighbour(nextEventComponent);
+    component->setPreviousNeighbour(previousEventComponent);
+    this->applyEventBounds(component);
 
-        sequenceMap->eventsMap[autoEvent] = component;
+    if (previousEventComponent)
+    {
+        previousEventComponent->setNextNeighbour(component);
     }
 
+    if (nextEventComponent)
+    {
+        nextEventComponent->setPreviousNeighbour(component);
+    }
+
+    sequenceMap->eventsMap[autoEvent] = component;
+
     AUTO_EDITOR_BATCH_REPAINT_END
 }
 
@@ -902,154 +1116,114 @@ void AutomationEditor::onRemoveMidiEvent(const MidiEvent &event)
     const auto &autoEvent = static_cast<const AutomationEvent &>(event);
     const auto *track = autoEvent.getSequence()->getTrack();
 
-    AUTO_EDITOR_BATCH_REPAINT_START
+    this->repaintInactiveEvents(autoEvent.getSequence(),
+        autoEvent.getBeat(), autoEvent.getBeat());
 
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    const auto foundSegments = this->curveSegments.find(autoEvent.getSequence());
+    if (foundSegments != this->curveSegments.end())
     {
-        auto *sequenceMap = c.second.get();
-
-        if (auto *component = sequenceMap->eventsMap[autoEvent])
-        {
-            //this->eventAnimator.fadeOut(component, Globals::UI::fadeOutShort);
-            this->removeChildComponent(component);
-            sequenceMap->eventsMap.erase(autoEvent);
-
-            // update links and connectors for neighbors
-            const int indexOfSorted = sequenceMap->sortedComponents.indexOfSorted(*component, component);
-            auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
-            auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
-
-            if (previousEventComponent)
-            {
-                previousEventComponent->setNextNeighbour(nextEventComponent);
-            }
-
-            if (nextEventComponent)
-            {
-                nextEventComponent->setPreviousNeighbour(previousEventComponent);
-            }
-
-            sequenceMap->sortedComponents.remove(indexOfSorted, true);
-        }
+        foundSegments.value().erase(autoEvent.getId());
     }
 
-    AUTO_EDITOR_BATCH_REPAINT_END
-}
-
-void AutomationEditor::onAddClip(const Clip &clip)
-{
-    SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
-    if (!dynamic_cast<const AutomationSequence *>(track->getSequence())) { return; }
-
-    const bool isOnOffTrack = track->isOnOffAutomationTrack();
-
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    if (track != this->getActiveTrack())
     {
-        // a sequence map for the same track:
-        referenceMap = c.second.get();
-        break;
+        return;
     }
 
-    if (referenceMap == nullptr)
+    auto *sequenceMap = &this->activeMap;
+    const auto foundComponent = sequenceMap->eventsMap.find(autoEvent);
+    if (foundComponent == sequenceMap->eventsMap.end())
     {
-        jassertfalse;
         return;
     }
 
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
+    auto *component = foundComponent->second;
 
     AUTO_EDITOR_BATCH_REPAINT_START
 
-    for (const auto *referenceComponent : referenceMap->sortedComponents)
-    {
-        const auto &referenceEvent = referenceComponent->getEvent();
-
-        auto *component = isOnOffTrack ?
-            this->createOnOffEventComponent(referenceEvent, clip) :
-            this->createCurveEventComponent(referenceEvent, clip);
-
-        component->setEditable(this->activeClip == clip);
-        this->addAndMakeVisible(component);
+    //this->eventAnimator.fadeOut(component, Globals::UI::fadeOutShort);
+    this->removeChildComponent(component);
+    sequenceMap->eventsMap.erase(autoEvent);
 
-        const int indexOfSorted = sequenceMap->sortedComponents.addSorted(*component, component);
-        auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
-        auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
+    // update links and connectors for neighbors
+    const int indexOfSorted = sequenceMap->sortedComponents.indexOfSorted(*component, component);
+    auto *previousEventComponent = sequenceMap->sortedComponents[indexOfSorted - 1];
+    auto *nextEventComponent = sequenceMap->sortedComponents[indexOfSorted + 1];
 
-        component->setNextNeighbour(nextEventComponent);
-        component->setPreviousNeighbour(previousEventComponent);
-
-        if (previousEventComponent)
-        {
-            previousEventComponent->setNextNeighbour(component);
-        }
-
-        if (nextEventComponent)
-        {
-            nextEventComponent->setPreviousNeighbour(component);
-        }
+    if (previousEventComponent)
+    {
+        previousEventComponent->setNextNeighbour(nextEventComponent);
+    }
 
-        sequenceMap->eventsMap[referenceEvent] = component;
+    if (nextEventComponent)
+    {
+        nextEventComponent->setPreviousNeighbour(previousEventComponent);
     }
 
-    this->applyEventsBounds(sequenceMap);
+    sequenceMap->sortedComponents.remove(indexOfSorted, true);
 
     AUTO_EDITOR_BATCH_REPAINT_END
+}
+
+void AutomationEditor::onAddClip(const Clip &clip)
+{
+    const auto *track = clip.getPattern()->getTrack();
+    if (!this->automationTracks.contains(track)) { return; }
 
+    this->repaint();
     this->listeners.call(&EditorPanelBase::Listener::onUpdateEventFilters);
 }
 
 void AutomationEditor::onChangeClip(const Clip &clip, const Clip &newClip)
 {
+    const auto *track = newClip.getPattern()->getTrack();
+    if (!this->automationTracks.contains(track)) { return; }
+
     if (this->activeClip == clip) // same id
     {
         this->activeClip = newClip; // new parameters
-    }
 
-    if (this->patternMap.contains(clip))
-    {
         AUTO_EDITOR_BATCH_REPAINT_START
-
-        // set new key for the existing sequence map
-        auto *sequenceMap = this->patternMap[clip].release();
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceMap>(sequenceMap);
-        this->applyEventsBounds(sequenceMap);
-
+        this->applyEventsBounds(&this->activeMap);
         AUTO_EDITOR_BATCH_REPAINT_END
     }
+
+    this->repaint();
 }
 
 void AutomationEditor::onRemoveClip(const Clip &clip)
 {
-    AUTO_EDITOR_BATCH_REPAINT_START
+    const auto *track = clip.getPattern()->getTrack();
+    if (!this->automationTracks.contains(track)) { return; }
 
-    if (this->patternMap.contains(clip))
+    if (this->activeClip == clip)
     {
-        this->patternMap.erase(clip);
+        // the components refer to the clip instance which is about to be deleted
+        AUTO_EDITOR_BATCH_REPAINT_START
+        this->activeMap.eventsMap.clear();
+        this->activeMap.sortedComponents.clear();
+        AUTO_EDITOR_BATCH_REPAINT_END
     }
 
-    AUTO_EDITOR_BATCH_REPAINT_END
-
+    this->repaint();
     this->listeners.call(&EditorPanelBase::Listener::onUpdateEventFilters);
 }
 
 void AutomationEditor::onChangeTrackProperties(MidiTrack *const track)
 {
-    if (!dynamic_cast<const AutomationSequence *>(track->getSequence())) { return; }
+    if (!this->automationTracks.contains(track)) { return; }
 
-    AUTO_EDITOR_BATCH_REPAINT_START
-
-    for (const auto &map : this->patternMap)
+    if (track == this->getActiveTrack())
     {
-        for (auto *component : map.second->sortedComponents)
+        AUTO_EDITOR_BATCH_REPAINT_START
+
+        for (auto *component : this->activeMap.sortedComponents)
         {
             component->updateColour();
         }
-    }
 
-    AUTO_EDITOR_BATCH_REPAINT_END
+        AUTO_EDITOR_BATCH_REPAINT_END
+    }
 
     this->repaint();
 
@@ -1068,9 +1242,11 @@ void AutomationEditor::onAddTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const AutomationSequence *>(track->getSequence())) { return; }
 
-    AUTO_EDITOR_BATCH_REPAINT_START
-    this->loadTrack(track);
-    AUTO_EDITOR_BATCH_REPAINT_END
+    if (track->getPattern() != nullptr)
+    {
+        this->automationTracks.addIfNotAlreadyThere(track);
+        this->repaint();
+    }
 
     this->listeners.call(&EditorPanelBase::Listener::onUpdateEventFilters);
 }
@@ -1079,15 +1255,18 @@ void AutomationEditor::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const AutomationSequence *>(track->getSequence())) { return; }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    if (track == this->getActiveTrack())
     {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
-        {
-            this->patternMap.erase(clip);
-        }
+        AUTO_EDITOR_BATCH_REPAINT_START
+        this->activeMap.eventsMap.clear();
+        this->activeMap.sortedComponents.clear();
+        AUTO_EDITOR_BATCH_REPAINT_END
     }
 
+    this->automationTracks.removeFirstMatchingValue(track);
+    this->curveSegments.erase(track->getSequence());
+    this->repaint();
+
     this->listeners.call(&EditorPanelBase::Listener::onUpdateEventFilters);
 }
 
@@ -1121,79 +1300,158 @@ void AutomationEditor::onChangeViewBeatRange(float firstBeat, float lastBeat)
 
 void AutomationEditor::reloadTrackMap()
 {
-    this->patternMap.clear();
-
-    AUTO_EDITOR_BATCH_REPAINT_START
+    this->automationTracks.clearQuick();
+    this->curveSegments.clear();
 
     const auto &tracks = this->project.getTracks();
     for (const auto *track : tracks)
     {
-        if (nullptr != dynamic_cast<const AutomationSequence *>(track->getSequence()))
+        if (nullptr != dynamic_cast<const AutomationSequence *>(track->getSequence()) &&
+            track->getPattern() != nullptr)
         {
-            this->loadTrack(track);
+            this->automationTracks.add(track);
         }
     }
 
+    AUTO_EDITOR_BATCH_REPAINT_START
+    this->reloadActiveMap();
     AUTO_EDITOR_BATCH_REPAINT_END
+
+    this->repaint();
 }
 
-void AutomationEditor::loadTrack(const MidiTrack *const track)
+void AutomationEditor::reloadActiveMap()
 {
-    if (track->getPattern() == nullptr)
+    this->activeMap.eventsMap.clear();
+    this->activeMap.sortedComponents.clear();
+
+    const auto *track = this->getActiveTrack();
+    if (track == nullptr)
+    {
+        return;
+    }
+
+    // the components refer to the clip instance owned by the pattern
+    const int clipIndex = track->getPattern()->indexOfSorted(&*this->activeClip);
+    if (clipIndex < 0)
     {
+        jassertfalse;
         return;
     }
 
+    const auto *clip = track->getPattern()->getUnchecked(clipIndex);
     const bool isOnOffTrack = track->isOnOffAutomationTrack();
+    auto *sequenceMap = &this->activeMap;
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    for (int j = 0; j < track->getSequence()->size(); ++j)
     {
-        const auto *clip = track->getPattern()->getUnchecked(i);
-        const bool editable = this->activeClip == *clip;
+        const auto *event = track->getSequence()->getUnchecked(j);
+        if (event->isTypeOf(MidiEvent::Type::Auto))
+        {
+            const auto *autoEvent = static_cast<const AutomationEvent *>(event);
 
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
+            auto *component = isOnOffTrack ?
+                this->createOnOffEventComponent(*autoEvent, *clip) :
+                this->createCurveEventComponent(*autoEvent, *clip);
 
-        for (int j = 0; j < track->getSequence()->size(); ++j)
-        {
-            const auto *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Auto))
-            {
-                const auto *autoEvent = static_cast<const AutomationEvent *>(event);
+            component->setEditable(true);
+            this->addAndMakeVisible(component);
+
+            sequenceMap->sortedComponents.addSorted(*component, component);
+            sequenceMap->eventsMap[*autoEvent] = component;
+        }
+    }
 
-                auto *component = isOnOffTrack ?
-                    this->createOnOffEventComponent(*autoEvent, *clip) :
-                    this->createCurveEventComponent(*autoEvent, *clip);
+    for (int j = 0; j < sequenceMap->sortedComponents.size(); ++j)
+    {
+        auto *component = sequenceMap->sortedComponents.getUnchecked(j);
+        auto *previousEventComponent = sequenceMap->sortedComponents[j - 1];
+        auto *nextEventComponent = sequenceMap->sortedComponents[j + 1];
 
-                component->setEditable(editable);
-                this->addAndMakeVisible(component);
+        component->setNextNeighbour(nextEventComponent);
+        component->setPreviousNeighbour(previousEventComponent);
 
-                sequenceMap->sortedComponents.addSorted(*component, component);
-                sequenceMap->eventsMap[*autoEvent] = component;
-            }
+        if (previousEventComponent)
+        {
+            previousEventComponent->setNextNeighbour(component);
         }
 
-        for (int j = 0; j < sequenceMap->sortedComponents.size(); ++j)
+        if (nextEventComponent)
         {
-            auto *component = sequenceMap->sortedComponents.getUnchecked(j);
-            auto *previousEventComponent = sequenceMap->sortedComponents[j - 1];
-            auto *nextEventComponent = sequenceMap->sortedComponents[j + 1];
+            nextEventComponent->setPreviousNeighbour(component);
+        }
+    }
 
-            component->setNextNeighbour(nextEventComponent);
-            component->setPreviousNeighbour(previousEventComponent);
+    this->applyEventsBounds(sequenceMap);
+}
 
-            if (previousEventComponent)
-            {
-                previousEventComponent->setNextNeighbour(component);
-            }
+const MidiTrack *AutomationEditor::getActiveTrack() const noexcept
+{
+    if (!this->activeClip.hasValue())
+    {
+        return nullptr;
+    }
 
-            if (nextEventComponent)
-            {
-                nextEventComponent->setPreviousNeighbour(component);
-            }
+    const auto *track = this->activeClip->getPattern()->getTrack();
+    return this->automationTracks.contains(track) ? track : nullptr;
+}
+
+float AutomationEditor::getRollBeatByXPosition(float x) const noexcept
+{
+    // not rounded and not clamped, unlike RollBase::getBeatByXPosition,
+    // because it's used for culling, not for editing
+    jassert(this->getWidth() == this->roll->getWidth());
+    return this->roll->getFirstBeat() + x / this->roll->getBeatWidth();
+}
+
+void AutomationEditor::repaintInactiveEvents(const MidiSequence *sequence,
+    float startBeat, float endBeat)
+{
+    const auto *track = sequence->getTrack();
+    if (!this->automationTracks.contains(track) ||
+        this->roll == nullptr || this->roll->getBeatWidth() <= 0.f)
+    {
+        return;
+    }
+
+    // the changed event's neighbours are affected as well, as their connectors are
+    const auto eventIndices = findAutomationEventsToPaint(*sequence, startBeat, endBeat);
+    if (!eventIndices.isEmpty())
+    {
+        startBeat = jmin(startBeat, sequence->getUnchecked(eventIndices.getStart())->getBeat());
+        endBeat = jmax(endBeat, sequence->getUnchecked(eventIndices.getEnd() - 1)->getBeat());
+    }
+
+    const auto margin = roundToInt(jmax(float(AutomationEditor::curveEventComponentDiameter),
+        this->getOnOffEventBounds(0.f, false).getWidth()));
+
+    const auto *pattern = track->getPattern();
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        const auto &clip = *pattern->getUnchecked(i);
+        if (this->activeClip == clip)
+        {
+            continue; // has its own components
         }
 
-        this->applyEventsBounds(sequenceMap);
+        const auto x1 = this->roll->getXPositionByBeat(startBeat + clip.getBeat(), float(this->getWidth()));
+        const auto x2 = this->roll->getXPositionByBeat(endBeat + clip.getBeat(), float(this->getWidth()));
+        const Rectangle<int> column(x1 - margin, 0, x2 - x1 + margin * 2, this->getHeight());
+        this->dirtyArea = this->dirtyArea.getUnion(column);
+    }
+
+    if (!this->dirtyArea.isEmpty())
+    {
+        this->triggerAsyncUpdate();
+    }
+}
+
+void AutomationEditor::handleAsyncUpdate()
+{
+    if (!this->dirtyArea.isEmpty())
+    {
+        this->repaint(this->dirtyArea);
+        this->dirtyArea = {};
     }
 }
 
@@ -1236,14 +1494,8 @@ void AutomationEditor::insertNewOnOffEventAt(const MouseEvent &e, bool shouldAdd
         return;
     }
 
-    if (!this->patternMap.contains(*this->activeClip))
-    {
-        jassertfalse;
-        return;
-    }
-
-    const auto *track = this->activeClip->getPattern()->getTrack();
-    if (!track->isOnOffAutomationTrack())
+    const auto *track = this->getActiveTrack();
+    if (track == nullptr || !track->isOnOffAutomationTrack())
     {
         jassertfalse;
         return;
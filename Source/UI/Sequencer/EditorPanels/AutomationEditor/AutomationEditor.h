@@ -26,6 +26,7 @@
 #include "RollEditMode.h"
 #include "EditorPanelBase.h"
 #include "Lasso.h"
+#include "AutomationCurveEventsConnector.h"
 
 class RollBase;
 class ProjectNode;
@@ -37,7 +38,8 @@ class AutomationEditor final :
     public AutomationEditorBase,
     public RollEditMode::Listener,
     public MultiTouchListener,
-    public ProjectListener
+    public ProjectListener,
+    public AsyncUpdater // triggers batch repaints for inactive clips
 {
 public:
 
@@ -113,6 +115,7 @@ public:
     //===------------------------------------------------------------------===//
 
     void resized() override;
+    void paint(Graphics &g) override;
     void mouseDown(const MouseEvent &e) override;
     void mouseDrag(const MouseEvent &e) override;
     void mouseUp(const MouseEvent &e) override;
@@ -132,6 +135,10 @@ private:
     float rollFirstBeat = 0.f;
     float rollLastBeat = Globals::Defaults::projectLength;
 
+    Array<const MidiTrack *> automationTracks;
+
+    // only the active clip has interactive event components,
+    // all other clips are painted straight from their sequences
     struct SequenceMap final
     {
         // owned components, sorted by beat
@@ -140,8 +147,27 @@ private:
         FlatHashMap<AutomationEvent, EventComponentBase *, MidiEventHash> eventsMap;
     };
 
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
+    SequenceMap activeMap;
+    const MidiTrack *getActiveTrack() const noexcept;
+
+private:
+
+    void paintInactiveCurveEvents(Graphics &g, const MidiSequence &sequence,
+        const Clip &clip, const Range<int> &eventIndices);
+    void paintInactiveStepEvents(Graphics &g, const MidiSequence &sequence,
+        const Clip &clip, const Range<int> &eventIndices);
+
+    float getRollBeatByXPosition(float x) const noexcept;
+
+    // the interpolated curves between the events of inactive clips, by the first event id;
+    // they are shared by all clips of a sequence, as they don't depend on a clip's offset
+    using CurveSegments = FlatHashMap<MidiEvent::Id, AutomationCurveSegment>;
+    FlatHashMap<const MidiSequence *, CurveSegments> curveSegments;
+
+    // collects the areas of the changed events and their connectors in inactive clips
+    void repaintInactiveEvents(const MidiSequence *sequence, float startBeat, float endBeat);
+    void handleAsyncUpdate() override;
+    Rectangle<int> dirtyArea;
 
 private:
 
@@ -186,7 +212,7 @@ private:
     void insertNewOnOffEventAt(const MouseEvent &e, bool shouldAddPairedEvents);
 
     void reloadTrackMap();
-    void loadTrack(const MidiTrack *const track);
+    void reloadActiveMap();
 
     JUCE_LEAK_DETECTOR(AutomationEditor)
 };
@@ -115,7 +115,7 @@ void EditorPanelsScroller::switchToRoll(SafePointer<RollBase> roll)
 
     if (this->animationsEnabled)
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
     else
     {
@@ -151,7 +151,7 @@ void EditorPanelsScroller::paint(Graphics &g)
 
 void EditorPanelsScroller::onMidiRollMoved(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !this->isAnimating())
     {
         this->updateAllChildrenBounds();
     }
@@ -159,7 +159,7 @@ void EditorPanelsScroller::onMidiRollMoved(RollBase *targetRoll)
 
 void EditorPanelsScroller::onMidiRollResized(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !this->isAnimating())
     {
         this->updateAllChildrenBounds();
     }
@@ -179,7 +179,7 @@ void EditorPanelsScroller::updateAllChildrenBounds()
 }
 
 //===----------------------------------------------------------------------===//
-// Timer animating transitions between rolls
+// FrameClock::Client animating transitions between rolls
 //===----------------------------------------------------------------------===//
 
 static Rectangle<float> lerpEditorPanelBounds(const Rectangle<float> &r1,
@@ -208,7 +208,7 @@ static float getEditorPanelBoundsDistance(const Rectangle<float> &r1,
     return fabs(r1.getX() - r2.getX()) + fabs(r1.getWidth() - r2.getWidth());
 }
 
-void EditorPanelsScroller::timerCallback()
+void EditorPanelsScroller::onAnimationFrame()
 {
     const auto newBounds = this->getEditorPanelBounds().toFloat();
     const auto interpolatedBounds = lerpEditorPanelBounds(this->panelsBoundsAnimationAnchor, newBounds, 0.6f);
@@ -218,7 +218,7 @@ void EditorPanelsScroller::timerCallback()
 
     if (shouldStop)
     {
-        this->stopTimer();
+        this->stopAnimating();
     }
 
     const auto finalBounds = this->panelsBoundsAnimationAnchor.toNearestInt();
@@ -29,6 +29,7 @@ class EditorPanelsSwitcher;
 #include "EditorPanelBase.h"
 #include "Clip.h"
 #include "ColourIDs.h"
+#include "FrameClock.h"
 
 class EditorPanelsScroller final :
     public Component,
@@ -36,7 +37,7 @@ class EditorPanelsScroller final :
     public RollListener,
     public EditorPanelBase::Listener,
     public ChangeListener, // subscribes on the parent roll's lasso changes
-    private Timer // optionally animates transitions between rolls
+    private FrameClock::Client // optionally animates transitions between rolls
 {
 public:
 
@@ -103,7 +104,7 @@ private:
 
     void updateAllChildrenBounds();
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
     Rectangle<float> panelsBoundsAnimationAnchor;
     bool animationsEnabled = true;
 
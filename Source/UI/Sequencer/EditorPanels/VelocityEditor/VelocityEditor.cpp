@@ -33,177 +33,6 @@
 #include "PointReduction.h"
 #include "ColourIDs.h"
 
-//===----------------------------------------------------------------------===//
-// Single note velocity component
-//===----------------------------------------------------------------------===//
-
-class VelocityEditorNoteComponent final : public Component
-{
-public:
-
-    VelocityEditorNoteComponent(const Note &note, const Clip &clip) :
-        note(note),
-        clip(clip)
-    {
-        this->setInterceptsMouseClicks(true, false);
-        this->setMouseClickGrabsKeyboardFocus(false);
-        this->setPaintingIsUnclipped(true);
-        this->setMouseCursor(MouseCursor::UpDownResizeCursor);
-        this->updateColour();
-    }
-
-    inline const Note &getNote() const noexcept
-    {
-        return this->note;
-    }
-
-    inline float getNoteBeat() const noexcept
-    {
-        return this->note.getBeat();
-    }
-
-    inline float getClipBeat() const noexcept
-    {
-        return this->clip.getBeat();
-    }
-
-    inline float getLength() const noexcept
-    {
-        return this->note.getLength();
-    }
-
-    inline float getFullVelocity() const noexcept
-    {
-        return this->note.getVelocity() * this->clip.getVelocity();
-    }
-
-    inline float getFullBeat() const noexcept
-    {
-        return this->note.getBeat() + this->clip.getBeat();
-    }
-
-    Line<float> getBeatIntersectionLine() const noexcept
-    {
-        const auto beat = this->getFullBeat();
-        return { beat, 0.f, beat, float(Globals::UI::editorPanelHeight) };
-    }
-
-    inline void updateColour()
-    {
-        const auto baseColour = findDefaultColour(ColourIDs::Roll::noteFill);
-        this->mainColour = this->note.getTrackColour()
-            .interpolatedWith(baseColour, (this->isEditable || this->isHighlighted) ? 0.35f : 0.5f)
-            .withAlpha(this->isEditable ? 0.8f : (this->isHighlighted ? 0.125f : 0.06f));
-        this->paleColour = this->mainColour
-            .brighter(this->isHighlighted ? 0.3f : 0.1f)
-            .withMultipliedAlpha(this->isHighlighted ? 0.3f : 0.1f);
-    }
-
-    void setRealBounds(float x, int y, float w, int h) noexcept
-    {
-        this->dx = x - floorf(x);
-        this->dw = w - ceilf(w);
-        this->setBounds(int(floorf(x)), y, int(ceilf(w)), h);
-    }
-
-    void setEditable(bool shouldBeEditable, bool shouldBeHighlighted = false)
-    {
-        if (this->isEditable == shouldBeEditable &&
-            this->isHighlighted == shouldBeHighlighted)
-        {
-            return;
-        }
-
-        this->isEditable = shouldBeEditable;
-        this->isHighlighted = shouldBeHighlighted;
-
-        this->updateColour();
-
-        if (this->isEditable)
-        {
-            // toBack() and toFront() use indexOf(this) so calling them sucks
-            this->toFront(false);
-        }
-    }
-
-    //===------------------------------------------------------------------===//
-    // Component
-    //===------------------------------------------------------------------===//
-
-    void paint(Graphics &g) noexcept override
-    {
-        g.setColour(this->mainColour);
-        g.fillRect(this->dx, 1.f, 1.f, float(this->getHeight() - 1));
-
-        if (this->getWidth() > 2)
-        {
-            g.fillRect(this->dx + 1.f, 0.f, float(this->getWidth() - 2) + this->dw, 1.f);
-            g.fillRect(this->dx, 1.f, float(this->getWidth()) + this->dw, 2.f);
-        }
-
-        g.setColour(this->paleColour);
-        g.fillRect(this->dx, 0.f, float(this->getWidth()) + this->dw, float(this->getHeight()));
-    }
-
-    bool hitTest(int x, int y) noexcept override
-    {
-        return this->isEditable;
-    }
-
-    void mouseDown(const MouseEvent &e) override
-    {
-        jassert(this->isEditable);
-        if (this->getEditor()->isMultiTouchEvent(e))
-        {
-            return;
-        }
-
-        this->getEditor()->startFineTuning(this, e);
-    }
-
-    void mouseDrag(const MouseEvent &e) override
-    {
-        jassert(this->isEditable);
-        if (this->getEditor()->isMultiTouchEvent(e))
-        {
-            this->getEditor()->endFineTuning(this, e);
-            return;
-        }
-
-        this->getEditor()->continueFineTuning(this, e);
-    }
-
-    void mouseUp(const MouseEvent &e) override
-    {
-        jassert(this->isEditable);
-        this->getEditor()->endFineTuning(this, e);
-    }
-
-private:
-
-    friend class VelocityEditor;
-
-    VelocityEditor *getEditor() const
-    {
-        jassert(this->getParentComponent());
-        return static_cast<VelocityEditor *>(this->getParentComponent());
-    }
-
-    const Note &note;
-    const Clip &clip;
-
-    Colour mainColour;
-    Colour paleColour;
-
-    float dx = 0.f;
-    float dw = 0.f;
-
-    bool isEditable = true;
-    bool isHighlighted = true;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VelocityEditorNoteComponent)
-};
-
 //===----------------------------------------------------------------------===//
 // Hand-drawing helper
 //===----------------------------------------------------------------------===//
@@ -324,18 +153,11 @@ private:
 // VelocityEditor
 //===----------------------------------------------------------------------===//
 
-#define VELOCITY_MAP_BATCH_REPAINT_START \
-    if (this->isEnabled()) { this->setVisible(false); }
-
-#define VELOCITY_MAP_BATCH_REPAINT_END \
-    if (this->isEnabled()) { this->setVisible(true); }
-
 VelocityEditor::VelocityEditor(ProjectNode &project, SafePointer<RollBase> roll) :
     project(project),
     roll(roll)
 {
     this->setInterceptsMouseClicks(true, true);
-    this->setPaintingIsUnclipped(true);
 
     this->volumeBlendingIndicator = make<FineTuningValueIndicator>(this->volumeBlendingAmount, "");
     this->volumeBlendingIndicator->setShouldDisplayValue(false);
@@ -364,25 +186,102 @@ VelocityEditor::~VelocityEditor()
 
 void VelocityEditor::resized()
 {
-    VELOCITY_MAP_BATCH_REPAINT_START
+    if (this->handDrawingHelper != nullptr)
+    {
+        this->handDrawingHelper->setBounds(this->getLocalBounds());
+        this->handDrawingHelper->updateCurves();
+    }
+}
+
+void VelocityEditor::paint(Graphics &g)
+{
+    if (this->rollLastBeat <= this->rollFirstBeat)
+    {
+        return;
+    }
+
+    const auto area = g.getClipBounds().toFloat();
+    const auto startBeat = this->getRollBeatByXPosition(area.getX());
+    const auto endBeat = this->getRollBeatByXPosition(area.getRight());
 
-    for (const auto &c : this->patternMap)
+    // getPalette returns nullptr for the notes to skip
+    const auto paintNotes = [&](const PianoSequence &sequence,
+        const Clip &clip, const auto &getPalette)
     {
-        const auto sequenceMap = c.second.get();
-        for (const auto &e : *sequenceMap)
+        sequence.forEachNoteInBeatRange(startBeat - clip.getBeat(), endBeat - clip.getBeat(),
+            [&](const Note &note)
+            {
+                if (const auto *palette = getPalette(note))
+                {
+                    VelocityEditor::paintNote(g, this->getNoteBounds(note, clip), *palette);
+                }
+            });
+    };
+
+    const auto *activeSequence = this->getActiveSequence();
+
+    for (const auto *track : this->pianoTracks)
+    {
+        const auto *sequence = static_cast<const PianoSequence *>(track->getSequence());
+        const auto *pattern = track->getPattern();
+        const auto palette = VelocityEditor::makePalette(track->getTrackColour(), false, false);
+
+        for (int i = 0; i < pattern->size(); ++i)
         {
-            jassert(e.second.get());
-            this->applyNoteBounds(e.second.get());
+            const auto &clip = *pattern->getUnchecked(i);
+
+            // the active clip is painted last, on top of everything else
+            if ((activeSequence != nullptr && clip == *this->activeClip) ||
+                clip.getBeat() + sequence->getFirstBeat() > endBeat ||
+                clip.getBeat() + sequence->getLastBeat() < startBeat)
+            {
+                continue;
+            }
+
+            paintNotes(*sequence, clip, [&palette](const Note &) { return &palette; });
         }
     }
 
-    if (this->handDrawingHelper != nullptr)
+    if (activeSequence == nullptr)
     {
-        this->handDrawingHelper->setBounds(this->getLocalBounds());
-        this->handDrawingHelper->updateCurves();
+        return;
     }
 
-    VELOCITY_MAP_BATCH_REPAINT_END
+    const auto &activeClip = *this->activeClip;
+    const auto trackColour = activeClip.getPattern()->getTrack()->getTrackColour();
+
+    if (this->selectedNotes.empty())
+    {
+        const auto editablePalette = VelocityEditor::makePalette(trackColour, true, false);
+        paintNotes(*activeSequence, activeClip,
+            [&editablePalette](const Note &) { return &editablePalette; });
+        return;
+    }
+
+    // the selected notes are editable, and they go on top of the others
+    const auto highlightedPalette = VelocityEditor::makePalette(trackColour, false, true);
+    paintNotes(*activeSequence, activeClip, [&](const Note &note)
+    {
+        return this->selectedNotes.contains(note.getId()) ? nullptr : &highlightedPalette;
+    });
+
+    const auto selectedPalette = VelocityEditor::makePalette(trackColour, true, true);
+    paintNotes(*activeSequence, activeClip, [&](const Note &note)
+    {
+        return this->selectedNotes.contains(note.getId()) ? &selectedPalette : nullptr;
+    });
+}
+
+void VelocityEditor::mouseMove(const MouseEvent &e)
+{
+    if (this->findEditableNoteAt(e.position) != nullptr)
+    {
+        this->setMouseCursor(MouseCursor::UpDownResizeCursor);
+    }
+    else
+    {
+        this->setMouseCursor(this->getEditMode().getCursor());
+    }
 }
 
 void VelocityEditor::mouseDown(const MouseEvent &e)
@@ -392,6 +291,14 @@ void VelocityEditor::mouseDown(const MouseEvent &e)
         return;
     }
 
+    // the editable notes take the clicks in any edit mode
+    this->fineTuningNote = this->findEditableNoteAt(e.position);
+    if (this->fineTuningNote != nullptr)
+    {
+        this->startFineTuning(*this->fineTuningNote, e);
+        return;
+    }
+
     this->panningStart = e.getPosition();
 
     if (this->isDrawingEvent(e))
@@ -413,6 +320,18 @@ void VelocityEditor::mouseDown(const MouseEvent &e)
 
 void VelocityEditor::mouseDrag(const MouseEvent &e)
 {
+    if (this->fineTuningNote != nullptr)
+    {
+        if (this->isMultiTouchEvent(e))
+        {
+            this->endFineTuning(*this->fineTuningNote, e);
+            return;
+        }
+
+        this->continueFineTuning(*this->fineTuningNote, e);
+        return;
+    }
+
     if (this->isMultiTouchEvent(e))
     {
         return;
@@ -439,6 +358,13 @@ void VelocityEditor::mouseDrag(const MouseEvent &e)
 
 void VelocityEditor::mouseUp(const MouseEvent &e)
 {
+    if (this->fineTuningNote != nullptr)
+    {
+        this->endFineTuning(*this->fineTuningNote, e);
+        this->fineTuningNote = nullptr;
+        return;
+    }
+
     if (this->handDrawingHelper != nullptr)
     {
         this->volumeBlendingIndicator->setVisible(false);
@@ -507,20 +433,8 @@ void VelocityEditor::setEditableClip(Optional<Clip> clip)
     }
 
     this->activeClip = clip;
-
-    VELOCITY_MAP_BATCH_REPAINT_START
-
-    for (const auto &c : this->patternMap)
-    {
-        const bool isEditable = c.first == clip;
-        const auto &componentsMap = *c.second.get();
-        for (const auto &e : componentsMap)
-        {
-            e.second->setEditable(isEditable);
-        }
-    }
-
-    VELOCITY_MAP_BATCH_REPAINT_END
+    this->selectedNotes.clear();
+    this->repaint();
 }
 
 void VelocityEditor::setEditableClip(const Clip &selectedClip, const EventFilter &)
@@ -531,58 +445,27 @@ void VelocityEditor::setEditableClip(const Clip &selectedClip, const EventFilter
 void VelocityEditor::setEditableSelection(WeakReference<Lasso> selection)
 {
     this->selection = selection;
+    this->selectedNotes.clear();
 
-    if (!this->activeClip.hasValue())
-    {
-        return;
-    }
-
-    const auto foundActiveMap = this->patternMap.find(*this->activeClip);
-    if (foundActiveMap == this->patternMap.end())
+    const auto *activeSequence = this->getActiveSequence();
+    if (activeSequence == nullptr)
     {
-        jassertfalse;
         return;
     }
 
-    const auto *activeMap = foundActiveMap->second.get();
-
-    VELOCITY_MAP_BATCH_REPAINT_START
-
-    if (selection == nullptr || selection->getNumSelected() == 0)
-    {
-        // no selection: the entire clip is editable
-        for (const auto &it : *activeMap)
-        {
-            it.second->setEditable(true);
-        }
-    }
-    else
+    if (selection != nullptr)
     {
-        for (const auto &it : *activeMap)
-        {
-            it.second->setEditable(false, true);
-        }
-
         for (const auto *component : *selection)
         {
             if (const auto *nc = dynamic_cast<const NoteComponent *>(component))
             {
-                auto foundVolumeComponent = activeMap->find(nc->getNote());
-                if (foundVolumeComponent != activeMap->end())
-                {
-                    foundVolumeComponent->second->setEditable(true, true);
-                }
-#if DEBUG
-                else
-                {
-                    jassertfalse; // wrong activeClip?
-                }
-#endif
+                jassert(nc->getNote().getSequence() == activeSequence); // wrong activeClip?
+                this->selectedNotes.insert(nc->getNote().getId());
             }
         }
     }
 
-    VELOCITY_MAP_BATCH_REPAINT_END
+    this->repaint();
 }
 
 bool VelocityEditor::canEditSequence(WeakReference<MidiSequence> sequence) const
@@ -671,8 +554,6 @@ RollEditMode VelocityEditor::getEditMode() const noexcept
 void VelocityEditor::onChangeEditMode(const RollEditMode &mode)
 {
     this->setMouseCursor(this->getSupportedEditMode(mode).getCursor());
-    // todo fix children interaction someday as well
-    // (not straighforward because it shouldn't break setEditable stuff)
 }
 
 bool VelocityEditor::isDraggingEvent(const MouseEvent &e) const
@@ -694,28 +575,19 @@ bool VelocityEditor::isDrawingEvent(const MouseEvent &e) const
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
-
 void VelocityEditor::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2)
 {
     if (e1.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(e1);
-        const Note &newNote = static_cast<const Note &>(e2);
-        const auto *track = newNote.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        const auto &note = static_cast<const Note &>(e1);
+        const auto &newNote = static_cast<const Note &>(e2);
+        if (!this->pianoTracks.contains(newNote.getSequence()->getTrack()))
         {
-            auto &sequenceMap = *c.second.get();
-            if (auto *component = sequenceMap[note].release())
-            {
-                sequenceMap.erase(note);
-                sequenceMap[newNote] = UniquePointer<VelocityEditorNoteComponent>(component);
-                this->triggerBatchRepaintFor(component);
-            }
+            return;
         }
+
+        this->repaintNote(note);
+        this->repaintNote(newNote);
     }
 }
 
@@ -723,29 +595,13 @@ void VelocityEditor::onAddMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        VELOCITY_MAP_BATCH_REPAINT_START
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        const auto &note = static_cast<const Note &>(event);
+        if (!this->pianoTracks.contains(note.getSequence()->getTrack()))
         {
-            auto &componentsMap = *c.second.get();
-            const auto *targetClipId = &c.first;
-            const int i = track->getPattern()->indexOfSorted(targetClipId);
-            jassert(i >= 0);
-
-            const auto *clip = track->getPattern()->getUnchecked(i);
-            const bool isEditable = this->activeClip == *clip;
-
-            auto *noteComponent = new VelocityEditorNoteComponent(note, *clip);
-            noteComponent->setEditable(isEditable);
-            componentsMap[note] = UniquePointer<VelocityEditorNoteComponent>(noteComponent);
-            this->addAndMakeVisible(noteComponent);
-            this->triggerBatchRepaintFor(noteComponent);
+            return;
         }
 
-        VELOCITY_MAP_BATCH_REPAINT_END
+        this->repaintNote(note);
     }
 }
 
@@ -753,62 +609,29 @@ void VelocityEditor::onRemoveMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        VELOCITY_MAP_BATCH_REPAINT_START
+        const auto &note = static_cast<const Note &>(event);
+        if (!this->pianoTracks.contains(note.getSequence()->getTrack()))
+        {
+            return;
+        }
 
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        if (this->fineTuningNote != nullptr && *this->fineTuningNote == note)
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                sequenceMap.erase(note);
-            }
+            this->fineTuningIndicator = nullptr;
+            this->fineTuningNote = nullptr;
         }
 
-        VELOCITY_MAP_BATCH_REPAINT_END
+        this->selectedNotes.erase(note.getId());
+        this->repaintNote(note);
     }
 }
 
 void VelocityEditor::onAddClip(const Clip &clip)
 {
-    const SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
-    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    if (this->pianoTracks.contains(clip.getPattern()->getTrack()))
     {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
+        this->repaint();
     }
-
-    if (referenceMap == nullptr)
-    {
-        jassertfalse;
-        return;
-    }
-
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
-
-    VELOCITY_MAP_BATCH_REPAINT_START
-
-    for (const auto &e : *referenceMap)
-    {
-        const auto &note = e.second.get()->note;
-        const bool isEditable = this->activeClip == clip;
-
-        auto *noteComponent = new VelocityEditorNoteComponent(note, clip);
-        noteComponent->setEditable(isEditable);
-
-        (*sequenceMap)[note] = UniquePointer<VelocityEditorNoteComponent>(noteComponent);
-        this->addAndMakeVisible(noteComponent);
-        this->applyNoteBounds(noteComponent);
-    }
-
-    VELOCITY_MAP_BATCH_REPAINT_END
 }
 
 void VelocityEditor::onChangeClip(const Clip &clip, const Clip &newClip)
@@ -818,53 +641,26 @@ void VelocityEditor::onChangeClip(const Clip &clip, const Clip &newClip)
         this->activeClip = newClip; // new parameters
     }
 
-    if (this->patternMap.contains(clip))
+    if (this->pianoTracks.contains(newClip.getPattern()->getTrack()))
     {
-        // Set new key for existing sequence map
-        auto *sequenceMap = this->patternMap[clip].release();
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceMap>(sequenceMap);
-
-        // And update all components within it, as their beats should change
-        for (const auto &e : *sequenceMap)
-        {
-            this->batchRepaintList.add(e.second.get());
-        }
-
-        this->triggerAsyncUpdate();
+        this->repaint();
     }
 }
 
 void VelocityEditor::onRemoveClip(const Clip &clip)
 {
-    VELOCITY_MAP_BATCH_REPAINT_START
-
-    if (this->patternMap.contains(clip))
+    if (this->pianoTracks.contains(clip.getPattern()->getTrack()))
     {
-        this->patternMap.erase(clip);
+        this->repaint();
     }
-
-    VELOCITY_MAP_BATCH_REPAINT_END
 }
 
 void VelocityEditor::onChangeTrackProperties(MidiTrack *const track)
 {
-    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    VELOCITY_MAP_BATCH_REPAINT_START
-
-    for (const auto &c : this->patternMap)
+    if (this->pianoTracks.contains(track))
     {
-        const auto &componentsMap = *c.second.get();
-        for (const auto &e : componentsMap)
-        {
-            e.second->updateColour();
-        }
+        this->repaint();
     }
-
-    VELOCITY_MAP_BATCH_REPAINT_END
-
-    this->repaint();
 }
 
 void VelocityEditor::onReloadProjectContent(const Array<MidiTrack *> &tracks,
@@ -877,23 +673,23 @@ void VelocityEditor::onAddTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
 
-    VELOCITY_MAP_BATCH_REPAINT_START
-    this->loadTrack(track);
-    VELOCITY_MAP_BATCH_REPAINT_END
+    this->pianoTracks.addIfNotAlreadyThere(track);
+    this->repaint();
 }
 
 void VelocityEditor::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    if (this->fineTuningNote != nullptr &&
+        this->fineTuningNote->getSequence() == track->getSequence())
     {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
-        {
-            this->patternMap.erase(clip);
-        }
+        this->fineTuningIndicator = nullptr;
+        this->fineTuningNote = nullptr;
     }
+
+    this->pianoTracks.removeFirstMatchingValue(track);
+    this->repaint();
 }
 
 void VelocityEditor::onChangeProjectBeatRange(float firstBeat, float lastBeat)
@@ -905,6 +701,7 @@ void VelocityEditor::onChangeProjectBeatRange(float firstBeat, float lastBeat)
     {
         this->rollFirstBeat = jmin(firstBeat, this->rollFirstBeat);
         this->rollLastBeat = jmax(lastBeat, this->rollLastBeat);
+        this->repaint();
     }
 }
 
@@ -914,6 +711,7 @@ void VelocityEditor::onChangeViewBeatRange(float firstBeat, float lastBeat)
     {
         this->rollFirstBeat = firstBeat;
         this->rollLastBeat = lastBeat;
+        this->repaint();
     }
 }
 
@@ -922,7 +720,7 @@ void VelocityEditor::onChangeViewBeatRange(float firstBeat, float lastBeat)
 //===----------------------------------------------------------------------===//
 
 static String getVelocityRangeView(WeakReference<Lasso> selection,
-    VelocityEditorNoteComponent *draggedNote)
+    const Note &draggedNote, const Clip &clip)
 {
     float minFullVelocity = 1.f;
     float maxFullVelocity = 0.f;
@@ -941,7 +739,7 @@ static String getVelocityRangeView(WeakReference<Lasso> selection,
     }
     else
     {
-        minFullVelocity = maxFullVelocity = draggedNote->getFullVelocity();
+        minFullVelocity = maxFullVelocity = draggedNote.getVelocity() * clip.getVelocity();
     }
 
     return (minFullVelocity == maxFullVelocity) ?
@@ -950,11 +748,14 @@ static String getVelocityRangeView(WeakReference<Lasso> selection,
         String(MidiMessage::floatValueToMidiByte(maxFullVelocity));
 }
 
-void VelocityEditor::startFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e)
+void VelocityEditor::startFineTuning(const Note &target, const MouseEvent &e)
 {
     if (e.mods.isLeftButtonDown())
     {
-        this->fineTuningAnchor = target->getNote().getVelocity();
+        jassert(this->activeClip.hasValue());
+        const auto &activeClip = *this->activeClip;
+
+        this->fineTuningAnchor = target.getVelocity();
 
         if (this->selection != nullptr &&
             this->selection->getNumSelected() > 0)
@@ -962,13 +763,14 @@ void VelocityEditor::startFineTuning(VelocityEditorNoteComponent *target, const
             SequencerOperations::startTuning(*this->selection);
         }
 
-        this->fineTuningDragger.startDraggingComponent(target, e,
+        // the dragger only needs a component to track the mouse relative to it
+        this->fineTuningDragger.startDraggingComponent(this, e,
             this->fineTuningAnchor, 0.f, 1.f, 1.f / 127.f,
             FineTuningComponentDragger::Mode::DragOnlyY);
 
         this->fineTuningIndicator = make<FineTuningValueIndicator>(0.f, "");
-        this->fineTuningIndicator->setValue(target->getNote().getVelocity(),
-            getVelocityRangeView(this->selection, target));
+        this->fineTuningIndicator->setValue(target.getVelocity(),
+            getVelocityRangeView(this->selection, target, activeClip));
 
         // adding it to grandparent to avoid clipping
         jassert(this->getParentComponent() != nullptr);
@@ -976,7 +778,8 @@ void VelocityEditor::startFineTuning(VelocityEditorNoteComponent *target, const
         auto *grandParent = this->getParentComponent()->getParentComponent();
 
         grandParent->addAndMakeVisible(this->fineTuningIndicator.get());
-        this->fineTuningIndicator->repositionAtTargetTop(target);
+        this->fineTuningIndicator->repositionAtTargetTop(this,
+            this->getNoteBounds(target, activeClip).getSmallestIntegerContainer());
         this->fader.fadeIn(this->fineTuningIndicator.get(), Globals::UI::fadeInLong);
 
         this->editingHadChanges = false;
@@ -985,18 +788,17 @@ void VelocityEditor::startFineTuning(VelocityEditorNoteComponent *target, const
     }
 }
 
-void VelocityEditor::continueFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e)
+void VelocityEditor::continueFineTuning(const Note &target, const MouseEvent &e)
 {
     if (this->fineTuningIndicator != nullptr)
     {
-        this->fineTuningDragger.dragComponent(target, e);
+        this->fineTuningDragger.dragComponent(this, e);
 
         const auto newVelocity = this->fineTuningDragger.getValue();
         const auto velocityDelta = this->fineTuningAnchor - newVelocity;
 
         if (velocityDelta == 0.f)
         {
-            this->applyNoteBounds(target);
             return;
         }
 
@@ -1031,35 +833,35 @@ void VelocityEditor::continueFineTuning(VelocityEditorNoteComponent *target, con
         }
         else
         {
-            auto *sequence = static_cast<PianoSequence *>(target->getNote().getSequence());
-            sequence->change(target->getNote(),
-                target->getNote().withVelocity(newVelocity), true);
+            // the note is changed in place, so the target reference stays valid
+            auto *sequence = static_cast<PianoSequence *>(target.getSequence());
+            sequence->change(target, target.withVelocity(newVelocity), true);
         }
 
         jassert(this->fineTuningIndicator != nullptr);
+        jassert(this->activeClip.hasValue());
         this->fineTuningIndicator->setValue(newVelocity,
-            getVelocityRangeView(this->selection, target));
+            getVelocityRangeView(this->selection, target, *this->activeClip));
 
-        this->fineTuningIndicator->repositionAtTargetTop(target);
+        this->fineTuningIndicator->repositionAtTargetTop(this,
+            this->getNoteBounds(target, *this->activeClip).getSmallestIntegerContainer());
     }
 }
 
-void VelocityEditor::endFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e)
+void VelocityEditor::endFineTuning(const Note &target, const MouseEvent &e)
 {
     if (this->fineTuningIndicator != nullptr)
     {
         this->fader.fadeOut(this->fineTuningIndicator.get(), Globals::UI::fadeOutLong);
         this->fineTuningIndicator = nullptr;
 
-        this->fineTuningDragger.endDraggingComponent(target, e);
+        this->fineTuningDragger.endDraggingComponent(this, e);
 
         if (this->selection != nullptr &&
             this->selection->getNumSelected() > 0)
         {
             SequencerOperations::endTuning(*this->selection);
         }
-
-        this->applyNoteBounds(target);
     }
 }
 
@@ -1092,9 +894,10 @@ constexpr float getVelocityByIntersection(const Point<float> &intersection)
 
 void VelocityEditor::applyGroupVolumeChanges()
 {
-    if (!this->activeClip.hasValue())
+    const auto *activeSequence = this->getActiveSequence();
+    if (activeSequence == nullptr)
     {
-        return; // no editable components
+        return; // no editable notes
     }
 
     if (this->editingHadChanges)
@@ -1109,13 +912,6 @@ void VelocityEditor::applyGroupVolumeChanges()
     }
 
     const auto activeClip = *this->activeClip;
-    if (!this->patternMap.contains(activeClip))
-    {
-        jassertfalse;
-        return;
-    }
-
-    const auto *activeMap = this->patternMap.at(activeClip).get();
 
     Point<float> intersectionPoint;
 
@@ -1123,18 +919,27 @@ void VelocityEditor::applyGroupVolumeChanges()
 
     jassert(this->handDrawingHelper != nullptr);
 
-    for (const auto &i : *activeMap)
+    for (const auto *event : *activeSequence)
     {
-        if (!i.second->isEditable)
+        if (!event->isTypeOf(MidiEvent::Type::Note))
         {
             continue;
         }
 
+        const auto &note = *static_cast<const Note *>(event);
+        if (!this->isNoteEditable(note))
+        {
+            continue;
+        }
+
+        const auto beat = note.getBeat() + activeClip.getBeat();
+        const Line<float> noteLine(beat, 0.f, beat, float(Globals::UI::editorPanelHeight));
+
         for (const auto &line : this->handDrawingHelper->getCurve())
         {
-            if (line.intersects(i.second->getBeatIntersectionLine(), intersectionPoint))
+            if (line.intersects(noteLine, intersectionPoint))
             {
-                this->groupDragIntersections[i.first] = getVelocityByIntersection(intersectionPoint);
+                this->groupDragIntersections[note] = getVelocityByIntersection(intersectionPoint);
                 break;
             }
         }
@@ -1170,99 +975,148 @@ void VelocityEditor::applyGroupVolumeChanges()
 }
 
 //===----------------------------------------------------------------------===//
-// Reloading / resizing / repainting
+// Reloading / hit-testing / repainting
 //===----------------------------------------------------------------------===//
 
 void VelocityEditor::reloadAllTracks()
 {
-    this->patternMap.clear();
-
-    VELOCITY_MAP_BATCH_REPAINT_START
+    this->pianoTracks.clearQuick();
+    this->selectedNotes.clear();
+    this->fineTuningIndicator = nullptr;
+    this->fineTuningNote = nullptr;
 
     for (const auto *track : this->project.getTracks())
     {
-        if (dynamic_cast<const PianoSequence *>(track->getSequence()))
+        if (dynamic_cast<const PianoSequence *>(track->getSequence()) &&
+            track->getPattern() != nullptr)
         {
-            this->loadTrack(track);
+            this->pianoTracks.add(track);
         }
     }
 
-    VELOCITY_MAP_BATCH_REPAINT_END
+    this->repaint();
+}
+
+float VelocityEditor::getRollBeatByXPosition(float x) const noexcept
+{
+    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
+    return this->rollFirstBeat + rollLengthInBeats * (x / float(jmax(1, this->getWidth())));
 }
 
-void VelocityEditor::loadTrack(const MidiTrack *const track)
+Rectangle<float> VelocityEditor::getNoteBounds(const Note &note, const Clip &clip) const noexcept
 {
-    if (track->getPattern() == nullptr)
+    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
+
+    const float beat = note.getBeat() + clip.getBeat() - this->rollFirstBeat;
+    const float x = float(this->getWidth()) * (beat / rollLengthInBeats);
+    const float w = float(this->getWidth()) * (note.getLength() / rollLengthInBeats);
+
+    // at least 4 pixels are visible for 0 volume events:
+    const int h = jmax(4, int(this->getHeight() * note.getVelocity() * clip.getVelocity()));
+    return { x, float(this->getHeight() - h), jmax(1.f, w), float(h) };
+}
+
+const PianoSequence *VelocityEditor::getActiveSequence() const noexcept
+{
+    if (!this->activeClip.hasValue())
     {
-        jassertfalse;
-        return;
+        return nullptr;
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    const auto *track = this->activeClip->getPattern()->getTrack();
+    return this->pianoTracks.contains(track) ?
+        static_cast<const PianoSequence *>(track->getSequence()) : nullptr;
+}
+
+bool VelocityEditor::isNoteEditable(const Note &note) const noexcept
+{
+    return this->activeClip.hasValue() &&
+        note.getSequence() == this->activeClip->getPattern()->getTrack()->getSequence() &&
+        (this->selectedNotes.empty() || this->selectedNotes.contains(note.getId()));
+}
+
+const Note *VelocityEditor::findEditableNoteAt(const Point<float> &position) const
+{
+    const auto *activeSequence = this->getActiveSequence();
+    if (activeSequence == nullptr)
     {
-        const auto *clip = track->getPattern()->getUnchecked(i);
-        const bool isEditable = this->activeClip == *clip;
+        return nullptr;
+    }
 
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
+    const auto &activeClip = *this->activeClip;
+    const auto beat = this->getRollBeatByXPosition(position.x) - activeClip.getBeat();
+    const auto beatTolerance = this->getRollBeatByXPosition(1.f) - this->rollFirstBeat;
 
-        for (int j = 0; j < track->getSequence()->size(); ++j)
+    // the notes painted later are on top, so the last hit one wins
+    const Note *result = nullptr;
+    activeSequence->forEachNoteInBeatRange(beat - beatTolerance, beat + beatTolerance,
+        [&](const Note &note)
         {
-            const auto *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Note))
+            if (this->isNoteEditable(note) &&
+                this->getNoteBounds(note, activeClip).contains(position))
             {
-                const auto *note = static_cast<const Note *>(event);
-                auto *noteComponent = new VelocityEditorNoteComponent(*note, *clip);
-                noteComponent->setEditable(isEditable);
-                (*sequenceMap)[*note] = UniquePointer<VelocityEditorNoteComponent>(noteComponent);
-                this->addAndMakeVisible(noteComponent);
-                this->applyNoteBounds(noteComponent);
+                result = &note;
             }
-        }
-    }
+        });
+
+    return result;
 }
 
-void VelocityEditor::applyNoteBounds(VelocityEditorNoteComponent *nc)
+VelocityEditor::Palette VelocityEditor::makePalette(const Colour &trackColour,
+    bool isEditable, bool isHighlighted)
 {
-    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
-    const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
+    const auto baseColour = findDefaultColour(ColourIDs::Roll::noteFill);
+
+    Palette palette;
+    palette.main = trackColour
+        .interpolatedWith(baseColour, (isEditable || isHighlighted) ? 0.35f : 0.5f)
+        .withAlpha(isEditable ? 0.8f : (isHighlighted ? 0.125f : 0.06f));
+    palette.pale = palette.main
+        .brighter(isHighlighted ? 0.3f : 0.1f)
+        .withMultipliedAlpha(isHighlighted ? 0.3f : 0.1f);
+    return palette;
+}
 
-    const float beat = nc->getFullBeat() - this->rollFirstBeat;
-    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
+void VelocityEditor::paintNote(Graphics &g,
+    const Rectangle<float> &bounds, const Palette &palette)
+{
+    g.setColour(palette.main);
+    g.fillRect(bounds.getX(), bounds.getY() + 1.f, 1.f, bounds.getHeight() - 1.f);
 
-    const float x = mapWidth * (beat / projectLengthInBeats);
-    const float w = mapWidth * (nc->getLength() / projectLengthInBeats);
+    if (bounds.getWidth() > 2.f)
+    {
+        g.fillRect(bounds.getX() + 1.f, bounds.getY(), bounds.getWidth() - 2.f, 1.f);
+        g.fillRect(bounds.getX(), bounds.getY() + 1.f, bounds.getWidth(), 2.f);
+    }
 
-    // at least 4 pixels are visible for 0 volume events:
-    const int h = jmax(4, int(this->getHeight() * nc->getFullVelocity()));
-    nc->setRealBounds(x, this->getHeight() - h, jmax(1.f, w), h);
+    g.setColour(palette.pale);
+    g.fillRect(bounds);
 }
 
-void VelocityEditor::triggerBatchRepaintFor(VelocityEditorNoteComponent *target)
+void VelocityEditor::repaintNote(const Note &note)
 {
-    this->batchRepaintList.add(target);
+    const auto *pattern = note.getSequence()->getTrack()->getPattern();
+    if (pattern == nullptr || this->rollLastBeat <= this->rollFirstBeat)
+    {
+        return;
+    }
+
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        const auto bounds = this->getNoteBounds(note, *pattern->getUnchecked(i));
+        const auto column = Rectangle<float>(bounds.getX(), 0.f,
+            bounds.getWidth(), float(this->getHeight())).getSmallestIntegerContainer();
+        this->dirtyArea = this->dirtyArea.getUnion(column.expanded(1, 0));
+    }
+
     this->triggerAsyncUpdate();
 }
 
 void VelocityEditor::handleAsyncUpdate()
 {
-    // batch repaint & resize stuff
-    if (this->batchRepaintList.size() > 0)
+    if (!this->dirtyArea.isEmpty())
     {
-        VELOCITY_MAP_BATCH_REPAINT_START
-
-        for (int i = 0; i < this->batchRepaintList.size(); ++i)
-        {
-            // There are still many cases when a component
-            // scheduled for repainting/repositioning is deleted at this time:
-            if (Component *component = this->batchRepaintList.getUnchecked(i))
-            {
-                this->applyNoteBounds(static_cast<VelocityEditorNoteComponent *>(component));
-            }
-        }
-
-        VELOCITY_MAP_BATCH_REPAINT_END
-
-        this->batchRepaintList.clearQuick();
+        this->repaint(this->dirtyArea);
+        this->dirtyArea = {};
     }
 }
@@ -29,7 +29,7 @@
 
 class RollBase;
 class ProjectNode;
-class VelocityEditorNoteComponent;
+class PianoSequence;
 class VelocityHandDrawingHelper;
 class FineTuningValueIndicator;
 class MultiTouchController;
@@ -39,7 +39,7 @@ class VelocityEditor final :
     public MultiTouchListener,
     public RollEditMode::Listener,
     public ProjectListener,
-    public AsyncUpdater // triggers batch repaints for children
+    public AsyncUpdater // triggers batch repaints for changed notes
 {
 public:
 
@@ -106,6 +106,8 @@ public:
     //===------------------------------------------------------------------===//
 
     void resized() override;
+    void paint(Graphics &g) override;
+    void mouseMove(const MouseEvent &e) override;
     void mouseDown(const MouseEvent &e) override;
     void mouseDrag(const MouseEvent &e) override;
     void mouseUp(const MouseEvent &e) override;
@@ -113,9 +115,10 @@ public:
 
 private:
 
-    void applyNoteBounds(VelocityEditorNoteComponent *nc);
     void reloadAllTracks();
-    void loadTrack(const MidiTrack *const track);
+
+    float getRollBeatByXPosition(float x) const noexcept;
+    Rectangle<float> getNoteBounds(const Note &note, const Clip &clip) const noexcept;
 
     float projectFirstBeat = 0.f;
     float projectLastBeat = Globals::Defaults::projectLength;
@@ -129,23 +132,39 @@ private:
 
     Optional<Clip> activeClip;
 
-    using SequenceMap = FlatHashMap<Note, UniquePointer<VelocityEditorNoteComponent>, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
+    // all notes are painted straight from the sequences instead of having
+    // a component per note per clip; only the active clip's notes are editable,
+    // and if it has selected notes, only those of them are:
+    Array<const MidiTrack *> pianoTracks;
+    FlatHashSet<MidiEvent::Id> selectedNotes;
+
+    const PianoSequence *getActiveSequence() const noexcept;
+    bool isNoteEditable(const Note &note) const noexcept;
+    const Note *findEditableNoteAt(const Point<float> &position) const;
+
+    struct Palette final
+    {
+        Colour main;
+        Colour pale;
+    };
+
+    static Palette makePalette(const Colour &trackColour,
+        bool isEditable, bool isHighlighted);
+    static void paintNote(Graphics &g,
+        const Rectangle<float> &bounds, const Palette &palette);
 
 private:
 
     // for fine-tuning a single note or entire selection, if any:
 
     float fineTuningAnchor = 0.f;
+    const Note *fineTuningNote = nullptr;
     FineTuningComponentDragger fineTuningDragger;
     UniquePointer<FineTuningValueIndicator> fineTuningIndicator;
 
-    void startFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e);
-    void continueFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e);
-    void endFineTuning(VelocityEditorNoteComponent *target, const MouseEvent &e);
-
-    friend class VelocityEditorNoteComponent;
+    void startFineTuning(const Note &target, const MouseEvent &e);
+    void continueFineTuning(const Note &target, const MouseEvent &e);
+    void endFineTuning(const Note &target, const MouseEvent &e);
 
     // for adjusting a group of notes with hand-drawn curve:
 
@@ -180,9 +199,10 @@ private:
 
     void applyGroupVolumeChanges();
 
-    void triggerBatchRepaintFor(VelocityEditorNoteComponent *target);
+    // collects the areas of the changed notes in all clips of their track
+    void repaintNote(const Note &note);
     void handleAsyncUpdate() override;
-    Array<WeakReference<Component>> batchRepaintList;
+    Rectangle<int> dirtyArea;
 
     JUCE_LEAK_DETECTOR(VelocityEditor)
 };
@@ -70,13 +70,13 @@ void HeaderSelectionIndicator::updateBounds()
     this->setBounds(startX, this->getY(), jmax(1, endX - startX), this->getHeight());
 }
 
-void HeaderSelectionIndicator::timerCallback()
+void HeaderSelectionIndicator::onAnimationFrame()
 {
     const auto newFill = this->currentFill.interpolatedWith(this->targetFill, 0.4f);
 
     if (this->currentFill == newFill)
     {
-        this->stopTimer();
+        this->stopAnimating();
 
         if (newFill.getAlpha() == 0)
         {
@@ -95,11 +95,11 @@ void HeaderSelectionIndicator::fadeIn()
 {
     this->targetFill = this->fill;
     this->setVisible(true);
-    this->startTimerHz(60);
+    this->startAnimating();
 }
 
 void HeaderSelectionIndicator::fadeOut()
 {
     this->targetFill = Colours::transparentBlack;
-    this->startTimerHz(60);
+    this->startAnimating();
 }
@@ -17,7 +17,9 @@
 
 #pragma once
 
-class HeaderSelectionIndicator final : public Component, private Timer
+#include "FrameClock.h"
+
+class HeaderSelectionIndicator final : public Component, private FrameClock::Client
 {
 public:
 
@@ -35,7 +37,7 @@ public:
 
 private:
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
 
     double startAbsPosition = 0.0;
     double endAbsPosition = 0.0;
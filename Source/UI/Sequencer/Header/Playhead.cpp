@@ -61,7 +61,7 @@ void Playhead::onSeek(float beatPosition)
 
     this->lastCorrectBeat = beatPosition;
 
-    if (this->isTimerRunning())
+    if (this->isAnimating())
     {
         this->timeAnchor = Time::getMillisecondCounter();
         this->beatAnchor = this->lastCorrectBeat;
@@ -80,7 +80,7 @@ void Playhead::onCurrentTempoChanged(double msPerQuarter)
     jassert(msPerQuarter >= 0.01);
     this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
 
-    if (this->isTimerRunning())
+    if (this->isAnimating())
     {
         // expects that lastCorrectBeat has been set
         // just before calling this function:
@@ -98,7 +98,7 @@ void Playhead::onPlay()
 {
     this->timeAnchor = Time::getMillisecondCounter();
     this->beatAnchor = this->lastCorrectBeat;
-    this->startTimerHz(60);
+    this->startAnimating();
 }
 
 void Playhead::onRecord()
@@ -112,7 +112,7 @@ void Playhead::onStop()
     this->currentColour = this->playbackColour;
     this->repaint();
 
-    this->stopTimer();
+    this->stopAnimating();
 
     this->timeAnchor = 0.0;
     this->beatAnchor = 0.0;
@@ -125,17 +125,17 @@ void Playhead::onStop()
 
 void Playhead::handleAsyncUpdate()
 {
-    if (!this->isTimerRunning())
+    if (!this->isAnimating())
     {
         this->updatePosition();
     }
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// FrameClock::Client
 //===----------------------------------------------------------------------===//
 
-void Playhead::timerCallback()
+void Playhead::onAnimationFrame()
 {
     {
         const SpinLock::ScopedLockType lock(this->playbackUpdatesLock);
@@ -199,7 +199,7 @@ void Playhead::updatePosition(float position)
 
 void Playhead::updatePosition()
 {
-    if (this->isTimerRunning())
+    if (this->isAnimating())
     {
         this->updatePosition(this->lastEstimatedBeat);
     }
@@ -21,11 +21,12 @@ class Transport;
 class RollBase;
 
 #include "TransportListener.h"
+#include "FrameClock.h"
 
 class Playhead final :
     public Component,
     public TransportListener,
-    public Timer,
+    public FrameClock::Client,
     private AsyncUpdater
 {
 public:
@@ -61,10 +62,10 @@ public:
     void onStop() override;
 
     //===------------------------------------------------------------------===//
-    // Timer
+    // FrameClock::Client
     //===------------------------------------------------------------------===//
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
 
     //===------------------------------------------------------------------===//
     // Component
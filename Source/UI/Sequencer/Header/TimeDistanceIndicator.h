@@ -19,8 +19,9 @@
 
 #include "ColourIDs.h"
 #include "HelioTheme.h"
+#include "FrameClock.h"
 
-class TimeDistanceIndicator final : public Component, private Timer
+class TimeDistanceIndicator final : public Component, private FrameClock::Client
 {
 public:
 
@@ -38,7 +39,7 @@ public:
         this->setSize(32, 32);
 
         this->setAlpha(0.f);
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 
     ~TimeDistanceIndicator() override
@@ -82,13 +83,13 @@ public:
 
 private:
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         this->setAlpha(this->getAlpha() + 0.1f);
 
         if (this->getAlpha() >= 1.f)
         {
-            this->stopTimer();
+            this->stopAnimating();
         }
     }
 
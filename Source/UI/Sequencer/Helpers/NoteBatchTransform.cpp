@@ -0,0 +1,148 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "NoteBatchTransform.h"
+#include "PianoSequence.h"
+
+void NoteBatchTransform::add(PianoSequence *sequence, Transform transform)
+{
+    jassert(sequence != nullptr);
+    this->tasks.add({ sequence, move(transform), {} });
+}
+
+bool NoteBatchTransform::apply(bool undoable, bool shouldCheckpoint)
+{
+    jassert(undoable || !shouldCheckpoint);
+
+    int totalNumNotes = 0;
+    for (auto &task : this->tasks)
+    {
+        const auto numNotes = task.sequence->size();
+        task.notes.ensureStorageAllocated(numNotes);
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const auto &note = task.sequence->getNoteUnchecked(i);
+            task.notes.add({ note.getBeat(), note.getKey(), note.getLength(), note.getVelocity() });
+        }
+
+        totalNumNotes += numNotes;
+    }
+
+    this->transformAll(totalNumNotes);
+
+    bool hasMadeChanges = false;
+    bool didCheckpoint = !shouldCheckpoint;
+
+    Array<Note> groupBefore, groupAfter;
+
+    for (auto &task : this->tasks)
+    {
+        jassert(task.notes.size() == task.sequence->size());
+
+        groupBefore.clearQuick();
+        groupAfter.clearQuick();
+
+        for (int i = 0; i < task.notes.size(); ++i)
+        {
+            const auto &note = task.sequence->getNoteUnchecked(i);
+            const auto &data = task.notes.getReference(i);
+
+            const auto keyChanged = data.key != note.getKey();
+            const auto beatChanged = data.beat != note.getBeat();
+            const auto lengthChanged = data.length != note.getLength();
+            const auto velocityChanged = data.velocity != note.getVelocity();
+
+            if (!keyChanged && !beatChanged && !lengthChanged && !velocityChanged)
+            {
+                continue;
+            }
+
+            auto newNote = beatChanged ? note.withKeyBeat(data.key, data.beat) :
+                (keyChanged ? note.withKey(data.key) : note);
+            newNote = lengthChanged ? newNote.withLength(data.length) : newNote;
+            newNote = velocityChanged ? newNote.withVelocity(data.velocity) : newNote;
+
+            groupBefore.add(note);
+            groupAfter.add(newNote);
+        }
+
+        if (groupBefore.isEmpty())
+        {
+            continue;
+        }
+
+        if (!didCheckpoint)
+        {
+            task.sequence->checkpoint();
+            didCheckpoint = true;
+        }
+
+        hasMadeChanges = true;
+        task.sequence->changeGroup(groupBefore, groupAfter, undoable);
+    }
+
+    this->tasks.clear();
+    return hasMadeChanges;
+}
+
+void NoteBatchTransform::transformAll(int totalNumNotes)
+{
+    const auto numTasks = this->tasks.size();
+    const auto numWorkers = jmin(numTasks, SystemStats::getNumCpus()) - 1;
+
+    if (numWorkers <= 0 || totalNumNotes < minNumNotesToRunInParallel)
+    {
+        for (auto &task : this->tasks)
+        {
+            task.transform(task.notes);
+        }
+
+        return;
+    }
+
+    // the workers and the calling thread are taking the tasks one by one,
+    // so the results don't depend on which thread has done what
+    Atomic<int> nextTaskIndex(0);
+    const auto processTasks = [this, &nextTaskIndex, numTasks]()
+    {
+        for (;;)
+        {
+            const auto i = (++nextTaskIndex) - 1;
+            if (i >= numTasks)
+            {
+                return;
+            }
+
+            auto &task = this->tasks.getReference(i);
+            task.transform(task.notes);
+        }
+    };
+
+    ThreadPool pool(numWorkers);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        pool.addJob(processTasks);
+    }
+
+    processTasks();
+
+    // the jobs that haven't started yet have nothing to do,
+    // and the running ones need to be waited for
+    pool.removeAllJobs(false, -1);
+}
@@ -0,0 +1,76 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class PianoSequence;
+
+#include "Note.h"
+
+// Transforms the notes of several sequences at once, which is what
+// the project-wide operations, like rescaling or remapping notes
+// to another temperament, do: the notes are copied into flat buffers,
+// which are transformed in parallel, one job per sequence, since
+// the sequences are independent; then all changes are committed
+// on the message thread with a single changeGroup per sequence.
+
+class NoteBatchTransform final
+{
+public:
+
+    NoteBatchTransform() = default;
+
+    struct NoteData final
+    {
+        float beat;
+        Note::Key key;
+        float length;
+        float velocity;
+    };
+
+    using Notes = Array<NoteData>;
+
+    // the transforms are called from the worker threads, so they
+    // should only read their own data and the immutable shared data;
+    // since apply() is synchronous, they can capture locals by reference;
+    // the transforms are not supposed to add or remove notes
+    using Transform = std::function<void(Notes &notes)>;
+
+    void add(PianoSequence *sequence, Transform transform);
+
+    // returns true if any changes were made, which also means
+    // that the checkpoint was made, if shouldCheckpoint is true
+    bool apply(bool undoable, bool shouldCheckpoint);
+
+private:
+
+    void transformAll(int totalNumNotes);
+
+    struct Task final
+    {
+        PianoSequence *sequence;
+        Transform transform;
+        Notes notes;
+    };
+
+    Array<Task> tasks;
+
+    // the batches smaller than that are not worth spawning threads
+    static constexpr auto minNumNotesToRunInParallel = 4096;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoteBatchTransform)
+};
@@ -30,7 +30,7 @@ RollExpandMark::RollExpandMark(RollBase &parentRoll, float targetBeat, float num
 
     this->setInterceptsMouseClicks(false, false);
     this->setPaintingIsUnclipped(true);
-    this->startTimerHz(60);
+    this->startAnimating();
 }
 
 RollExpandMark::~RollExpandMark() = default;
@@ -66,7 +66,7 @@ void RollExpandMark::updatePosition()
     this->setBounds(xOffset, 0, newWidth, this->getParentHeight());
 }
 
-void RollExpandMark::timerCallback()
+void RollExpandMark::onAnimationFrame()
 {
     this->alpha *= 0.945f;
 
@@ -20,8 +20,9 @@
 class RollBase;
 
 #include "IconComponent.h"
+#include "FrameClock.h"
 
-class RollExpandMark final : public Component, private Timer
+class RollExpandMark final : public Component, private FrameClock::Client
 {
 public:
 
@@ -36,7 +37,7 @@ public:
 
 private:
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
     void updatePosition();
 
     const RollBase &roll;
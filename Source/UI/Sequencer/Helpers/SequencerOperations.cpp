@@ -38,6 +38,7 @@
 #include "TimeSignaturesAggregator.h"
 
 #include "Pattern.h"
+#include "NoteBatchTransform.h"
 
 #include "UndoStack.h"
 #include "AutomationTrackActions.h"
@@ -1732,22 +1733,71 @@ bool SequencerOperations::quantize(const NoteListBase &notes, float bar,
     return true;
 }
 
-static inline void doRescaleLogic(Array<Note> &groupBefore, Array<Note> &groupAfter,
-    const Note &note, Note::Key keyOffset, Scale::Ptr scaleA, Scale::Ptr scaleB)
+static inline bool doRescaleKey(Note::Key key, Note::Key keyOffset,
+    const Scale::Ptr scaleA, const Scale::Ptr scaleB, Note::Key &outNewKey)
 {
-    const auto noteKey = note.getKey() - keyOffset;
+    const auto noteKey = key - keyOffset;
     const auto periodNumber = noteKey / scaleA->getBasePeriod();
     const auto inScaleKey = scaleA->getScaleKey(noteKey);
-    if (inScaleKey >= 0)
+    if (inScaleKey < 0)
     {
-        const auto newChromaticKey = scaleB->getBasePeriod() * periodNumber +
-            scaleB->getChromaticKey(inScaleKey, 0, false) + keyOffset;
+        return false;
+    }
+
+    outNewKey = scaleB->getBasePeriod() * periodNumber +
+        scaleB->getChromaticKey(inScaleKey, 0, false) + keyOffset;
+
+    return true;
+}
 
+static inline void doRescaleLogic(Array<Note> &groupBefore, Array<Note> &groupAfter,
+    const Note &note, Note::Key keyOffset, Scale::Ptr scaleA, Scale::Ptr scaleB)
+{
+    Note::Key newChromaticKey;
+    if (doRescaleKey(note.getKey(), keyOffset, scaleA, scaleB, newChromaticKey))
+    {
         groupBefore.add(note);
         groupAfter.add(note.withKey(newChromaticKey));
     }
 }
 
+// rescales the notes of one track between startBeat and endBeat,
+// only considering the notes of one clip: the first one having any
+// notes in that range, and skipping all other clips of the same track
+static void doRescaleBatch(NoteBatchTransform::Notes &notes, const Array<Clip> &clips,
+    float startBeat, float endBeat, Note::Key rootKey, const Scale::Ptr scaleA, const Scale::Ptr scaleB)
+{
+    const Clip *targetClip = nullptr;
+
+    for (auto &note : notes)
+    {
+        if (targetClip == nullptr)
+        {
+            for (const auto &clip : clips)
+            {
+                if ((note.beat + clip.getBeat()) >= startBeat &&
+                    (note.beat + clip.getBeat()) < endBeat)
+                {
+                    targetClip = &clip;
+                    break;
+                }
+            }
+
+            if (targetClip == nullptr)
+            {
+                continue;
+            }
+        }
+
+        if ((note.beat + targetClip->getBeat()) >= startBeat &&
+            (note.beat + targetClip->getBeat()) < endBeat)
+        {
+            const auto keyOffset = rootKey - targetClip->getKey();
+            doRescaleKey(note.key, keyOffset, scaleA, scaleB, note.key);
+        }
+    }
+}
+
 void SequencerOperations::rescale(const NoteListBase &notes, const Clip &clip,
     WeakReference<KeySignaturesSequence> harmonicContext, Scale::Ptr targetScale,
     bool undoable, bool shouldCheckpoint)
@@ -1798,8 +1848,7 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
 {
     jassert(undoable || !shouldCheckpoint);
 
-    bool hasMadeChanges = false;
-    bool didCheckpoint = !shouldCheckpoint;
+    NoteBatchTransform batch;
 
     const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
     for (const auto *track : pianoTracks)
@@ -1807,47 +1856,100 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
         auto *sequence = dynamic_cast<PianoSequence *>(track->getSequence());
         jassert(sequence != nullptr);
 
-        Array<Note> groupBefore, groupAfter;
-
-        // find events in between (only consider events of one clip!),
-        // skipping clips of the same track if already processed any other:
-
-        FlatHashSet<MidiEvent::Id> usedClips;
-
-        for (int i = 0; i < sequence->size(); ++i)
+        if (sequence->size() == 0)
         {
-            const auto *note = static_cast<Note *>(sequence->getUnchecked(i));
-            for (const auto *clip : track->getPattern()->getClips())
-            {
-                if (usedClips.contains(clip->getId()) || usedClips.size() == 0)
-                {
-                    if ((note->getBeat() + clip->getBeat()) >= startBeat &&
-                        (note->getBeat() + clip->getBeat()) < endBeat)
-                    {
-                        const auto keyOffset = rootKey - clip->getKey();
-                        doRescaleLogic(groupBefore, groupAfter, *note, keyOffset, scaleA, scaleB);
-                        usedClips.insert(clip->getId());
-                    }
-                }
-            }
+            continue;
         }
 
-        if (groupBefore.size() == 0)
+        Array<Clip> clips;
+        for (const auto *clip : track->getPattern()->getClips())
         {
-            continue;
+            clips.add(*clip);
         }
 
-        if (!didCheckpoint)
+        batch.add(sequence, [clips, startBeat, endBeat, rootKey, scaleA, scaleB]
+            (NoteBatchTransform::Notes &notes)
         {
-            sequence->checkpoint();
-            didCheckpoint = true;
+            doRescaleBatch(notes, clips, startBeat, endBeat, rootKey, scaleA, scaleB);
+        });
+    }
+
+    return batch.apply(undoable, shouldCheckpoint);
+}
+
+// the data needed to remap the notes of all tracks,
+// shared by the worker threads and never changed by them
+struct TemperamentRemapping final
+{
+    Scale::Ptr chromaticMapFrom;
+    Scale::Ptr chromaticMapTo;
+    int periodSizeBefore = Globals::twelveTonePeriodSize;
+    int periodSizeAfter = Globals::twelveTonePeriodSize;
+    bool shouldUseChromaticMaps = true;
+
+    // the sorted key signatures' beats and root keys
+    Array<float> keySignatureBeats;
+    Array<Note::Key> keySignatureRootKeys;
+
+    // finds the key signature at certain beat, which works similarly
+    // to findHarmonicContext, but simpler: it's the last one starting
+    // before that beat, or the first one, if there's no such signature
+    Note::Key findRootKey(float beat) const noexcept
+    {
+        if (this->keySignatureBeats.isEmpty())
+        {
+            return 0;
         }
 
-        hasMadeChanges = true;
-        sequence->changeGroup(groupBefore, groupAfter, undoable);
+        const auto found = std::upper_bound(this->keySignatureBeats.begin(),
+            this->keySignatureBeats.end(), beat);
+
+        const auto index = jmax(0, int(found - this->keySignatureBeats.begin()) - 1);
+        return this->keySignatureRootKeys.getUnchecked(index);
     }
+};
 
-    return hasMadeChanges;
+static Note::Key doRemapKeyToTemperament(const TemperamentRemapping &remapping,
+    Note::Key noteKey, Note::Key rootKeyBefore)
+{
+    const auto key = noteKey - rootKeyBefore;
+    const auto periodNum = key / remapping.periodSizeBefore;
+    const auto relativeKey = key % remapping.periodSizeBefore;
+
+    // key signatures are converted in a different method
+    // (tech debt warning: these two lines should be the same in both methods)
+    const auto rootIndexInChromaticMap = remapping.chromaticMapFrom->getNearestScaleKey(rootKeyBefore);
+    const auto rootKeyAfter = remapping.chromaticMapTo->getChromaticKey(rootIndexInChromaticMap, 0, true);
+
+    // convert notes either by using the temperaments' chromatic maps,
+    // or by assuming equal temperaments and using proportions (more accurate):
+    int newKey = 0;
+    if (remapping.shouldUseChromaticMaps)
+    {
+        // round the relative key to the nearest one in chromaticMapFrom 
+        const auto keyIndexInChromaticMap = remapping.chromaticMapFrom->getNearestScaleKey(relativeKey);
+        const auto newRelativeKey = remapping.chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, rootKeyAfter, false);
+        newKey = periodNum * remapping.periodSizeAfter + newRelativeKey;
+    }
+    else
+    {
+        const auto relativeKeyAsFraction = double(relativeKey) / double(remapping.periodSizeBefore);
+        const auto newRelativeKey = int(round(remapping.periodSizeAfter * relativeKeyAsFraction));
+        newKey = periodNum * remapping.periodSizeAfter + newRelativeKey + rootKeyAfter;
+    }
+
+    jassert(newKey != 0);
+    return newKey;
+}
+
+static void doRemapNotesToTemperament(NoteBatchTransform::Notes &notes,
+    const TemperamentRemapping &remapping, float firstClipBeat)
+{
+    for (auto &note : notes)
+    {
+        const auto rootKeyBefore = remapping.findRootKey(note.beat + firstClipBeat);
+        note.key = jmax(0, doRemapKeyToTemperament(remapping, note.key, rootKeyBefore));
+    }
 }
 
 bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
@@ -1870,87 +1972,43 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
     const auto periodSizeBefore = currentTemperament->getPeriodSize();
     const auto periodSizeAfter = temperament->getPeriodSize();
 
-    // a helper to find a key signature at certain beat
-    // works similarly to findHarmonicContext, but simpler:
-    auto *keySignatures = project.getTimeline()->getKeySignatures()->getSequence();
-    const auto findRootKey = [keySignatures](float beat)
+    TemperamentRemapping remapping;
+    remapping.chromaticMapFrom = chromaticMapFrom;
+    remapping.chromaticMapTo = chromaticMapTo;
+    remapping.periodSizeBefore = periodSizeBefore;
+    remapping.periodSizeAfter = periodSizeAfter;
+    remapping.shouldUseChromaticMaps = shouldUseChromaticMaps;
+
+    const auto *keySignatures = project.getTimeline()->getKeySignatures()->getSequence();
+    for (const auto *event : *keySignatures)
     {
-        if (keySignatures->size() == 0)
-        {
-            return 0;
-        }
+        remapping.keySignatureBeats.add(event->getBeat());
+        remapping.keySignatureRootKeys.add(static_cast<const KeySignatureEvent *>(event)->getRootKey());
+    }
 
-        const KeySignatureEvent *context = nullptr;
+    // the notes of all tracks are converted in parallel, and then
+    // the clips are adjusted sequentially, since there are much fewer of them
+    NoteBatchTransform batch;
 
-        for (int i = 0; i < keySignatures->size(); ++i)
-        {
-            auto *ks = keySignatures->getUnchecked(i);
-            if (context == nullptr || ks->getBeat() <= beat)
-            {
-                // take the first one no matter where it resides;
-                // if event is still before the sequence beat, update the context anyway:
-                context = static_cast<KeySignatureEvent *>(ks);
-            }
-            else if (ks->getBeat() >= beat)
-            {
-                // no need to look further
-                break;
-            }
-        }
-
-        if (context != nullptr)
+    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
+    for (const auto *track : pianoTracks)
+    {
+        // simply using the first clip's position to determine harmonic context,
+        // (there could be several clips, in which case I have no idea what to do)
+        const auto firstClipBeat = track->getPattern()->getFirstBeat();
+        batch.add(static_cast<PianoSequence *>(track->getSequence()),
+            [&remapping, firstClipBeat](NoteBatchTransform::Notes &notes)
         {
-            // we've found the only context that doesn't change within a sequence:
-            return context->getRootKey();
-        }
+            doRemapNotesToTemperament(notes, remapping, firstClipBeat);
+        });
+    }
 
-        return 0;
-    };
+    hasMadeChanges = batch.apply(true, shouldCheckpoint);
+    didCheckpoint = didCheckpoint || hasMadeChanges;
 
-    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
     for (const auto *track : pianoTracks)
     {
         auto *pattern = track->getPattern();
-        auto *sequence = static_cast<PianoSequence *>(track->getSequence());
-
-        Array<Note> notesBefore, notesAfter;
-        for (int n = 0; n < sequence->size(); ++n)
-        {
-            const auto *note = static_cast<Note *>(sequence->getUnchecked(n));
-            
-            // simply using the first clip's position to determine harmonic context,
-            // (there could be several clips, in which case I have no idea what to do)
-            const auto rootKeyBefore = findRootKey(note->getBeat() + pattern->getFirstBeat());
-            const auto key = note->getKey() - rootKeyBefore;
-            const auto periodNum = key / periodSizeBefore;
-            const auto relativeKey = key % periodSizeBefore;
-
-            // key signatures are converted in a different method
-            // (tech debt warning: these two lines should be the same in both methods)
-            const auto rootIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(rootKeyBefore);
-            const auto rootKeyAfter = chromaticMapTo->getChromaticKey(rootIndexInChromaticMap, 0, true);
-
-            // convert notes either by using the temperaments' chromatic maps,
-            // or by assuming equal temperaments and using proportions (more accurate):
-            int newKey = 0;
-            if (shouldUseChromaticMaps)
-            {
-                // round the relative key to the nearest one in chromaticMapFrom 
-                const auto keyIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(relativeKey);
-                const auto newRelativeKey = chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, rootKeyAfter, false);
-                newKey = periodNum * periodSizeAfter + newRelativeKey;
-            }
-            else
-            {
-                const auto relativeKeyAsFraction = double(relativeKey) / double(periodSizeBefore);
-                const auto newRelativeKey = int(round(periodSizeAfter * relativeKeyAsFraction));
-                newKey = periodNum * periodSizeAfter + newRelativeKey + rootKeyAfter;
-            }
-
-            jassert(newKey != 0);
-            notesBefore.add(*note);
-            notesAfter.add(note->withKey(newKey));
-        }
 
         // adjust clip key offsets in a similar way
         Array<Clip> clipsBefore, clipsAfter;
@@ -1984,28 +2042,19 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
             }
         }
 
-        if (notesBefore.isEmpty() && clipsBefore.isEmpty())
+        if (clipsBefore.isEmpty())
         {
             continue;
         }
 
         if (!didCheckpoint)
         {
-            sequence->checkpoint();
+            pattern->checkpoint();
             didCheckpoint = true;
         }
 
         hasMadeChanges = true;
-
-        if (!notesBefore.isEmpty())
-        {
-            sequence->changeGroup(notesBefore, notesAfter, true);
-        }
-
-        if (!clipsBefore.isEmpty())
-        {
-            pattern->changeGroup(clipsBefore, clipsAfter, true);
-        }
+        pattern->changeGroup(clipsBefore, clipsAfter, true);
     }
 
     return hasMadeChanges;
@@ -2095,39 +2144,21 @@ bool SequencerOperations::findHarmonicContext(float startBeat, float endBeat,
         return false;
     }
 
-    const KeySignatureEvent *context = nullptr;
-
-    for (int i = 0; i < keySignatures->size(); ++i)
+    if (keySignatures->hasChangesWithin(startBeat, endBeat))
     {
-        const auto event = keySignatures->getUnchecked(i);
-        if (context == nullptr || event->getBeat() <= startBeat)
-        {
-            // Take the first one no matter where it resides;
-            // If event is still before the sequence start, update the context anyway:
-            context = static_cast<KeySignatureEvent *>(event);
-        }
-        else if (event->getBeat() > startBeat && event->getBeat() < endBeat)
-        {
-            // Harmonic context is already here and changes within a sequence:
-            return false;
-        }
-        else if (event->getBeat() >= endBeat)
-        {
-            // No need to look further
-            break;
-        }
+        // Harmonic context is already here and changes within a sequence:
+        return false;
     }
 
-    if (context != nullptr)
-    {
-        // We've found the only context that doesn't change within a sequence:
-        outScale = context->getScale();
-        outRootKey = context->getRootKey();
-        outKeyName = context->getRootKeyName();
-        return true;
-    }
+    // We've found the only context that doesn't change within a sequence
+    // (if all signatures start after startBeat, the first one is taken):
+    const auto *context = keySignatures->findContextAt(startBeat);
+    jassert(context != nullptr);
 
-    return false;
+    outScale = context->getScale();
+    outRootKey = context->getRootKey();
+    outKeyName = context->getRootKeyName();
+    return true;
 }
 
 bool SequencerOperations::findHarmonicContext(float startBeat, float endBeat,
@@ -2212,20 +2243,25 @@ String SequencerOperations::findClosestOverlappingAnnotation(const Lasso &select
     const float selectionStart = SequencerOperations::findStartBeat(selection) + sourceClip.getBeat();
     const float selectionEnd = SequencerOperations::findEndBeat(selection) + sourceClip.getBeat();
 
+    const auto *annotations = dynamic_cast<AnnotationsSequence *>(annotationsTrack->getSequence());
+    if (annotations == nullptr)
+    {
+        jassertfalse;
+        return {};
+    }
+
+    Array<const AnnotationEvent *> overlappingAnnotations;
+    annotations->findOverlapping(selectionStart, selectionEnd, overlappingAnnotations);
+
     String result;
     float minDistance = FLT_MAX;
-    for (int i = 0; i < annotationsTrack->getSequence()->size(); ++i)
+    for (const auto *annotation : overlappingAnnotations)
     {
-        const auto *event = annotationsTrack->getSequence()->getUnchecked(i);
-        jassert(dynamic_cast<const AnnotationEvent *>(event));
-        const auto *annotation = static_cast<const AnnotationEvent *>(event);
-
         const auto annotationStart = annotation->getBeat();
         const auto annotationEnd = annotation->getBeat() + annotation->getLength();
         const float distance = fabs(annotationStart - selectionStart + annotationEnd - selectionEnd);
-        const bool isOverlapping = selectionStart <= annotationEnd && annotationStart <= selectionEnd;
 
-        if (minDistance > distance && isOverlapping)
+        if (minDistance > distance)
         {
             minDistance = distance;
             result = annotation->getDescription();
@@ -2870,6 +2906,137 @@ public:
 
         expectEquals({ "Duplicate 2" },
             SequencerOperations::generateNextNameForNewTrack("Duplicate", { "Duplicate", "Duplicate", "Track A", "Recording" }));
+
+        Random random(13);
+
+        beginTest("Batch rescaling matches the per-note implementation");
+        {
+            const auto scaleA = Scale::makeNaturalMajorScale();
+            const auto scaleB = Scale::makeNaturalMinorScale();
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const auto notes = makeRandomNotes(random, 500);
+
+                Array<Clip> clips;
+                const auto numClips = 1 + random.nextInt(4);
+                for (int j = 0; j < numClips; ++j)
+                {
+                    clips.add(Clip(nullptr, float(random.nextInt(64)), random.nextInt(25) - 12));
+                }
+
+                const auto startBeat = float(random.nextInt(64));
+                const auto endBeat = startBeat + float(random.nextInt(64));
+                const auto rootKey = random.nextInt(12);
+
+                auto expected = notes;
+                FlatHashSet<const Clip *> usedClips;
+                for (auto &note : expected)
+                {
+                    for (const auto &clip : clips)
+                    {
+                        if ((usedClips.contains(&clip) || usedClips.size() == 0) &&
+                            (note.beat + clip.getBeat()) >= startBeat &&
+                            (note.beat + clip.getBeat()) < endBeat)
+                        {
+                            doRescaleKey(note.key, rootKey - clip.getKey(), scaleA, scaleB, note.key);
+                            usedClips.insert(&clip);
+                        }
+                    }
+                }
+
+                auto actual = notes;
+                doRescaleBatch(actual, clips, startBeat, endBeat, rootKey, scaleA, scaleB);
+
+                expectNotesEqual(actual, expected);
+            }
+        }
+
+        beginTest("Batch temperament remapping matches the per-note implementation");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                TemperamentRemapping remapping;
+                remapping.chromaticMapFrom = Scale::makeChromaticScale();
+                remapping.chromaticMapTo = (i % 2) ? Scale::makeNaturalMajorScale() : Scale::makeChromaticScale();
+                remapping.periodSizeAfter = (i % 3) ? Globals::twelveTonePeriodSize : 19;
+                remapping.shouldUseChromaticMaps = (i % 4) != 0;
+
+                float beat = float(random.nextInt(16)) - 8.f;
+                const auto numKeySignatures = random.nextInt(8);
+                for (int j = 0; j < numKeySignatures; ++j)
+                {
+                    remapping.keySignatureBeats.add(beat);
+                    remapping.keySignatureRootKeys.add(random.nextInt(12));
+                    beat += float(random.nextInt(3) * 4);
+                }
+
+                // the linear search which was used before
+                const auto findRootKey = [&remapping](float beat)
+                {
+                    if (remapping.keySignatureBeats.isEmpty())
+                    {
+                        return 0;
+                    }
+
+                    int context = -1;
+                    for (int k = 0; k < remapping.keySignatureBeats.size(); ++k)
+                    {
+                        if (context < 0 || remapping.keySignatureBeats[k] <= beat)
+                        {
+                            context = k;
+                        }
+                        else if (remapping.keySignatureBeats[k] >= beat)
+                        {
+                            break;
+                        }
+                    }
+
+                    return remapping.keySignatureRootKeys[context];
+                };
+
+                const auto notes = makeRandomNotes(random, 500);
+                const auto firstClipBeat = float(random.nextInt(8));
+
+                auto expected = notes;
+                for (auto &note : expected)
+                {
+                    note.key = jmax(0, doRemapKeyToTemperament(remapping,
+                        note.key, findRootKey(note.beat + firstClipBeat)));
+                }
+
+                auto actual = notes;
+                doRemapNotesToTemperament(actual, remapping, firstClipBeat);
+
+                expectNotesEqual(actual, expected);
+            }
+        }
+    }
+
+private:
+
+    static NoteBatchTransform::Notes makeRandomNotes(Random &random, int numNotes)
+    {
+        NoteBatchTransform::Notes notes;
+        float beat = 0.f;
+        for (int i = 0; i < numNotes; ++i)
+        {
+            beat += float(random.nextInt(3)) * 0.25f;
+            notes.add({ beat, 36 + random.nextInt(48), 0.25f, 0.5f });
+        }
+
+        return notes;
+    }
+
+    void expectNotesEqual(const NoteBatchTransform::Notes &actual,
+        const NoteBatchTransform::Notes &expected)
+    {
+        expectEquals(actual.size(), expected.size());
+        for (int i = 0; i < jmin(actual.size(), expected.size()); ++i)
+        {
+            expectEquals(actual[i].key, expected[i].key);
+            expectEquals(actual[i].beat, expected[i].beat);
+        }
     }
 };
 
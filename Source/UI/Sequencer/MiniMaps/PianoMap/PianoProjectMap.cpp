@@ -62,31 +62,48 @@ void PianoProjectMap::resized()
 void PianoProjectMap::paint(Graphics &g)
 {
     const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
-    const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
-    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
-    const auto h = float(this->getHeight());
+    const float pixelsPerBeat = float(this->getWidth()) / rollLengthInBeats;
+    const auto clipBounds = g.getClipBounds().toFloat();
 
-    for (const auto &c : this->patternMap)
+    // notes are drawn once into per-sequence rasters,
+    // here we only stretch and position those for each clip
+    g.setImageResamplingQuality(Graphics::lowResamplingQuality);
+
+    for (const auto *track : this->pianoTracks)
     {
-        const auto sequenceMap = c.second.get();
-        const bool isActiveClip = this->activeClip == c.first;
+        const auto *sequence = track->getSequence();
+        const auto *pattern = track->getPattern();
+        auto raster = this->rasters.find(sequence);
+        if (pattern == nullptr || raster == this->rasters.end())
+        {
+            jassertfalse;
+            continue;
+        }
+
+        const auto &image = raster.value().update(static_cast<const PianoSequence &>(*sequence),
+            this->getHeight(), this->keyboardSize);
 
-        g.setColour(c.first.getTrackColour()
-            .interpolatedWith(this->baseColour, 0.45f)
-            .withAlpha(isActiveClip ? this->brightnessFactor : this->brightnessFactor * 0.65f));
+        const auto sequenceFirstBeat = raster->second.getFirstBeat();
+        const auto sequenceWidth = jmax(1.f,
+            raster->second.getLastBeat() - sequenceFirstBeat) * pixelsPerBeat;
 
-        for (const auto &n : *sequenceMap)
+        const auto colour = track->getTrackColour().interpolatedWith(this->baseColour, 0.45f);
+
+        for (int i = 0; i < pattern->size(); ++i)
         {
-            const auto key = jlimit(0, this->keyboardSize, n.getKey() + c.first.getKey());
-            const auto beat = n.getBeat() + c.first.getBeat() - this->rollFirstBeat;
-            const auto length = n.getLength();
+            const auto &clip = *pattern->getUnchecked(i);
+            const float x = (clip.getBeat() + sequenceFirstBeat - this->rollFirstBeat) * pixelsPerBeat;
+            if (x > clipBounds.getRight() || (x + sequenceWidth) < clipBounds.getX())
+            {
+                continue;
+            }
 
-            const float x = (mapWidth * (beat / projectLengthInBeats));
-            const float w = (mapWidth * (length / projectLengthInBeats));
+            const bool isActiveClip = this->activeClip == clip;
+            g.setColour(colour.withAlpha(isActiveClip ?
+                this->brightnessFactor : this->brightnessFactor * 0.65f));
 
-            // with rounding it just looks better:
-            const float y = roundf(h - (key * this->componentHeight));
-            g.fillRect(x, y, jmax(0.25f, w), 1.f);
+            const float y = -roundf(float(clip.getKey()) * this->componentHeight);
+            g.drawImageTransformed(image, raster->second.getTransform(x, y, pixelsPerBeat), true);
         }
     }
 }
@@ -95,28 +112,12 @@ void PianoProjectMap::paint(Graphics &g)
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
-
 void PianoProjectMap::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2)
 {
     if (e1.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(e1);
-        const Note &newNote = static_cast<const Note &>(e2);
-        const auto *track = newNote.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                sequenceMap.erase(note);
-                sequenceMap.insert(newNote);
-            }
-        }
-
+        this->invalidateRaster(static_cast<const Note &>(e1));
+        this->invalidateRaster(static_cast<const Note &>(e2));
         this->triggerAsyncUpdate();
     }
 }
@@ -125,15 +126,7 @@ void PianoProjectMap::onAddMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            sequenceMap.insert(note);
-        }
-
+        this->invalidateRaster(static_cast<const Note &>(event));
         this->triggerAsyncUpdate();
     }
 }
@@ -142,69 +135,33 @@ void PianoProjectMap::onRemoveMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                sequenceMap.erase(note);
-            }
-        }
-
+        this->invalidateRaster(static_cast<const Note &>(event));
         this->triggerAsyncUpdate();
     }
 }
 
+// clips only reposition the rasters, no need to invalidate them:
+
 void PianoProjectMap::onAddClip(const Clip &clip)
 {
-    const SequenceSet *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
-    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-    {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
-    }
-
-    if (referenceMap == nullptr)
+    if (this->pianoTracks.contains(clip.getPattern()->getTrack()))
     {
-        jassertfalse;
-        return;
-    }
-
-    auto *sequenceMap = new SequenceSet();
-    this->patternMap[clip] = UniquePointer<SequenceSet>(sequenceMap);
-        
-    for (const auto &note : *referenceMap)
-    {
-        sequenceMap->insert(note);
+        this->triggerAsyncUpdate();
     }
-
-    this->triggerAsyncUpdate();
 }
 
 void PianoProjectMap::onChangeClip(const Clip &clip, const Clip &newClip)
 {
-    if (this->patternMap.contains(clip))
+    if (this->pianoTracks.contains(newClip.getPattern()->getTrack()))
     {
-        // Set new key for existing sequence map
-        auto *sequenceMap = this->patternMap[clip].release();
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceSet>(sequenceMap);
         this->triggerAsyncUpdate();
     }
 }
 
 void PianoProjectMap::onRemoveClip(const Clip &clip)
 {
-    if (this->patternMap.contains(clip))
+    if (this->pianoTracks.contains(clip.getPattern()->getTrack()))
     {
-        this->patternMap.erase(clip);
         this->triggerAsyncUpdate();
     }
 }
@@ -243,15 +200,8 @@ void PianoProjectMap::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
-    {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
-        {
-            this->patternMap.erase(clip);
-        }
-    }
-
+    this->pianoTracks.removeAllInstancesOf(track);
+    this->rasters.erase(track->getSequence());
     this->triggerAsyncUpdate();
 }
 
@@ -297,7 +247,8 @@ void PianoProjectMap::onChangeViewEditableScope(MidiTrack *const, const Clip &cl
 
 void PianoProjectMap::reloadTrackMap()
 {
-    this->patternMap.clear();
+    this->pianoTracks.clearQuick();
+    this->rasters.clear();
 
     const auto &tracks = this->project.getTracks();
     for (const auto *track : tracks)
@@ -318,22 +269,16 @@ void PianoProjectMap::loadTrack(const MidiTrack *const track)
         return;
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
-    {
-        const Clip *clip = track->getPattern()->getUnchecked(i);
-
-        auto *sequenceMap = new SequenceSet();
-        this->patternMap[*clip] = UniquePointer<SequenceSet>(sequenceMap);
+    this->pianoTracks.addIfNotAlreadyThere(track);
+    this->rasters[track->getSequence()].invalidate();
+}
 
-        for (int j = 0; j < track->getSequence()->size(); ++j)
-        {
-            const MidiEvent *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Note))
-            {
-                const Note *note = static_cast<const Note *>(event);
-                sequenceMap->insert(*note);
-            }
-        }
+void PianoProjectMap::invalidateRaster(const Note &note)
+{
+    auto raster = this->rasters.find(note.getSequence());
+    if (raster != this->rasters.end())
+    {
+        raster.value().invalidate(note);
     }
 }
 
@@ -22,9 +22,11 @@
 #include "ProjectListener.h"
 #include "ProjectMapsScroller.h"
 #include "ColourIDs.h"
+#include "PianoSequenceRaster.h"
 
 class RollBase;
 class ProjectNode;
+class MidiSequence;
 
 class PianoProjectMap final :
     public ProjectMapsScroller::ScrolledComponent,
@@ -73,6 +75,7 @@ private:
 
     void reloadTrackMap();
     void loadTrack(const MidiTrack *const track);
+    void invalidateRaster(const Note &note);
 
     float projectFirstBeat = 0.f;
     float projectLastBeat = Globals::Defaults::projectLength;
@@ -90,9 +93,10 @@ private:
 
     const Colour baseColour = findDefaultColour(ColourIDs::Roll::noteFill);
 
-    using SequenceSet = FlatHashSet<Note, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceSet>, ClipHash>;
-    PatternMap patternMap;
+    Array<const MidiTrack *> pianoTracks;
+
+    // one cached image per piano sequence, shared by all its clips
+    FlatHashMap<const MidiSequence *, PianoSequenceRaster> rasters;
 
     void handleAsyncUpdate() override;
 
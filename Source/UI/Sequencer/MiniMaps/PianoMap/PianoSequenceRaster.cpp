@@ -0,0 +1,151 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "PianoSequenceRaster.h"
+#include "PianoSequence.h"
+
+void PianoSequenceRaster::invalidate() noexcept
+{
+    this->isStale = true;
+}
+
+void PianoSequenceRaster::invalidate(const Note &note) noexcept
+{
+    if (this->isStale || !this->image.isValid())
+    {
+        return;
+    }
+
+    // a note out of the current range will change the sequence range,
+    // and the whole image will be re-rendered anyway in the next update
+    const auto area = this->getNoteArea(note, this->beatWidth)
+        .getSmallestIntegerContainer().expanded(1, 0)
+        .getIntersection(this->image.getBounds());
+
+    this->staleArea = this->staleArea.getUnion(area);
+}
+
+const Image &PianoSequenceRaster::update(const PianoSequence &sequence,
+    int height, int keyboardSize)
+{
+    height = jmax(1, height);
+
+    if (this->isStale ||
+        !this->image.isValid() ||
+        this->image.getHeight() != height ||
+        this->keyboardSize != keyboardSize ||
+        this->firstBeat != sequence.getFirstBeat() ||
+        this->lastBeat != sequence.getLastBeat())
+    {
+        this->firstBeat = sequence.getFirstBeat();
+        this->lastBeat = sequence.getLastBeat();
+        this->keyboardSize = keyboardSize;
+
+        const auto length = jmax(1.f, this->lastBeat - this->firstBeat);
+        this->beatWidth = jmin(PianoSequenceRaster::maxBeatWidth,
+            float(PianoSequenceRaster::maxImageWidth) / length);
+
+        const auto width = int(ceilf(length * this->beatWidth)) + 1;
+        if (!this->image.isValid() ||
+            this->image.getWidth() != width ||
+            this->image.getHeight() != height)
+        {
+            this->image = Image(Image::SingleChannel, width, height, true);
+        }
+        else
+        {
+            this->image.clear(this->image.getBounds());
+        }
+
+        this->render(sequence, this->image.getBounds());
+
+        this->isStale = false;
+        this->staleArea = {};
+    }
+    else if (!this->staleArea.isEmpty())
+    {
+        this->image.clear(this->staleArea);
+        this->render(sequence, this->staleArea);
+        this->staleArea = {};
+    }
+
+    return this->image;
+}
+
+AffineTransform PianoSequenceRaster::getTransform(float x, float y,
+    float pixelsPerBeat) const noexcept
+{
+    return AffineTransform::scale(pixelsPerBeat / this->beatWidth, 1.f).translated(x, y);
+}
+
+bool PianoSequenceRaster::isSharpAt(float pixelsPerBeat) const noexcept
+{
+    return pixelsPerBeat <= this->beatWidth;
+}
+
+void PianoSequenceRaster::drawNotes(Graphics &g, const PianoSequence &sequence,
+    float x, float y, float pixelsPerBeat) const
+{
+    const auto clipBounds = g.getClipBounds().toFloat().translated(-x, -y);
+    sequence.forEachNoteInBeatRange(
+        this->firstBeat + (clipBounds.getX() - 1.f) / pixelsPerBeat,
+        this->firstBeat + clipBounds.getRight() / pixelsPerBeat,
+        [&](const Note &note)
+        {
+            const auto noteArea = this->getNoteArea(note, pixelsPerBeat);
+            if (noteArea.intersects(clipBounds))
+            {
+                g.fillRect(noteArea.translated(x, y));
+            }
+        });
+}
+
+Rectangle<float> PianoSequenceRaster::getNoteArea(const Note &note,
+    float pixelsPerBeat) const noexcept
+{
+    const auto h = float(this->image.getHeight());
+    const auto rowHeight = h / float(jmax(1, this->keyboardSize));
+    const auto key = jlimit(0, this->keyboardSize, int(note.getKey()));
+
+    // with rounding it just looks better:
+    return { (note.getBeat() - this->firstBeat) * pixelsPerBeat,
+        roundf(h - key * rowHeight),
+        jmax(1.f, note.getLength() * pixelsPerBeat), 1.f };
+}
+
+void PianoSequenceRaster::render(const PianoSequence &sequence, const Rectangle<int> &area)
+{
+    Graphics g(this->image);
+    g.reduceClipRegion(area);
+    g.setColour(Colours::white);
+
+    // only the notes around the stale area are checked
+    const auto areaF = area.toFloat();
+    sequence.forEachNoteInBeatRange(
+        this->firstBeat + (areaF.getX() - 1.f) / this->beatWidth,
+        this->firstBeat + areaF.getRight() / this->beatWidth,
+        [&](const Note &note)
+        {
+            const auto noteArea = this->getNoteArea(note, this->beatWidth);
+            if (noteArea.intersects(areaF))
+            {
+                g.fillRect(noteArea);
+            }
+        });
+}
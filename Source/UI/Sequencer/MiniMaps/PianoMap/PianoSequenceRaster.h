@@ -0,0 +1,75 @@
+/*
+    This file is part of Helio music sequencer.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+class Note;
+class PianoSequence;
+
+// A single-channel image of all notes in a sequence, one pixel row per key,
+// laid out in sequence-local beats at a fixed resolution; maps and clip previews
+// keep one per sequence and blit it with a scaling transform when scrolling or zooming,
+// so that the notes are only drawn again when something in the sequence changes
+
+class PianoSequenceRaster final
+{
+public:
+
+    PianoSequenceRaster() = default;
+
+    void invalidate() noexcept;
+    void invalidate(const Note &note) noexcept;
+
+    // re-renders all stale areas and returns the alpha mask
+    // to be filled with the current colour via drawImageTransformed
+    const Image &update(const PianoSequence &sequence, int height, int keyboardSize);
+
+    // the transform to draw the raster at pixelsPerBeat scale,
+    // where x is the position of the sequence's first beat
+    AffineTransform getTransform(float x, float y, float pixelsPerBeat) const noexcept;
+
+    // the raster's resolution is limited, so at the larger scales it would
+    // look blurry when stretched; instead, the notes can be drawn directly,
+    // which only draws the notes within the graphics context's clip bounds
+    bool isSharpAt(float pixelsPerBeat) const noexcept;
+    void drawNotes(Graphics &g, const PianoSequence &sequence,
+        float x, float y, float pixelsPerBeat) const;
+
+    float getFirstBeat() const noexcept { return this->firstBeat; }
+    float getLastBeat() const noexcept { return this->lastBeat; }
+
+private:
+
+    Rectangle<float> getNoteArea(const Note &note, float pixelsPerBeat) const noexcept;
+    void render(const PianoSequence &sequence, const Rectangle<int> &area);
+
+    Image image;
+
+    float firstBeat = 0.f;
+    float lastBeat = 0.f;
+    float beatWidth = 1.f;
+    int keyboardSize = 0;
+
+    bool isStale = true;
+    Rectangle<int> staleArea;
+
+    static constexpr auto maxBeatWidth = 8.f;
+    static constexpr auto maxImageWidth = 4096;
+
+    JUCE_LEAK_DETECTOR(PianoSequenceRaster)
+};
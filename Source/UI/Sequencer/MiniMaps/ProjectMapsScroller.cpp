@@ -243,7 +243,7 @@ void ProjectMapsScroller::mouseUp(const MouseEvent &event)
 
         if (this->animationsEnabled)
         {
-            this->startTimerHz(60);
+            this->startAnimating();
         }
     }
 
@@ -342,7 +342,7 @@ void ProjectMapsScroller::onChangeViewBeatRange(float firstBeat, float lastBeat)
 
 void ProjectMapsScroller::onMidiRollMoved(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !this->isAnimating())
     {
         this->updateAllChildrenBounds();
     }
@@ -350,7 +350,7 @@ void ProjectMapsScroller::onMidiRollMoved(RollBase *targetRoll)
 
 void ProjectMapsScroller::onMidiRollResized(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !this->isAnimating())
     {
         this->updateAllChildrenBounds();
     }
@@ -372,7 +372,7 @@ void ProjectMapsScroller::switchToRoll(SafePointer<RollBase> roll)
 
     if (this->animationsEnabled)
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
     else
     {
@@ -397,7 +397,7 @@ bool ProjectMapsScroller::ScrolledComponent::isMultiTouchEvent(const MouseEvent
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// FrameClock::Client
 //===----------------------------------------------------------------------===//
 
 static Rectangle<float> lerpMapBounds(const Rectangle<float> &r1,
@@ -430,7 +430,7 @@ static float getMapBoundsDistance(const Rectangle<float> &r1,
         fabs(r1.getHeight() - r2.getHeight());
 }
 
-void ProjectMapsScroller::timerCallback()
+void ProjectMapsScroller::onAnimationFrame()
 {
     const auto mb = this->getMapBounds().toFloat();
     const auto mbLerp = lerpMapBounds(this->oldMapBounds, mb, 0.4f);
@@ -463,7 +463,7 @@ void ProjectMapsScroller::timerCallback()
     if (shouldStop)
     {
         this->screenRangeRectangle->setBrightness(this->screenRangeTargetBrightness);
-        this->stopTimer();
+        this->stopAnimating();
     }
 }
 
@@ -483,7 +483,7 @@ void ProjectMapsScroller::updateAllChildrenBounds()
     this->projectStartIndicator->updateBounds(mapBounds);
     this->projectEndIndicator->updateBounds(mapBounds);
 
-    if (!this->playhead->isTimerRunning()) // avoid glitches when zooming during playback
+    if (!this->playhead->isAnimating()) // avoid glitches when zooming during playback
     {
         this->playhead->updatePosition();
     }
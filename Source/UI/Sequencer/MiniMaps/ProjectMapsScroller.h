@@ -29,13 +29,14 @@ class MultiTouchController;
 #include "RollListener.h"
 #include "ComponentFader.h"
 #include "ColourIDs.h"
+#include "FrameClock.h"
 
 class ProjectMapsScroller final :
     public Component,
     public ProjectListener,
     public RollListener,
     public MultiTouchListener,
-    private Timer // optionally animates transitions between rolls
+    private FrameClock::Client // optionally animates transitions between rolls
 {
 public:
 
@@ -342,7 +343,7 @@ private:
 
     void updateAllChildrenBounds();
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
 
     ProjectNode &project;
     SafePointer<RollBase> roll;
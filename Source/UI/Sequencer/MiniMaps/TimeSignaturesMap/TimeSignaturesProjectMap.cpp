@@ -79,7 +79,7 @@ void TimeSignaturesProjectMap::resized()
 // TimeSignaturesAggregator::Listener
 //===----------------------------------------------------------------------===//
 
-void TimeSignaturesProjectMap::onTimeSignaturesUpdated()
+void TimeSignaturesProjectMap::onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat)
 {
     const auto &sequenceToSyncWith =
         *this->project.getTimeline()->getTimeSignaturesAggregator()->getSequence();
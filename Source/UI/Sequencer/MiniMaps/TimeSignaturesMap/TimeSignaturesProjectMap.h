@@ -51,7 +51,7 @@ public:
     // TimeSignaturesAggregator::Listener
     //===------------------------------------------------------------------===//
 
-    void onTimeSignaturesUpdated() override;
+    void onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat) override;
 
     //===------------------------------------------------------------------===//
     // Stuff for children
@@ -69,6 +69,30 @@ struct StringComparator final
 
 static StringComparator kStringSort;
 
+// In case there are no events, display an empty clip of some default length,
+// if there are some really short events (e.g. the first moments in recording mode),
+// set the minimal limit for the clip bounds:
+static float getClipLengthInBeats(const MidiSequence *sequence) noexcept
+{
+    return sequence->isEmpty() ? Globals::Defaults::emptyClipLength :
+        jmax(sequence->getLengthInBeats(), Globals::minClipLength);
+}
+
+// clips are sorted by beat, so this is just a binary search:
+template <typename Callback>
+static void forEachClipInBeatRange(const Pattern &pattern,
+    float startBeat, float endBeat, Callback callback)
+{
+    const auto &clips = pattern.getClips();
+    const auto *firstClip = std::lower_bound(clips.begin(), clips.end(), startBeat,
+        [](const Clip *clip, float beat) { return clip->getBeat() < beat; });
+
+    for (auto *it = firstClip; it != clips.end() && (*it)->getBeat() <= endBeat; ++it)
+    {
+        callback(**it);
+    }
+}
+
 static void updateTrackRowPosition(Array<String> &rows,
     MidiTrack::Grouping grouping, const MidiTrack *const track)
 {
@@ -293,11 +317,7 @@ Rectangle<float> PatternRoll::getEventBounds(const Clip &clip) const
     const auto trackGroupKey = track->getTrackGroupKey(grouping);
     const int trackIndex = this->rows.indexOfSorted(kStringSort, trackGroupKey);
 
-    // In case there are no events, display an empty clip of some default length,
-    // if there are some really short events (e.g. the first moments in recording mode),
-    // set the minimal limit for the clip bounds:
-    const float sequenceLength = sequence->isEmpty() ? Globals::Defaults::emptyClipLength :
-        jmax(sequence->getLengthInBeats(), Globals::minClipLength);
+    const float sequenceLength = getClipLengthInBeats(sequence);
 
     const float w = this->beatWidth * sequenceLength;
     const float x = this->beatWidth * (sequence->getFirstBeat() + clip.getBeat() - this->firstBeat);
@@ -500,43 +520,40 @@ void PatternRoll::selectEventsInRange(float startBeat, float endBeat, bool shoul
         this->selection.deselectAll();
     }
 
-    for (const auto &e : this->clipComponents)
+    this->forEachClipComponentInBeatRange(startBeat, endBeat, [&](ClipComponent *component)
     {
-        const auto component = e.second.get();
         if (component->isActiveAndEditable() &&
             component->getBeat() >= startBeat &&
             component->getBeat() < endBeat)
         {
             this->selection.addToSelection(component);
         }
-    }
+    });
 }
 
 void PatternRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
     const Rectangle<int> &rectangle)
 {
-    for (const auto &e : this->clipComponents)
+    this->forEachClipComponentInArea(rectangle.toFloat(), [&](ClipComponent *component)
     {
-        const auto component = e.second.get();
         if (component->isActiveAndEditable() &&
             rectangle.intersects(component->getBounds()))
         {
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
         }
-    }
+    });
 }
 
 void PatternRoll::findLassoItemsInPolygon(Array<SelectableComponent *> &itemsFound,
     const Rectangle<int> &bounds, const Array<Point<float>> &polygon)
 {
-    for (const auto &e : this->clipComponents)
+    this->forEachClipComponentInArea(bounds.toFloat(), [&](ClipComponent *component)
     {
-        const auto component = e.second.get();
         if (!component->isActiveAndEditable() ||
             !bounds.intersects(component->getBounds())) // fast path
         {
-            continue;
+            return;
         }
 
         if (DrawableLassoSource::boundsIntersectPolygon(component->getFloatBounds(), polygon))
@@ -544,7 +561,7 @@ void PatternRoll::findLassoItemsInPolygon(Array<SelectableComponent *> &itemsFou
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
         }
-    }
+    });
 }
 
 void PatternRoll::updateHighlightedInstances()
@@ -586,6 +603,58 @@ void PatternRoll::selectClip(const Clip &clip)
     }
 }
 
+void PatternRoll::forEachClipComponentInBeatRange(float startBeat, float endBeat,
+    const Function<void(ClipComponent *)> &callback) const
+{
+    for (const auto *track : this->tracks)
+    {
+        forEachClipInBeatRange(*track->getPattern(), startBeat, endBeat, [&](const Clip &clip)
+        {
+            const auto found = this->clipComponents.find(clip);
+            if (found != this->clipComponents.end())
+            {
+                callback(found->second.get());
+            }
+        });
+    }
+}
+
+void PatternRoll::forEachClipComponentInArea(const Rectangle<float> &area,
+    const Function<void(ClipComponent *)> &callback) const
+{
+    const auto startBeat = this->firstBeat + area.getX() / this->beatWidth;
+    const auto endBeat = this->firstBeat + area.getRight() / this->beatWidth;
+    const auto grouping = this->project.getTrackGroupingMode();
+
+    for (const auto *track : this->tracks)
+    {
+        // skip the rows not intersecting the area, see getEventBounds
+        const auto trackGroupKey = track->getTrackGroupKey(grouping);
+        const int trackIndex = this->rows.indexOfSorted(kStringSort, trackGroupKey);
+        const auto rowY = float(Globals::UI::rollHeaderHeight + trackIndex * PatternRoll::rowHeight);
+        if (rowY > area.getBottom() || rowY + PatternRoll::rowHeight < area.getY())
+        {
+            continue;
+        }
+
+        // displayed clip position depends on a sequence's first beat as well:
+        const auto *sequence = track->getSequence();
+        const auto clipOffset = sequence->getFirstBeat();
+        const auto clipLength = getClipLengthInBeats(sequence);
+
+        forEachClipInBeatRange(*track->getPattern(),
+            startBeat - clipOffset - clipLength, endBeat - clipOffset,
+            [&](const Clip &clip)
+            {
+                const auto found = this->clipComponents.find(clip);
+                if (found != this->clipComponents.end())
+                {
+                    callback(found->second.get());
+                }
+            });
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // SmoothZoomListener
 //===----------------------------------------------------------------------===//
@@ -1139,17 +1208,17 @@ void PatternRoll::startErasingEvents(const Point<float> &mousePosition)
 
 void PatternRoll::continueErasingEvents(const Point<float> &mousePosition)
 {
-    for (const auto &it : this->clipComponents)
+    const Rectangle<float> mouseArea(mousePosition, mousePosition);
+    this->forEachClipComponentInArea(mouseArea, [&](ClipComponent *cc)
     {
-        auto *cc = it.second.get();
         if (!cc->isActiveAndEditable() || !cc->isVisible())
         {
-            continue;
+            return;
         }
 
         if (!cc->getBounds().contains(mousePosition.toInt()))
         {
-            continue;
+            return;
         }
 
         // duplicates the behavior in onRemoveClip
@@ -1159,7 +1228,7 @@ void PatternRoll::continueErasingEvents(const Point<float> &mousePosition)
         // but sets invisible instead of removing
         cc->setVisible(false);
         this->clipsToEraseOnMouseUp.add(cc->getClip());
-    }
+    });
 }
 
 void PatternRoll::endErasingEvents()
@@ -1181,14 +1250,15 @@ void PatternRoll::endErasingEvents()
 void PatternRoll::startCuttingClips(const Point<float> &mousePosition)
 {
     ClipComponent *targetClip = nullptr;
-    for (const auto &cc : this->clipComponents)
+    const Rectangle<float> mouseArea(mousePosition, mousePosition);
+    this->forEachClipComponentInArea(mouseArea, [&](ClipComponent *cc)
     {
-        if (cc.second.get()->getBounds().contains(mousePosition.toInt()))
+        if (targetClip == nullptr &&
+            cc->getBounds().contains(mousePosition.toInt()))
         {
-            targetClip = cc.second.get();
-            break;
+            targetClip = cc;
         }
-    }
+    });
 
     if (this->knifeToolHelper == nullptr && targetClip != nullptr)
     {
@@ -147,6 +147,14 @@ private:
     void reloadRollContent();
     void insertNewClipAt(const MouseEvent &e);
 
+    // patterns are sorted by beat, so they work as a spatial index
+    // for the lasso and hit-testing, instead of checking every component;
+    // the callbacks get all components which may overlap the given range:
+    void forEachClipComponentInBeatRange(float startBeat, float endBeat,
+        const Function<void(ClipComponent *)> &callback) const;
+    void forEachClipComponentInArea(const Rectangle<float> &area,
+        const Function<void(ClipComponent *)> &callback) const;
+
     void showNewTrackMenu(float beatToInsertAt);
     void showNewTrackDialog(const String &instrumentId, float beatToInsertAt);
 
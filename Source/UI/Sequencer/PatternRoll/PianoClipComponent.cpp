@@ -34,7 +34,7 @@ PianoClipComponent::PianoClipComponent(ProjectNode &project, MidiSequence *seque
     sequence(sequence)
 {
     this->setPaintingIsUnclipped(true);
-    this->reloadTrackMap();
+    this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
     this->project.addListener(this);
 }
 
@@ -62,20 +62,29 @@ void PianoClipComponent::paint(Graphics &g)
             this->getTextArea(), Justification::topLeft, false);
     }
 
-    const auto w = float(this->getWidth());
-    const auto h = float(this->getHeight());
+    if (this->sequence == nullptr)
+    {
+        return;
+    }
+
+    const auto &sequence = static_cast<const PianoSequence &>(*this->sequence);
+    const auto &image = this->raster.update(sequence,
+        this->getHeight(), this->keyboardSize);
 
-    const auto *sequence = this->clip.getPattern()->getTrack()->getSequence();
-    const auto sequenceLength = jmax(1.f, sequence->getLengthInBeats());
+    const auto sequenceLength = jmax(1.f, sequence.getLengthInBeats());
+    const auto pixelsPerBeat = float(this->getWidth()) / sequenceLength;
+    const auto y = -roundf(float(this->clip.getKey() * this->getHeight()) / float(this->keyboardSize));
 
-    for (const auto &note : this->displayedNotes)
+    if (this->raster.isSharpAt(pixelsPerBeat))
     {
-        const float beat = note.getBeat() - sequence->getFirstBeat();
-        const auto key = jlimit(0, this->keyboardSize, note.getKey() + this->clip.getKey());
-        const float clipX = w * (beat / sequenceLength);
-        const float clipW = w * (note.getLength() / sequenceLength);
-        const float clipY = roundf(h - key * h / float(this->keyboardSize));
-        g.fillRect(clipX, clipY, jmax(0.25f, clipW), 1.f);
+        g.setImageResamplingQuality(Graphics::lowResamplingQuality);
+        g.drawImageTransformed(image, this->raster.getTransform(0.f, y, pixelsPerBeat), true);
+    }
+    else
+    {
+        // zoomed in beyond the raster's resolution, the stretched
+        // image would look blurry, but only a few notes are visible:
+        this->raster.drawNotes(g, sequence, 0.f, y, pixelsPerBeat);
     }
 }
 
@@ -91,12 +100,8 @@ void PianoClipComponent::onChangeMidiEvent(const MidiEvent &oldEvent, const Midi
         const Note &newNote = static_cast<const Note &>(newEvent);
         if (newNote.getSequence() != this->sequence) { return; }
 
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-            this->displayedNotes.insert(newNote);
-        }
-
+        this->raster.invalidate(note);
+        this->raster.invalidate(newNote);
         this->roll.triggerBatchRepaintFor(this);
     }
 }
@@ -108,7 +113,7 @@ void PianoClipComponent::onAddMidiEvent(const MidiEvent &event)
         const Note &note = static_cast<const Note &>(event);
         if (note.getSequence() != this->sequence) { return; }
 
-        this->displayedNotes.insert(note);
+        this->raster.invalidate(note);
         this->roll.triggerBatchRepaintFor(this);
     }
 }
@@ -120,11 +125,7 @@ void PianoClipComponent::onRemoveMidiEvent(const MidiEvent &event)
         const Note &note = static_cast<const Note &>(event);
         if (note.getSequence() != this->sequence) { return; }
 
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-        }
-
+        this->raster.invalidate(note);
         this->roll.triggerBatchRepaintFor(this);
     }
 }
@@ -147,10 +148,9 @@ void PianoClipComponent::onChangeTrackProperties(MidiTrack *const track)
 void PianoClipComponent::onReloadProjectContent(const Array<MidiTrack *> &tracks,
     const ProjectMetadata *meta)
 {
-    if (this->sequence != nullptr)
-    {
-        this->reloadTrackMap();
-    }
+    this->keyboardSize = meta->getKeyboardSize();
+    this->raster.invalidate();
+    this->roll.triggerBatchRepaintFor(this);
 }
 
 void PianoClipComponent::onChangeProjectInfo(const ProjectMetadata *info)
@@ -167,51 +167,15 @@ void PianoClipComponent::onAddTrack(MidiTrack *const track)
     if (track->getSequence() == this->sequence &&
         track->getSequence()->size() > 0)
     {
-        this->reloadTrackMap();
+        this->raster.invalidate();
         this->roll.triggerBatchRepaintFor(this);
     }
 }
 
-void PianoClipComponent::onRemoveTrack(MidiTrack *const track)
-{
-    if (track->getSequence() != this->sequence) { return; }
-
-    for (int i = 0; i < track->getSequence()->size(); ++i)
-    {
-        const Note &note = static_cast<const Note &>(*track->getSequence()->getUnchecked(i));
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-        }
-    }
-}
-
 //===----------------------------------------------------------------------===//
 // Private
 //===----------------------------------------------------------------------===//
 
-void PianoClipComponent::reloadTrackMap()
-{
-    this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
-
-    this->displayedNotes.clear();
-
-    for (auto *track : this->project.getTracks())
-    {
-        if (track->getSequence() != this->sequence) { continue; }
-
-        for (int j = 0; j < track->getSequence()->size(); ++j)
-        {
-            auto *event = track->getSequence()->getUnchecked(j);
-            if (event != nullptr && event->isTypeOf(MidiEvent::Type::Note))
-            {
-                auto *note = static_cast<Note *>(event);
-                this->displayedNotes.insert(*note);
-            }
-        }
-    }
-}
-
 void PianoClipComponent::setShowRecordingMode(bool isRecording)
 {
     this->flags.isRecordingTarget = isRecording;
@@ -20,6 +20,7 @@
 #include "Note.h"
 #include "ClipComponent.h"
 #include "ProjectListener.h"
+#include "PianoSequenceRaster.h"
 
 class RollBase;
 class MidiSequence;
@@ -53,7 +54,7 @@ public:
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
 
     void onAddTrack(MidiTrack *const track) override;
-    void onRemoveTrack(MidiTrack *const track) override;
+    void onRemoveTrack(MidiTrack *const track) override {}
     void onChangeTrackProperties(MidiTrack *const track) override;
 
     void onChangeProjectBeatRange(float firstBeat, float lastBeat) override {}
@@ -64,11 +65,12 @@ public:
 
 private:
 
-    void reloadTrackMap();
-
     ProjectNode &project;
     WeakReference<MidiSequence> sequence;
-    FlatHashSet<Note, MidiEventHash> displayedNotes;
+
+    // notes are rendered once at the sequence's own scale,
+    // and only the stale parts are re-rendered on changes
+    PianoSequenceRaster raster;
 
     int keyboardSize = Globals::twelveToneKeyboardSize;
 
@@ -22,41 +22,110 @@
 #include "ColourIDs.h"
 
 HighlightingScheme::HighlightingScheme(Note::Key rootKey,
-    const Scale::Ptr scale) noexcept :
+    const Scale::Ptr scale, Renderer &renderer) noexcept :
     rootKey(rootKey),
-    scale(scale) {}
+    scale(scale),
+    renderer(renderer) {}
+
+// patterns are pre-rendered for every n-th row height only,
+// so that there is something close enough to scale when zooming
+static constexpr auto quantizedRowHeightStep = 4;
 
 void HighlightingScheme::renderBackgroundCache(Temperament::Ptr temperament)
 {
-    Array<Image> result;
     const auto &theme = HelioTheme::getCurrentTheme();
 
-    //static PNGImageFormat png;
+    this->temperament = temperament;
+    this->palette.blackKey = theme.findColour(ColourIDs::Roll::blackKey);
+    this->palette.whiteKey = theme.findColour(ColourIDs::Roll::whiteKey);
+    this->palette.rootKey = theme.findColour(ColourIDs::Roll::rootKey);
+    this->palette.rowLine = theme.findColour(ColourIDs::Roll::rowLine);
+    this->palette.bevelBrightness = theme.isDark() ? 0.025f : 0.1f;
+    this->palette.theme = &theme;
+
+    // any jobs still running for the old cache will be dropped
+    this->cache = new Renderer::RowsCache();
+    this->cache->rows.insertMultiple(0, {}, PianoRoll::maxRowHeight + 1);
+    this->cache->requested.insertMultiple(0, false, PianoRoll::maxRowHeight + 1);
 
-    for (int j = 0; j < PianoRoll::minRowHeight; ++j)
+    for (int h = PianoRoll::minRowHeight; ; h += quantizedRowHeightStep)
     {
-        result.add({});
+        const auto rowHeight = jmin(h, int(PianoRoll::maxRowHeight));
+        this->cache->requested.set(rowHeight, true);
+        this->renderer.schedule({ this->cache, this->palette,
+            this->temperament, this->scale, this->rootKey, rowHeight }, false);
+
+        if (rowHeight == PianoRoll::maxRowHeight)
+        {
+            break;
+        }
     }
+}
+
+Image HighlightingScheme::getRowsPattern(int rowHeight) const
+{
+    jassert(this->cache != nullptr);
+    jassert(rowHeight >= PianoRoll::minRowHeight && rowHeight <= PianoRoll::maxRowHeight);
 
-    for (int j = PianoRoll::minRowHeight; j <= PianoRoll::maxRowHeight; ++j)
     {
-        Image img(HighlightingScheme::renderRowsPattern(theme,
-            temperament,this->getScale(), this->getRootKey(), j));
+        const ScopedLock lock(this->cache->lock);
 
-        //File f("test" + String(j) + ".png");
-        //FileOutputStream outStream(f);
-        //png.writeImageToStream(img, outStream);
-        //outStream.flush();
+        const auto &rows = this->cache->rows;
+        if (rows.getReference(rowHeight).isValid())
+        {
+            return rows.getReference(rowHeight);
+        }
+
+        if (!this->cache->requested[rowHeight])
+        {
+            this->cache->requested.set(rowHeight, true);
+            this->renderer.schedule({ this->cache, this->palette,
+                this->temperament, this->scale, this->rootKey, rowHeight }, true);
+        }
+
+        for (int d = 1; d <= PianoRoll::maxRowHeight - PianoRoll::minRowHeight; ++d)
+        {
+            if (rowHeight - d >= PianoRoll::minRowHeight &&
+                rows.getReference(rowHeight - d).isValid())
+            {
+                return rows.getReference(rowHeight - d);
+            }
 
-        result.add(img);
+            if (rowHeight + d <= PianoRoll::maxRowHeight &&
+                rows.getReference(rowHeight + d).isValid())
+            {
+                return rows.getReference(rowHeight + d);
+            }
+        }
     }
 
-    this->rows.swapWith(result);
+    // nothing is ready yet, e.g. the very first paint after the cache reset,
+    // so just render the requested one synchronously:
+    auto image = HighlightingScheme::renderRowsPattern(this->palette,
+        this->temperament, this->scale, this->rootKey, rowHeight);
+
+    const ScopedLock lock(this->cache->lock);
+    this->cache->rows.set(rowHeight, image);
+    return image;
 }
 
 Image HighlightingScheme::renderRowsPattern(const HelioTheme &theme,
     const Temperament::Ptr temperament,
     const Scale::Ptr scale, Note::Key root, int height)
+{
+    Renderer::Palette palette;
+    palette.blackKey = theme.findColour(ColourIDs::Roll::blackKey);
+    palette.whiteKey = theme.findColour(ColourIDs::Roll::whiteKey);
+    palette.rootKey = theme.findColour(ColourIDs::Roll::rootKey);
+    palette.rowLine = theme.findColour(ColourIDs::Roll::rowLine);
+    palette.bevelBrightness = theme.isDark() ? 0.025f : 0.1f;
+    palette.theme = &theme;
+    return HighlightingScheme::renderRowsPattern(palette, temperament, scale, root, height);
+}
+
+Image HighlightingScheme::renderRowsPattern(const Renderer::Palette &palette,
+    const Temperament::Ptr temperament,
+    const Scale::Ptr scale, Note::Key root, int height)
 {
     if (height < PianoRoll::minRowHeight)
     {
@@ -76,11 +145,11 @@ Image HighlightingScheme::renderRowsPattern(const HelioTheme &theme,
     const int middleCOffset = periodSize - (temperament->getMiddleC() % periodSize);
     const int lastPeriodRemainder = (temperament->getNumKeys() % periodSize) - root + middleCOffset;
 
-    const auto blackKeyColour = theme.findColour(ColourIDs::Roll::blackKey);
-    const auto whiteKeyColour = theme.findColour(ColourIDs::Roll::whiteKey);
-    const auto rootKeyColour = theme.findColour(ColourIDs::Roll::rootKey);
-    const auto rowLineColour = theme.findColour(ColourIDs::Roll::rowLine);
-    const auto bevelBrightness = theme.isDark() ? 0.025f : 0.1f;
+    const auto blackKeyColour = palette.blackKey;
+    const auto whiteKeyColour = palette.whiteKey;
+    const auto rootKeyColour = palette.rootKey;
+    const auto rowLineColour = palette.rowLine;
+    const auto bevelBrightness = palette.bevelBrightness;
 
     // draw rows
     for (int i = lastPeriodRemainder;
@@ -119,7 +188,88 @@ Image HighlightingScheme::renderRowsPattern(const HelioTheme &theme,
         posY -= currentHeight;
     }
 
-    HelioTheme::drawNoise(theme, g, 1.f);
+    HelioTheme::drawNoise(*palette.theme, g, 1.f);
 
     return patternImage;
 }
+
+//===----------------------------------------------------------------------===//
+// Renderer
+//===----------------------------------------------------------------------===//
+
+HighlightingScheme::Renderer::Renderer() : Thread("HighlightingScheme")
+{
+    this->startThread(3);
+}
+
+HighlightingScheme::Renderer::~Renderer()
+{
+    this->cancelPendingUpdate();
+    this->stopThread(1000);
+}
+
+void HighlightingScheme::Renderer::schedule(const Job &job, bool isUrgent)
+{
+    {
+        const ScopedLock lock(this->queueLock);
+        if (isUrgent)
+        {
+            this->queue.insert(0, job);
+        }
+        else
+        {
+            this->queue.add(job);
+        }
+    }
+
+    this->notify();
+}
+
+void HighlightingScheme::Renderer::run()
+{
+    while (!this->threadShouldExit())
+    {
+        Job job;
+
+        {
+            const ScopedLock lock(this->queueLock);
+            if (!this->queue.isEmpty())
+            {
+                job = this->queue.removeAndReturn(0);
+            }
+        }
+
+        if (job.cache == nullptr)
+        {
+            this->wait(-1);
+            continue;
+        }
+
+        // the scheme was deleted or re-rendered since the job was scheduled
+        if (job.cache->getReferenceCount() == 1)
+        {
+            continue;
+        }
+
+        const auto image = HighlightingScheme::renderRowsPattern(job.palette,
+            job.temperament, job.scale, job.rootKey, job.rowHeight);
+
+        {
+            const ScopedLock lock(job.cache->lock);
+            if (!job.cache->rows.getReference(job.rowHeight).isValid())
+            {
+                job.cache->rows.set(job.rowHeight, image);
+            }
+        }
+
+        this->triggerAsyncUpdate();
+    }
+}
+
+void HighlightingScheme::Renderer::handleAsyncUpdate()
+{
+    if (this->onRendered != nullptr)
+    {
+        this->onRendered();
+    }
+}
@@ -27,7 +27,10 @@ class HighlightingScheme final
 {
 public:
 
-    HighlightingScheme(Note::Key rootKey, const Scale::Ptr scale) noexcept;
+    class Renderer;
+
+    HighlightingScheme(Note::Key rootKey, const Scale::Ptr scale,
+        Renderer &renderer) noexcept;
 
     template<typename T1, typename T2>
     static int compareElements(const T1 *const l, const T2 *const r)
@@ -44,19 +47,98 @@ public:
 
     const Scale::Ptr getScale() const noexcept { return this->scale; }
     const Note::Key getRootKey() const noexcept { return this->rootKey; }
-    const Image getUnchecked(int i) const noexcept { return this->rows.getUnchecked(i); }
-    
+
+    // returns the pattern of two periods of rows rendered for the given row height,
+    // or, while that one is being rendered in background, the pattern rendered
+    // for the closest row height, which the caller is supposed to scale
+    Image getRowsPattern(int rowHeight) const;
+
+    // starts rendering the patterns for a few quantized row heights in background,
+    // all other row heights are rendered on demand
     void renderBackgroundCache(Temperament::Ptr temperament);
 
     static Image renderRowsPattern(const HelioTheme &theme,
         const Temperament::Ptr temperament, const Scale::Ptr scale,
         Note::Key root, int height);
 
+    //===------------------------------------------------------------------===//
+    // Renderer
+    //===------------------------------------------------------------------===//
+
+    // a single worker thread shared by all schemes of the roll
+    class Renderer final : private Thread, private AsyncUpdater
+    {
+    public:
+
+        Renderer();
+        ~Renderer() override;
+
+        // called on the message thread when some patterns are ready
+        Function<void()> onRendered;
+
+    private:
+
+        struct RowsCache final : public ReferenceCountedObject
+        {
+            using Ptr = ReferenceCountedObjectPtr<RowsCache>;
+
+            CriticalSection lock;
+            Array<Image> rows; // indexed by row height
+            Array<bool> requested;
+        };
+
+        // the theme colours are picked on the message thread,
+        // so that the worker never touches the look and feel
+        struct Palette final
+        {
+            Colour blackKey;
+            Colour whiteKey;
+            Colour rootKey;
+            Colour rowLine;
+            float bevelBrightness = 0.f;
+            // only used for the noise texture, which never changes
+            const HelioTheme *theme = nullptr;
+        };
+
+        struct Job final
+        {
+            RowsCache::Ptr cache;
+            Palette palette;
+            Temperament::Ptr temperament;
+            Scale::Ptr scale;
+            Note::Key rootKey = 0;
+            int rowHeight = 0;
+        };
+
+        void schedule(const Job &job, bool isUrgent);
+
+        void run() override;
+        void handleAsyncUpdate() override;
+
+        CriticalSection queueLock;
+        Array<Job> queue;
+
+        friend class HighlightingScheme;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Renderer)
+    };
+
 private:
 
+    static Image renderRowsPattern(const Renderer::Palette &palette,
+        const Temperament::Ptr temperament, const Scale::Ptr scale,
+        Note::Key root, int height);
+
     Scale::Ptr scale;
     Note::Key rootKey;
-    Array<Image> rows;
+
+    Renderer &renderer;
+    Renderer::Palette palette;
+    Temperament::Ptr temperament;
+
+    // the rendered patterns are shared with the worker's jobs, so that
+    // the scheme can be safely deleted or re-rendered while they are running
+    Renderer::RowsCache::Ptr cache;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HighlightingScheme)
 };
@@ -80,26 +80,36 @@ PianoRoll &NoteComponent::getRoll() const noexcept
 
 void NoteComponent::updateColours()
 {
-    const bool generated = this->flags.isGenerated;
-    const bool ghost = this->flags.isGhost || !this->flags.isActive;
+    this->palette = NoteComponent::makePalette(this->getNote().getTrackColour(),
+        this->flags.isGhost || !this->flags.isActive,
+        this->flags.isGenerated, this->flags.isSelected);
+}
+
+NoteComponent::Palette NoteComponent::makePalette(const Colour &trackColour,
+    bool ghost, bool generated, bool selected) noexcept
+{
     const bool darkTheme = HelioTheme::getCurrentTheme().isDark();
     const auto base = findDefaultColour(ColourIDs::Roll::noteFill);
 
-    this->colour = this->getNote().getTrackColour()
+    Palette palette;
+
+    palette.fill = trackColour
         .interpolatedWith(base, ghost ? 0.15f : (generated ? 0.3f : 0.4f))
-        .brighter(this->flags.isSelected ? 1.15f : 0.f)
+        .brighter(selected ? 1.15f : 0.f)
         .withMultipliedSaturationHSL(ghost || generated ? 1.5f : 1.f)
         .withAlpha(ghost ? 0.25f : (generated ? 0.4f : 0.95f));
 
     if (ghost)
     {
-        this->colour = darkTheme ?
-            this->colour.brighter(0.55f) : this->colour.darker(0.45f);
+        palette.fill = darkTheme ?
+            palette.fill.brighter(0.55f) : palette.fill.darker(0.45f);
     }
 
-    this->colourLighter = this->colour.brighter(darkTheme ? 0.125f : 0.2f);
-    this->colourDarker = this->colour.darker(darkTheme ? 0.25f : 0.15f).withMultipliedAlpha(1.25f);
-    this->colourVolume = this->colour.darker(0.75f).withAlpha(ghost || generated ? 0.f : 0.5f);
+    palette.lighter = palette.fill.brighter(darkTheme ? 0.125f : 0.2f);
+    palette.darker = palette.fill.darker(darkTheme ? 0.25f : 0.15f).withMultipliedAlpha(1.25f);
+    palette.volume = palette.fill.darker(0.75f).withAlpha(ghost || generated ? 0.f : 0.5f);
+
+    return palette;
 }
 
 bool NoteComponent::shouldGoQuickSelectTrackMode(const ModifierKeys &modifiers) const
@@ -661,23 +671,36 @@ void NoteComponent::mouseDoubleClick(const MouseEvent &e)
 // Notes painting
 //===----------------------------------------------------------------------===//
 
+void NoteComponent::paint(Graphics &g) noexcept
+{
+    NoteComponent::paintNote(g, this->floatLocalBounds, this->palette,
+        this->note, this->clip, this->flags.isGenerated);
+
+    // debug
+    //g.setColour(Colours::orangered);
+    //const auto edge = this->getResizableEdge();
+    //g.fillRect(0, 0, edge, this->getHeight());
+    //g.fillRect(this->getWidth() - edge, 0, edge, this->getHeight());
+}
+
 // Always use only either drawHorizontalLine/drawVerticalLine,
 // or fillRect - these are the ones with minimal overhead:
-void NoteComponent::paint(Graphics &g) noexcept
+void NoteComponent::paintNote(Graphics &g, const Rectangle<float> &bounds,
+    const Palette &palette, const Note &note, const Clip &clip, bool generated) noexcept
 {
-    const float x = this->floatLocalBounds.getX() + 0.5f; // a small gap
-    const float w = this->floatLocalBounds.getWidth() - 1.f; // between notes
-    const float y = this->floatLocalBounds.getY();
-    const float h = this->floatLocalBounds.getHeight();
+    const float x = bounds.getX() + 0.5f; // a small gap
+    const float w = bounds.getWidth() - 1.f; // between notes
+    const float y = bounds.getY();
+    const float h = bounds.getHeight();
     
-    g.setColour(this->colour);
+    g.setColour(palette.fill);
 
     if (w >= 0.5f)
     {
         // fill
         g.fillRect(x + 0.25f, y + 1.f, w - 0.5f, h - 2.f);
 
-        if (this->flags.isGenerated)
+        if (generated)
         {
             HelioTheme::drawStripes({ x + 0.25f, y + 0.5f, w - 0.5f, h - 1.f }, g);
         }
@@ -690,22 +713,22 @@ void NoteComponent::paint(Graphics &g) noexcept
     if (w >= 1.5f)
     {
         // top/bottom horizontal borders
-        g.setColour(this->colourLighter);
+        g.setColour(palette.lighter);
         g.fillRect(x + 0.75f, roundf(y), w - 1.5f, 1.f);
 
-        g.setColour(this->colourDarker);
-        g.fillRect(x + 0.75f, roundf(h - 1.f), w - 1.5f, 1.f);
+        g.setColour(palette.darker);
+        g.fillRect(x + 0.75f, roundf(y + h - 1.f), w - 1.5f, 1.f);
     }
 
-    // velocity line
-    if (w >= 6.f)
+    // velocity line (transparent for ghost and generated notes)
+    if (w >= 6.f && !palette.volume.isTransparent())
     {
-        g.setColour(this->colourVolume);
+        g.setColour(palette.volume);
         const float sx = x + 1.5f;
         const float sh = jmin(h - 2.f, 4.f);
-        const float sy = h - sh - 1.f;
-        const float sw1 = (w - 4.f) * this->note.getVelocity();
-        const float sw2 = (w - 4.f) * this->note.getVelocity() * this->clip.getVelocity();
+        const float sy = y + h - sh - 1.f;
+        const float sw1 = (w - 4.f) * note.getVelocity();
+        const float sw2 = (w - 4.f) * note.getVelocity() * clip.getVelocity();
 
         g.fillRect(sx, sy, sw1, sh);
         g.fillRect(sx, sy, sw2, sh);
@@ -715,27 +738,21 @@ void NoteComponent::paint(Graphics &g) noexcept
     }
 
     // tuplet marks
-    const auto tuplet = this->note.getTuplet();
+    const auto tuplet = note.getTuplet();
     if (tuplet > 1 && w > 25.f)
     {
-        g.setColour(this->colourLighter);
+        g.setColour(palette.lighter);
         for (int i = 1; i < tuplet; ++i)
         {
             g.fillRect(x + i * (w / tuplet) - 1.f, y, 1.f, h);
         }
 
-        g.setColour(this->colourVolume);
+        g.setColour(palette.volume);
         for (int i = 1; i < tuplet; ++i)
         {
             g.fillRect(x + i * (w / tuplet), y, 1.5f, h);
         }
     }
-
-    // debug
-    //g.setColour(Colours::orangered);
-    //const auto edge = this->getResizableEdge();
-    //g.fillRect(0, 0, edge, this->getHeight());
-    //g.fillRect(this->getWidth() - edge, 0, edge, this->getHeight());
 }
 
 //===----------------------------------------------------------------------===//
@@ -70,6 +70,28 @@ public:
 
     void updateColours() override;
 
+    //===------------------------------------------------------------------===//
+    // Painting helpers
+    //===------------------------------------------------------------------===//
+
+    // the roll only creates components for the active clip's notes,
+    // and draws all other notes directly with these helpers:
+
+    struct Palette final
+    {
+        Colour fill;
+        Colour lighter;
+        Colour darker;
+        Colour volume;
+    };
+
+    static Palette makePalette(const Colour &trackColour,
+        bool ghost, bool generated, bool selected) noexcept;
+
+    static void paintNote(Graphics &g, const Rectangle<float> &bounds,
+        const Palette &palette, const Note &note, const Clip &clip,
+        bool generated) noexcept;
+
     //===------------------------------------------------------------------===//
     // RollChildComponentBase
     //===------------------------------------------------------------------===//
@@ -211,10 +233,7 @@ private:
     State state = State::None;
     bool isInEditMode() const;
 
-    Colour colour;
-    Colour colourLighter;
-    Colour colourDarker;
-    Colour colourVolume;
+    Palette palette;
 
     friend class PianoRoll;
     friend class NoteResizerLeft;
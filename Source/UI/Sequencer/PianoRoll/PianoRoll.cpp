@@ -56,19 +56,6 @@
 #include "ComponentIDs.h"
 #include "Config.h"
 
-#define forEachEventOfGivenTrack(map, child, track) \
-    for (const auto &_c : map) \
-        if (_c.first.getPattern()->getTrack() == track) \
-            for (const auto &child : (*_c.second.get()))
-
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
-
-#define forEachEventComponent(map, child) \
-    for (const auto &_c : this->patternMap) \
-        for (const auto &child : (*_c.second.get()))
-
 #if PLATFORM_DESKTOP
 #   define PIANOROLL_HAS_NOTE_RESIZERS 0
 #elif PLATFORM_MOBILE
@@ -86,6 +73,12 @@ PianoRoll::PianoRoll(ProjectNode &project, Viewport &viewport, WeakReference<Aud
     this->draggingHelper = make<NotesDraggingGuide>();
     this->addChildComponent(this->draggingHelper.get());
 
+    this->backgroundsRenderer = make<HighlightingScheme::Renderer>();
+    this->backgroundsRenderer->onRendered = [this]()
+    {
+        this->repaint(this->viewport.getViewArea());
+    };
+
     this->consoleMoveNotesMenu = make<CommandPaletteMoveNotesMenu>(*this, this->project);
     this->consoleChordConstructor = make<CommandPaletteChordConstructor>(*this);
 
@@ -102,8 +95,9 @@ PianoRoll::~PianoRoll() = default;
 void PianoRoll::reloadRollContent()
 {
     this->selection.deselectAll();
-    this->generatedNotes.clear();
-    this->patternMap.clear();
+    this->generatedSequences.clear();
+    this->noteComponents.clear();
+    this->pianoTracks.clearQuick();
 
     ROLL_BATCH_REPAINT_START
 
@@ -112,6 +106,7 @@ void PianoRoll::reloadRollContent()
         this->loadTrack(track);
     }
 
+    this->loadActiveClipNotes();
     this->updateBackgroundCachesAndRepaint();
     this->applyEditModeUpdates();
 
@@ -120,33 +115,56 @@ void PianoRoll::reloadRollContent()
 
 void PianoRoll::loadTrack(const MidiTrack *const track)
 {
-    if (track->getPattern() == nullptr)
+    if (track->getPattern() == nullptr ||
+        dynamic_cast<const PianoSequence *>(track->getSequence()) == nullptr)
     {
         return;
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    this->pianoTracks.addIfNotAlreadyThere(track);
+}
+
+void PianoRoll::loadActiveClipNotes()
+{
+    this->noteComponents.clear();
+    this->newNoteDragging = nullptr;
+
+    if (this->activeTrack == nullptr ||
+        this->activeTrack->getPattern() == nullptr)
     {
-        const Clip *clip = track->getPattern()->getUnchecked(i);
+        return;
+    }
+
+    const auto *pattern = this->activeTrack->getPattern();
+    const auto *sequence = this->activeTrack->getSequence();
 
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
-        const bool isActive = this->activeClip == *clip;
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        // components have to reference the pattern-owned clip,
+        // which is updated in place, not the local copy:
+        const auto *clip = pattern->getUnchecked(i);
+        if (*clip != this->activeClip)
+        {
+            continue;
+        }
 
-        for (int j = 0; j < track->getSequence()->size(); ++j)
+        for (const auto *event : *sequence)
         {
-            const auto *event = track->getSequence()->getUnchecked(j);
             if (event->isTypeOf(MidiEvent::Type::Note))
             {
                 const auto *note = static_cast<const Note *>(event);
                 auto *nc = new NoteComponent(*this, *note, *clip);
-                (*sequenceMap)[*note] = UniquePointer<NoteComponent>(nc);
-                nc->setActive(isActive, true);
+                this->noteComponents[*note] = UniquePointer<NoteComponent>(nc);
+                nc->setActive(true, true);
+                nc->setDisplayAsGenerated(this->isPreviewingGeneratedNotes &&
+                    this->generatedSequences.contains(*clip));
                 this->addAndMakeVisible(nc);
                 // project/view ranges may change right after reloading, so:
                 this->triggerBatchRepaintFor(nc);
             }
         }
+
+        break;
     }
 }
 
@@ -201,20 +219,18 @@ void PianoRoll::updateHeight()
 
 void PianoRoll::selectAll()
 {
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &e : this->noteComponents)
     {
         auto *childComponent = e.second.get();
-        if (childComponent->belongsTo(this->activeClip))
-        {
-            jassert(childComponent->isActiveAndEditable());
-            this->selectEvent(childComponent, false);
-        }
+        jassert(childComponent->belongsTo(this->activeClip));
+        jassert(childComponent->isActiveAndEditable());
+        this->selectEvent(childComponent, false);
     }
 }
 
 void PianoRoll::setChildrenInteraction(bool interceptsMouse, MouseCursor cursor)
 {
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &e : this->noteComponents)
     {
         auto *childComponent = e.second.get();
         childComponent->setInterceptsMouseClicks(interceptsMouse, interceptsMouse);
@@ -317,10 +333,10 @@ void PianoRoll::onLongTap(const Point<float> &position,
     if (!this->multiTouchController->hasMultiTouch() &&
         !this->getEditMode().forbidsSelectionMode({}))
     {
-        const auto *nc = dynamic_cast<NoteComponent *>(target.get());
-        if (nc != nullptr && !nc->isActiveAndEditable())
+        const auto *clip = (target == this) ? this->findInactiveClipAt(position) : nullptr;
+        if (clip != nullptr)
         {
-            this->project.setEditableScope(nc->getClip(), false);
+            this->project.setEditableScope(*clip, false);
             return;
         }
     }
@@ -552,22 +568,23 @@ void PianoRoll::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
         const auto &newNote = static_cast<const Note &>(newEvent);
         const auto *track = newEvent.getSequence()->getTrack();
 
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        if (track == this->activeTrack.get() && this->noteComponents.contains(note))
         {
-            auto &sequenceMap = *c.second.get();
-            if (auto *component = sequenceMap[note].release())
-            {
-                // Pass ownership to another key:
-                sequenceMap.erase(note);
-                // Hitting this assert means that a track somehow contains events
-                // with duplicate id's. This should never, ever happen.
-                jassert(!sequenceMap.contains(newNote));
-                // Always erase before updating, as it may happen both events have the same hash code:
-                sequenceMap[newNote] = UniquePointer<NoteComponent>(component);
-                // Schedule to be repainted later:
-                this->triggerBatchRepaintFor(component);
-            }
+            // Pass ownership to another key:
+            auto *component = this->noteComponents[note].release();
+            this->noteComponents.erase(note);
+            // Hitting this assert means that a track somehow contains events
+            // with duplicate id's. This should never, ever happen.
+            jassert(!this->noteComponents.contains(newNote));
+            // Always erase before updating, as it may happen both events have the same hash code:
+            this->noteComponents[newNote] = UniquePointer<NoteComponent>(component);
+            // Schedule to be repainted later:
+            this->triggerBatchRepaintFor(component);
         }
+
+        // other instances of the same track's sequence have no components:
+        this->repaintInactiveNote(note);
+        this->repaintInactiveNote(newNote);
     }
     else if (oldEvent.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -593,36 +610,35 @@ void PianoRoll::onAddMidiEvent(const MidiEvent &event)
         const Note &note = static_cast<const Note &>(event);
         const auto *track = note.getSequence()->getTrack();
 
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        if (track == this->activeTrack.get())
         {
-            auto &sequenceMap = *c.second.get();
-            const auto *targetClipId = &c.first;
-            const int i = track->getPattern()->indexOfSorted(targetClipId);
+            const int i = track->getPattern()->indexOfSorted(&this->activeClip);
             jassert(i >= 0);
-            
+
             const auto *clip = track->getPattern()->getUnchecked(i);
             auto *component = new NoteComponent(*this, note, *clip);
-            sequenceMap[note] = UniquePointer<NoteComponent>(component);
+            this->noteComponents[note] = UniquePointer<NoteComponent>(component);
             this->addAndMakeVisible(component);
 
             this->fader.fadeIn(component, Globals::UI::fadeInLong);
 
-            const bool isActive = component->belongsTo(this->activeClip);
-            component->setActive(isActive, true);
+            component->setActive(true, true);
 
-            if (isActive && !this->isDraggingAnyNotes)
+            if (!this->isDraggingAnyNotes)
             {
                 // arpeggiators preview cannot work without that:
                 this->selectEvent(component, false);
             }
 
-            if (this->addNewNoteMode && isActive)
+            if (this->addNewNoteMode)
             {
                 this->newNoteDragging = component;
                 this->addNewNoteMode = false;
                 this->selectEvent(this->newNoteDragging, true); // clear prev selection
             }
         }
+
+        this->repaintInactiveNote(note);
     }
     else if (event.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -645,17 +661,15 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
         const Note &note = static_cast<const Note &>(event);
         const auto *track = note.getSequence()->getTrack();
 
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        if (track == this->activeTrack.get() && this->noteComponents.contains(note))
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                NoteComponent *deletedComponent = sequenceMap[note].get();
-                this->fader.fadeOut(deletedComponent, Globals::UI::fadeOutLong);
-                this->selection.deselect(deletedComponent);
-                sequenceMap.erase(note);
-            }
+            NoteComponent *deletedComponent = this->noteComponents[note].get();
+            this->fader.fadeOut(deletedComponent, Globals::UI::fadeOutLong);
+            this->selection.deselect(deletedComponent);
+            this->noteComponents.erase(note);
         }
+
+        this->repaintInactiveNote(note);
     }
     else if (event.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -670,38 +684,8 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
 
 void PianoRoll::onAddClip(const Clip &clip)
 {
-    const SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
-
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-    {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
-    }
-
-    if (referenceMap == nullptr)
-    {
-        jassertfalse;
-        return;
-    }
-
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
-
-    for (const auto &e : *referenceMap)
-    {
-        // reference the same note as neighbor components:
-        const auto &note = e.second.get()->getNote();
-        auto *component = new NoteComponent(*this, note, clip);
-        (*sequenceMap)[note] = UniquePointer<NoteComponent>(component);
-        this->addAndMakeVisible(component);
-
-        const bool isActive = component->belongsTo(this->activeClip);
-        component->setActive(isActive);
-    }
-
-    this->triggerAsyncUpdate();
+    // a new clip is never the active one, so it has no components to create
+    this->repaint(this->viewport.getViewArea());
 }
 
 void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
@@ -709,29 +693,22 @@ void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
     if (this->activeClip == clip) // same id
     {
         this->activeClip = newClip; // new parameters
-    }
-
-    if (auto *sequenceMap = this->patternMap[clip].release())
-    {
-        // Set new key for existing sequence map
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceMap>(sequenceMap);
 
-        // And update all components within it, as their beats should change
-        for (const auto &e : *sequenceMap)
+        // update all components, as their beats should change
+        for (const auto &e : this->noteComponents)
         {
             this->batchRepaintList.add(e.second.get());
         }
 
-        if (newClip == this->activeClip)
-        {
-            this->updateClipRangeIndicator();
-        }
+        this->updateClipRangeIndicator();
 
         // Schedule batch repaint
         this->triggerAsyncUpdate();
     }
 
+    // inactive clips and generated notes are painted directly:
+    this->repaint(this->viewport.getViewArea());
+
     RollBase::onChangeClip(clip, newClip);
 }
 
@@ -739,18 +716,25 @@ void PianoRoll::onRemoveClip(const Clip &clip)
 {
     ROLL_BATCH_REPAINT_START
 
-    if (this->patternMap.contains(clip))
+    this->generatedSequences.erase(clip);
+
+    if (this->activeClip == clip)
     {
-        this->patternMap.erase(clip);
+        this->selection.deselectAll();
+        this->noteComponents.clear();
+        this->newNoteDragging = nullptr;
     }
 
+    this->repaint(this->viewport.getViewArea());
+
     ROLL_BATCH_REPAINT_END
 }
 
 void PianoRoll::onReloadGeneratedSequence(const Clip &clip,
     MidiSequence *const generatedSequence)
 {
-    this->generatedNotes.erase(clip);
+    this->generatedSequences.erase(clip);
+    this->repaint(this->viewport.getViewArea());
 
     if (generatedSequence == nullptr ||
         generatedSequence->isEmpty() ||
@@ -759,40 +743,20 @@ void PianoRoll::onReloadGeneratedSequence(const Clip &clip,
         return;
     }
 
-    auto &newComponents = this->generatedNotes[clip];
-    const bool isActive = clip == this->activeClip;
-
-    for (const auto *event : *generatedSequence)
-    {
-        // only notes are supported at the moment
-        jassert(dynamic_cast<const Note *>(event));
-        const auto *note = static_cast<const Note *>(event);
-
-        auto *component = new NoteComponent(*this, *note, clip);
-        component->setDisplayAsGenerated(true);
-        component->setActive(isActive);
-        component->setEditable(false);
-        this->addAndMakeVisible(component, 0);
-
-        newComponents.add(component);
-    }
+    // only notes are supported at the moment
+    jassert(dynamic_cast<PianoSequence *>(generatedSequence));
+    this->generatedSequences[clip] = generatedSequence;
 }
 
 void PianoRoll::onChangeTrackProperties(MidiTrack *const track)
 {
     if (dynamic_cast<const PianoSequence *>(track->getSequence()))
     {
-        forEachEventOfGivenTrack(this->patternMap, e, track)
+        if (track == this->activeTrack.get())
         {
-            const auto component = e.second.get();
-            component->updateColours();
-        }
-
-        for (const auto &generatedMap : this->generatedNotes)
-        {
-            for (auto *component : generatedMap.second)
+            for (const auto &e : this->noteComponents)
             {
-                component->updateColours();
+                e.second->updateColours();
             }
         }
 
@@ -848,15 +812,23 @@ void PianoRoll::onRemoveTrack(MidiTrack *const track)
         }
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    if (track->getPattern() != nullptr)
     {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
+        for (int i = 0; i < track->getPattern()->size(); ++i)
         {
-            this->patternMap.erase(clip);
+            const auto &clip = *track->getPattern()->getUnchecked(i);
+            this->generatedSequences.erase(clip);
         }
     }
 
+    if (track == this->activeTrack.get())
+    {
+        this->noteComponents.clear();
+        this->newNoteDragging = nullptr;
+    }
+
+    this->pianoTracks.removeFirstMatchingValue(track);
+
     this->repaint();
 }
 
@@ -923,45 +895,36 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
 
     this->selection.deselectAll();
 
+    const bool activeClipChanged =
+        this->activeTrack != newActiveTrack ||
+        this->activeClip != newActiveClip;
+
     this->activeTrack = newActiveTrack;
     this->activeClip = newActiveClip;
 
+    if (activeClipChanged)
+    {
+        this->loadActiveClipNotes();
+    }
+
     int focusMinKey = INT_MAX;
     int focusMaxKey = 0;
     float focusMinBeat = FLT_MAX;
     float focusMaxBeat = -FLT_MAX;
     bool hasComponentsToFocusOn = false;
 
-    for (const auto &generatedMap : this->generatedNotes)
+    if (shouldFocus)
     {
-        const bool belongsToActiveClip =
-            generatedMap.first == this->activeClip; // same id
-
-        for (auto *component : generatedMap.second)
+        for (const auto &e : this->noteComponents)
         {
-            component->setActive(belongsToActiveClip);
-        }
-    }
-
-    for (const auto &sequenceMap : this->patternMap)
-    {
-        const bool isActive =
-            sequenceMap.first == this->activeClip; // same id
-
-        for (const auto &components : *sequenceMap.second)
-        {
-            auto *nc = components.second.get();
+            const auto *nc = e.second.get();
             const auto key = nc->getKey() + this->activeClip.getKey();
-            nc->setActive(isActive, true);
 
-            if (shouldFocus && isActive)
-            {
-                hasComponentsToFocusOn = true;
-                focusMinKey = jmin(focusMinKey, key);
-                focusMaxKey = jmax(focusMaxKey, key);
-                focusMinBeat = jmin(focusMinBeat, nc->getBeat());
-                focusMaxBeat = jmax(focusMaxBeat, nc->getBeat() + nc->getLength());
-            }
+            hasComponentsToFocusOn = true;
+            focusMinKey = jmin(focusMinKey, key);
+            focusMaxKey = jmax(focusMaxKey, key);
+            focusMinBeat = jmin(focusMinBeat, nc->getBeat());
+            focusMaxBeat = jmax(focusMaxBeat, nc->getBeat() + nc->getLength());
         }
     }
 
@@ -1003,43 +966,40 @@ void PianoRoll::selectEventsInRange(float startBeat, float endBeat, bool shouldC
         this->selection.deselectAll();
     }
 
-    forEachEventComponent(this->patternMap, e)
+    this->forEachNoteComponentInBeatRange(startBeat, endBeat, [&](NoteComponent *component)
     {
-        auto *component = e.second.get();
         if (component->isActiveAndEditable() &&
             (component->getNote().getBeat() + component->getClip().getBeat()) >= startBeat &&
             (component->getNote().getBeat() + component->getClip().getBeat()) < endBeat)
         {
             this->selectEvent(component, false);
         }
-    }
+    });
 }
 
 void PianoRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
     const Rectangle<int> &rectangle)
 {
-    forEachEventComponent(this->patternMap, e)
+    this->forEachNoteComponentInArea(rectangle.toFloat(), [&](NoteComponent *component)
     {
-        auto *component = e.second.get();
         if (component->isActiveAndEditable() &&
             rectangle.intersects(component->getBounds()))
         {
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
         }
-    }
+    });
 }
 
 void PianoRoll::findLassoItemsInPolygon(Array<SelectableComponent *> &itemsFound,
     const Rectangle<int> &bounds, const Array<Point<float>> &polygon)
 {
-    forEachEventComponent(this->patternMap, e)
+    this->forEachNoteComponentInArea(bounds.toFloat(), [&](NoteComponent *component)
     {
-        auto *component = e.second.get();
         if (!component->isActiveAndEditable() ||
             !bounds.intersects(component->getBounds())) // fast path
         {
-            continue;
+            return;
         }
 
         if (DrawableLassoSource::boundsIntersectPolygon(component->getFloatBounds(), polygon))
@@ -1047,7 +1007,37 @@ void PianoRoll::findLassoItemsInPolygon(Array<SelectableComponent *> &itemsFound
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
         }
+    });
+}
+
+void PianoRoll::forEachNoteComponentInBeatRange(float startBeat, float endBeat,
+    const Function<void(NoteComponent *)> &callback) const
+{
+    if (this->activeTrack == nullptr)
+    {
+        return;
     }
+
+    const auto *sequence = static_cast<const PianoSequence *>(this->activeTrack->getSequence());
+    const auto clipBeat = this->activeClip.getBeat();
+
+    sequence->forEachNoteInBeatRange(startBeat - clipBeat, endBeat - clipBeat,
+        [&](const Note &note)
+        {
+            const auto found = this->noteComponents.find(note);
+            if (found != this->noteComponents.end())
+            {
+                callback(found->second.get());
+            }
+        });
+}
+
+void PianoRoll::forEachNoteComponentInArea(const Rectangle<float> &area,
+    const Function<void(NoteComponent *)> &callback) const
+{
+    this->forEachNoteComponentInBeatRange(
+        this->firstBeat + area.getX() / this->beatWidth,
+        this->firstBeat + area.getRight() / this->beatWidth, callback);
 }
 
 void PianoRoll::selectEvents(const Array<Note> &notes, bool shouldDeselectAllOthers)
@@ -1057,19 +1047,14 @@ void PianoRoll::selectEvents(const Array<Note> &notes, bool shouldDeselectAllOth
         this->deselectAll();
     }
 
-    for (const auto &it : this->patternMap)
+    for (const auto &note : notes)
     {
-        if (it.first == this->activeClip)
+        const auto found = this->noteComponents.find(note);
+        if (found != this->noteComponents.end())
         {
-            auto &sequenceMap = *it.second.get();
-            for (const auto &note : notes)
-            {
-                if (auto *component = sequenceMap[note].get())
-                {
-                    jassert(component->isActiveAndEditable());
-                    this->selectEvent(component, false);
-                }
-            }
+            auto *component = found->second.get();
+            jassert(component->isActiveAndEditable());
+            this->selectEvent(component, false);
         }
     }
 }
@@ -1102,20 +1087,13 @@ const NoteListBase &PianoRoll::getLassoOrEntireSequence() const
 
 void PianoRoll::onPlay()
 {
-    for (const auto &generatedMap : this->generatedNotes)
-    {
-        jassert(this->patternMap.contains(generatedMap.first));
-        if (auto *sequenceMap = this->patternMap[generatedMap.first].get())
-        {
-            for (const auto &it : *sequenceMap)
-            {
-                it.second->setDisplayAsGenerated(true);
-            }
-        }
+    this->isPreviewingGeneratedNotes = true;
 
-        for (auto *component : generatedMap.second)
+    if (this->generatedSequences.contains(this->activeClip))
+    {
+        for (const auto &it : this->noteComponents)
         {
-            component->setDisplayAsGenerated(false);
+            it.second->setDisplayAsGenerated(true);
         }
     }
 
@@ -1126,21 +1104,11 @@ void PianoRoll::onPlay()
 
 void PianoRoll::onStop()
 {
-    for (const auto &generatedMap : this->generatedNotes)
-    {
-        jassert(this->patternMap.contains(generatedMap.first));
-        if (auto *sequenceMap = this->patternMap[generatedMap.first].get())
-        {
-            for (const auto &it : *sequenceMap)
-            {
-                it.second->setDisplayAsGenerated(false);
-            }
-        }
+    this->isPreviewingGeneratedNotes = false;
 
-        for (auto *component : generatedMap.second)
-        {
-            component->setDisplayAsGenerated(true);
-        }
+    for (const auto &it : this->noteComponents)
+    {
+        it.second->setDisplayAsGenerated(false);
     }
 
     this->repaint();
@@ -1176,6 +1144,17 @@ void PianoRoll::mouseDown(const MouseEvent &e)
     }
 
     RollBase::mouseDown(e);
+
+    // the inactive clips' notes have no components to handle this,
+    // see NoteComponent::shouldGoQuickSelectTrackMode:
+    if (e.mods.isRightButtonDown() &&
+        this->getEditMode().shouldInteractWithChildren())
+    {
+        if (const auto *clip = this->findInactiveClipAt(e.position))
+        {
+            this->project.setEditableScope(*clip, e.mods.isAnyModifierKeyDown());
+        }
+    }
 }
 
 void PianoRoll::mouseDoubleClick(const MouseEvent &e)
@@ -1633,7 +1612,7 @@ void PianoRoll::resized()
 
     ROLL_BATCH_REPAINT_START
 
-    forEachEventComponent(this->patternMap, e)
+    for (const auto &e : this->noteComponents)
     {
         const auto component = e.second.get();
         component->setFloatBounds(this->getEventBounds(component));
@@ -1644,14 +1623,6 @@ void PianoRoll::resized()
         component->setFloatBounds(this->getEventBounds(component));
     }
 
-    for (const auto &components : this->generatedNotes)
-    {
-        for (auto *component : components.second)
-        {
-            component->setFloatBounds(this->getEventBounds(component));
-        }
-    }
-
     if (this->knifeToolHelper != nullptr)
     {
         this->knifeToolHelper->updateBounds();
@@ -1692,7 +1663,9 @@ void PianoRoll::paint(Graphics &g)
         jassert(index >= 0);
 
         const auto *s = (prevScheme == nullptr) ? this->backgroundsCache.getUnchecked(index) : prevScheme;
-        const auto fillImage = s->getUnchecked(this->rowHeight);
+        const auto fillImage = s->getRowsPattern(this->rowHeight);
+        // while zooming, the pattern may be rendered for another row height
+        const auto fillScale = float(periodHeight * 2) / float(fillImage.getHeight());
 
         if (beatX >= paintStartX)
         {
@@ -1710,7 +1683,8 @@ void PianoRoll::paint(Graphics &g)
 
             for (int i = paintStartY; i < y + h; i += periodHeight)
             {
-                g.setFillType({ fillImage, AffineTransform::translation(0.f, float(i)) });
+                g.setFillType({ fillImage,
+                    AffineTransform::scale(1.f, fillScale).translated(0.f, float(i)) });
                 g.fillRect(prevBeatX, i, beatX - prevBeatX, periodHeight);
             }
         }
@@ -1718,6 +1692,7 @@ void PianoRoll::paint(Graphics &g)
         if (beatX >= paintEndX)
         {
             RollBase::paint(g);
+            this->paintInactiveNotes(g);
             return;
         }
 
@@ -1728,19 +1703,141 @@ void PianoRoll::paint(Graphics &g)
     if (prevBeatX < paintEndX)
     {
         const auto *s = (prevScheme == nullptr) ? this->defaultHighlighting.get() : prevScheme;
-        const auto fillImage = s->getUnchecked(this->rowHeight);
+        const auto fillImage = s->getRowsPattern(this->rowHeight);
+        const auto fillScale = float(periodHeight * 2) / float(fillImage.getHeight());
 
         // just because we cannot rely on OpenGL tiling:
         for (int i = paintStartY; i < y + h; i += periodHeight)
         {
-            g.setFillType({ fillImage, AffineTransform::translation(0.f, float(i)) });
+            g.setFillType({ fillImage,
+                AffineTransform::scale(1.f, fillScale).translated(0.f, float(i)) });
             g.fillRect(prevBeatX, i, paintEndX - prevBeatX, periodHeight);
         }
 
         RollBase::paint(g);
+        this->paintInactiveNotes(g);
     }
 }
 
+void PianoRoll::paintInactiveNotes(Graphics &g) const
+{
+    const auto area = g.getClipBounds().toFloat();
+    const auto startBeat = this->firstBeat + area.getX() / this->beatWidth;
+    const auto endBeat = this->firstBeat + area.getRight() / this->beatWidth;
+
+    const auto paintNotes = [&](const PianoSequence &sequence,
+        const Clip &clip, const NoteComponent::Palette &palette, bool generated)
+    {
+        sequence.forEachNoteInBeatRange(startBeat - clip.getBeat(), endBeat - clip.getBeat(),
+            [&](const Note &note)
+            {
+                const auto bounds = this->getEventBounds(note.getKey() + clip.getKey(),
+                    note.getBeat() + clip.getBeat(), note.getLength());
+
+                if (bounds.getBottom() >= area.getY() && bounds.getY() <= area.getBottom())
+                {
+                    NoteComponent::paintNote(g, bounds, palette, note, clip, generated);
+                }
+            });
+    };
+
+    for (const auto *track : this->pianoTracks)
+    {
+        const auto *sequence = static_cast<const PianoSequence *>(track->getSequence());
+        const auto *pattern = track->getPattern();
+        const auto trackColour = track->getTrackColour();
+
+        for (int i = 0; i < pattern->size(); ++i)
+        {
+            const auto &clip = *pattern->getUnchecked(i);
+            const bool isActive = clip == this->activeClip;
+
+            const auto generatedNotes = this->generatedSequences.find(clip);
+            const bool hasGeneratedNotes = generatedNotes != this->generatedSequences.end() &&
+                generatedNotes->second != nullptr;
+
+            if (hasGeneratedNotes)
+            {
+                const bool displayAsGenerated = !this->isPreviewingGeneratedNotes;
+                paintNotes(static_cast<const PianoSequence &>(*generatedNotes->second.get()), clip,
+                    NoteComponent::makePalette(trackColour, !isActive, displayAsGenerated, false),
+                    displayAsGenerated);
+            }
+
+            // the active clip's notes have their own components
+            if (isActive ||
+                clip.getBeat() + sequence->getFirstBeat() > endBeat ||
+                clip.getBeat() + sequence->getLastBeat() < startBeat)
+            {
+                continue;
+            }
+
+            const bool displayAsGenerated = hasGeneratedNotes && this->isPreviewingGeneratedNotes;
+            paintNotes(*sequence, clip,
+                NoteComponent::makePalette(trackColour, true, displayAsGenerated, false),
+                displayAsGenerated);
+        }
+    }
+}
+
+void PianoRoll::repaintInactiveNote(const Note &note)
+{
+    const auto *pattern = note.getSequence()->getTrack()->getPattern();
+    if (pattern == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        const auto *clip = pattern->getUnchecked(i);
+        if (*clip != this->activeClip)
+        {
+            this->inactiveNotesDirtyArea = this->inactiveNotesDirtyArea.getUnion(
+                this->getEventBounds(note.getKey() + clip->getKey(),
+                    note.getBeat() + clip->getBeat(), note.getLength()));
+        }
+    }
+
+    this->triggerAsyncUpdate();
+}
+
+const Clip *PianoRoll::findInactiveClipAt(const Point<float> &position) const
+{
+    const auto beat = this->firstBeat + position.getX() / this->beatWidth;
+    const auto key = int((this->getHeight() - position.getY()) / this->rowHeight);
+
+    for (const auto *track : this->pianoTracks)
+    {
+        const auto *sequence = static_cast<const PianoSequence *>(track->getSequence());
+        const auto *pattern = track->getPattern();
+
+        for (int i = 0; i < pattern->size(); ++i)
+        {
+            const auto *clip = pattern->getUnchecked(i);
+            if (*clip == this->activeClip)
+            {
+                continue;
+            }
+
+            bool hasNoteAtPosition = false;
+            sequence->forEachNoteInBeatRange(beat - clip->getBeat(), beat - clip->getBeat(),
+                [&](const Note &note)
+                {
+                    hasNoteAtPosition = hasNoteAtPosition ||
+                        note.getKey() + clip->getKey() == key;
+                });
+
+            if (hasNoteAtPosition)
+            {
+                return clip;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
 void PianoRoll::insertNewNoteAt(const MouseEvent &e, bool snap)
 {
     int key = 0;
@@ -1776,16 +1873,32 @@ void PianoRoll::switchToClipInViewport() const
 
     FlatHashMap<Clip, int, ClipHash> visibilityWeights;
 
-    forEachEventComponent(this->patternMap, e)
+    const auto startBeat = this->firstBeat + fullArea.getX() / this->beatWidth;
+    const auto endBeat = this->firstBeat + fullArea.getRight() / this->beatWidth;
+
+    for (const auto *track : this->pianoTracks)
     {
-        auto *nc = e.second.get();
-        if (nc->getBounds().intersects(centreArea))
-        {
-            visibilityWeights[nc->getClip()] += 4;
-        }
-        else if (nc->getBounds().intersects(fullArea))
+        const auto *sequence = static_cast<const PianoSequence *>(track->getSequence());
+        const auto *pattern = track->getPattern();
+
+        for (int i = 0; i < pattern->size(); ++i)
         {
-            visibilityWeights[nc->getClip()] += 1;
+            const auto &clip = *pattern->getUnchecked(i);
+            sequence->forEachNoteInBeatRange(startBeat - clip.getBeat(), endBeat - clip.getBeat(),
+                [&](const Note &note)
+                {
+                    const auto bounds = this->getEventBounds(note.getKey() + clip.getKey(),
+                        note.getBeat() + clip.getBeat(), note.getLength()).toNearestInt();
+
+                    if (bounds.intersects(centreArea))
+                    {
+                        visibilityWeights[clip] += 4;
+                    }
+                    else if (bounds.intersects(fullArea))
+                    {
+                        visibilityWeights[clip] += 1;
+                    }
+                });
         }
     }
 
@@ -1833,17 +1946,17 @@ void PianoRoll::startErasingEvents(const Point<float> &mousePosition)
 
 void PianoRoll::continueErasingEvents(const Point<float> &mousePosition)
 {
-    forEachEventComponent(this->patternMap, it)
+    const Rectangle<float> mouseArea(mousePosition, mousePosition);
+    this->forEachNoteComponentInArea(mouseArea, [&](NoteComponent *nc)
     {
-        auto *nc = it.second.get();
         if (!nc->isActiveAndEditable() || !nc->isVisible())
         {
-            continue;
+            return;
         }
 
         if (!nc->getBounds().contains(mousePosition.toInt()))
         {
-            continue;
+            return;
         }
 
         // duplicates the behavior in onRemoveMidiEvent
@@ -1853,7 +1966,7 @@ void PianoRoll::continueErasingEvents(const Point<float> &mousePosition)
         nc->setVisible(false);
 
         this->notesToEraseOnMouseUp.add(nc->getNote());
-    }
+    });
 }
 
 void PianoRoll::endErasingEvents()
@@ -1897,7 +2010,7 @@ void PianoRoll::continueCuttingEvents(const Point<float> &mousePosition)
 
         bool addsPoint;
         Point<float> intersection;
-        forEachEventComponent(this->patternMap, e)
+        for (const auto &e : this->noteComponents)
         {
             addsPoint = false;
             auto *nc = e.second.get();
@@ -1952,15 +2065,15 @@ void PianoRoll::startMergingEvents(const Point<float> &mousePosition)
     this->deselectAll();
 
     NoteComponent *targetNote = nullptr;
-    forEachEventComponent(this->patternMap, e)
+    const Rectangle<float> mouseArea(mousePosition, mousePosition);
+    this->forEachNoteComponentInArea(mouseArea, [&](NoteComponent *nc)
     {
-        auto *nc = e.second.get();
         if (nc->isActiveAndEditable() &&
             nc->getBounds().contains(mousePosition.toInt()))
         {
             targetNote = nc;
         }
-    }
+    });
 
     if (this->mergeToolHelper == nullptr && targetNote != nullptr)
     {
@@ -1978,16 +2091,16 @@ void PianoRoll::continueMergingEvents(const Point<float> &mousePosition)
     }
 
     NoteComponent *targetNote = nullptr;
-    forEachEventComponent(this->patternMap, e)
+    const Rectangle<float> mouseArea(mousePosition, mousePosition);
+    this->forEachNoteComponentInArea(mouseArea, [&](NoteComponent *nc)
     {
-        auto *nc = e.second.get();
         if (nc->isActiveAndEditable() &&
             nc->getBounds().contains(mousePosition.toInt()) &&
             this->mergeToolHelper->canMergeInto(nc))
         {
             targetNote = nc;
         }
-    }
+    });
 
     const auto position = mousePosition / this->getLocalBounds().getBottomRight().toFloat();
     this->mergeToolHelper->setTargetComponent(targetNote);
@@ -2020,6 +2133,12 @@ void PianoRoll::endMergingEvents()
 
 void PianoRoll::handleAsyncUpdate()
 {
+    if (!this->inactiveNotesDirtyArea.isEmpty())
+    {
+        this->repaint(this->inactiveNotesDirtyArea.getSmallestIntegerContainer());
+        this->inactiveNotesDirtyArea = {};
+    }
+
 #if PIANOROLL_HAS_NOTE_RESIZERS
     if (this->selection.getNumSelected() > 0)
     {
@@ -2173,7 +2292,8 @@ void PianoRoll::updateBackgroundCachesAndRepaint()
     ROLL_BATCH_REPAINT_START
 
     const auto highlightingScale = App::Config().getTemperaments()->findHighlightingFor(this->temperament);
-    this->defaultHighlighting = make<HighlightingScheme>(0, highlightingScale);
+    this->defaultHighlighting = make<HighlightingScheme>(0,
+        highlightingScale, *this->backgroundsRenderer);
     this->defaultHighlighting->renderBackgroundCache(this->temperament);
 
     this->backgroundsCache.clear();
@@ -2202,7 +2322,8 @@ void PianoRoll::updateBackgroundCacheFor(const KeySignatureEvent &key)
     int duplicateSchemeIndex = this->binarySearchForHighlightingScheme(&key);
     if (duplicateSchemeIndex < 0)
     {
-        auto scheme = make<HighlightingScheme>(key.getRootKey(), key.getScale());
+        auto scheme = make<HighlightingScheme>(key.getRootKey(),
+            key.getScale(), *this->backgroundsRenderer);
         scheme->renderBackgroundCache(this->temperament);
         this->backgroundsCache.addSorted(*this->defaultHighlighting, scheme.release());
     }
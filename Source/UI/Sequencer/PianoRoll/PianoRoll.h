@@ -225,6 +225,7 @@ private:
 
     void reloadRollContent();
     void loadTrack(const MidiTrack *const track);
+    void loadActiveClipNotes();
 
     void updateHeight();
     void updateChildrenBounds() override;
@@ -232,6 +233,15 @@ private:
     void setChildrenInteraction(bool interceptsMouse, MouseCursor c) override;
 
     void switchToClipInViewport() const;
+    const Clip *findInactiveClipAt(const Point<float> &position) const;
+
+    // the active sequence is sorted by beat, so it works as a spatial index
+    // for the lasso and hit-testing, instead of checking every component;
+    // the callbacks get all components which may overlap the given range:
+    void forEachNoteComponentInBeatRange(float startBeat, float endBeat,
+        const Function<void(NoteComponent *)> &callback) const;
+    void forEachNoteComponentInArea(const Rectangle<float> &area,
+        const Function<void(NoteComponent *)> &callback) const;
     void insertNewNoteAt(const MouseEvent &e, bool snap = true);
     int getYPositionByKey(int targetKey) const;
 
@@ -270,6 +280,8 @@ private:
     void updateBackgroundCacheFor(const KeySignatureEvent &key);
     void removeBackgroundCacheFor(const KeySignatureEvent &key);
 
+    // renders the background patterns for all schemes in background
+    UniquePointer<HighlightingScheme::Renderer> backgroundsRenderer;
     OwnedArray<HighlightingScheme> backgroundsCache;
     UniquePointer<HighlightingScheme> defaultHighlighting;
     int binarySearchForHighlightingScheme(const KeySignatureEvent *const e) const noexcept;
@@ -297,12 +309,27 @@ private:
     UniquePointer<CommandPaletteMoveNotesMenu> consoleMoveNotesMenu;
     UniquePointer<CommandPaletteChordConstructor> consoleChordConstructor;
 
+    // interactive components only exist for the notes of the active clip;
+    // the notes of all other clips and all generated notes have no components,
+    // they are painted right from the sequences, culled to the repainted area:
     using SequenceMap = FlatHashMap<Note, UniquePointer<NoteComponent>, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
+    SequenceMap noteComponents;
+
+    // piano tracks to paint, kept here to avoid traversing the project tree on each repaint
+    Array<const MidiTrack *> pianoTracks;
 
     // a separate map for parametrically-generated sequences:
-    FlatHashMap<Clip, OwnedArray<NoteComponent>, ClipHash> generatedNotes;
+    FlatHashMap<Clip, WeakReference<MidiSequence>, ClipHash> generatedSequences;
+
+    // while playing, generated notes are displayed as normal ones,
+    // and the original notes of their clips are displayed as generated:
+    bool isPreviewingGeneratedNotes = false;
+
+    void paintInactiveNotes(Graphics &g) const;
+
+    // the area covered by the changed notes without components, repainted asynchronously:
+    Rectangle<float> inactiveNotesDirtyArea;
+    void repaintInactiveNote(const Note &note);
 
 private:
 
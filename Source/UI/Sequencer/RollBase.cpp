@@ -592,9 +592,21 @@ float RollBase::getZoomFactorY() const noexcept
 // TimeSignaturesAggregator::Listener
 //===----------------------------------------------------------------------===//
 
-void RollBase::onTimeSignaturesUpdated()
+void RollBase::onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat)
 {
-    this->repaint();
+    // the grid model is cheap to rebuild, but the visible lines
+    // only need to be recomputed when the changes are in sight:
+    this->gridSegmentsOutdated = true;
+
+    const auto viewX = float(this->viewport.getViewPositionX());
+    const auto visibleFirstBeat = this->getBeatByXPosition(viewX);
+    const auto visibleLastBeat = this->getBeatByXPosition(viewX + float(this->viewport.getViewWidth()));
+
+    if (firstAffectedBeat <= visibleLastBeat && lastAffectedBeat >= visibleFirstBeat)
+    {
+        this->gridViewState = {};
+        this->repaint();
+    }
 }
 
 //===----------------------------------------------------------------------===//
@@ -683,22 +695,80 @@ float RollBase::getMinVisibleBeatForCurrentZoomLevel() const
     return minBeat;
 }
 
+void RollBase::rebuildGridSegments()
+{
+    this->gridSegments.clearQuick();
+
+    auto *timeContext = this->project.getTimeline()->getTimeSignaturesAggregator();
+    const auto *signatures = timeContext->getSequence();
+    constexpr auto beatsPerBar = float(Globals::beatsPerBar);
+
+    // in the absence of time signatures we still need defaults for the grid,
+    // and the very first meter extends to the left as far as needed:
+    if (signatures->isEmpty())
+    {
+        GridSegment segment;
+        segment.startBar = timeContext->getDefaultMeterStartBeat() / beatsPerBar;
+        segment.endBar = FLT_MAX;
+        segment.numerator = timeContext->getDefaultNumerator();
+        segment.denominator = timeContext->getDefaultDenominator();
+        this->gridSegments.add(segment);
+        return;
+    }
+
+    for (int i = 0; i < signatures->size(); ++i)
+    {
+        const auto *signature = static_cast<const TimeSignatureEvent *>(signatures->getUnchecked(i));
+
+        GridSegment segment;
+        segment.startBar = signature->getBeat() / beatsPerBar;
+        segment.endBar = (i < signatures->size() - 1) ?
+            signatures->getUnchecked(i + 1)->getBeat() / beatsPerBar : FLT_MAX;
+        segment.numerator = signature->getNumerator();
+        segment.denominator = signature->getDenominator();
+
+        if (segment.endBar > segment.startBar)
+        {
+            this->gridSegments.add(segment);
+        }
+    }
+}
+
 void RollBase::updateAllSnapLines()
 {
     static constexpr auto minBarWidth = 12;
     static constexpr auto minBeatWidth = 7;
 
-    constexpr auto beatsPerBar = float(Globals::beatsPerBar);
+    const GridViewState viewState = {
+        this->viewport.getViewPositionX(),
+        this->viewport.getViewWidth(),
+        this->firstBeat,
+        this->beatWidth
+    };
+
+    if (this->gridSegmentsOutdated)
+    {
+        this->rebuildGridSegments();
+        this->gridSegmentsOutdated = false;
+    }
+
+    if (this->gridViewState == viewState)
+    {
+        // the grid lines are still valid, only the extra snaps need to be re-collected
+        this->updateAllSnapsFromGridLines();
+        return;
+    }
+
+    this->gridViewState = viewState;
 
     this->visibleBars.clearQuick();
     this->visibleBeats.clearQuick();
     this->visibleSnaps.clearQuick();
-    this->allSnaps.clearQuick();
 
-    auto *timeContext = this->project.getTimeline()->getTimeSignaturesAggregator();
+    constexpr auto beatsPerBar = float(Globals::beatsPerBar);
 
-    const float paintStartX = float(this->viewport.getViewPositionX());
-    const float paintEndX = float(paintStartX + this->viewport.getViewWidth());
+    const float paintStartX = float(viewState.viewX);
+    const float paintEndX = float(viewState.viewX + viewState.viewWidth);
 
     const float defaultBarWidth = float(this->beatWidth * beatsPerBar);
     const float firstBar = this->firstBeat / beatsPerBar;
@@ -711,162 +781,75 @@ void RollBase::updateAllSnapLines()
     const float numSnaps = powf(2, jlimit(1.f, 6.f, nearestPowTwo - 5.f)); // use -4.f for twice as dense grid
     const float snapWidth = defaultBarWidth / numSnaps;
 
-    // in the absence of time signatures we still need defaults for the grid:
-    int numerator = timeContext->getDefaultNumerator();
-    int denominator = timeContext->getDefaultDenominator();
-    float defaultMeterStartBeat = timeContext->getDefaultMeterStartBeat();
+    // start from the nearest time signature before the left side of visible area,
+    // or just pick the very first one, which also extends to the left:
+    const auto firstSegment = std::upper_bound(this->gridSegments.begin(), this->gridSegments.end(),
+        paintStartBar, [](float bar, const GridSegment &segment) { return bar <= segment.startBar; });
 
-    int nextTsIndex = 0;
-    // try to find the nearest time signature before the left side of visible area,
-    // or just pick the very first time signature, if available
-    for (bool hasPickedTheFirstMeter = false;
-         nextTsIndex < timeContext->getSequence()->size(); ++nextTsIndex)
+    for (int i = jmax(0, int(firstSegment - this->gridSegments.begin()) - 1);
+        i < this->gridSegments.size(); ++i)
     {
-        const auto *signature = static_cast<const TimeSignatureEvent *>
-            (timeContext->getSequence()->getUnchecked(nextTsIndex));
-
-        if ((signature->getBeat() / beatsPerBar) >= paintStartBar && hasPickedTheFirstMeter)
+        const auto &segment = this->gridSegments.getReference(i);
+        if (i > 0 && segment.startBar > paintEndBar)
         {
             break;
         }
 
-        numerator = signature->getNumerator();
-        denominator = signature->getDenominator();
-        defaultMeterStartBeat = signature->getBeat();
-        hasPickedTheFirstMeter = true;
-    }
+        const float beatStep = 1.f / float(segment.denominator);
+        const float barStep = beatStep * float(segment.numerator);
+        const float barWidth = defaultBarWidth * barStep;
 
-    const float defaultMeterStartBar = defaultMeterStartBeat / beatsPerBar;
-    const float defaultMeterBarLength = float(numerator) / float(denominator);
+        // too narrow bars are thinned out so that every n-th bar line is displayed,
+        // counting from the time signature start in both directions
+        const int barLinesStep = int(float(minBarWidth) / barWidth) + 1;
 
-    // iterate backwards from the first picked meter, if it starts on-screen
-    float barWidthSum = 0.f;
-    bool canDrawBarLine = true;
-    auto barIterator = defaultMeterStartBar - defaultMeterBarLength;
+        // the first segment extends to the left, all others start at their time signatures;
+        // also include the bar crossing the left edge of the visible area:
+        const int firstBarIndex = jmax(i == 0 ? INT_MIN / 2 : 0,
+            int(ceilf((paintStartBar - segment.startBar) / barStep)) - 1);
 
-    while (barIterator >= (paintStartBar - defaultMeterBarLength))
-    {
-        const float beatStep = 1.f / float(denominator);
-        const float barStep = beatStep * float(numerator);
-        const float barStartX = defaultBarWidth * (barIterator - firstBar);
-        const float barWidth = defaultBarWidth * barStep;
-
-        // when in the drawing area:
-        if (barIterator <= (paintEndBar + barStep))
+        for (int barIndex = firstBarIndex; ; ++barIndex)
         {
-            if (canDrawBarLine)
+            const float barStart = segment.startBar + barStep * float(barIndex);
+            if (barStart > paintEndBar || barStart >= segment.endBar)
             {
-                this->visibleBars.add(barStartX);
-                this->allSnaps.add(barStartX);
-            }
-
-            // the beat lines
-            for (float j = 0.f; j < barStep; j += beatStep)
-            {
-                const float beatStartX = barStartX + defaultBarWidth * j;
-                float nextBeatStartX = barStartX + defaultBarWidth * (j + beatStep);
-
-                // snap lines and beat lines
-                for (float k = beatStartX + snapWidth; k < (nextBeatStartX - 1); k += snapWidth)
-                {
-                    this->visibleSnaps.add(k);
-                    this->allSnaps.add(k);
-                }
-
-                if (j >= beatStep && // don't draw the first one as it is a bar line
-                    (nextBeatStartX - beatStartX) > minBeatWidth)
-                {
-                    this->visibleBeats.add(beatStartX);
-                    this->allSnaps.add(beatStartX);
-                }
+                break;
             }
-        }
-
-        barIterator -= barStep;
-
-        barWidthSum += barWidth;
-        canDrawBarLine = barWidthSum > minBarWidth;
-        barWidthSum = canDrawBarLine ? 0.f : barWidthSum;
-    }
-
-    // now iterate forwards from the anchor
 
-    barWidthSum = minBarWidth;
-    barIterator = defaultMeterStartBar;
+            const float barStartX = defaultBarWidth * (barStart - firstBar);
+            // the last bar of the segment may be incomplete:
+            const float barEnd = jmin(barStart + barStep, segment.endBar);
 
-    while (barIterator <= paintEndBar)
-    {
-        // don't do anything here until we reach the left side of visible area
+            const bool canDrawBarLine = barIndex >= 0 ?
+                (barIndex % barLinesStep == 0) :
+                ((-barIndex - 1) % barLinesStep == 0);
 
-        const float beatStep = 1.f / float(denominator);
-        float barStep = beatStep * float(numerator);
-        const float barStartX = defaultBarWidth * (barIterator - firstBar);
-        const float barWidth = defaultBarWidth * barStep;
-
-        barWidthSum += barWidth;
-        canDrawBarLine = barWidthSum > minBarWidth;
-        barWidthSum = canDrawBarLine ? 0.f : barWidthSum;
-
-        // when in the drawing area:
-        if (barIterator >= (paintStartBar - barStep))
-        {
             if (canDrawBarLine)
             {
                 this->visibleBars.add(barStartX);
-                this->allSnaps.add(barStartX);
             }
 
             // the beat lines
-            bool lastFrame = false;
-            for (float j = 0.f; j < barStep && !lastFrame; j += beatStep)
+            const float barLength = barEnd - barStart;
+            for (float j = 0.f; j < barLength; j += beatStep)
             {
                 const float beatStartX = barStartX + defaultBarWidth * j;
-                float nextBeatStartX = barStartX + defaultBarWidth * (j + beatStep);
-
-                // check if we have more time signatures to come
-                if (nextTsIndex < timeContext->getSequence()->size())
-                {
-                    const auto *nextSignature = static_cast<const TimeSignatureEvent *>
-                        (timeContext->getSequence()->getUnchecked(nextTsIndex));
-
-                    const float tsBar = nextSignature->getBeat() / beatsPerBar;
-                    if (tsBar <= (barIterator + j + beatStep))
-                    {
-                        numerator = nextSignature->getNumerator();
-                        denominator = nextSignature->getDenominator();
-                        barStep = (tsBar - barIterator); // i.e. incomplete bar
-                        nextBeatStartX = barStartX + defaultBarWidth * barStep;
-                        nextTsIndex++;
-                        barWidthSum = minBarWidth; // forces to draw the next bar line
-                        lastFrame = true;
-                    }
-                }
+                const float nextBeatStartX = defaultBarWidth *
+                    (jmin(barStart + j + beatStep, barEnd) - firstBar);
 
                 // snap lines and beat lines
                 for (float k = beatStartX + snapWidth; k < (nextBeatStartX - 1); k += snapWidth)
                 {
                     this->visibleSnaps.add(k);
-                    this->allSnaps.add(k);
                 }
 
                 if (j >= beatStep && // don't draw the first one as it is a bar line
                     (nextBeatStartX - beatStartX) > minBeatWidth)
                 {
                     this->visibleBeats.add(beatStartX);
-                    this->allSnaps.add(beatStartX);
                 }
             }
         }
-
-        barIterator += barStep;
-    }
-
-    // adding the project start beat to snaps helps a lot
-    // on higher zoom levels when the project starts off-beat
-    const auto projectStartBeatX = (this->projectFirstBeat - this->firstBeat) * this->beatWidth;
-    if (projectStartBeatX > paintStartX && projectStartBeatX < paintEndX)
-    {
-        this->allSnaps.add(projectStartBeatX);
     }
 
     // a nice fade-in/fade-out effect for the grid inspired by Miro
@@ -877,6 +860,26 @@ void RollBase::updateAllSnapLines()
         sqrtf(jmin(1.f, jmax(0.f, this->beatWidth - minBeatWidth) / (minBeatWidth * 32.f)));
 
     this->header->updateColours();
+
+    this->updateAllSnapsFromGridLines();
+}
+
+void RollBase::updateAllSnapsFromGridLines()
+{
+    this->allSnaps.clearQuick();
+    this->allSnaps.addArray(this->visibleBars);
+    this->allSnaps.addArray(this->visibleBeats);
+    this->allSnaps.addArray(this->visibleSnaps);
+
+    // adding the project start beat to snaps helps a lot
+    // on higher zoom levels when the project starts off-beat
+    const auto paintStartX = float(this->viewport.getViewPositionX());
+    const auto paintEndX = float(paintStartX + this->viewport.getViewWidth());
+    const auto projectStartBeatX = (this->projectFirstBeat - this->firstBeat) * this->beatWidth;
+    if (projectStartBeatX > paintStartX && projectStartBeatX < paintEndX)
+    {
+        this->allSnaps.add(projectStartBeatX);
+    }
 }
 
 //===----------------------------------------------------------------------===//
@@ -1556,29 +1559,35 @@ void RollBase::paint(Graphics &g)
     const float y = float(this->viewport.getViewPositionY());
     const float h = float(this->viewport.getViewHeight());
 
-    g.setColour(this->barLineColour);
-    for (const auto &f : this->visibleBars)
-    {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+    // the lines are collected into one list per colour and filled in batches,
+    // skipping the ones outside the area being repainted
+    const auto clipBounds = g.getClipBounds();
+    const float clipStartX = float(clipBounds.getX() - 1);
+    const float clipEndX = float(clipBounds.getRight());
 
-    g.setColour(this->barLineBevelColour);
-    for (const auto &f : this->visibleBars)
+    const auto fillLines = [&](const Array<float> &lines, float offset, const Colour &colour)
     {
-        g.fillRect(floorf(f + 1.f), y, 1.f, h);
-    }
+        this->gridLinesBatch.clear();
+        for (const auto &f : lines)
+        {
+            const auto x = floorf(f + offset);
+            if (x >= clipStartX && x < clipEndX)
+            {
+                this->gridLinesBatch.addWithoutMerging({ x, y, 1.f, h });
+            }
+        }
 
-    g.setColour(this->beatLineColour);
-    for (const auto &f : this->visibleBeats)
-    {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+        if (!this->gridLinesBatch.isEmpty())
+        {
+            g.setColour(colour);
+            g.fillRectList(this->gridLinesBatch);
+        }
+    };
 
-    g.setColour(this->snapLineColour);
-    for (const auto &f : this->visibleSnaps)
-    {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+    fillLines(this->visibleBars, 0.f, this->barLineColour);
+    fillLines(this->visibleBars, 1.f, this->barLineBevelColour);
+    fillLines(this->visibleBeats, 0.f, this->beatLineColour);
+    fillLines(this->visibleSnaps, 0.f, this->snapLineColour);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1741,7 +1750,7 @@ void RollBase::onStop()
     this->stopFollowingPlayhead();
     if (shouldCatchPlayhead)
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 }
 
@@ -1759,7 +1768,7 @@ bool RollBase::scrollToPlayheadPositionIfNeeded(int edgeMargin)
 
     if (App::Config().getUiFlags()->areUiAnimationsEnabled())
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
     else
     {
@@ -1775,7 +1784,7 @@ bool RollBase::scrollToPlayheadPositionIfNeeded(int edgeMargin)
 
 void RollBase::startFollowingPlayhead(bool forceScrollToPlayhead)
 {
-    this->stopTimer();
+    this->stopAnimating();
 
     if (this->playheadFollowMode != PlayheadFollowMode::Disabled)
     {
@@ -1792,7 +1801,7 @@ void RollBase::startFollowingPlayhead(bool forceScrollToPlayhead)
 
 void RollBase::stopFollowingPlayhead()
 {
-    this->stopTimer();
+    this->stopAnimating();
 
     if (this->playheadFollowMode != PlayheadFollowMode::Disabled)
     {
@@ -1852,10 +1861,10 @@ void RollBase::triggerBatchRepaintFor(FloatBoundsComponent *target)
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// FrameClock::Client
 //===----------------------------------------------------------------------===//
 
-void RollBase::timerCallback()
+void RollBase::onAnimationFrame()
 {
     const auto viewportCentreX = this->viewport.getViewPositionX() + this->viewport.getViewWidth() / 2;
     const auto playheadOffset = (this->playhead->getX() - viewportCentreX);
@@ -1871,7 +1880,7 @@ void RollBase::timerCallback()
 
     if (stuckFollowingPlayhead || doneFollowingPlayhead)
     {
-        this->stopTimer();
+        this->stopAnimating();
     }
 }
 
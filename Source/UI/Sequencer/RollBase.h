@@ -75,7 +75,7 @@ class RollBase :
     protected RollEditMode::Listener,
     protected TransportListener, // for positioning the playhead component and auto-scrolling
     protected AsyncUpdater, // coalesce multiple transport events ^^ into a single async view change
-    protected Timer, // for smooth scrolling to seek position,
+    protected FrameClock::Client, // for smooth scrolling to seek position,
     protected TimeSignaturesAggregator::Listener, // when the editable scope changes, active time signatures may change
     protected AudioMonitor::ClippingListener // for displaying clipping indicator components
 {
@@ -170,7 +170,7 @@ public:
     // TimeSignaturesAggregator::Listener
     //===------------------------------------------------------------------===//
 
-    void onTimeSignaturesUpdated() override;
+    void onTimeSignaturesUpdated(float firstAffectedBeat, float lastAffectedBeat) override;
 
     //===------------------------------------------------------------------===//
     // Misc
@@ -348,10 +348,10 @@ protected:
     friend class RollHeader;
     
     //===------------------------------------------------------------------===//
-    // Timer
+    // FrameClock::Client
     //===------------------------------------------------------------------===//
 
-    void timerCallback() override;
+    void onAnimationFrame() override;
     
 protected:
     
@@ -439,6 +439,46 @@ protected:
 
     virtual void updateAllSnapLines();
 
+private:
+
+    // the grid model, rebuilt only when time signatures change:
+    // knowing where each meter starts and ends, the lines for any visible
+    // range are computed without iterating all the bars before it
+    struct GridSegment final
+    {
+        float startBar = 0.f;
+        float endBar = 0.f;
+        int numerator = Globals::Defaults::timeSignatureNumerator;
+        int denominator = Globals::Defaults::timeSignatureDenominator;
+    };
+
+    Array<GridSegment> gridSegments;
+    bool gridSegmentsOutdated = true;
+    void rebuildGridSegments();
+
+    // the visible lines are only updated when the view changes,
+    // not on every repaint of some small area
+    struct GridViewState final
+    {
+        int viewX = 0;
+        int viewWidth = 0;
+        float firstBeat = 0.f;
+        float beatWidth = 0.f;
+
+        bool operator== (const GridViewState &other) const noexcept
+        {
+            return this->viewX == other.viewX &&
+                this->viewWidth == other.viewWidth &&
+                this->firstBeat == other.firstBeat &&
+                this->beatWidth == other.beatWidth;
+        }
+    };
+
+    GridViewState gridViewState;
+    void updateAllSnapsFromGridLines();
+
+    RectangleList<float> gridLinesBatch;
+
 protected:
 
     UniquePointer<LongTapController> longTapController;
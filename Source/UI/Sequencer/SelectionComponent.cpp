@@ -224,7 +224,7 @@ const Point<double> SelectionComponent::getParentSize() const
     return { 1.0, 1.0 };
 }
 
-void SelectionComponent::timerCallback()
+void SelectionComponent::onAnimationFrame()
 {
     const auto newOutline = this->currentOutline.interpolatedWith(this->targetOutline, 0.5f);
     const auto newFill = this->currentFill.interpolatedWith(this->targetFill, 0.3f);
@@ -232,7 +232,7 @@ void SelectionComponent::timerCallback()
     if (this->currentOutline == newOutline && this->currentFill == newFill)
     {
         //DBG("--- stop timer");
-        this->stopTimer();
+        this->stopAnimating();
 
         if (newOutline.getAlpha() == 0)
         {
@@ -254,12 +254,12 @@ void SelectionComponent::fadeIn()
     this->targetFill = this->fill;
     this->targetOutline = this->outline;
     this->setVisible(true);
-    this->startTimerHz(60);
+    this->startAnimating();
 }
 
 void SelectionComponent::fadeOut()
 {
     this->targetFill = Colours::transparentBlack;
     this->targetOutline = Colours::transparentBlack;
-    this->startTimerHz(60);
+    this->startAnimating();
 }
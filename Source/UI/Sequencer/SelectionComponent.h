@@ -19,8 +19,9 @@
 
 #include "Lasso.h"
 #include "SelectableComponent.h"
+#include "FrameClock.h"
 
-class SelectionComponent final : public Component, private Timer
+class SelectionComponent final : public Component, private FrameClock::Client
 {
 public:
 
@@ -62,7 +63,7 @@ private:
 private:
 
     // some helpers for the fancy animations
-    void timerCallback() override;
+    void onAnimationFrame() override;
     void fadeIn();
     void fadeOut();
 
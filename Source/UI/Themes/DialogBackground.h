@@ -18,11 +18,12 @@
 #pragma once
 
 #include "CommandIDs.h"
+#include "FrameClock.h"
 
 // Used by modal dialogs, supposed to be unowned
 // and deletes itself after a fadeout animation
 
-class DialogBackground final : public Component, private Timer
+class DialogBackground final : public Component, private FrameClock::Client
 {
 public:
     
@@ -31,7 +32,7 @@ public:
         this->setPaintingIsUnclipped(true);
         this->setInterceptsMouseClicks(false, false);
         this->setWantsKeyboardFocus(false);
-        this->startTimerHz(60);
+        this->startAnimating();
     }
     
     void handleCommandMessage(int commandId) override
@@ -39,7 +40,7 @@ public:
         if (commandId == CommandIDs::DismissDialog)
         {
             this->appearMode = false;
-            this->startTimerHz(60);
+            this->startAnimating();
         }
     }
 
@@ -64,7 +65,7 @@ private:
     static constexpr auto alphaStep = 0.02f;
     static constexpr auto maxAlpha = 0.1f;
 
-    void timerCallback() override
+    void onAnimationFrame() override
     {
         if (this->appearMode)
         {
@@ -73,7 +74,7 @@ private:
 
             if (this->alpha >= maxAlpha)
             {
-                this->stopTimer();
+                this->stopAnimating();
             }
         }
         else
@@ -69,9 +69,9 @@ void ViewportKineticSlider::calculateDragSpeedForViewport(Viewport *targetViewpo
     
     targetState->currentOffset = absDragOffset;
     
-    if (! this->isTimerRunning())
+    if (! this->isAnimating())
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 }
 
@@ -110,17 +110,17 @@ void ViewportKineticSlider::startAnimationForViewport(Viewport *targetViewport,
     animator->anchor = targetViewport->getViewPosition();
     this->animators.add(animator);
     
-    if (! this->isTimerRunning())
+    if (! this->isAnimating())
     {
-        this->startTimerHz(60);
+        this->startAnimating();
     }
 }
 
-void ViewportKineticSlider::timerCallback()
+void ViewportKineticSlider::onAnimationFrame()
 {
     if (this->animators.isEmpty() && this->dragStates.isEmpty())
     {
-        this->stopTimer();
+        this->stopAnimating();
     }
     
     // updates animators
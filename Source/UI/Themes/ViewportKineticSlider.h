@@ -17,7 +17,9 @@
 
 #pragma once
 
-class ViewportKineticSlider final : private Timer
+#include "FrameClock.h"
+
+class ViewportKineticSlider final : private FrameClock::Client
 {
 public:
     
@@ -33,7 +35,7 @@ public:
     
 private:
     
-    void timerCallback() override;
+    void onAnimationFrame() override;
     
     struct Animator final : ReferenceCountedObject
     {